@@ -26,8 +26,13 @@
 #include <opencv2/core/cvdef.h>
 
 #include "ball_image_proc.h"
+#include "spin_analysis_context.h"
+#include "spin_remap_cache.h"
+#include "hough_circle_engine.h"
+#include "dnn_preprocessor.h"
 #include "utils/logging_tools.h"
 #include "utils/cv_utils.h"
+#include "utils/ball_color_statistics.h"
 #include "gs_config.h"
 #include "gs_options.h"
 #include "gs_ui_system.h"
@@ -106,6 +111,7 @@ namespace golf_sim {
     double BallImageProc::kStrobedBallsParam2Increment = 4;
 
     bool  BallImageProc::kStrobedBallsUseAltHoughAlgorithm = true;
+    bool BallImageProc::kUseSinglePassHoughEngine = true;
     double BallImageProc::kStrobedBallsAltCannyLower = 35;
     double BallImageProc::kStrobedBallsAltCannyUpper = 70;
     int BallImageProc::kStrobedBallsAltPreCannyBlurSize = 11;
@@ -170,6 +176,13 @@ namespace golf_sim {
 
 
     bool BallImageProc::kLogIntermediateSpinImagesToFile = false;
+    bool BallImageProc::kUsePrecomputedSpinSearch = true;
+    bool BallImageProc::kUseBitplaneSpinScoring = true;
+    bool BallImageProc::kUseSpinRemapCache = true;
+    double BallImageProc::kSpinRemapCacheRadiusQuantumPixels = 0.25;
+    int BallImageProc::kSpinRemapCacheMaxMegabytes = 256;
+    bool BallImageProc::kSaveSpinRemapCacheToDisk = false;
+    std::string BallImageProc::kSpinRemapCacheDirectory = "";
     double BallImageProc::kPlacedBallHoughDpParam1 = 1.5;
 
     bool BallImageProc::kUseBestCircleRefinement = false;
@@ -219,6 +232,8 @@ namespace golf_sim {
     std::string BallImageProc::kONNXBackend = "onnxruntime";  // Default to ONNX Runtime
     bool BallImageProc::kONNXRuntimeAutoFallback = true;     // Enable automatic fallback
     int BallImageProc::kONNXRuntimeThreads = 4;              // ARM64 optimized default
+    int BallImageProc::kONNXRuntimeSessions = 1;
+    bool BallImageProc::kONNXUseTiledInference = false;
 
     // ONNX Runtime detector instance - replaces all static ONNX members
     std::unique_ptr<ONNXRuntimeDetector> BallImageProc::onnx_detector_;
@@ -232,7 +247,6 @@ namespace golf_sim {
     // Pre-allocated buffers - static members
     cv::Mat BallImageProc::yolo_input_buffer_;
     cv::Mat BallImageProc::yolo_letterbox_buffer_;
-    cv::Mat BallImageProc::yolo_resized_buffer_;
     cv::Mat BallImageProc::yolo_blob_buffer_;
     std::vector<cv::Rect> BallImageProc::yolo_detection_boxes_;
     std::vector<float> BallImageProc::yolo_detection_confidences_;
@@ -266,6 +280,18 @@ namespace golf_sim {
 
         GolfSimConfiguration::SetConstant("gs_config.spin_analysis.kGaborMinWhitePercent", kGaborMinWhitePercent);
         GolfSimConfiguration::SetConstant("gs_config.spin_analysis.kGaborMaxWhitePercent", kGaborMaxWhitePercent);
+        GolfSimConfiguration::SetConstant("gs_config.spin_analysis.kUsePrecomputedSpinSearch", kUsePrecomputedSpinSearch);
+        GolfSimConfiguration::SetConstant("gs_config.spin_analysis.kUseBitplaneSpinScoring", kUseBitplaneSpinScoring);
+        GolfSimConfiguration::SetConstant("gs_config.spin_analysis.kUseSpinRemapCache", kUseSpinRemapCache);
+        GolfSimConfiguration::SetConstant("gs_config.spin_analysis.kSpinRemapCacheRadiusQuantumPixels", kSpinRemapCacheRadiusQuantumPixels);
+        GolfSimConfiguration::SetConstant("gs_config.spin_analysis.kSpinRemapCacheMaxMegabytes", kSpinRemapCacheMaxMegabytes);
+        GolfSimConfiguration::SetConstant("gs_config.spin_analysis.kSaveSpinRemapCacheToDisk", kSaveSpinRemapCacheToDisk);
+        GolfSimConfiguration::SetConstant("gs_config.spin_analysis.kSpinRemapCacheDirectory", kSpinRemapCacheDirectory);
+
+        // Map any remap tables saved by earlier runs so that the first shot does not have to rebuild them
+        if (kUseSpinRemapCache && kSaveSpinRemapCacheToDisk) {
+            SpinRemapCache::GetSharedCache().LoadFromDisk(kSpinRemapCacheDirectory);
+        }
 
         GolfSimConfiguration::SetConstant("gs_config.ball_identification.kPlacedBallCannyLower", kPlacedBallCannyLower);
         GolfSimConfiguration::SetConstant("gs_config.ball_identification.kPlacedBallCannyUpper", kPlacedBallCannyUpper);
@@ -291,6 +317,7 @@ namespace golf_sim {
         GolfSimConfiguration::SetConstant("gs_config.ball_identification.kStrobedBallsMaxHoughReturnCircles", kStrobedBallsMaxHoughReturnCircles);
 
         GolfSimConfiguration::SetConstant("gs_config.ball_identification.kStrobedBallsUseAltHoughAlgorithm", kStrobedBallsUseAltHoughAlgorithm);
+        GolfSimConfiguration::SetConstant("gs_config.ball_identification.kUseSinglePassHoughEngine", kUseSinglePassHoughEngine);
 
         GolfSimConfiguration::SetConstant("gs_config.ball_identification.kStrobedBallsAltCannyLower", kStrobedBallsAltCannyLower);
         GolfSimConfiguration::SetConstant("gs_config.ball_identification.kStrobedBallsAltCannyUpper", kStrobedBallsAltCannyUpper);
@@ -595,8 +622,36 @@ namespace golf_sim {
 
         // *** ONNX DETECTION INTEGRATION - Process through full trajectory analysis pipeline ***
         if (kDetectionMethod == "experimental" || kDetectionMethod == "experimental_sahi") {
+            std::vector<cv::Point2f> predicted_centers;
+
+            // The crops are the model's input size, so an image that is no bigger than that in
+            // either direction (e.g., a 1456x1088 frame with the default 1472 model) is just run whole
+            const bool image_larger_than_model_input = (rgbImg.cols > kONNXInputSize && rgbImg.rows > kONNXInputSize);
+
+            if (kONNXUseTiledInference && !image_larger_than_model_input) {
+                static bool logged_tiling_inactive = false;
+                if (!logged_tiling_inactive) {
+                    GS_LOG_MSG(warning, "kONNXUseTiledInference has no effect - the " + std::to_string(rgbImg.cols) + "x" +
+                        std::to_string(rgbImg.rows) + " image already fits the " + std::to_string(kONNXInputSize) +
+                        "-pixel model input.  Tiling needs a model with a smaller input size, such as 640.");
+                    logged_tiling_inactive = true;
+                }
+            }
+
+            if (kONNXUseTiledInference && image_larger_than_model_input && expectedBallArea.area() > 0) {
+                // Cover the expected ball area with overlapping, model-input-sized crops
+                const int step = std::max(1, kONNXInputSize * 3 / 4);
+                const cv::Point area_end = expectedBallArea.br();
+
+                for (int y = expectedBallArea.y + std::min(step, expectedBallArea.height) / 2; y < area_end.y + step / 2; y += step) {
+                    for (int x = expectedBallArea.x + std::min(step, expectedBallArea.width) / 2; x < area_end.x + step / 2; x += step) {
+                        predicted_centers.emplace_back((float)std::min(x, area_end.x), (float)std::min(y, area_end.y));
+                    }
+                }
+            }
+
             std::vector<GsCircle> onnx_circles;
-            if (DetectBallsONNX(rgbImg, search_mode, onnx_circles)) {
+            if (DetectBallsONNX(rgbImg, search_mode, onnx_circles, predicted_centers)) {
                 // Convert GsCircle results to GolfBall objects for trajectory analysis
                 return_balls.clear();
                 for (size_t i = 0; i < onnx_circles.size(); ++i) {
@@ -653,9 +708,9 @@ namespace golf_sim {
         }
 
 
-        // We will create our own colorMask if we don't have one already
+        // We will create our own colorMask if we don't have one already (for an image of this size)
         // We will not do anything with the areaMask(other than to apply it further below if it exists)
-        if (color_mask_image_.empty()) {
+        if (color_mask_image_.empty() || color_mask_image_.size() != blurImg.size()) {
 
             cv::Mat hsvImage;
             cv::cvtColor(blurImg, hsvImage, cv::COLOR_BGR2HSV);
@@ -992,6 +1047,65 @@ namespace golf_sim {
             }
         }
 
+        // The narrowing search and the adaptive search below all look at the same image.  With the
+        // single-pass engine, its gradients, edges and center accumulator are only computed once
+        // per combination of gradient type, dp and param1 (for the widest radius range), and each
+        // search just picks out the circles that meet its param2 threshold and radius band.  So the
+        // narrowing search gets its own engine with its own dp and param1, and every step of the
+        // adaptive search shares another.  Otherwise, each search is a separate cv::HoughCircles.
+        const bool use_hough_engine = kUseSinglePassHoughEngine;
+
+        HoughCircleEngine::Settings engine_settings;
+        GetHoughEngineRadiusRange(search_mode, minimum_search_radius, maximum_search_radius,
+                                  engine_settings.min_radius, engine_settings.max_radius);
+
+        std::vector<HoughCircleEngine> hough_engines;
+
+        auto get_hough_engine = [&](cv::HoughModes mode, double dp, double param1) -> const HoughCircleEngine& {
+            const bool use_scharr = (mode == cv::HOUGH_GRADIENT_ALT);
+
+            for (const HoughCircleEngine& engine : hough_engines) {
+                if (engine.settings().dp == dp && engine.settings().canny_threshold == param1 &&
+                    engine.settings().use_scharr == use_scharr) {
+                    return engine;
+                }
+            }
+
+            auto engine_start = std::chrono::high_resolution_clock::now();
+
+            HoughCircleEngine::Settings settings = engine_settings;
+            settings.dp = dp;
+            settings.canny_threshold = param1;
+            settings.use_scharr = use_scharr;
+
+            hough_engines.emplace_back();
+            hough_engines.back().Compute(final_search_image, settings);
+
+            auto engine_end = std::chrono::high_resolution_clock::now();
+            GS_LOG_TRACE_MSG(trace, "HoughCircleEngine (dp = " + std::to_string(dp) + ", param1 = " + std::to_string(param1) + ") computed " +
+                std::to_string(hough_engines.back().number_of_candidates()) + " candidate centers from " +
+                std::to_string(hough_engines.back().number_of_edge_points()) + " edge points in " +
+                std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(engine_end - engine_start).count()) + " us.");
+
+            return hough_engines.back();
+        };
+
+        auto find_hough_circles = [&](cv::HoughModes mode, double dp, double param1, double param2,
+                                      double min_distance, int min_radius, int max_radius, std::vector<GsCircle>& found_circles) {
+            if (use_hough_engine) {
+                HoughCircleEngine::Query query;
+                query.score = (mode == cv::HOUGH_GRADIENT_ALT) ? HoughCircleEngine::Score::kPerimeterSupport : HoughCircleEngine::Score::kCenterVotes;
+                query.threshold = param2;
+                query.min_radius = min_radius;
+                query.max_radius = max_radius;
+                query.min_distance = min_distance;
+                found_circles = get_hough_engine(mode, dp, param1).GetCircles(query);
+            }
+            else {
+                cv::HoughCircles(final_search_image, found_circles, mode, dp, min_distance, param1, param2, min_radius, max_radius);
+            }
+        };
+
         if (search_mode == kStrobed || search_mode == kExternallyStrobed || search_mode == kFindPlacedBall) {
 
             if (kUseDynamicRadiiAdjustment && search_mode != kFindPlacedBall) {
@@ -1038,15 +1152,14 @@ namespace golf_sim {
                 // The _ALT mode seems to work best for this purpose
                 std::vector<GsCircle> test_circles;
                 
-                    cv::HoughCircles(final_search_image,
-                    test_circles,
-                    cv::HOUGH_GRADIENT_ALT,
+                find_hough_circles(cv::HOUGH_GRADIENT_ALT,
                     narrowing_dp_param,
-                    minimum_distance, 
                     kPlacedNarrowingParam1,
                     narrowing_radii_param2,
+                    minimum_distance,
                     (int)minimum_search_radius,
-                    (int)maximum_search_radius );
+                    (int)maximum_search_radius,
+                    test_circles);
                 
 
                 {
@@ -1175,15 +1288,14 @@ namespace golf_sim {
             // TBD - Need to set minDist to rows / 8, roughly ?
             std::vector<GsCircle> test_circles;
             
-            cv::HoughCircles(final_search_image,
-                test_circles,
-                hough_mode,
+            find_hough_circles(hough_mode,
                 currentDp,
-                /* minDist = */ minimum_distance, // Does this really matter if we are only looking for one circle ?
                 /* param1 = */ currentParam1,
                 /* param2 = */ currentParam2,
+                /* minDist = */ minimum_distance, // Does this really matter if we are only looking for one circle ?
                 /* minRadius = */ (int)minimum_search_radius,
-                /* maxRadius = */ (int)maximum_search_radius);
+                /* maxRadius = */ (int)maximum_search_radius,
+                test_circles);
 
             // Save the prior number of circles if we need it later
             if (!circles.empty()) {
@@ -1369,6 +1481,14 @@ namespace golf_sim {
                 c[1] += offset_sub_to_full.y;
             }
 
+            // Only build the color statistics if they will be used
+            std::unique_ptr<BallColorStatistics> color_statistics;
+            if (expectedBallColorExists || search_mode == kPutting) {
+                const size_t number_to_evaluate = std::min(circles.size(), (size_t)MAX_CIRCLES_TO_EVALUATE);
+                color_statistics = std::make_unique<BallColorStatistics>(rgbImg,
+                    std::vector<GsCircle>(circles.begin(), circles.begin() + number_to_evaluate));
+            }
+
             for (auto& c : circles) {
 
                 i += 1;
@@ -1396,7 +1516,7 @@ namespace golf_sim {
                     // Putting currently uses ball colors to weed out balls that are formed from the noise of the putting green.
                     if (expectedBallColorExists || search_mode == kPutting) {
                         // Only deal with color if we will be comparing colors
-                        std::vector<GsColorTriplet> stats = CvUtils::GetBallColorRgb(rgbImg, c);
+                        std::vector<GsColorTriplet> stats = color_statistics->GetBallColorRgb(c);
                         avg_RGB = { stats[0] };
                         medianRGB = { stats[1] };
                         stdRGB = { stats[2] };
@@ -2606,6 +2726,28 @@ namespace golf_sim {
         brightness_cutoff = i + 1;
     }
 
+    void BallImageProc::GetHoughEngineRadiusRange(BallSearchMode search_mode, int minimum_search_radius, int maximum_search_radius,
+                                                  int& engine_min_radius, int& engine_max_radius) {
+        const int initial_min_radius = CvUtils::RoundAndMakeEven(minimum_search_radius);
+        const int initial_max_radius = CvUtils::RoundAndMakeEven(maximum_search_radius);
+
+        engine_min_radius = initial_min_radius;
+        engine_max_radius = initial_max_radius;
+
+        if (!kUseDynamicRadiiAdjustment || search_mode == kFindPlacedBall) {
+            return;
+        }
+
+        // The narrowing search averages the radii of the circles it finds, which are somewhere in the
+        // initial range, and then searches from min_ratio to max_ratio times that average (rounded to
+        // an even number, hence the extra pixel each way)
+        const double min_ratio = std::min(kStrobedNarrowingRadiiMinRatio, 1.0);
+        const double max_ratio = std::max(kStrobedNarrowingRadiiMaxRatio, 1.0);
+
+        engine_min_radius = std::max(1, (int)std::floor(initial_min_radius * min_ratio) - 1);
+        engine_max_radius = (int)std::ceil(initial_max_radius * max_ratio) + 1;
+    }
+
     bool BallImageProc::RemoveSmallestConcentricCircles(std::vector<GsCircle> &circles) {
         // Remove any concentric (nested) circles that share the same center but have different radii
         // TBD - this shouldn't occur, but the HOUGH_ALT_GRADIENT mode does not seem to respect the minimum
@@ -3026,15 +3168,13 @@ namespace golf_sim {
         initialSearchSpace.anglez_rotation_degrees_start = kCoarseZRotationDegreesStart;
         initialSearchSpace.anglez_rotation_degrees_end = kCoarseZRotationDegreesEnd;
 
-        cv::Mat outputCandidateElementsMat;
-        std::vector< RotationCandidate> candidates;
-        cv::Vec3i output_candidate_elements_mat_size;
-
-        ComputeCandidateAngleImages(ball_image1DimpleEdges, initialSearchSpace, outputCandidateElementsMat, output_candidate_elements_mat_size, candidates, local_ball1);
+        // All of the search state for this shot lives in the context (not in statics), so that
+        // more than one spin analysis can safely be in progress at the same time
+        SpinAnalysisContext spin_context(ball_image1DimpleEdges, local_ball1, ball_image2DimpleEdges);
 
         // Compare the second (presumably rotated) ball image to different candidate rotations of the first ball image to determine the angular change
-        std::vector<std::string> comparison_csv_data;
-        int best_candidate_index = CompareCandidateAngleImages(&ball_image2DimpleEdges, &outputCandidateElementsMat, &output_candidate_elements_mat_size, &candidates, comparison_csv_data);
+        SpinAnalysisContext::SearchPass coarse_pass;
+        int best_candidate_index = spin_context.RunSearchPass(initialSearchSpace, coarse_pass);
         
         cv::Vec3f rotationResult;
 
@@ -3052,7 +3192,7 @@ namespace golf_sim {
             std::string csv_fname_coarse = "spin_analysis_coarse.csv";
             ofstream csv_file_coarse(csv_fname_coarse);
             GS_LOG_TRACE_MSG(trace, "Writing CSV spin data to: " + csv_fname_coarse);
-            for (auto& element : comparison_csv_data)
+            for (auto& element : coarse_pass.comparison_csv_data)
             {
                 // Don't use logging utility so that we don't have all the timing crap in the output
                 csv_file_coarse << element;
@@ -3061,7 +3201,7 @@ namespace golf_sim {
         }
 
         // See which angle looked best and then iterate more closely near those angles
-        RotationCandidate c = candidates[best_candidate_index];
+        RotationCandidate c = coarse_pass.candidates[best_candidate_index];
 
         std::string s = "Best Coarse Initial Rotation Candidate was #" + std::to_string(best_candidate_index) + " - Rot: (" + std::to_string(c.x_rotation_degrees) + ", " + std::to_string(c.y_rotation_degrees) + ", " + std::to_string(c.z_rotation_degrees) + ") ";
         GS_LOG_MSG(debug, s);
@@ -3085,16 +3225,10 @@ namespace golf_sim {
         finalSearchSpace.anglez_rotation_degrees_start = c.z_rotation_degrees - anglez_window_width;
         finalSearchSpace.anglez_rotation_degrees_end = c.z_rotation_degrees + anglez_window_width;
 
-        cv::Mat finalOutputCandidateElementsMat;
-        cv::Vec3i finalOutputCandidateElementsMatSize;
-        std::vector< RotationCandidate> finalCandidates;
-
-        // After this, the finalOutputCandidateElementsMat will have X,Y,Z elements with an index into the finalCandidates vector.
-        // Each candidate in finalCandidates will have an image, associated X,Y,Z information and a place to put a score
-        ComputeCandidateAngleImages(ball_image1DimpleEdges, finalSearchSpace, finalOutputCandidateElementsMat, finalOutputCandidateElementsMatSize, finalCandidates, local_ball1);
-
-        // TBD - change CompareCandidateAngleImages to work directly with the "3D" images
-        best_candidate_index = CompareCandidateAngleImages(&ball_image2DimpleEdges, &finalOutputCandidateElementsMat, &finalOutputCandidateElementsMatSize, &finalCandidates, comparison_csv_data);
+        // After this, the fine pass will have an X,Y,Z matrix with indexes into its candidates vector.
+        // Each candidate will have associated X,Y,Z information and a score
+        SpinAnalysisContext::SearchPass fine_pass;
+        best_candidate_index = spin_context.RunSearchPass(finalSearchSpace, fine_pass);
 
         // Save all the candidate scores to a CSV file if requested
         if (write_spin_analysis_CSV_files) {
@@ -3102,7 +3236,7 @@ namespace golf_sim {
             std::string csv_fname_fine = "spin_analysis_fine.csv";
             ofstream csv_file_fine(csv_fname_fine);
             GS_LOG_TRACE_MSG(trace, "Writing CSV spin data to: " + csv_fname_fine);
-            for (auto& element : comparison_csv_data)
+            for (auto& element : fine_pass.comparison_csv_data)
             {
                 // Don't use logging utility so that we don't have all the timing crap in the output
                 csv_file_fine << element;
@@ -3116,7 +3250,7 @@ namespace golf_sim {
         int best_rot_z = 0;
 
         if (best_candidate_index >= 0) {
-            RotationCandidate finalC = finalCandidates[best_candidate_index];
+            RotationCandidate finalC = fine_pass.candidates[best_candidate_index];
             best_rot_x = finalC.x_rotation_degrees;
             best_rot_y = finalC.y_rotation_degrees;
             best_rot_z = finalC.z_rotation_degrees;
@@ -3129,7 +3263,8 @@ namespace golf_sim {
             GS_LOG_MSG(debug, s);
 
             /*** FOR DEBUG ***/
-            cv::Mat bestImg3D = finalCandidates[best_candidate_index].img;
+            // The precomputed search does not keep per-candidate images, so re-create the winner's projection
+            cv::Mat bestImg3D = spin_context.ProjectRotation(cv::Vec3i(best_rot_x, best_rot_y, best_rot_z));
             cv::Mat bestImg2D = cv::Mat::zeros(ball_image1DimpleEdges.rows, ball_image1DimpleEdges.cols, ball_image1DimpleEdges.type());
             Unproject3dBallTo2dImage(bestImg3D, bestImg2D, ball2);
             LoggingTools::DebugShowImage("Best Final Rotation Candidate Image", bestImg2D);
@@ -3210,6 +3345,11 @@ namespace golf_sim {
         auto spin_duration = std::chrono::duration_cast<std::chrono::milliseconds>(spin_detection_end - spin_detection_start);
         GS_LOG_MSG(info, "Spin detection completed in " + std::to_string(spin_duration.count()) + "ms");
 
+        // Only the remap tables that are new since the last save get written
+        if (kUseSpinRemapCache && kSaveSpinRemapCacheToDisk) {
+            SpinRemapCache::GetSharedCache().SaveToDisk(kSpinRemapCacheDirectory);
+        }
+
         // Note that we return angles, not angular velocities.  The velocities will
         // be determined later based on the derived ball speed.
         return rotationResult;
@@ -3218,18 +3358,18 @@ namespace golf_sim {
 
 
     // This structure is used as a callback for the OpenCV forEach() call.
-    // After first being setup, the operator() will be called in parallel across
-    // different processing cores.
+    // The operator() will be called in parallel across different processing cores.
+    // All of the inputs are held by the (copied) functor itself rather than in static
+    // members, so that more than one comparison can be in progress at the same time.
     struct ImgComparisonOp {
-        // Must be called prior to using the iteration() operator
-        static void setup(const cv::Mat* target_image,
-                          const cv::Mat* candidate_elements_mat,
-                          std::vector<RotationCandidate>* candidates,
-                          std::vector<std::string>* comparisonData ) {
-            ImgComparisonOp::comparisonData_ = comparisonData;
-            ImgComparisonOp::target_image_ = target_image;
-            ImgComparisonOp::candidate_elements_mat_ = candidate_elements_mat;
-            ImgComparisonOp::candidates_ = candidates;
+        ImgComparisonOp(const cv::Mat* target_image,
+                        const cv::Mat* candidate_elements_mat,
+                        std::vector<RotationCandidate>* candidates,
+                        std::vector<std::string>* comparisonData)
+            : target_image_(target_image),
+              candidate_elements_mat_(candidate_elements_mat),
+              comparisonData_(comparisonData),
+              candidates_(candidates) {
         }
 
         void operator ()(ushort& unusedValue, const int* position) const {
@@ -3267,21 +3407,12 @@ namespace golf_sim {
             (*comparisonData_)[c.index] = s;
         }
 
-        static const cv::Mat* target_image_;
-        static const cv::Mat* candidate_elements_mat_;
-        static std::vector<std::string>* comparisonData_;
-        static std::vector<RotationCandidate>* candidates_;
+        const cv::Mat* target_image_;
+        const cv::Mat* candidate_elements_mat_;
+        std::vector<std::string>* comparisonData_;
+        std::vector<RotationCandidate>* candidates_;
     };
 
-    // Complete storage for ImgComparisonOp struct
-    // Create temporary nonce objects because C++ requires references to point to a valid object.
-    // the null/nonce references will go out of scope after setup() is called and these references
-    // are set to valid objects
-    std::vector<std::string>* ImgComparisonOp::comparisonData_ = nullptr;
-    const cv::Mat* ImgComparisonOp::target_image_ = nullptr;
-    const cv::Mat* ImgComparisonOp::candidate_elements_mat_ = nullptr;
-    std::vector<RotationCandidate>* ImgComparisonOp::candidates_ = nullptr;
-
 
     // Returns the index within candidates that has the best comparison.
     // Returns -1 on failure.
@@ -3305,7 +3436,7 @@ namespace golf_sim {
 
         // Iterate through the matrix of candidates
 
-        ImgComparisonOp::setup(target_image, candidate_elements_mat, candidates, &comparisonData);
+        ImgComparisonOp comparison_op(target_image, candidate_elements_mat, candidates, &comparisonData);
 
         //  Serialized version for debugging
         if (kSerializeOpsForDebug) {
@@ -3314,15 +3445,34 @@ namespace golf_sim {
                     for (int z = 0; z < zSize; z++) {
                         ushort unusedValue = 0;
                         int position[]{ x, y, z };
-                        ImgComparisonOp()(unusedValue, position);
+                        comparison_op(unusedValue, position);
                     }
                 }
             }
         }
         else {
-            (*candidate_elements_mat).forEach<ushort>(ImgComparisonOp());
+            (*candidate_elements_mat).forEach<ushort>(comparison_op);
         }
 
+        // Transfer all the csv data to the output variable
+        comparison_csv_data = comparisonData;
+
+        int best_candidate_index = SelectBestCandidate(*candidates);
+
+        timer1.stop();
+        boost::timer::cpu_times times = timer1.elapsed();
+        std::cout << "CompareCandidateAngleImages: ";
+        std::cout << std::fixed << std::setprecision(8)
+            << times.wall / 1.0e9 << "s wall, "
+            << times.user / 1.0e9 << "s user + "
+            << times.system / 1.0e9 << "s system.\n";
+
+        return best_candidate_index;
+    }
+
+
+    int BallImageProc::SelectBestCandidate(const std::vector<RotationCandidate>& candidates) {
+
         // Find the best candidate from the comparison results
         double maxScaledScore = -1.0;
         double maxPixelsExamined = -1.0;
@@ -3355,9 +3505,9 @@ namespace golf_sim {
         // Find the range of numbers of matching pixels and the total
         // most-available pixels in order to insert that into the mix for
         // a combined score
-        for (auto& element : *candidates)
+        for (auto& element : candidates)
         {
-            RotationCandidate c = element;
+            const RotationCandidate& c = element;
 
             if (c.pixels_examined > maxPixelsExamined) {
                 maxPixelsExamined = c.pixels_examined;
@@ -3373,9 +3523,9 @@ namespace golf_sim {
             }
         }
 
-        for (auto& element : *candidates)
+        for (auto& element : candidates)
         {
-            RotationCandidate c = element;
+            const RotationCandidate& c = element;
 
             low_count_penalty = std::pow((maxPixelsExamined - (double)c.pixels_examined) / kSpinLowCountDifferenceWeightingFactor,
                                 kSpinLowCountPenaltyPower) / kSpinLowCountPenaltyScalingFactor;
@@ -3400,17 +3550,6 @@ namespace golf_sim {
                             std::to_string(bestScaledScoreRotY) + ", " + std::to_string(bestScaledScoreRotZ) + ") ";
         GS_LOG_MSG(debug, s);
 
-        // Transfer all the csv data to the output variable
-        comparison_csv_data = comparisonData;
-
-        timer1.stop();
-        boost::timer::cpu_times times = timer1.elapsed();
-        std::cout << "CompareCandidateAngleImages: ";
-        std::cout << std::fixed << std::setprecision(8)
-            << times.wall / 1.0e9 << "s wall, "
-            << times.user / 1.0e9 << "s user + "
-            << times.system / 1.0e9 << "s system.\n";
-
         return maxScaledScoreIndex;
     }
 
@@ -3422,17 +3561,18 @@ namespace golf_sim {
 
         CV_Assert((img1.rows == img2.rows && img1.rows == img2.cols));
 
-        // DEBUG - create a binary image showing what pixels are the same between them
-        cv::Mat testCorrespondenceImg = cv::Mat::zeros(img1.rows, img1.cols, img1.type());
-
-        // This comparison is currently done serially, but we should be processing
-        // multiple such image comparisons in parallel
+        // This is the reference (per-pixel) comparison.  SpinBitplaneScorer::Compare produces
+        // identical results much faster for images that hold only 0/255/kPixelIgnoreValue pixels.
+        // Both images are square, so walk them row by row rather than column by column.
         long score = 0;
         long totalPixelsExamined = 0;
-        for (int x = 0; x < img1.cols; x++) {
-            for (int y = 0; y < img1.rows; y++) {
-                uchar p1 = img1.at<uchar>(x, y);
-                uchar p2 = img2.at<cv::Vec2i>(x, y)[1];
+        for (int x = 0; x < img1.rows; x++) {
+            const uchar* row1 = img1.ptr<uchar>(x);
+            const cv::Vec2i* row2 = img2.ptr<cv::Vec2i>(x);
+
+            for (int y = 0; y < img1.cols; y++) {
+                uchar p1 = row1[y];
+                uchar p2 = (uchar)row2[y][1];
 
                 if (p1 != kPixelIgnoreValue && p2 != kPixelIgnoreValue) {
                     // Both points have values, so we can validly compare them
@@ -3440,21 +3580,11 @@ namespace golf_sim {
 
                     if (p1 == p2) {
                         score++;
-                        // The test image is already zero'd out, so only set the
-                        // pixel to 1 if there is a match
-                        testCorrespondenceImg.at<uchar>(x, y) = 255;
                     }
                 }
-                else
-                {
-                    testCorrespondenceImg.at<uchar>(x, y) = kPixelIgnoreValue;
-                }
             }
         }
 
-        // LoggingTools::DebugShowImage("testCorrespondenceImg #" + std::to_string(index), testCorrespondenceImg);
-        // WON'T WORK BECAUSE IMG2 is 3D LoggingTools::DebugShowImage("testCandidateImg #" + std::to_string(index), img2);
-
         cv::Vec2i result(score, totalPixelsExamined);
         return result;
     }
@@ -3520,10 +3650,13 @@ namespace golf_sim {
         double ps = (double)pos_psi * 10.0;
         double gm = (double)pos_gamma / 20.0;   // Nominal:  30
 
-        int white_percent = 0;
+        // The filter response does not depend on the binary threshold, so compute it just once
+        // and then find the white percentage for each threshold that we try from its histogram
+        std::shared_ptr<const GaborFilterBank> gabor_bank = GaborFilterBank::GetBank(GetGaborParameters(kernel_size, sig, lm, ps, gm));
+        const cv::Mat response_gray = GaborFilterBank::ResponseTo8U(gabor_bank->ComputeMaxResponse(img_f32));
+        const GaborFilterBank::Histogram response_histogram = GaborFilterBank::ComputeHistogram(response_gray);
 
-        cv::Mat dimpleImg = ApplyTestGaborFilter(img_f32, kernel_size, sig, lm, th, ps, gm, binary_threshold,
-            white_percent);
+        int white_percent = GaborFilterBank::WhitePercent(response_histogram, GaborEdgeThreshold(binary_threshold));
 
         GS_LOG_TRACE_MSG(trace, "Initial Gabor filter white percent = " + std::to_string(white_percent));
 
@@ -3558,8 +3691,7 @@ namespace golf_sim {
                     GS_LOG_TRACE_MSG(trace, "Trying higher gabor binary_threshold setting of " + std::to_string(binary_threshold) + " for better balance.");
                 }
 
-                dimpleImg = ApplyTestGaborFilter(img_f32, kernel_size, sig, lm, th, ps, gm, binary_threshold,
-                    white_percent);
+                white_percent = GaborFilterBank::WhitePercent(response_histogram, GaborEdgeThreshold(binary_threshold));
                 GS_LOG_TRACE_MSG(trace, "Next, refined, Gabor white percent = " + std::to_string(white_percent));
 
                 // If we've gone as far as we can, just return
@@ -3576,39 +3708,50 @@ namespace golf_sim {
             GS_LOG_TRACE_MSG(trace, "Final Gabor white percent = " + std::to_string(white_percent));
         }
 
-        return dimpleImg;
+        return ThresholdGaborResponse(response_gray, binary_threshold);
     }
 
-    cv::Mat BallImageProc::ApplyTestGaborFilter(const cv::Mat& img_f32,
-        const int kernel_size, double sig, double lm, double th, double ps, double gm, float binary_threshold,
-        int &white_percent  ) {
+    GaborFilterBank::Parameters BallImageProc::GetGaborParameters(const int kernel_size, double sig, double lm, double ps, double gm) {
+        GaborFilterBank::Parameters parameters;
+        parameters.kernel_size = kernel_size;
+        parameters.sigma = sig;
+        parameters.lambda = lm;
+        parameters.gamma = gm;
+        parameters.psi_degrees = ps;
+        // Sweep through a bunch of different angles for the filter in order to pick up features
+        // in all directions
+        parameters.theta_increment_degrees = 11.25; //  5.625; // CURRENT 11.25;  // degrees.  Nominal: 11.25 also works 
+        return parameters;
+    }
 
-        cv::Mat dest = cv::Mat::zeros(img_f32.rows, img_f32.cols, img_f32.type());
-        cv::Mat accum = cv::Mat::zeros(img_f32.rows, img_f32.cols, img_f32.type());
-        cv::Mat kernel;
+    int BallImageProc::GaborEdgeThreshold(float binary_threshold) {
+        return (int)std::round(binary_threshold * 10.);
+    }
 
+    cv::Mat BallImageProc::ThresholdGaborResponse(const cv::Mat& response_gray, float binary_threshold) {
+        cv::Mat dimpleEdges;
 
-        // Sweep through a bunch of different angles for the filter in order to pick up features
-        // in all directions
-        const double thetaIncrement = 11.25; //  5.625; // CURRENT 11.25;  // degrees.  Nominal: 11.25 also works 
-        for (double theta = 0; theta <= 360.0; theta += thetaIncrement) {
-            kernel = CreateGaborKernel(kernel_size, sig, theta, lm, gm, ps);
-            cv::filter2D(img_f32, dest, CV_32F, kernel);
+        // Threshold the image to either 0 or 255
+        const int edgeThresholdLow = GaborEdgeThreshold(binary_threshold);
+        const int edgeThresholdHigh = 255;
+        cv::threshold(response_gray, dimpleEdges, edgeThresholdLow, edgeThresholdHigh, cv::THRESH_BINARY);
 
-            cv::max(accum, dest, accum);
-        }
+        return dimpleEdges;
+    }
+
+    cv::Mat BallImageProc::ApplyTestGaborFilter(const cv::Mat& img_f32,
+        const int kernel_size, double sig, double lm, double th, double ps, double gm, float binary_threshold,
+        int &white_percent  ) {
 
-        cv::Mat accumGray;
+        // th is unused - the filter is applied at every orientation
+        (void)th;
 
-        // Convert from the 0.0 to 1.0 range into 0-255
-        accum.convertTo(accumGray, CV_8U, 255, 0);
+        std::shared_ptr<const GaborFilterBank> gabor_bank = GaborFilterBank::GetBank(GetGaborParameters(kernel_size, sig, lm, ps, gm));
 
-        cv::Mat dimpleEdges = cv::Mat::zeros(accum.rows, accum.cols, accum.type());
+        // Convert from the 0.0 to 1.0 range into 0-255
+        cv::Mat accumGray = GaborFilterBank::ResponseTo8U(gabor_bank->ComputeMaxResponse(img_f32));
 
-        // Threshold the image to either 0 or 255
-        const int edgeThresholdLow = (int)std::round(binary_threshold * 10.);
-        const int edgeThresholdHigh = 255;
-        cv::threshold(accumGray, dimpleEdges, edgeThresholdLow, edgeThresholdHigh, cv::THRESH_BINARY);
+        cv::Mat dimpleEdges = ThresholdGaborResponse(accumGray, binary_threshold);
 
         white_percent = (int)std::round(((double)cv::countNonZero(dimpleEdges) * 100.) / ((double)dimpleEdges.rows * dimpleEdges.cols));
 
@@ -3755,21 +3898,17 @@ namespace golf_sim {
    }
 
    // The following struct is used as a callback for the OpenCV forEach() call.
-   // After first being setup, the operator() will be called in parallel across
-   // different processing cores.
+   // The operator() will be called in parallel across different processing cores.
+   // Each call to Project2dImageTo3dBall constructs its own instance, so concurrent
+   // projections (e.g., two spin analyses at once) do not share any state.
     struct projectionOp {
-        // Must be called prior to using the iteration() operator
-        static void setup(const GolfBall *currentBall,
-                          cv::Mat& projectedImg,
-                          const double& x_rotation_degreesAngleRad,
-                          const double& y_rotation_degreesAngleRad,
-                          const double& z_rotation_degreesAngleRad ) {
+        projectionOp(const GolfBall *currentBall,
+                     cv::Mat* projectedImg,
+                     const double& x_rotation_degreesAngleRad,
+                     const double& y_rotation_degreesAngleRad,
+                     const double& z_rotation_degreesAngleRad ) {
             currentBall_ = currentBall;
             projectedImg_ = projectedImg;
-            // Copy the rows/cols from the image because openCV will not do so otherwise
-            // TBD - Kind of a hack
-            projectedImg_.rows = projectedImg.rows;
-            projectedImg_.cols = projectedImg.cols;
             x_rotation_degreesAngleRad_ = x_rotation_degreesAngleRad;
             y_rotation_degreesAngleRad_ = y_rotation_degreesAngleRad;
             z_rotation_degreesAngleRad_ = z_rotation_degreesAngleRad;
@@ -3794,7 +3933,7 @@ namespace golf_sim {
         }
 
         // The returned imageXFromCenter and imageYFromCenter are the original imageX & Y in a new coordinate system with the center of the ball at (0,0)
-        static void getBallZ(const double imageX, const double imageY, double& imageXFromCenter, double& imageYFromCenter, double& ball3dZ) {
+        void getBallZ(const double imageX, const double imageY, double& imageXFromCenter, double& imageYFromCenter, double& ball3dZ) const {
             // Basic idea:  x2 + y2 + z2 = r2  (2's are squared).  Just solve for z where we can
 
             double r = currentBall_->measured_radius_pixels_;
@@ -3850,8 +3989,8 @@ namespace golf_sim {
                 // std::cout << "CV_ELEM_SIZE1(traits::Depth<_Tp>::value): " << CV_ELEM_SIZE1(projectedImg_.traits::Depth<_Tp>::value) << "elemSize1()" << projectedImg_.elemSize1() << std::endl;
                 // TBD - Not sure we even need to bother with this?
 
-                projectedImg_.at<cv::Vec2i>((int)imageX, (int)imageY)[0] = (int)ball3dZOfUnrotatedPoint;    // TBD - Wait, is this right?  Why change the Z??
-                projectedImg_.at<cv::Vec2i>((int)imageX, (int)imageY)[1] = kPixelIgnoreValue;
+                projectedImg_->at<cv::Vec2i>((int)imageX, (int)imageY)[0] = (int)ball3dZOfUnrotatedPoint;    // TBD - Wait, is this right?  Why change the Z??
+                projectedImg_->at<cv::Vec2i>((int)imageX, (int)imageY)[1] = kPixelIgnoreValue;
             }
 
 
@@ -3882,8 +4021,8 @@ namespace golf_sim {
             }
 
             // Shift back to coordinates with the origin in the top-left
-            imageX = imageXFromCenter + projectionOp::currentBall_->x();
-            imageY = imageYFromCenter + projectionOp::currentBall_->y();
+            imageX = imageXFromCenter + currentBall_->x();
+            imageY = imageYFromCenter + currentBall_->y();
 
             // Get the Z value of the destination, rotated-to point.
             double ball3dZOfRotatedPoint = 0;
@@ -3893,8 +4032,7 @@ namespace golf_sim {
             getBallZ(imageX, imageY, dummy_rotatedImageXFromCenter, dummy_rotatedImageYFromCenter, ball3dZOfRotatedPoint);
 
             if (currentBall_->PointIsInsideBall(imageX, imageY) && ball3dZOfRotatedPoint < 0.001) {
-                GS_LOG_TRACE_MSG(trace, "Project2dImageTo3dBall Z-value pixel within ball at (" + std::to_string(imageX) +
-                    ", " + std::to_string(imageY) + ").");
+                GS_LOG_TRACE_FMT(trace, "Project2dImageTo3dBall Z-value pixel within ball at ({}, {}).", imageX, imageY);
             }
 
             // Some of the points (like the corners) may rotate out to a place that is outside of the image Mat
@@ -3903,15 +4041,15 @@ namespace golf_sim {
             // and do absolutely nothing
             if (imageX >= 0 &&
                 imageY >= 0 &&
-                imageX < projectedImg_.cols &&
-                imageY < projectedImg_.rows &&
+                imageX < projectedImg_->cols &&
+                imageY < projectedImg_->rows &&
                 ball3dZOfRotatedPoint > 0.0) {
                     // The rotated-to point is on the visible surface of the hemisphere
 
                     // Instead of performing a zillion round operations, we'll just effectively floor (truncate)
                     // each x and y value.  We'll lose some accuracy, but if everything is floored, it should at least
                     // still be consistent.
-                    // projectedImg_.at<cv::Vec2i>((int)imageX, (int)imageY)[0] = (int)std::round(ball3dZOfRotatedPoint);
+                    // projectedImg_->at<cv::Vec2i>((int)imageX, (int)imageY)[0] = (int)std::round(ball3dZOfRotatedPoint);
 
                     int roundedImageX = (int)(imageX + 0.5);
                     int roundedImageY = (int)(imageY + 0.5);
@@ -3921,7 +4059,7 @@ namespace golf_sim {
 
                     // If the final, new pixel came from an invalid place, don't allow it to pollute the rotated image
                     // Not rounding here helped increase performance
-                    projectedImg_.at<cv::Vec2i>(roundedImageX, roundedImageY)[0] = (int)(ball3dZOfRotatedPoint);
+                    projectedImg_->at<cv::Vec2i>(roundedImageX, roundedImageY)[0] = (int)(ball3dZOfRotatedPoint);
 
                     /** TBD - DEBUG ONLY 
                     if (currentBall_->PointIsInsideBall(roundedImageX, roundedImageY) && pixelValue == kPixelIgnoreValue) {
@@ -3929,7 +4067,7 @@ namespace golf_sim {
                                     ", " + std::to_string(roundedImageY) + ").");
                     }
                     */
-                    projectedImg_.at<cv::Vec2i>(roundedImageX, roundedImageY)[1] = (prerotatedPointNotValid ? kPixelIgnoreValue : pixelValue);
+                    projectedImg_->at<cv::Vec2i>(roundedImageX, roundedImageY)[1] = (prerotatedPointNotValid ? kPixelIgnoreValue : pixelValue);
             }
             else {
                 /** TBD - DEBUG ONLY
@@ -3942,47 +4080,29 @@ namespace golf_sim {
         }
 
         // The ball information that we are currently operating with
-        // Null if not yet set
-        static const GolfBall* currentBall_;
+        const GolfBall* currentBall_ = nullptr;
 
-        // The 3D grayscale image we are working on
-        static cv::Mat projectedImg_;
+        // The 3D grayscale image we are working on.  Owned by the caller.
+        cv::Mat* projectedImg_ = nullptr;
 
         // The angles to rotate the Mat when we project it to 3D
-        static double x_rotation_degreesAngleRad_;
-        static double y_rotation_degreesAngleRad_;
-        static double z_rotation_degreesAngleRad_;
+        double x_rotation_degreesAngleRad_ = 0;
+        double y_rotation_degreesAngleRad_ = 0;
+        double z_rotation_degreesAngleRad_ = 0;
 
         // Precomputed trig results for rotation
-        static double sinX_;
-        static double cosX_;
-        static double sinY_;
-        static double cosY_;
-        static double sinZ_;
-        static double cosZ_;
-
-        static bool rotatingOnX_;
-        static bool rotatingOnY_;
-        static bool rotatingOnZ_;
+        double sinX_ = 0;
+        double cosX_ = 0;
+        double sinY_ = 0;
+        double cosY_ = 0;
+        double sinZ_ = 0;
+        double cosZ_ = 0;
+
+        bool rotatingOnX_ = true;
+        bool rotatingOnY_ = true;
+        bool rotatingOnZ_ = true;
     };
 
-    // Complete storage for projectionOp struct
-    const GolfBall* projectionOp::currentBall_ = NULL;
-    cv::Mat projectionOp::projectedImg_;
-    double projectionOp::x_rotation_degreesAngleRad_ = 0;
-    double projectionOp::y_rotation_degreesAngleRad_ = 0;
-    double projectionOp::z_rotation_degreesAngleRad_ = 0;
-    double projectionOp::sinX_ = 0;
-    double projectionOp::cosX_ = 0;
-    double projectionOp::sinY_ = 0;
-    double projectionOp::cosY_ = 0;
-    double projectionOp::sinZ_ = 0;
-    double projectionOp::cosZ_ = 0;
-    bool projectionOp::rotatingOnX_ = true;
-    bool projectionOp::rotatingOnY_ = true;
-    bool projectionOp::rotatingOnZ_ = true;
-
-
     // Positive X-axis angles rotate so that the ball appears to go from left to right
     // positive Y-axis angles move the ball from the top to the bottom
     // positive Z-Axis angles are counter-clockwise looking down the positive z-axis
@@ -3999,13 +4119,13 @@ namespace golf_sim {
         projectedImg.rows = image_gray.rows;
         projectedImg.cols = image_gray.cols;
 
-        // Setup the global structures we need before we do the parallelized callback to process
+        // Set up the per-call state we need before we do the parallelized callback to process
         // the 2D image
-        projectionOp::setup(&ball, 
-                            projectedImg, 
-                            -(float)CvUtils::DegreesToRadians((double)rotation_angles_degrees[0]),  /* Negative due to rotation in X axis being backward */
-                            (float)CvUtils::DegreesToRadians((double)rotation_angles_degrees[1]),
-                            (float)CvUtils::DegreesToRadians((double)rotation_angles_degrees[2])  );
+        projectionOp projection_op(&ball, 
+                                   &projectedImg, 
+                                   -(float)CvUtils::DegreesToRadians((double)rotation_angles_degrees[0]),  /* Negative due to rotation in X axis being backward */
+                                   (float)CvUtils::DegreesToRadians((double)rotation_angles_degrees[1]),
+                                   (float)CvUtils::DegreesToRadians((double)rotation_angles_degrees[2])  );
 
         if (kSerializeOpsForDebug) {
             /*  Serialized version for debugging - use the parallel stuff below for release */
@@ -4023,13 +4143,13 @@ namespace golf_sim {
                     }
 
 
-                    projectionOp()(pixel, position);
+                    projection_op(pixel, position);
                 }
             }
         }
         else {
             // Parallel execution with function object.
-            image_gray.forEach<uchar>(projectionOp());
+            image_gray.forEach<uchar>(projection_op);
         }
 
         return projectedImg;
@@ -4278,12 +4398,13 @@ namespace golf_sim {
     }
 
     bool BallImageProc::DetectBallsONNX(const cv::Mat& preprocessed_img, BallSearchMode search_mode,
-                                       std::vector<GsCircle>& detected_circles) {
+                                       std::vector<GsCircle>& detected_circles,
+                                       const std::vector<cv::Point2f>& predicted_centers) {
         GS_LOG_TRACE_MSG(trace, "BallImageProc::DetectBallsONNX - Dispatching to backend: " + kONNXBackend);
 
         // Dual-Backend Dispatcher: Try ONNX Runtime first, fallback to OpenCV DNN if needed
         if (kONNXBackend == "onnxruntime") {
-            if (DetectBallsONNXRuntime(preprocessed_img, search_mode, detected_circles)) {
+            if (DetectBallsONNXRuntime(preprocessed_img, search_mode, detected_circles, predicted_centers)) {
                 return true;
             } else if (kONNXRuntimeAutoFallback) {
                 GS_LOG_MSG(warning, "ONNX Runtime detection failed, falling back to OpenCV DNN");
@@ -4298,7 +4419,8 @@ namespace golf_sim {
     }
 
     bool BallImageProc::DetectBallsONNXRuntime(const cv::Mat& preprocessed_img, BallSearchMode search_mode,
-                                              std::vector<GsCircle>& detected_circles) {
+                                              std::vector<GsCircle>& detected_circles,
+                                              const std::vector<cv::Point2f>& predicted_centers) {
         auto detection_start = std::chrono::high_resolution_clock::now();
 
         try {
@@ -4315,6 +4437,7 @@ namespace golf_sim {
                     config.input_width = kONNXInputSize;
                     config.input_height = kONNXInputSize;
                     config.num_threads = kONNXRuntimeThreads;
+                    config.num_sessions = kONNXRuntimeSessions;
 
                     // Pi-optimized settings
                     config.use_arm_compute_library = true;
@@ -4384,8 +4507,9 @@ namespace golf_sim {
                     }
                 }
             } else {
-                // Single image detection (fastest path)
-                std::vector<ONNXRuntimeDetector::Detection> detections = onnx_detector_->Detect(input_image);
+                // Single image detection (fastest path), or just the crops around where the ball is expected
+                std::vector<ONNXRuntimeDetector::Detection> detections = predicted_centers.empty() ?
+                    onnx_detector_->Detect(input_image) : onnx_detector_->DetectTiled(input_image, predicted_centers);
 
                 // Convert ONNXRuntimeDetector::Detection to GsCircle format
                 detected_circles.clear();
@@ -4492,27 +4616,17 @@ namespace golf_sim {
             for (const auto& slice : slices) {
                 cv::Mat slice_img = input_image(slice);
 
-                // Create letterboxed input
-                float scale = std::min(float(kONNXInputSize) / slice_img.cols,
-                                     float(kONNXInputSize) / slice_img.rows);
-                int new_width = int(slice_img.cols * scale);
-                int new_height = int(slice_img.rows * scale);
-
-                if (yolo_resized_buffer_.size() != cv::Size(new_width, new_height) || yolo_resized_buffer_.type() != CV_8UC3) {
-                    yolo_resized_buffer_ = cv::Mat(new_height, new_width, CV_8UC3);
-                }
-                cv::resize(slice_img, yolo_resized_buffer_, cv::Size(new_width, new_height));
-
-                // Create letterbox with gray padding
-                yolo_letterbox_buffer_.setTo(cv::Scalar(114, 114, 114));
-                int x_offset = (kONNXInputSize - new_width) / 2;
-                int y_offset = (kONNXInputSize - new_height) / 2;
-                yolo_resized_buffer_.copyTo(yolo_letterbox_buffer_(cv::Rect(x_offset, y_offset, new_width, new_height)));
+                // Letterbox with gray padding, and pack straight into the (1, 3, H, W) blob.  This gives
+                // the same values as blobFromImage(1.0/255.0, swapRB=false), as YOLOv8 takes BGR input.
+                const int blob_sizes[] = { 1, 3, kONNXInputSize, kONNXInputSize };
+                yolo_blob_buffer_.create(4, blob_sizes, CV_32F);
 
-                // Create blob
-                cv::dnn::blobFromImage(yolo_letterbox_buffer_, yolo_blob_buffer_, 1.0/255.0,
-                                      cv::Size(kONNXInputSize, kONNXInputSize),
-                                      cv::Scalar(), false, false);  // swapRB=false for YOLOv8 BGR input
+                const DnnPreprocessor::LetterboxParams letterbox =
+                    DnnPreprocessor::LetterboxToTensor(slice_img, cv::Size(kONNXInputSize, kONNXInputSize),
+                                                       yolo_letterbox_buffer_, yolo_blob_buffer_.ptr<float>());
+                const float scale = letterbox.scale;
+                const int x_offset = letterbox.x_offset;
+                const int y_offset = letterbox.y_offset;
 
                 // Run inference
                 yolo_model_.setInput(yolo_blob_buffer_);
@@ -4621,6 +4735,7 @@ namespace golf_sim {
             config.input_width = kONNXInputSize;
             config.input_height = kONNXInputSize;
             config.num_threads = kONNXRuntimeThreads;
+            config.num_sessions = kONNXRuntimeSessions;
 
             // Pi-optimized settings
             config.use_arm_compute_library = true;
@@ -4679,6 +4794,8 @@ namespace golf_sim {
         GolfSimConfiguration::SetConstant("gs_config.ball_identification.kONNXBackend", kONNXBackend);
         GolfSimConfiguration::SetConstant("gs_config.ball_identification.kONNXRuntimeAutoFallback", kONNXRuntimeAutoFallback);
         GolfSimConfiguration::SetConstant("gs_config.ball_identification.kONNXRuntimeThreads", kONNXRuntimeThreads);
+        GolfSimConfiguration::SetConstant("gs_config.ball_identification.kONNXRuntimeSessions", kONNXRuntimeSessions);
+        GolfSimConfiguration::SetConstant("gs_config.ball_identification.kONNXUseTiledInference", kONNXUseTiledInference);
 
         // Resolve relative ONNX model path against PITRAC_ROOT
         if (!kONNXModelPath.empty() && kONNXModelPath[0] != '/') {
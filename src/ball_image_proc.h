@@ -29,6 +29,7 @@
 #include "utils/logging_tools.h"
 #include "gs_camera.h"
 #include "colorsys.h"
+#include "gabor_filter_bank.h"
 #include "golf_ball.h"
 #include "onnx_runtime_detector.hpp"
 
@@ -95,6 +96,11 @@ public:
     static int kPuttingPreHoughBlurSize;
 
     static bool kStrobedBallsUseAltHoughAlgorithm;
+
+    // If set, GetBall's repeated Hough searches of an image share a HoughCircleEngine instead
+    // of each calling cv::HoughCircles.  test_hough_circle_engine checks that the engine finds
+    // every ball that cv::HoughCircles does on the recorded teed, strobed and putting images.
+    static bool kUseSinglePassHoughEngine;
     static double kStrobedBallsAltCannyLower;
     static double kStrobedBallsAltCannyUpper;
     static int kStrobedBallsAltPreCannyBlurSize;
@@ -190,6 +196,26 @@ public:
     static int kGaborMaxWhitePercent;
     static int kGaborMinWhitePercent;
 
+    // If true, the spin search computes the ball's hemisphere geometry once and scores
+    // each candidate rotation against it instead of building a projection per candidate
+    static bool kUsePrecomputedSpinSearch;
+
+    // If true (and the images allow it), candidate scoring uses packed edge/valid
+    // bitplanes and popcounts instead of the per-pixel CompareRotationImage loop
+    static bool kUseBitplaneSpinScoring;
+
+    // If true, the (bitplane) spin search re-uses cached per-rotation remap tables for
+    // balls of the same geometry.  The ball center and radius are snapped to
+    // kSpinRemapCacheRadiusQuantumPixels so that similar balls share the same tables.
+    static bool kUseSpinRemapCache;
+    static double kSpinRemapCacheRadiusQuantumPixels;
+    static int kSpinRemapCacheMaxMegabytes;
+
+    // If true, the remap tables are appended to files in kSpinRemapCacheDirectory after each
+    // spin analysis and are mmapped again at startup.  An empty directory means the current one.
+    static bool kSaveSpinRemapCacheToDisk;
+    static std::string kSpinRemapCacheDirectory;
+
     // ONNX Detection Configuration
     static std::string kDetectionMethod;
     static std::string kBallPlacementDetectionMethod;
@@ -205,6 +231,12 @@ public:
     static std::string kONNXBackend;  // "onnxruntime" (primary) or "opencv_dnn" (fallback)
     static bool kONNXRuntimeAutoFallback;  // Enable automatic fallback to OpenCV DNN
     static int kONNXRuntimeThreads;  // Number of threads for ONNX Runtime (ARM optimization)
+    static int kONNXRuntimeSessions;  // Number of detections that can run at the same time
+    // If true, and GetBall has an expected ball area, the model is run on model-input-sized
+    // crops of that area rather than on the whole, shrunk image.  Only a model whose input
+    // (kONNXInputSize) is smaller than the image, such as a 640 model, is ever tiled.  With
+    // the default 1472 model, a 1456x1088 frame is always run whole.
+    static bool kONNXUseTiledInference;
 
     // This determines which potential 3D angles will be searched for spin processing
     struct RotationSearchSpace {
@@ -315,12 +347,27 @@ public:
 
     static cv::Vec2i CompareRotationImage(const cv::Mat& img1, const cv::Mat& img2, const int index = 0);
 
+    // Given a set of already-scored candidates, returns the index of the best one, or -1 if none
+    static int SelectBestCandidate(const std::vector<RotationCandidate>& candidates);
+
     static cv::Mat MaskAreaOutsideBall(cv::Mat& ball_image, const GolfBall& ball, float mask_reduction_factor, const cv::Scalar& maskValue = (255, 255, 255));
 
     static void GetRotatedImage(const cv::Mat& gray_2D_input_image, const GolfBall& ball, const cv::Vec3i rotation, cv::Mat& outputGrayImg);
 
+    // Positive X-axis angles rotate so that the ball appears to go from left to right
+    // positive Y-axis angles move the ball from the top to the bottom
+    // positive Z-Axis angles are counter-clockwise looking down the positive z-axis
+    static cv::Mat Project2dImageTo3dBall(const cv::Mat& image_gray, const GolfBall& ball, const cv::Vec3i& rotation_angles_degrees);
+
     static bool RemoveSmallestConcentricCircles(std::vector<GsCircle>& circles);
 
+    // The radius range that GetBall's HoughCircleEngine must cover for the searches of an image in
+    // the given mode.  When the search radii will be dynamically narrowed, that includes every band
+    // the narrowed search could ask for, which can extend below the initial minimum and above the
+    // initial maximum.
+    static void GetHoughEngineRadiusRange(BallSearchMode search_mode, int minimum_search_radius, int maximum_search_radius,
+                                          int& engine_min_radius, int& engine_max_radius);
+
     // Img would be a constant reference, but we need to perform sub-imaging on it, so keep non-const for now
     // reference_ball_circle is the circle around where the best approximation of where the ball is
     static cv::RotatedRect FindLargestEllipse(cv::Mat& img, const GsCircle& reference_ball_circle, int mask_radius);
@@ -339,9 +386,13 @@ public:
     // ONNX Detection Methods
     static bool DetectBalls(const cv::Mat& preprocessed_img, BallSearchMode search_mode, std::vector<GsCircle>& detected_circles);
     static bool DetectBallsHoughCircles(const cv::Mat& preprocessed_img, BallSearchMode search_mode, std::vector<GsCircle>& detected_circles);
-    static bool DetectBallsONNX(const cv::Mat& preprocessed_img, BallSearchMode search_mode, std::vector<GsCircle>& detected_circles);
+    // predicted_centers are where the ball(s) are expected to be, if known.  Only the ONNX
+    // Runtime backend uses them, and only for tiled inference.
+    static bool DetectBallsONNX(const cv::Mat& preprocessed_img, BallSearchMode search_mode, std::vector<GsCircle>& detected_circles,
+                                const std::vector<cv::Point2f>& predicted_centers = {});
 
-    static bool DetectBallsONNXRuntime(const cv::Mat& preprocessed_img, BallSearchMode search_mode, std::vector<GsCircle>& detected_circles);
+    static bool DetectBallsONNXRuntime(const cv::Mat& preprocessed_img, BallSearchMode search_mode, std::vector<GsCircle>& detected_circles,
+                                       const std::vector<cv::Point2f>& predicted_centers = {});
     static bool DetectBallsOpenCVDNN(const cv::Mat& preprocessed_img, BallSearchMode search_mode, std::vector<GsCircle>& detected_circles);
 
     static bool PreloadYOLOModel();
@@ -369,7 +420,6 @@ private:
     // Prevents allocating ~1.2MB per frame (640x640x3 multiple times)
     static cv::Mat yolo_input_buffer_;        // Reusable input conversion buffer
     static cv::Mat yolo_letterbox_buffer_;    // 640x640x3 letterboxed image
-    static cv::Mat yolo_resized_buffer_;      // Resized image before letterboxing
     static cv::Mat yolo_blob_buffer_;         // Blob for network input
     static std::vector<cv::Rect> yolo_detection_boxes_;     // Detection results
     static std::vector<float> yolo_detection_confidences_;  // Detection confidences
@@ -428,7 +478,14 @@ private:
 
     static cv::Mat CreateGaborKernel(int ks, double sig, double th, double lm, double gm, double ps);
 
-    static cv::Mat Project2dImageTo3dBall(const cv::Mat& image_gray, const GolfBall& ball, const cv::Vec3i& rotation_angles_degrees);
+    // The (cached) filter bank parameters for the ApplyTestGaborFilter arguments
+    static GaborFilterBank::Parameters GetGaborParameters(const int kernel_size, double sig, double lm, double ps, double gm);
+
+    // Converts the binary_threshold used by the Gabor functions to a 0-255 threshold
+    static int GaborEdgeThreshold(float binary_threshold);
+
+    // Thresholds an 8-bit Gabor filter response to either 0 or 255
+    static cv::Mat ThresholdGaborResponse(const cv::Mat& response_gray, float binary_threshold);
 
     static void Unproject3dBallTo2dImage(const cv::Mat& src3D, cv::Mat& destination_image_gray, const GolfBall& ball);
 
@@ -0,0 +1,393 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#ifdef __unix__  // Ignore in Windows environment
+
+#include <cfloat>
+#include <time.h>
+
+#include <opencv2/imgproc.hpp>
+
+#include "core/rpicam_app.hpp"
+
+#include "utils/logging_tools.h"
+#include "utils/cv_utils.h"
+#include "gs_options.h"
+#include "libcamera_interface.h"
+#include "undistort_map_cache.h"
+
+#include "ball_placement_watcher.h"
+
+
+namespace golf_sim {
+
+    bool BallPlacementWatcher::kUseStreamingBallPlacement = true;
+    int BallPlacementWatcher::kPlacementPreviewDownscale = 2;
+    int BallPlacementWatcher::kPlacementPreviewFPS = 15;
+    int BallPlacementWatcher::kPlacementStableFrames = 8;
+    double BallPlacementWatcher::kPlacementMaxDifferenceEnergy = 3.0;
+    double BallPlacementWatcher::kPlacementMaxCenterDriftPixels = 1.0;
+    double BallPlacementWatcher::kPlacementMaxRadiusChangePercent = 6.0;
+    double BallPlacementWatcher::kPlacementSearchAreaRadiusRatio = 4.0;
+    int BallPlacementWatcher::kPlacementMaxFrameAgeMs = 250;
+    int BallPlacementWatcher::kPlacementFramesPerCheck = 4;
+
+    BallPlacementWatcher& BallPlacementWatcher::GetWatcher() {
+        static BallPlacementWatcher watcher;
+        return watcher;
+    }
+
+    cv::Rect BallPlacementWatcher::GetSearchArea(const cv::Size& image_size, const cv::Vec2i& expected_center, double expected_radius) {
+        const int half_size = (int)std::ceil(expected_radius * kPlacementSearchAreaRadiusRatio);
+
+        cv::Rect search_area(expected_center[0] - half_size, expected_center[1] - half_size, 2 * half_size, 2 * half_size);
+
+        return search_area & cv::Rect(0, 0, image_size.width, image_size.height);
+    }
+
+    bool BallPlacementWatcher::FindBallInSearchArea(const cv::Mat& search_area_gray, double min_radius, double max_radius, GsCircle& circle) {
+        CV_Assert(search_area_gray.type() == CV_8UC1);
+
+        if (search_area_gray.empty() || max_radius < 1.0) {
+            return false;
+        }
+
+        cv::Mat blurred;
+        cv::GaussianBlur(search_area_gray, blurred, cv::Size(5, 5), 0);
+
+        // The search area is small, so the slower but much more selective gradient method is affordable
+        std::vector<cv::Vec3f> circles;
+        cv::HoughCircles(blurred, circles, cv::HOUGH_GRADIENT_ALT, 1.5, std::max(min_radius, 1.0),
+                         200 /* canny upper threshold */, 0.8 /* circle perfectness */,
+                         (int)std::floor(min_radius), (int)std::ceil(max_radius));
+
+        if (circles.empty()) {
+            return false;
+        }
+
+        // The ball will be the circle that is nearest to where the ball is expected
+        const cv::Point2f center(search_area_gray.cols / 2.0F, search_area_gray.rows / 2.0F);
+
+        size_t best_index = 0;
+        double best_distance = DBL_MAX;
+
+        for (size_t i = 0; i < circles.size(); i++) {
+            double distance = cv::norm(cv::Point2f(circles[i][0], circles[i][1]) - center);
+            if (distance < best_distance) {
+                best_distance = distance;
+                best_index = i;
+            }
+        }
+
+        circle = circles[best_index];
+        return true;
+    }
+
+    BallStabilityTracker::Settings BallPlacementWatcher::GetTrackerSettings(double preview_scale) {
+        BallStabilityTracker::Settings settings;
+
+        settings.window_frames = std::max(1, kPlacementStableFrames);
+        settings.max_difference_energy = kPlacementMaxDifferenceEnergy;
+        settings.max_centroid_drift_pixels = kPlacementMaxCenterDriftPixels / std::max(1.0, preview_scale);
+
+        return settings;
+    }
+
+    bool BallPlacementWatcher::Open() {
+
+        const CameraHardware::CameraModel  camera_model = GolfSimCamera::kSystemSlot1CameraType;
+        const CameraHardware::LensType camera_lens_type = GolfSimCamera::kSystemSlot1LensType;
+        const CameraHardware::CameraOrientation camera_orientation = GolfSimCamera::kSystemSlot1CameraOrientation;
+
+        camera_.camera_hardware_.init_camera_parameters(GsCameraNumber::kGsCamera1, camera_model, camera_lens_type, camera_orientation);
+
+        const int full_width = camera_.camera_hardware_.resolution_x_;
+        const int full_height = camera_.camera_hardware_.resolution_y_;
+
+        const int downscale = std::max(1, kPlacementPreviewDownscale);
+
+        // Keep the preview dimensions even, which the ISP output formats want
+        preview_size_ = cv::Size((full_width / downscale) & ~1, (full_height / downscale) & ~1);
+        preview_scale_ = (double)full_width / preview_size_.width;
+
+        preview_calibration_matrix_ = cv::Mat();
+        if (!camera_.camera_hardware_.calibrationMatrix_.empty()) {
+            camera_.camera_hardware_.calibrationMatrix_.convertTo(preview_calibration_matrix_, CV_64F);
+
+            // The focal lengths and principal point scale with the image, the distortion doesn't
+            preview_calibration_matrix_.rowRange(0, 2) /= preview_scale_;
+
+            // Keep the maps here, as the shared cache drops them whenever the (full-resolution)
+            // calibration is reloaded
+            if (preview_maps_ == nullptr || preview_maps_->map1.size() != preview_size_ ||
+                !preview_maps_->MatchesCalibration(preview_calibration_matrix_, camera_.camera_hardware_.cameraDistortionVector_)) {
+                preview_maps_ = UndistortMapCache::GetSharedCache().GetMaps(UndistortMapKey::FromCamera(camera_.camera_hardware_, preview_size_),
+                                                                            preview_calibration_matrix_, camera_.camera_hardware_.cameraDistortionVector_);
+            }
+        }
+        else {
+            preview_maps_.reset();
+        }
+
+        expected_center_ = camera_.GetExpectedBallCenter();
+        expected_radius_ = GolfSimCamera::GetExpectedBallRadiusPixels(camera_.camera_hardware_, full_width,
+                                                                      CvUtils::GetDistance(GolfSimCamera::kCamera1PositionsFromExpectedBallMeters));
+
+        // The whole sensor is streamed and then scaled down by the ISP
+        if (!ConfigCameraForFullScreenWatching(camera_)) {
+            GS_LOG_MSG(error, "BallPlacementWatcher could not configure the camera for full-screen watching.");
+            return false;
+        }
+
+        // Camera 1 can't be opened twice
+        if (LibCameraInterface::libcamera_app_[GsCameraNumber::kGsCamera1] != nullptr) {
+            DeConfigureForLibcameraStill(GsCameraNumber::kGsCamera1);
+        }
+
+        app_ = std::make_unique<LibcameraJpegApp>();
+
+        StillOptions* options = app_->GetOptions();
+
+        char dummy_arguments[] = "DummyExecutableName";
+        char* argv[] = { dummy_arguments, NULL };
+
+        if (!options->Parse(1, argv))
+        {
+            GS_LOG_TRACE_MSG(error, "failed to parse dummy command line.");
+            app_.reset();
+            return false;
+        }
+
+        options->camera = 0;
+        options->gain = LibCameraInterface::kCamera1Gain;
+        options->contrast = LibCameraInterface::kCamera1Contrast;
+        options->shutter.set(std::to_string(LibCameraInterface::kCamera1StillShutterTimeuS) + "us");
+        options->framerate = (float)kPlacementPreviewFPS;
+        options->awb = "indoor";
+        options->denoise = "cdn_off";
+        options->nopreview = true;
+        options->no_raw = true;
+        options->viewfinder_width = preview_size_.width;
+        options->viewfinder_height = preview_size_.height;
+        options->info_text = "";
+
+        if (camera_orientation == CameraHardware::CameraOrientation::kUpsideDown) {
+            options->transform = libcamera::Transform::VFlip;
+        }
+
+        if (!SetLibcameraTuningFileEnvVariable(camera_)) {
+            GS_LOG_TRACE_MSG(error, "failed to SetLibcameraTuningFileEnvVariable");
+            app_.reset();
+            return false;
+        }
+
+        app_->OpenCamera();
+
+        // The RGB flag still works for grayscale mono images
+        app_->ConfigureViewfinder(RPiCamApp::FLAG_STILL_RGB);
+        app_->StartCamera();
+
+        tracker_ = BallStabilityTracker(GetTrackerSettings(preview_scale_));
+
+        GS_LOG_TRACE_MSG(trace, "BallPlacementWatcher streaming " + std::to_string(preview_size_.width) + "x" +
+                                std::to_string(preview_size_.height) + " preview frames at " + std::to_string(kPlacementPreviewFPS) + " FPS.");
+        return true;
+    }
+
+    void BallPlacementWatcher::Close() {
+
+        if (!IsOpen()) {
+            return;
+        }
+
+        GS_LOG_TRACE_MSG(trace, "BallPlacementWatcher closing the preview stream.");
+
+        try
+        {
+            app_->StopCamera();
+            app_->Teardown();
+        }
+        catch (std::exception const& e)
+        {
+            GS_LOG_MSG(error, "ERROR in BallPlacementWatcher::Close: *** " + std::string(e.what()) + " ***");
+        }
+
+        app_.reset();
+        tracker_.Clear();
+    }
+
+    bool BallPlacementWatcher::GetNextFrame(cv::Mat& frame) {
+
+        // Don't loop forever if every frame is stale for some reason
+        const int kMaxFramesToSkip = 32;
+
+        for (int skipped = 0; skipped < kMaxFramesToSkip; skipped++) {
+
+            RPiCamApp::Msg msg = app_->Wait();
+
+            if (msg.type == RPiCamApp::MsgType::Timeout) {
+                GS_LOG_MSG(error, "BallPlacementWatcher device timeout.");
+                return false;
+            }
+
+            if (msg.type != RPiCamApp::MsgType::RequestComplete) {
+                return false;
+            }
+
+            CompletedRequestPtr& completed_request = std::get<CompletedRequestPtr>(msg.payload);
+
+            // Frames queue up while the FSM is doing other things.  Skip the ones that no
+            // longer show what's on the tee.
+            auto sensor_timestamp = completed_request->metadata.get(libcamera::controls::SensorTimestamp);
+            if (sensor_timestamp) {
+                struct timespec now;
+                clock_gettime(CLOCK_BOOTTIME, &now);
+                const int64_t now_ns = (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+
+                if ((now_ns - *sensor_timestamp) / 1000000LL > kPlacementMaxFrameAgeMs) {
+                    continue;
+                }
+            }
+
+            libcamera::Stream* stream = app_->ViewfinderStream();
+
+            if (stream == nullptr) {
+                GS_LOG_MSG(error, "BallPlacementWatcher got a null stream");
+                return false;
+            }
+
+            StreamInfo info = app_->GetStreamInfo(stream);
+            BufferReadSync r(app_.get(), completed_request->buffers[stream]);
+            const std::vector<libcamera::Span<uint8_t>> mem = r.Get();
+
+            // Copy, so that the buffer can go straight back to the camera
+            cv::Mat(info.height, info.width, CV_8UC3, mem[0].data(), info.stride).copyTo(frame);
+            return true;
+        }
+
+        GS_LOG_MSG(warning, "BallPlacementWatcher could not get a recent frame.");
+        return false;
+    }
+
+    cv::Mat BallPlacementWatcher::UndistortPreviewRoi(const cv::Mat& frame, const cv::Rect& roi) const {
+
+        if (preview_maps_ == nullptr || preview_maps_->map1.size() != frame.size()) {
+            return frame(roi).clone();
+        }
+
+        cv::Mat undistorted_roi;
+        cv::remap(frame, undistorted_roi, preview_maps_->map1(roi), preview_maps_->map2(roi), cv::INTER_LINEAR);
+
+        return undistorted_roi;
+    }
+
+    bool BallPlacementWatcher::CalibrateStableBall(const GsCircle& tracked_circle, GolfBall& ball, cv::Mat& img) {
+
+        // The still needs the camera, and the preview resolution isn't precise enough for the
+        // rest of the shot anyway
+        Close();
+
+        if (!CheckForBall(ball, img)) {
+            GS_LOG_MSG(info, "BallPlacementWatcher lost the ball when taking the full-resolution image.");
+            return false;
+        }
+
+        GolfBall tracked_ball;
+        tracked_ball.set_circle(tracked_circle);
+        tracked_ball.measured_radius_pixels_ = tracked_circle[2];
+
+        // Allow for the lower resolution of the tracked circle
+        const int max_center_move = (int)std::ceil(kPlacementMaxCenterDriftPixels + 2.0 * preview_scale_);
+
+        if (ball.CheckIfBallMoved(tracked_ball, max_center_move, (int)std::ceil(2.0 * kPlacementMaxRadiusChangePercent))) {
+            GS_LOG_MSG(info, "BallPlacementWatcher found the ball somewhere other than where it was tracked.");
+            return false;
+        }
+
+        return true;
+    }
+
+    BallPlacementWatcher::PlacementStatus BallPlacementWatcher::CheckForPlacedBall(GolfBall& ball, cv::Mat& img) {
+
+        try
+        {
+            if (!IsOpen() && !Open()) {
+                Close();
+                return PlacementStatus::kError;
+            }
+
+            const cv::Vec2i preview_center((int)std::round(expected_center_[0] / preview_scale_),
+                                           (int)std::round(expected_center_[1] / preview_scale_));
+            const double preview_radius = expected_radius_ / preview_scale_;
+
+            const cv::Rect search_area = GetSearchArea(preview_size_, preview_center, preview_radius);
+
+            const double min_radius = std::max(1.0, (expected_radius_ - GolfSimCamera::kMinRadiusOffset) / preview_scale_);
+            const double max_radius = (expected_radius_ + GolfSimCamera::kMaxRadiusOffset) / preview_scale_;
+
+            for (int frame_number = 0; frame_number < std::max(1, kPlacementFramesPerCheck); frame_number++) {
+
+                if (!GetNextFrame(img)) {
+                    Close();
+                    return PlacementStatus::kError;
+                }
+
+                // Let the caller show where the ball is being looked for
+                ball.search_area_center_ = preview_center;
+                ball.search_area_radius_ = (int)std::round(search_area.width / 2.0);
+
+                cv::Mat search_area_gray;
+                cv::cvtColor(UndistortPreviewRoi(img, search_area), search_area_gray, cv::COLOR_BGR2GRAY);
+
+                // Only look for the ball (which is comparatively expensive) until it's been found.
+                // After that, the tracker follows it.
+                if (!tracker_.IsTracking()) {
+                    GsCircle found_circle;
+                    if (!FindBallInSearchArea(search_area_gray, min_radius, max_radius, found_circle)) {
+                        continue;
+                    }
+
+                    tracker_.Reset(found_circle, search_area_gray.size());
+                }
+
+                const BallStabilityTracker::Status status = tracker_.AddFrame(search_area_gray);
+
+                if (status == BallStabilityTracker::Status::kLost) {
+                    GS_LOG_TRACE_MSG(trace, "BallPlacementWatcher lost track of the ball.");
+                    continue;
+                }
+
+                if (status == BallStabilityTracker::Status::kStable) {
+                    const GsCircle preview_circle = tracker_.GetTrackedCircle();
+
+                    // The full-resolution still is compared with the tracked ball in full-resolution pixels
+                    const GsCircle tracked_circle((float)((preview_circle[0] + search_area.x) * preview_scale_),
+                                                  (float)((preview_circle[1] + search_area.y) * preview_scale_),
+                                                  (float)(preview_circle[2] * preview_scale_));
+
+                    GS_LOG_TRACE_MSG(trace, "BallPlacementWatcher - ball has been still for " + std::to_string(tracker_.frame_count()) +
+                                            " frames (last difference energy " + std::to_string(tracker_.last_difference_energy()) + ").");
+
+                    if (CalibrateStableBall(tracked_circle, ball, img)) {
+                        return PlacementStatus::kBallStable;
+                    }
+
+                    return PlacementStatus::kNoBall;
+                }
+            }
+        }
+        catch (std::exception const& e)
+        {
+            GS_LOG_MSG(error, "ERROR in BallPlacementWatcher::CheckForPlacedBall: *** " + std::string(e.what()) + " ***");
+            Close();
+            return PlacementStatus::kError;
+        }
+
+        return tracker_.IsTracking() ? PlacementStatus::kBallSettling : PlacementStatus::kNoBall;
+    }
+
+}
+
+#endif // #ifdef __unix__  // Ignore in Windows environment
@@ -0,0 +1,137 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Watches for a ball to be teed up using a continuous, low-resolution preview stream
+// from camera 1.
+//
+// The older approach configured the camera (including a media-ctl call), took a
+// full-resolution still, undistorted all of it and searched the whole image for a ball,
+// over and over until a ball showed up.  Then it did all of that again a second later
+// to see if the ball had stayed put.
+//
+// Here, the camera is opened once and left streaming.  Each preview frame is only looked
+// at in the search area around the expected ball position, which is undistorted on its
+// own using maps scaled to the preview resolution.  Once a ball has been found there, it is
+// not searched for again.  Instead, a BallStabilityTracker follows it from frame to frame
+// using frame differences and the ball's centroid.  Only once the tracker says the ball is
+// stable is the stream closed and a single full-resolution still taken, so that the ball
+// can be located precisely for the rest of the shot.
+
+#pragma once
+
+#ifdef __unix__  // Ignore in Windows environment
+
+#include <memory>
+
+#include <opencv2/core.hpp>
+
+#include "golf_ball.h"
+#include "ball_stability_tracker.h"
+#include "gs_camera.h"
+#include "undistort_map_cache.h"
+#include "still_image_libcamera_app.hpp"
+
+
+namespace golf_sim {
+
+class BallPlacementWatcher {
+public:
+
+    enum class PlacementStatus {
+        kNoBall,            // Nothing ball-like in the search area
+        kBallSettling,      // There is a ball, but it hasn't been still for long enough yet
+        kBallStable,        // The ball is still, and has been located in a full-resolution image
+        kError
+    };
+
+    // If false, the FSM uses the older repeated-still approach (CheckForBall)
+    static bool kUseStreamingBallPlacement;
+
+    // The preview frames are the full camera resolution divided by this
+    static int kPlacementPreviewDownscale;
+    static int kPlacementPreviewFPS;
+
+    // How many consecutive frames the ball has to be still in before it is considered stable
+    static int kPlacementStableFrames;
+
+    // Mean absolute difference (in gray levels) between consecutive frames in and around the
+    // ball, above which the ball is considered to be moving
+    static double kPlacementMaxDifferenceEnergy;
+
+    // How far (in full-resolution pixels) the ball's centroid can wander over the stable frames
+    // and still be considered to be still.  Also how far the ball in the full-resolution still
+    // can be from the tracked ball, on top of the preview resolution.
+    static double kPlacementMaxCenterDriftPixels;
+    static double kPlacementMaxRadiusChangePercent;
+
+    // The search area is this many expected ball radii around the expected ball center
+    static double kPlacementSearchAreaRadiusRatio;
+
+    // Frames that are older than this (because the FSM was busy) are skipped
+    static int kPlacementMaxFrameAgeMs;
+
+    // How many frames to look at each time CheckForPlacedBall is called, so that the FSM can
+    // process other events in between
+    static int kPlacementFramesPerCheck;
+
+    static BallPlacementWatcher& GetWatcher();
+
+    // Opens the preview stream if necessary and looks at the next few frames.  ball always
+    // gets the search area (in img coordinates).  When the status is kBallStable, ball and img
+    // are the calibrated ball and the full-resolution, undistorted image that it was found in,
+    // and the preview stream has been closed.  Otherwise, img is the latest preview frame.
+    PlacementStatus CheckForPlacedBall(GolfBall& ball, cv::Mat& img);
+
+    // Closes the preview stream so that camera 1 can be used for something else
+    void Close();
+
+    bool IsOpen() const { return app_ != nullptr; }
+
+    // Looks for the most central ball-like circle in a (small) grayscale search area image.
+    // The returned circle is in search area coordinates.
+    static bool FindBallInSearchArea(const cv::Mat& search_area_gray, double min_radius, double max_radius, GsCircle& circle);
+
+    // The search area in an image of the given size, for a ball expected at expected_center
+    // with the given radius, both in that image's coordinates
+    static cv::Rect GetSearchArea(const cv::Size& image_size, const cv::Vec2i& expected_center, double expected_radius);
+
+    // The tracker settings for the current configuration.  preview_scale is the number of
+    // full-resolution pixels per preview pixel.
+    static BallStabilityTracker::Settings GetTrackerSettings(double preview_scale);
+
+private:
+
+    bool Open();
+
+    // Waits for the next preview frame that isn't too old
+    bool GetNextFrame(cv::Mat& frame);
+
+    // Undistorts just the roi of a preview frame
+    cv::Mat UndistortPreviewRoi(const cv::Mat& frame, const cv::Rect& roi) const;
+
+    // Takes a full-resolution still and locates the ball precisely in it
+    bool CalibrateStableBall(const GsCircle& tracked_circle, GolfBall& ball, cv::Mat& img);
+
+    std::unique_ptr<LibcameraJpegApp> app_;
+    GolfSimCamera camera_;
+
+    cv::Size preview_size_;
+    double preview_scale_ = 1.0;    // Full-resolution pixels per preview pixel
+
+    // Calibration scaled to the preview resolution
+    cv::Mat preview_calibration_matrix_;
+    std::shared_ptr<const UndistortMaps> preview_maps_;
+
+    // Everything below is in full-resolution pixels
+    cv::Vec2i expected_center_;
+    double expected_radius_ = 0.0;
+
+    // In search area (preview) coordinates
+    BallStabilityTracker tracker_;
+};
+
+}
+
+#endif // #ifdef __unix__  // Ignore in Windows environment
@@ -0,0 +1,174 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <opencv2/imgproc.hpp>
+
+#include "ball_stability_tracker.h"
+
+
+namespace golf_sim {
+
+    // Relative to the ball radius
+    static constexpr double kBallMaskRadiusRatio = 1.2;
+    static constexpr double kDifferenceMaskRadiusRatio = 1.5;
+    static constexpr double kBackgroundOuterRadiusRatio = 2.0;
+
+    BallStabilityTracker::BallStabilityTracker(const Settings& settings) : settings_(settings) {
+    }
+
+    void BallStabilityTracker::Clear() {
+        tracking_ = false;
+        have_reference_ = false;
+        reference_brightness_ = 0.0;
+        previous_frame_.release();
+        samples_.clear();
+        last_difference_energy_ = 0.0;
+    }
+
+    void BallStabilityTracker::Reset(const GsCircle& ball_circle, const cv::Size& region_size) {
+        Clear();
+
+        ball_circle_ = ball_circle;
+
+        const cv::Point center((int)std::round(ball_circle[0]), (int)std::round(ball_circle[1]));
+        const double radius = std::max(1.0F, ball_circle[2]);
+
+        ball_mask_ = cv::Mat::zeros(region_size, CV_8UC1);
+        cv::circle(ball_mask_, center, (int)std::ceil(radius * kBallMaskRadiusRatio), cv::Scalar(255), cv::FILLED);
+
+        difference_mask_ = cv::Mat::zeros(region_size, CV_8UC1);
+        cv::circle(difference_mask_, center, (int)std::ceil(radius * kDifferenceMaskRadiusRatio), cv::Scalar(255), cv::FILLED);
+
+        background_mask_ = cv::Mat::zeros(region_size, CV_8UC1);
+        cv::circle(background_mask_, center, (int)std::ceil(radius * kBackgroundOuterRadiusRatio), cv::Scalar(255), cv::FILLED);
+        background_mask_.setTo(0, difference_mask_);
+
+        // If the ball fills the region, use whatever is left as the background
+        if (cv::countNonZero(background_mask_) == 0) {
+            cv::bitwise_not(ball_mask_, background_mask_);
+        }
+
+        last_centroid_ = cv::Point2d(ball_circle[0], ball_circle[1]);
+        tracking_ = true;
+    }
+
+    bool BallStabilityTracker::ComputeCentroid(const cv::Mat& region_gray, cv::Point2d& centroid, double& brightness) const {
+
+        const double background = (cv::countNonZero(background_mask_) > 0) ? cv::mean(region_gray, background_mask_)[0] : 0.0;
+
+        // Only what is brighter than the background counts, so the centroid isn't pulled
+        // towards the middle of the mask
+        cv::Mat weights;
+        region_gray.convertTo(weights, CV_32F, 1.0, -background);
+        cv::max(weights, 0.0, weights);
+        weights.setTo(0, ~ball_mask_);
+
+        const cv::Moments moments = cv::moments(weights, false);
+
+        if (moments.m00 <= 0.0) {
+            return false;
+        }
+
+        centroid = cv::Point2d(moments.m10 / moments.m00, moments.m01 / moments.m00);
+        brightness = moments.m00;
+        return true;
+    }
+
+    bool BallStabilityTracker::IsWindowStill() const {
+
+        if ((int)samples_.size() < std::max(1, settings_.window_frames)) {
+            return false;
+        }
+
+        cv::Point2d mean_centroid(0.0, 0.0);
+
+        for (const Sample& sample : samples_) {
+            if (sample.difference_energy > settings_.max_difference_energy) {
+                return false;
+            }
+            mean_centroid += sample.centroid;
+        }
+
+        mean_centroid *= 1.0 / samples_.size();
+
+        for (const Sample& sample : samples_) {
+            if (cv::norm(sample.centroid - mean_centroid) > settings_.max_centroid_drift_pixels) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    BallStabilityTracker::Status BallStabilityTracker::AddFrame(const cv::Mat& region_gray) {
+        CV_Assert(region_gray.empty() || region_gray.type() == CV_8UC1);
+
+        if (!tracking_) {
+            return Status::kLost;
+        }
+
+        if (region_gray.size() != ball_mask_.size()) {
+            Clear();
+            return Status::kLost;
+        }
+
+        cv::Point2d centroid;
+        double brightness = 0.0;
+
+        if (!ComputeCentroid(region_gray, centroid, brightness)) {
+            Clear();
+            return Status::kLost;
+        }
+
+        if (!have_reference_) {
+            reference_centroid_ = centroid;
+            reference_brightness_ = brightness;
+            have_reference_ = true;
+        }
+        else if (brightness < settings_.lost_brightness_ratio * reference_brightness_ ||
+                 cv::norm(centroid - reference_centroid_) > settings_.lost_center_radius_ratio * ball_circle_[2]) {
+            Clear();
+            return Status::kLost;
+        }
+
+        double difference_energy = 0.0;
+
+        if (!previous_frame_.empty()) {
+            cv::Mat difference;
+            cv::absdiff(region_gray, previous_frame_, difference);
+            difference_energy = cv::mean(difference, difference_mask_)[0];
+        }
+
+        region_gray.copyTo(previous_frame_);
+
+        last_difference_energy_ = difference_energy;
+        last_centroid_ = centroid;
+
+        // Something moved, so the ball has to be still for a whole new window
+        if (difference_energy > settings_.max_difference_energy) {
+            samples_.clear();
+        }
+
+        samples_.push_back({ difference_energy, centroid });
+
+        while ((int)samples_.size() > std::max(1, settings_.window_frames)) {
+            samples_.pop_front();
+        }
+
+        return IsWindowStill() ? Status::kStable : Status::kSettling;
+    }
+
+    GsCircle BallStabilityTracker::GetTrackedCircle() const {
+
+        if (!have_reference_) {
+            return ball_circle_;
+        }
+
+        return GsCircle((float)(ball_circle_[0] + last_centroid_.x - reference_centroid_.x),
+                        (float)(ball_circle_[1] + last_centroid_.y - reference_centroid_.y),
+                        ball_circle_[2]);
+    }
+
+}
@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Decides whether a ball that has already been found in a small region of interest
+// (e.g., the search area around the tee) has stopped moving, without finding the ball
+// again in every frame.
+//
+// Each new frame of the region is compared with the one before it, and only two cheap
+// measurements are kept:
+//
+//  - the difference energy, i.e., the mean absolute per-pixel difference between the two
+//    frames in and just around the ball.  A hand, a club or a ball that is still rolling
+//    all show up here, even if the ball's center hasn't (yet) moved.
+//  - the intensity-weighted centroid of the ball, to sub-pixel precision.  The ball is
+//    brighter than its surroundings, so this follows the ball as it creeps or settles,
+//    which a Hough circle (at whole-pixel resolution and with its own jitter) can't.
+//
+// The ball is stable once the last N frames all have low difference energy and their
+// centroids all lie within a small distance of each other.  If the ball moves well away
+// from where it was found, or most of its brightness disappears, it is considered lost
+// and has to be found again.
+
+#pragma once
+
+#include <deque>
+
+#include <opencv2/core.hpp>
+
+#include "gs_globals.h"
+
+
+namespace golf_sim {
+
+class BallStabilityTracker {
+public:
+
+    enum class Status {
+        kLost,          // The ball is gone (or was never there) and must be found again
+        kSettling,      // The ball is there, but hasn't been still for long enough
+        kStable         // The ball has been still for the last window_frames frames
+    };
+
+    struct Settings {
+        // How many consecutive frames the ball must be still in
+        int window_frames = 8;
+
+        // Mean absolute per-pixel difference (in gray levels) between consecutive frames,
+        // in and around the ball, above which the ball is considered to be moving
+        double max_difference_energy = 3.0;
+
+        // How far (in region pixels) the ball's centroids in the window can be from their mean
+        double max_centroid_drift_pixels = 0.5;
+
+        // The ball is lost if its centroid is further than this many ball radii from where
+        // it was found, or if its brightness falls below this fraction of what it was
+        double lost_center_radius_ratio = 0.5;
+        double lost_brightness_ratio = 0.25;
+    };
+
+    explicit BallStabilityTracker(const Settings& settings = Settings());
+
+    // Starts tracking a ball that was found at ball_circle (in region coordinates).  The
+    // frames given to AddFrame must all be of the same region, at region_size.
+    void Reset(const GsCircle& ball_circle, const cv::Size& region_size);
+
+    // Forgets the ball, e.g., because the region it was found in is no longer being watched
+    void Clear();
+
+    bool IsTracking() const { return tracking_; }
+
+    // region_gray must be CV_8UC1
+    Status AddFrame(const cv::Mat& region_gray);
+
+    // The ball circle, moved by how far the centroid has moved since the ball was found
+    GsCircle GetTrackedCircle() const;
+
+    // Measurements of the latest frame, mostly for logging
+    double last_difference_energy() const { return last_difference_energy_; }
+    cv::Point2d last_centroid() const { return last_centroid_; }
+
+    // Number of frames in a row that the ball has been seen, up to window_frames
+    int frame_count() const { return (int)samples_.size(); }
+
+    const Settings& settings() const { return settings_; }
+
+private:
+
+    struct Sample {
+        double difference_energy = 0.0;
+        cv::Point2d centroid;
+    };
+
+    // False if there was nothing brighter than the background to take the centroid of
+    bool ComputeCentroid(const cv::Mat& region_gray, cv::Point2d& centroid, double& brightness) const;
+
+    bool IsWindowStill() const;
+
+    Settings settings_;
+
+    bool tracking_ = false;
+    GsCircle ball_circle_;
+
+    // Where the ball itself is, where differences between frames count, and the ring
+    // around the ball that is used as the background level
+    cv::Mat ball_mask_;
+    cv::Mat difference_mask_;
+    cv::Mat background_mask_;
+
+    // The centroid and brightness in the first frame after Reset
+    bool have_reference_ = false;
+    cv::Point2d reference_centroid_;
+    double reference_brightness_ = 0.0;
+
+    cv::Mat previous_frame_;
+    std::deque<Sample> samples_;
+
+    double last_difference_energy_ = 0.0;
+    cv::Point2d last_centroid_;
+};
+
+}
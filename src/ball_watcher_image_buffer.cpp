@@ -7,12 +7,103 @@
 
 #ifdef __unix__  // Ignore in Windows environment
 
+#include <algorithm>
+#include <string>
+
+#include <opencv2/imgproc.hpp>
 
 #include "ball_watcher_image_buffer.h"
 
 	// Global queue to hold the last <n> frames before motion is detected in the frame
 	// WARNING - NOT THREAD SAFE ON ITS OWN
-	boost::circular_buffer<golf_sim::RecentFrameInfo> golf_sim::RecentFrames(10);
+	golf_sim::RecentFrameRing golf_sim::RecentFrames(10);
 
-#endif // #ifdef __unix__  // Ignore in Windows environment
+namespace golf_sim {
+
+	cv::Mat RecentFrameInfo::GetAnnotatedMat() const {
+		if (mat.empty()) {
+			return cv::Mat();
+		}
+
+		cv::Mat annotated = mat.clone();
+
+		if (showRoi) {
+			cv::Scalar c_black{ 0, 0, 0 }; // black
+			cv::Scalar c_green{ 170, 255, 0 }; // bright green
+
+			// We could have different frame sizes for the "hit" frame?
+			int rectWidth = isballHitFrame ? 2 : 2;
+
+			cv::Scalar rectangle_color = isballHitFrame ? c_green : c_black;
+
+			cv::rectangle(annotated, roi.tl(), roi.br(), rectangle_color, rectWidth);
+		}
+
+		// Number the frame 
+		cv::Scalar c_label{ 170, 255, 0 }; // bright green
+		std::string frame_label = std::to_string(requestSequence);
+		int text_x = annotated.cols - 60;
+		int text_y = 25;
+
+		cv::putText(annotated, frame_label, cv::Point(text_x, text_y), cv::FONT_HERSHEY_SIMPLEX, 0.8, c_label, 2, cv::LINE_AA);
+
+		return annotated;
+	}
+
+	RecentFrameRing::RecentFrameRing(size_t capacity) {
+		SetCapacity(capacity);
+	}
+
+	void RecentFrameRing::SetCapacity(size_t capacity) {
+		capacity = std::max<size_t>(capacity, 1);
 
+		if (capacity != slots_.size()) {
+			slots_.clear();
+			slots_.resize(capacity);
+		}
+
+		clear();
+	}
+
+	void RecentFrameRing::Preallocate(int rows, int cols, int type) {
+		for (RecentFrameInfo& slot : slots_) {
+			// A no-op if the slot is already the right size
+			slot.mat.create(rows, cols, type);
+		}
+	}
+
+	RecentFrameInfo& RecentFrameRing::PushFrame(const cv::Mat& frame) {
+		size_t slot_index;
+
+		if (count_ < slots_.size()) {
+			slot_index = (head_ + count_) % slots_.size();
+			count_++;
+		}
+		else {
+			// Overwrite the oldest frame
+			slot_index = head_;
+			head_ = (head_ + 1) % slots_.size();
+		}
+
+		RecentFrameInfo& slot = slots_[slot_index];
+
+		// Re-uses the slot's buffer as long as the frame size has not changed
+		frame.copyTo(slot.mat);
+
+		slot.requestSequence = 0;
+		slot.isballHitFrame = false;
+		slot.frameRate = 0.0;
+		slot.showRoi = false;
+		slot.roi = cv::Rect();
+
+		return slot;
+	}
+
+	void RecentFrameRing::clear() {
+		head_ = 0;
+		count_ = 0;
+	}
+
+}
+
+#endif // #ifdef __unix__  // Ignore in Windows environment
@@ -8,25 +8,74 @@
 
 #pragma once
 
+#include <vector>
+
 #include <opencv2/core/cvdef.h>
 #include <opencv2/highgui.hpp>
 
-#include <boost/circular_buffer.hpp>
-
 namespace golf_sim {
 
 	//  We also need to be able to reach these variables from within the libcamera namespace.
 
 	struct RecentFrameInfo {
+		// The un-annotated frame.  Its pixels live in a slab that is owned and re-used by
+		// the RecentFrameRing, so clone() it if it has to outlive the next few frames.
 		cv::Mat mat;
 		// Holds the sequence number from the completed request from whence the mat came
-		unsigned int requestSequence;
+		unsigned int requestSequence = 0;
 		// True if this was the frame where motion (the ball hit) was first detected
 		bool isballHitFrame = false;
 		float frameRate = 0.0;
+
+		// If true, the motion-detection ROI should be drawn when the frame is exported
+		bool showRoi = false;
+		cv::Rect roi;
+
+		// Returns a copy of the frame with the frame number (and the ROI, if showRoi)
+		// drawn on it.  Annotation is deferred to here so that the high-FPS watch loop
+		// does not have to draw on every frame.
+		cv::Mat GetAnnotatedMat() const;
+	};
+
+	// Fixed-capacity ring of the most recent frames.  Each slot keeps its own image
+	// buffer, so once the slots have been allocated (see Preallocate) pushing a frame
+	// is a single copy with no heap allocation.  When full, the oldest frame is overwritten.
+	// WARNING - NOT THREAD SAFE ON ITS OWN
+	class RecentFrameRing {
+	public:
+		explicit RecentFrameRing(size_t capacity);
+
+		// Discards all frames.  Does not release the slot buffers unless the capacity changes.
+		void SetCapacity(size_t capacity);
+
+		// Allocates every slot's buffer up front for frames of the given size and type
+		void Preallocate(int rows, int cols, int type);
+
+		// Copies the frame into the next slot and returns that slot so that the caller
+		// can fill in the rest of the frame information
+		RecentFrameInfo& PushFrame(const cv::Mat& frame);
+
+		// Index 0 is the oldest frame and size() - 1 the most recent
+		RecentFrameInfo& operator[](size_t index) { return slots_[(head_ + index) % slots_.size()]; }
+		const RecentFrameInfo& operator[](size_t index) const { return slots_[(head_ + index) % slots_.size()]; }
+
+		RecentFrameInfo& back() { return (*this)[count_ - 1]; }
+
+		size_t size() const { return count_; }
+		size_t capacity() const { return slots_.size(); }
+		bool empty() const { return count_ == 0; }
+
+		void clear();
+
+	private:
+		std::vector<RecentFrameInfo> slots_;
+
+		// Index within slots_ of the oldest frame
+		size_t head_ = 0;
+		size_t count_ = 0;
 	};
 
 	// Global queue to hold the last <n> frames before motion is detected in the frame
-	extern boost::circular_buffer<RecentFrameInfo> RecentFrames;
+	extern RecentFrameRing RecentFrames;
 
-}
\ No newline at end of file
+}
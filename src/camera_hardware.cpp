@@ -20,6 +20,7 @@
 #include "gs_options.h"
 #include "gs_config.h"
 #include "camera_hardware.h"
+#include "undistort_map_cache.h"
 
 
 namespace golf_sim {
@@ -486,6 +487,9 @@ namespace golf_sim {
         tag = "gs_config.cameras.kCamera" + std::to_string(camera_number_) + "Angles";
         GolfSimConfiguration::SetConstant(tag, camera_angles_);
 
+        // Any cached undistortion maps from a different calibration are no longer any good
+        UndistortMapCache::GetSharedCache().OnCalibrationLoaded(camera_number_, calibrationMatrix_, cameraDistortionVector_);
+
         cameraInitialized = true;
     }
 
@@ -0,0 +1,251 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <locale>
+#include <mutex>
+#include <sstream>
+
+#include "utils/logging_tools.h"
+
+#include "config_snapshot.h"
+
+
+namespace golf_sim {
+
+    std::atomic<const ConfigSnapshot*> ConfigSnapshot::current_{ nullptr };
+
+    // Reads the whole of the text (other than surrounding white space) the same way
+    // that boost::property_tree's stream translator does
+    template <typename T>
+    static std::optional<T> ParseWhole(const std::string& text) {
+        std::istringstream stream(text);
+        stream.imbue(std::locale::classic());
+
+        T value{};
+        stream >> value;
+
+        if (!stream.eof()) {
+            stream >> std::ws;
+        }
+
+        if (stream.fail() || stream.bad() || stream.get() != std::char_traits<char>::eof()) {
+            return std::nullopt;
+        }
+
+        return value;
+    }
+
+    // std::stoi, without the exceptions
+    static std::optional<int> ParseLeadingInt(const std::string& text) {
+        const char* start = text.c_str();
+        char* end = nullptr;
+
+        errno = 0;
+        const long value = std::strtol(start, &end, 10);
+
+        if (end == start || errno == ERANGE || value < INT_MIN || value > INT_MAX) {
+            return std::nullopt;
+        }
+
+        return (int)value;
+    }
+
+    // std::stof, without the exceptions
+    static std::optional<float> ParseLeadingFloat(const std::string& text) {
+        const char* start = text.c_str();
+        char* end = nullptr;
+
+        errno = 0;
+        const float value = std::strtof(start, &end);
+
+        if (end == start || errno == ERANGE) {
+            return std::nullopt;
+        }
+
+        return value;
+    }
+
+    static std::optional<bool> ParseBool(const std::string& text) {
+        if (text == "true" || text == "1" || text == "yes" || text == "on") {
+            return true;
+        }
+        if (text == "false" || text == "0" || text == "no" || text == "off") {
+            return false;
+        }
+        return std::nullopt;
+    }
+
+    // JSON arrays become nodes whose children all have empty names
+    static bool IsArray(const boost::property_tree::ptree& node) {
+        if (node.empty()) {
+            return false;
+        }
+
+        for (const auto& child : node) {
+            if (!child.first.empty()) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    ConfigSnapshot::Value ConfigSnapshot::Value::Parse(const std::string& text) {
+        Value value;
+        value.text = text;
+        value.boolean = ParseBool(text);
+        value.integer = ParseLeadingInt(text);
+        value.real = ParseLeadingFloat(text);
+        value.whole_long = ParseWhole<long>(text);
+        value.whole_uint = ParseWhole<unsigned int>(text);
+        value.whole_float = ParseWhole<float>(text);
+        value.whole_double = ParseWhole<double>(text);
+        return value;
+    }
+
+    static ConfigSnapshot::Value ParseNode(const boost::property_tree::ptree& node) {
+        ConfigSnapshot::Value value = ConfigSnapshot::Value::Parse(node.data());
+        value.has_children = !node.empty();
+
+        if (IsArray(node)) {
+            value.elements.reserve(node.size());
+
+            for (const auto& element : node) {
+                value.elements.push_back(ParseNode(element.second));
+            }
+        }
+
+        return value;
+    }
+
+    void ConfigSnapshot::AddJsonNode(const std::string& path, const boost::property_tree::ptree& node) {
+        // As with ptree lookups, the first of any repeated names wins
+        Entry& entry = entries_[path];
+        if (entry.json) {
+            return;
+        }
+
+        entry.json = ParseNode(node);
+
+        if (IsArray(node)) {
+            return;
+        }
+
+        for (const auto& child : node) {
+            AddJsonNode(path.empty() ? child.first : path + "." + child.first, child.second);
+        }
+    }
+
+    std::unique_ptr<ConfigSnapshot> ConfigSnapshot::Build(const boost::property_tree::ptree& json_root,
+                                                          const std::vector<std::pair<std::string, std::string>>& overrides) {
+        auto snapshot = std::make_unique<ConfigSnapshot>();
+
+        for (const auto& child : json_root) {
+            snapshot->AddJsonNode(child.first, child.second);
+        }
+
+        for (const auto& [key, text] : overrides) {
+            Entry& entry = snapshot->entries_[key];
+
+            if (!entry.override) {
+                entry.override = Value::Parse(text);
+            }
+        }
+
+        return snapshot;
+    }
+
+    const ConfigSnapshot& ConfigSnapshot::Current() noexcept {
+        static const ConfigSnapshot empty_snapshot;
+
+        const ConfigSnapshot* current = current_.load(std::memory_order_acquire);
+        return (current != nullptr) ? *current : empty_snapshot;
+    }
+
+    uint64_t ConfigSnapshot::Publish(std::unique_ptr<ConfigSnapshot> snapshot) {
+        static std::mutex publish_mutex;
+        static std::vector<std::unique_ptr<const ConfigSnapshot>> published;
+
+        std::lock_guard<std::mutex> lock(publish_mutex);
+
+        snapshot->generation_ = published.size() + 1;
+        const uint64_t generation = snapshot->generation_;
+
+        // Readers may still be using the earlier snapshots, so they are kept
+        published.push_back(std::move(snapshot));
+        current_.store(published.back().get(), std::memory_order_release);
+
+        GS_LOG_TRACE_MSG(trace, "ConfigSnapshot::Publish - published generation " + std::to_string(generation) +
+                                " with " + std::to_string(published.back()->size()) + " entries.");
+
+        return generation;
+    }
+
+    const ConfigSnapshot::Entry* ConfigSnapshot::Find(const std::string& key) const noexcept {
+        const auto found = entries_.find(key);
+        return (found != entries_.end()) ? &found->second : nullptr;
+    }
+
+    bool ConfigSnapshot::JsonNodeExists(const std::string& key) const noexcept {
+        const Entry* entry = Find(key);
+        return entry != nullptr && entry->json.has_value();
+    }
+
+    bool ConfigSnapshot::GetBool(const std::string& key, bool default_value) const noexcept {
+        const Entry* entry = Find(key);
+        const Value* value = (entry != nullptr) ? entry->Effective() : nullptr;
+        return (value != nullptr && value->boolean) ? *value->boolean : default_value;
+    }
+
+    int ConfigSnapshot::GetInt(const std::string& key, int default_value) const noexcept {
+        const Entry* entry = Find(key);
+        const Value* value = (entry != nullptr) ? entry->Effective() : nullptr;
+        return (value != nullptr && value->integer) ? *value->integer : default_value;
+    }
+
+    long ConfigSnapshot::GetLong(const std::string& key, long default_value) const noexcept {
+        const Entry* entry = Find(key);
+        const Value* value = (entry != nullptr) ? entry->Effective() : nullptr;
+        return (value != nullptr && value->whole_long) ? *value->whole_long : default_value;
+    }
+
+    unsigned int ConfigSnapshot::GetUInt(const std::string& key, unsigned int default_value) const noexcept {
+        const Entry* entry = Find(key);
+        const Value* value = (entry != nullptr) ? entry->Effective() : nullptr;
+        return (value != nullptr && value->whole_uint) ? *value->whole_uint : default_value;
+    }
+
+    float ConfigSnapshot::GetFloat(const std::string& key, float default_value) const noexcept {
+        const Entry* entry = Find(key);
+        const Value* value = (entry != nullptr) ? entry->Effective() : nullptr;
+        return (value != nullptr && value->real) ? *value->real : default_value;
+    }
+
+    double ConfigSnapshot::GetDouble(const std::string& key, double default_value) const noexcept {
+        const Entry* entry = Find(key);
+        const Value* value = (entry != nullptr) ? entry->Effective() : nullptr;
+        return (value != nullptr && value->whole_double) ? *value->whole_double : default_value;
+    }
+
+    std::string ConfigSnapshot::GetString(const std::string& key, const std::string& default_value) const {
+        const Entry* entry = Find(key);
+        const Value* value = (entry != nullptr) ? entry->Effective() : nullptr;
+        return (value != nullptr) ? value->text : default_value;
+    }
+
+    const std::vector<ConfigSnapshot::Value>* ConfigSnapshot::GetJsonArray(const std::string& key) const noexcept {
+        const Entry* entry = Find(key);
+
+        if (entry == nullptr || !entry->json) {
+            return nullptr;
+        }
+
+        return &entry->json->elements;
+    }
+
+}
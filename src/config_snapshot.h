@@ -0,0 +1,124 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// A flat, pre-parsed, read-only copy of the configuration.
+//
+// Looking a value up in the configuration trees means walking a boost::property_tree
+// path for each of the CLI, YAML and JSON layers (under ConfigurationManager's mutex),
+// parsing the string each time, and catching ptree_error when it is missing.  That is
+// fine at start-up, but SetConstant is also called while waiting for and processing shots.
+//
+// A ConfigSnapshot is built once from those layers.  Every node of the JSON tree, and
+// every override from the user settings, YAML and command line, is stored under its
+// full dotted path (e.g., "gs_config.strobing.kBaudRateForFastPulses") in a hash table,
+// with its value already parsed into each of the types that SetConstant reads.  Arrays
+// keep their (parsed) elements.  Lookups neither lock nor throw.
+//
+// The current snapshot is published by swapping an atomic pointer, so readers always see
+// a complete snapshot, RCU-style.  A new snapshot is published whenever the configuration
+// changes (GolfSimConfiguration::PublishConfigSnapshot).  Old snapshots are kept until the
+// process exits, so a reader can never be left holding a deleted one.  The configuration
+// only changes a handful of times per run, so this costs very little memory.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+
+namespace golf_sim {
+
+class ConfigSnapshot {
+public:
+
+    // One configuration value, parsed in each of the ways it may be read
+    struct Value {
+        std::string text;
+        bool has_children = false;
+
+        // Parsed like ConfigurationManager::GetBool, GetInt and GetFloat.  The numbers
+        // are read from the start of the text, as std::stoi and std::stof do.
+        std::optional<bool> boolean;
+        std::optional<int> integer;
+        std::optional<float> real;
+
+        // The whole text (other than surrounding white space) must be the number, as
+        // boost::property_tree reads it
+        std::optional<long> whole_long;
+        std::optional<unsigned int> whole_uint;
+        std::optional<float> whole_float;
+        std::optional<double> whole_double;
+
+        // Only for JSON arrays, e.g., [ "1.0", "2.0" ] or [ [ "1", "0" ], [ "0", "1" ] ]
+        std::vector<Value> elements;
+
+        static Value Parse(const std::string& text);
+    };
+
+    struct Entry {
+        // The value in the JSON configuration tree
+        std::optional<Value> json;
+
+        // The value from the user settings, YAML or command line, which wins over the JSON
+        std::optional<Value> override;
+
+        // The value that scalar settings use
+        const Value* Effective() const { return override ? &*override : (json ? &*json : nullptr); }
+    };
+
+    // Flattens json_root, and adds the overrides (JSON-style dotted path and value pairs).
+    // If an override path is repeated, the first one is used.
+    static std::unique_ptr<ConfigSnapshot> Build(const boost::property_tree::ptree& json_root,
+                                                 const std::vector<std::pair<std::string, std::string>>& overrides);
+
+    // The most recently published snapshot.  Before anything is published, this is an
+    // empty snapshot, so it is never null.
+    static const ConfigSnapshot& Current() noexcept;
+
+    // Makes snapshot the current one and returns its generation (1 for the first)
+    static uint64_t Publish(std::unique_ptr<ConfigSnapshot> snapshot);
+
+    // nullptr if the key is in none of the layers
+    const Entry* Find(const std::string& key) const noexcept;
+
+    // True if the node exists in the JSON tree (whether or not it has a value)
+    bool JsonNodeExists(const std::string& key) const noexcept;
+
+    // These read the override if there is one, and the JSON value otherwise.  The
+    // default is returned if the key is missing or its value cannot be parsed.
+    bool GetBool(const std::string& key, bool default_value) const noexcept;
+    int GetInt(const std::string& key, int default_value) const noexcept;
+    long GetLong(const std::string& key, long default_value) const noexcept;
+    unsigned int GetUInt(const std::string& key, unsigned int default_value) const noexcept;
+    float GetFloat(const std::string& key, float default_value) const noexcept;
+    double GetDouble(const std::string& key, double default_value) const noexcept;
+    std::string GetString(const std::string& key, const std::string& default_value) const;
+
+    // The elements of a JSON array (which are empty if the node is not an array), or
+    // nullptr if the node is not in the JSON tree
+    const std::vector<Value>* GetJsonArray(const std::string& key) const noexcept;
+
+    size_t size() const { return entries_.size(); }
+    uint64_t generation() const { return generation_; }
+
+private:
+
+    void AddJsonNode(const std::string& path, const boost::property_tree::ptree& node);
+
+    std::unordered_map<std::string, Entry> entries_;
+    uint64_t generation_ = 0;
+
+    static std::atomic<const ConfigSnapshot*> current_;
+};
+
+}
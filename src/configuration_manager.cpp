@@ -47,6 +47,25 @@ namespace {
         }
     }
     
+    // Helper function to list the leaf values of a property tree with their dotted paths.
+    // Array elements (which have no names) are skipped.
+    void append_leaves(const boost::property_tree::ptree& tree, const std::string& path,
+                       std::vector<std::pair<std::string, std::string>>& leaves) {
+        for (const auto& [key, value] : tree) {
+            if (key.empty()) {
+                continue;
+            }
+
+            const std::string child_path = path.empty() ? key : path + "." + key;
+
+            if (value.empty()) {
+                leaves.emplace_back(child_path, value.data());
+            } else {
+                append_leaves(value, child_path, leaves);
+            }
+        }
+    }
+
     // Helper function to load YAML file to property tree
     void load_yaml_to_ptree(const std::string& filename, boost::property_tree::ptree& pt) {
         try {
@@ -92,6 +111,7 @@ bool ConfigurationManager::Initialize(
             
             // Merge user settings into json_config (user overrides defaults)
             merge_ptree(user_settings, json_config_);
+            user_settings_ = user_settings;
             
             GS_LOG_MSG(info, "Loaded user settings from: " + user_settings_file);
         } catch (const boost::property_tree::json_parser_error& e) {
@@ -174,8 +194,12 @@ bool ConfigurationManager::GetBool(const std::string& key, bool default_value) c
 }
 
 void ConfigurationManager::SetOverride(const std::string& key, const std::string& value) {
-    std::lock_guard<std::mutex> lock(config_mutex_);
-    SetInTree(cli_overrides_, key, value);
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        SetInTree(cli_overrides_, key, value);
+    }
+
+    NotifyChanged();
 }
 
 bool ConfigurationManager::HasKey(const std::string& key) const {
@@ -210,7 +234,8 @@ bool ConfigurationManager::ApplyPreset(const std::string& preset_name) {
                 SetInTree(yaml_config_, key, val);
             }
         }
-        
+
+        NotifyChanged();
         return true;
     } catch (const std::exception& e) {
         GS_LOG_MSG(error, "Failed to apply preset: " + std::string(e.what()));
@@ -307,10 +332,55 @@ bool ConfigurationManager::Reload() {
     // Clear existing configuration
     json_config_.clear();
     yaml_config_.clear();
+    user_settings_.clear();
     // Keep CLI overrides
     
     // Reload files
-    return Initialize(json_config_file_, yaml_config_file_, {});
+    const bool success = Initialize(json_config_file_, yaml_config_file_, {});
+
+    NotifyChanged();
+    return success;
+}
+
+std::vector<std::pair<std::string, std::string>> ConfigurationManager::GetOverrideValues() const {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+
+    std::vector<std::pair<std::string, std::string>> overrides;
+
+    append_leaves(cli_overrides_, "", overrides);
+
+    // YAML keys are looked up both through their JSON path mapping and as-is
+    std::vector<std::pair<std::string, std::string>> yaml_values;
+    append_leaves(yaml_config_, "", yaml_values);
+
+    for (const auto& [yaml_key, value] : yaml_values) {
+        const std::string json_path = MapToJsonPath(yaml_key);
+        if (json_path != yaml_key) {
+            overrides.emplace_back(json_path, value);
+        }
+    }
+    overrides.insert(overrides.end(), yaml_values.begin(), yaml_values.end());
+
+    append_leaves(user_settings_, "", overrides);
+
+    return overrides;
+}
+
+void ConfigurationManager::SetChangeListener(std::function<void()> listener) {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    change_listener_ = std::move(listener);
+}
+
+void ConfigurationManager::NotifyChanged() {
+    std::function<void()> listener;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        listener = change_listener_;
+    }
+
+    if (listener) {
+        listener();
+    }
 }
 
 bool ConfigurationManager::LoadMappings(const std::string& mappings_file) {
@@ -13,6 +13,9 @@
 #include <map>
 #include <optional>
 #include <mutex>
+#include <functional>
+#include <utility>
+#include <vector>
 
 namespace golf_sim {
 
@@ -151,12 +154,27 @@ public:
      */
     bool Reload();
 
+    /**
+     * Get every value that overrides the JSON defaults, highest priority first
+     * (CLI, then YAML, then user settings)
+     * @return Dotted JSON path and value pairs.  A path may appear more than once.
+     */
+    std::vector<std::pair<std::string, std::string>> GetOverrideValues() const;
+
+    /**
+     * Set a function to call whenever the overrides change (e.g., to republish
+     * the configuration snapshot).  Called without the configuration lock held.
+     * @param listener Function to call, or an empty function for none
+     */
+    void SetChangeListener(std::function<void()> listener);
+
 private:
     ConfigurationManager() = default;
     ~ConfigurationManager() = default;
 
     // Configuration storage (three tiers)
     boost::property_tree::ptree json_config_;     // golf_sim_config.json
+    boost::property_tree::ptree user_settings_;   // user_settings.json (also merged into json_config_)
     boost::property_tree::ptree yaml_config_;     // pitrac.yaml overrides
     boost::property_tree::ptree cli_overrides_;   // Command-line overrides
     boost::property_tree::ptree mappings_;        // Parameter mappings
@@ -175,6 +193,10 @@ private:
     // Reverse mapping cache (JSON path -> YAML key)
     mutable std::map<std::string, std::string> json_to_yaml_map_;
 
+    std::function<void()> change_listener_;
+
+    void NotifyChanged();
+
     /**
      * Load parameter mappings from file
      * @param mappings_file Path to parameter-mappings.yaml
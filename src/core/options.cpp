@@ -224,6 +224,12 @@ Options::Options()
 			"Set the file name for configuring the post-processing")
 		("post-process-libs", value<std::string>(&post_process_libs),
 			"Set a custom location for the post-processing library .so files")
+		("post-process-threads", value<unsigned int>(&post_process_threads)->default_value(0),
+			"Number of threads running the post-processing stages (0 = one per CPU, up to 4)")
+		("post-process-max-in-flight", value<unsigned int>(&post_process_max_in_flight)->default_value(8),
+			"Maximum number of requests being post-processed at once. Any more are dropped")
+		("post-process-cpus", value<std::string>(&post_process_cpus),
+			"Comma-separated list of CPUs to pin the post-processing threads to, e.g. 2,3")
 		("nopreview,n", value<bool>(&nopreview)->default_value(false)->implicit_value(true),
 			"Do not show a preview window")
 		("preview,p", value<std::string>(&preview)->default_value("0,0,0,0"),
@@ -667,6 +673,10 @@ void Options::Print() const
 	std::cerr << "    output: " << output << std::endl;
 	std::cerr << "    post_process_file: " << post_process_file << std::endl;
 	std::cerr << "    post_process_libs: " << post_process_libs << std::endl;
+	std::cerr << "    post_process_threads: " << post_process_threads << std::endl;
+	std::cerr << "    post_process_max_in_flight: " << post_process_max_in_flight << std::endl;
+	if (!post_process_cpus.empty())
+		std::cerr << "    post_process_cpus: " << post_process_cpus << std::endl;
 	if (nopreview)
 		std::cerr << "    preview: none" << std::endl;
 	else if (fullscreen)
@@ -115,6 +115,9 @@ struct Options
 	std::string output;
 	std::string post_process_file;
 	std::string post_process_libs;
+	unsigned int post_process_threads;
+	unsigned int post_process_max_in_flight;
+	std::string post_process_cpus;
 	unsigned int width;
 	unsigned int height;
 	bool nopreview;
@@ -6,9 +6,14 @@
  */
 
 #include <dlfcn.h>
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
 #include <map>
+#include <sstream>
 
 #include "core/options.hpp"
 #include "core/rpicam_app.hpp"
@@ -187,15 +192,81 @@ void PostProcessor::Configure()
 	}
 }
 
-void PostProcessor::Start()
+static void pinThread(std::thread &thread, int cpu)
 {
-	quit_ = false;
-	output_thread_ = std::thread(&PostProcessor::outputThread, this);
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	CPU_SET(cpu, &cpu_set);
+
+	int ret = pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set);
+	if (ret)
+		LOG_ERROR("Unable to pin post-processing thread to CPU " << cpu << ": " << strerror(ret));
+}
+
+// Parse a comma-separated list of CPU numbers, e.g. "2,3".
+static std::vector<int> parseCpuList(std::string const &cpus)
+{
+	std::vector<int> cpu_list;
+	std::stringstream ss(cpus);
+	std::string cpu;
 
+	while (std::getline(ss, cpu, ','))
+	{
+		try
+		{
+			cpu_list.push_back(std::stoi(cpu));
+		}
+		catch (std::exception const &)
+		{
+			LOG_ERROR("Ignoring invalid post-processing CPU \"" << cpu << "\"");
+		}
+	}
+
+	return cpu_list;
+}
+
+void PostProcessor::Start()
+{
 	for (auto &stage : stages_)
 	{
 		stage->Start();
 	}
+
+	// Without any stages, Process calls the callback directly.
+	if (stages_.empty())
+		return;
+
+	Options const *options = app_->GetOptions();
+
+	unsigned int num_workers = options->post_process_threads;
+	if (num_workers == 0)
+		num_workers = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+
+	max_in_flight_ = std::max(options->post_process_max_in_flight, 1u);
+	num_slots_ = max_in_flight_ + 1;
+	slots_ = std::make_unique<Slot[]>(num_slots_);
+	next_submit_ = 0;
+	published_ = 0;
+	next_claim_ = 0;
+	next_output_ = 0;
+
+	stage_timings_ = std::make_unique<StageTiming[]>(stages_.size());
+	submitted_ = 0;
+	output_ = 0;
+	dropped_by_stage_ = 0;
+	dropped_in_flight_ = 0;
+
+	output_thread_ = std::thread(&PostProcessor::outputThread, this);
+
+	std::vector<int> cpus = parseCpuList(options->post_process_cpus);
+	for (unsigned int i = 0; i < num_workers; i++)
+	{
+		workers_.emplace_back(&PostProcessor::workerThread, this);
+		if (!cpus.empty())
+			pinThread(workers_.back(), cpus[i % cpus.size()]);
+	}
+
+	LOG(2, "Post-processing with " << num_workers << " threads, at most " << max_in_flight_ << " requests in flight");
 }
 
 void PostProcessor::Process(CompletedRequestPtr &request)
@@ -206,57 +277,114 @@ void PostProcessor::Process(CompletedRequestPtr &request)
 		return;
 	}
 
-	std::unique_lock<std::mutex> l(mutex_);
-	requests_.push(std::move(request)); // caller has given us ownership of this reference
+	// Rather than queue up ever more requests when the stages can't keep up, drop this one (which
+	// hands its buffers straight back to the camera).
+	uint64_t sequence = next_submit_;
+	if (sequence - next_output_.load(std::memory_order_acquire) >= max_in_flight_)
+	{
+		dropped_in_flight_++;
+		LOG(2, "Post-processing is behind, dropping request " << request->sequence);
+		request.reset();
+		return;
+	}
+
+	Slot &slot = slots_[sequence % num_slots_];
+	slot.request = std::move(request); // caller has given us ownership of this reference
+	slot.drop_request = false;
+	slot.state.store(Queued, std::memory_order_release);
+
+	next_submit_ = sequence + 1;
+	published_.store(next_submit_, std::memory_order_release);
+	submitted_++;
+	work_available_.release();
+}
+
+// Claim the oldest request that no worker has started on. Returns false if there are none, which
+// only happens once Stop has released the workers.
+bool PostProcessor::claimRequest(uint64_t &sequence)
+{
+	sequence = next_claim_.load(std::memory_order_acquire);
+	do
+	{
+		if (sequence >= published_.load(std::memory_order_acquire))
+			return false;
+	} while (!next_claim_.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acq_rel));
+
+	return true;
+}
+
+void PostProcessor::workerThread()
+{
+	while (true)
+	{
+		work_available_.acquire();
+
+		uint64_t sequence;
+		if (!claimRequest(sequence))
+			break;
+
+		// Claiming the request (an acquire of published_) makes the camera thread's writes to it visible.
+		Slot &slot = slots_[sequence % num_slots_];
 
-	std::promise<bool> promise;
-	auto process_fn = [this](CompletedRequestPtr &request, std::promise<bool> promise) {
 		bool drop_request = false;
-		for (auto &stage : stages_)
+		for (size_t i = 0; i < stages_.size(); i++)
 		{
-			if (stage->Process(request))
+			auto start = std::chrono::steady_clock::now();
+			bool drop = stages_[i]->Process(slot.request);
+			uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+			StageTiming &timing = stage_timings_[i];
+			timing.calls++;
+			timing.total_us += us;
+			uint64_t max_us = timing.max_us.load(std::memory_order_relaxed);
+			while (us > max_us && !timing.max_us.compare_exchange_weak(max_us, us, std::memory_order_relaxed))
+			{
+			}
+
+			if (drop)
 			{
 				drop_request = true;
 				break;
 			}
 		}
-		promise.set_value(drop_request);
-		cv_.notify_one();
-	};
-
-	// Queue the futures to ensure we have correct ordering in the output thread. The promise/future return value
-	// tells us when all the streams for this request have been processed and output_ready_callback_ can be called.
-	futures_.push(promise.get_future());
-	std::thread { process_fn, std::ref(requests_.back()), std::move(promise) }.detach();
+
+		slot.drop_request = drop_request;
+		slot.state.store(Done, std::memory_order_release);
+		slot.state.notify_one();
+	}
 }
 
 void PostProcessor::outputThread()
 {
 	while (true)
 	{
-		CompletedRequestPtr request;
+		Slot &slot = slots_[next_output_.load(std::memory_order_relaxed) % num_slots_];
 
-		bool drop_request = false;
-		{
-			std::unique_lock<std::mutex> l(mutex_);
-
-			cv_.wait(l, [this] {
-				return (quit_ && futures_.empty()) ||
-					   (!futures_.empty() && futures_.front().wait_for(0s) == std::future_status::ready);
-			});
-
-			// Only quit when the futures_ queue is empty.
-			if (quit_ && futures_.empty())
-				break;
+		// Wait for the next request in sequence order. Queueing a request doesn't wake us, only
+		// a worker finishing it (or Stop) does.
+		int state;
+		while ((state = slot.state.load(std::memory_order_acquire)) == Empty || state == Queued)
+			slot.state.wait(state, std::memory_order_acquire);
 
-			drop_request = futures_.front().get();
-			futures_.pop();
-			request = std::move(requests_.front()); // reuse as it's being dropped from the queue
-			requests_.pop();
+		// Stop puts the quit marker after the last request, so everything before it has been output.
+		if (state == Quit)
+		{
+			slot.state.store(Empty, std::memory_order_relaxed);
+			break;
 		}
 
-		if (!drop_request)
+		CompletedRequestPtr request = std::move(slot.request); // reuse as it's being dropped from the ring
+		bool drop_request = slot.drop_request;
+		slot.state.store(Empty, std::memory_order_relaxed);
+		next_output_.fetch_add(1, std::memory_order_release);
+
+		if (drop_request)
+			dropped_by_stage_++;
+		else
+		{
+			output_++;
 			callback_(request); // callback can take over ownership from us
+		}
 	}
 }
 
@@ -267,13 +395,45 @@ void PostProcessor::Stop()
 		stage->Stop();
 	}
 
+	if (!output_thread_.joinable())
+		return;
+
+	// The camera has stopped, so nothing more is being submitted and the next slot is free.
+	Slot &slot = slots_[next_submit_ % num_slots_];
+	slot.state.store(Quit, std::memory_order_release);
+	slot.state.notify_one();
+
+	// Each worker finishes off any requests still queued before it finds none left and quits.
+	work_available_.release(workers_.size());
+	for (auto &worker : workers_)
+		worker.join();
+	workers_.clear();
+
+	output_thread_.join();
+
+	PostProcessorStats stats = GetStats();
+	LOG(1, "Post-processing: " << stats.submitted << " requests, " << stats.output << " output, "
+							   << stats.dropped_by_stage << " dropped by stages, " << stats.dropped_in_flight
+							   << " dropped with " << max_in_flight_ << " in flight");
+	for (auto const &stage : stats.stages)
+		LOG(1, "    " << stage.name << ": " << stage.calls << " calls, average "
+					  << (stage.calls ? stage.total_us / stage.calls : 0) << "us, max " << stage.max_us << "us");
+}
+
+PostProcessorStats PostProcessor::GetStats() const
+{
+	PostProcessorStats stats = { submitted_, output_, dropped_by_stage_, dropped_in_flight_, {} };
+
+	if (stage_timings_)
 	{
-		std::unique_lock<std::mutex> l(mutex_);
-		quit_ = true;
-		cv_.notify_one();
+		for (size_t i = 0; i < stages_.size(); i++)
+		{
+			StageTiming const &timing = stage_timings_[i];
+			stats.stages.push_back({ stages_[i]->Name(), timing.calls, timing.total_us, timing.max_us });
+		}
 	}
 
-	output_thread_.join();
+	return stats;
 }
 
 void PostProcessor::Teardown()
@@ -7,11 +7,16 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
-#include <condition_variable>
-#include <future>
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "core/completed_request.hpp"
 #include "core/logging.hpp"
@@ -47,6 +52,24 @@ private:
 	std::mutex lock_;
 };
 
+// Counters describing how the post-processing stages have been running since Start.
+struct PostProcessorStats
+{
+	struct Stage
+	{
+		std::string name;
+		uint64_t calls;
+		uint64_t total_us;
+		uint64_t max_us;
+	};
+
+	uint64_t submitted; // requests handed to the stages
+	uint64_t output; // requests passed on to the callback
+	uint64_t dropped_by_stage; // a stage asked for the request to be dropped
+	uint64_t dropped_in_flight; // the maximum number of requests were already being processed
+	std::vector<Stage> stages;
+};
+
 class PostProcessor
 {
 public:
@@ -72,19 +95,60 @@ public:
 
 	void Teardown();
 
+	PostProcessorStats GetStats() const;
+
 private:
 	PostProcessingStage *createPostProcessingStage(char const *name);
 
 	RPiCamApp *app_;
 	std::vector<StagePtr> stages_;
 	std::vector<PostProcessingLib> dynamic_stages_;
+	void workerThread();
 	void outputThread();
-
-	std::queue<CompletedRequestPtr> requests_;
-	std::queue<std::future<bool>> futures_;
+	bool claimRequest(uint64_t &sequence);
+
+	enum SlotState : int
+	{
+		Empty,
+		Queued,
+		Done,
+		Quit,
+	};
+
+	struct Slot
+	{
+		CompletedRequestPtr request;
+		bool drop_request = false;
+		std::atomic<int> state { Empty };
+	};
+
+	struct StageTiming
+	{
+		std::atomic<uint64_t> calls { 0 };
+		std::atomic<uint64_t> total_us { 0 };
+		std::atomic<uint64_t> max_us { 0 };
+	};
+
+	// Requests in flight, indexed by their sequence number modulo the ring size. Only the camera
+	// thread submits requests, the workers claim them in sequence order, and the output thread
+	// hands them on in that same order. There is one more slot than the maximum number in flight,
+	// so that Stop always has a free slot for the quit marker.
+	std::unique_ptr<Slot[]> slots_;
+	unsigned int num_slots_ = 0;
+	unsigned int max_in_flight_ = 0;
+	uint64_t next_submit_ = 0; // only used by the camera thread
+	std::atomic<uint64_t> published_ { 0 };
+	std::atomic<uint64_t> next_claim_ { 0 };
+	std::atomic<uint64_t> next_output_ { 0 };
+	std::counting_semaphore<> work_available_ { 0 };
+
+	std::vector<std::thread> workers_;
 	std::thread output_thread_;
-	bool quit_;
 	PostProcessorCallback callback_;
-	std::mutex mutex_;
-	std::condition_variable cv_;
+
+	std::unique_ptr<StageTiming[]> stage_timings_;
+	std::atomic<uint64_t> submitted_ { 0 };
+	std::atomic<uint64_t> output_ { 0 };
+	std::atomic<uint64_t> dropped_by_stage_ { 0 };
+	std::atomic<uint64_t> dropped_in_flight_ { 0 };
 };
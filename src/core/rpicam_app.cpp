@@ -25,6 +25,7 @@
 #include <libcamera/orientation.h>
 
 #include "utils/logging_tools.h"
+#include "latency_tracer.h"
 
 
 unsigned int RPiCamApp::verbosity = 1;
@@ -1145,6 +1146,8 @@ void RPiCamApp::requestComplete(Request *request)
 		return;
 	}
 
+	const int64_t request_completed_ns = golf_sim::LatencyTracer::NowNs();
+
 	struct dma_buf_sync dma_sync {};
 	dma_sync.flags = DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ;
 	for (auto const &buffer_map : request->buffers())
@@ -1176,6 +1179,13 @@ void RPiCamApp::requestComplete(Request *request)
 		payload->framerate = 1e9 / (timestamp - last_timestamp_);
 	last_timestamp_ = timestamp;
 
+	// The frame's first trigger-latency events must be recorded before any post-processing stage
+	// (such as motion detection) records its own.
+	golf_sim::LatencyTracer &latency_tracer = golf_sim::LatencyTracer::GetSharedTracer();
+	if (ts)
+		latency_tracer.Record(payload->sequence, golf_sim::LatencyTracer::Event::kSensorTimestamp, *ts);
+	latency_tracer.Record(payload->sequence, golf_sim::LatencyTracer::Event::kRequestCompleted, request_completed_ns);
+
 	post_processor_.Process(payload); // post-processor can re-use our shared_ptr
 }
 
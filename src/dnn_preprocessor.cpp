@@ -0,0 +1,230 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <algorithm>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+#include <opencv2/imgproc.hpp>
+
+#include "dnn_preprocessor.h"
+
+
+namespace golf_sim {
+
+    DnnPreprocessor::LetterboxParams DnnPreprocessor::Letterbox(const cv::Mat& image, const cv::Size& input_size, cv::Mat& letterbox_image) {
+        CV_Assert((!image.empty() && image.type() == CV_8UC3 && input_size.area() > 0));
+
+        LetterboxParams letterbox;
+        letterbox.scale = std::min(static_cast<float>(input_size.width) / image.cols,
+                                   static_cast<float>(input_size.height) / image.rows);
+
+        const int new_width = std::clamp(static_cast<int>(image.cols * letterbox.scale), 1, input_size.width);
+        const int new_height = std::clamp(static_cast<int>(image.rows * letterbox.scale), 1, input_size.height);
+
+        letterbox.x_offset = (input_size.width - new_width) / 2;
+        letterbox.y_offset = (input_size.height - new_height) / 2;
+
+        letterbox_image.create(input_size, CV_8UC3);
+
+        const cv::Rect image_area(letterbox.x_offset, letterbox.y_offset, new_width, new_height);
+
+        // Only the padding is filled, as the image area is about to be overwritten.  The
+        // buffer may be reused with other image sizes, so every bit of padding is refilled.
+        const cv::Scalar padding = cv::Scalar::all(kLetterboxPaddingValue);
+        const cv::Rect padding_areas[] = {
+            cv::Rect(0, 0, input_size.width, image_area.y),
+            cv::Rect(0, image_area.y + image_area.height, input_size.width, input_size.height - image_area.y - image_area.height),
+            cv::Rect(0, image_area.y, image_area.x, image_area.height),
+            cv::Rect(image_area.x + image_area.width, image_area.y, input_size.width - image_area.x - image_area.width, image_area.height),
+        };
+
+        for (const cv::Rect& area : padding_areas) {
+            if (area.area() > 0) {
+                letterbox_image(area).setTo(padding);
+            }
+        }
+
+        cv::Mat destination = letterbox_image(image_area);
+
+        // Input-sized images (e.g., tiles) don't need to be resized
+        if (image_area.size() == image.size()) {
+            image.copyTo(destination);
+        }
+        else {
+            cv::resize(image, destination, image_area.size(), 0, 0, cv::INTER_LINEAR);
+        }
+
+        return letterbox;
+    }
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    static inline void StoreScaled16(uint8x16_t values, float* output, float32x4_t scale) {
+        const uint16x8_t low = vmovl_u8(vget_low_u8(values));
+        const uint16x8_t high = vmovl_high_u8(values);
+
+        vst1q_f32(output, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(low))), scale));
+        vst1q_f32(output + 4, vmulq_f32(vcvtq_f32_u32(vmovl_high_u16(low)), scale));
+        vst1q_f32(output + 8, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(high))), scale));
+        vst1q_f32(output + 12, vmulq_f32(vcvtq_f32_u32(vmovl_high_u16(high)), scale));
+    }
+#elif defined(__AVX2__) || defined(__SSSE3__)
+    // pshufb masks that pick channel c of 16 interleaved pixels out of each of the three
+    // 16-byte registers that hold them.  -1 (0x80) produces a 0 byte.
+    struct DeinterleaveMasks {
+        __m128i masks[3][3];
+
+        DeinterleaveMasks() {
+            for (int c = 0; c < 3; c++) {
+                alignas(16) int8_t bytes[3][16];
+
+                for (int j = 0; j < 16; j++) {
+                    const int source = 3 * j + c;
+
+                    for (int r = 0; r < 3; r++) {
+                        bytes[r][j] = (source / 16 == r) ? (int8_t)(source % 16) : (int8_t)-1;
+                    }
+                }
+
+                for (int r = 0; r < 3; r++) {
+                    masks[c][r] = _mm_load_si128((const __m128i*)bytes[r]);
+                }
+            }
+        }
+    };
+
+    static inline void StoreScaled16(__m128i values, float* output, __m128 scale) {
+#if defined(__AVX2__)
+        const __m256 scale256 = _mm256_set_m128(scale, scale);
+        _mm256_storeu_ps(output, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(values)), scale256));
+        _mm256_storeu_ps(output + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(values, 8))), scale256));
+#else
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i low = _mm_unpacklo_epi8(values, zero);
+        const __m128i high = _mm_unpackhi_epi8(values, zero);
+
+        _mm_storeu_ps(output, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale));
+        _mm_storeu_ps(output + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale));
+        _mm_storeu_ps(output + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale));
+        _mm_storeu_ps(output + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scale));
+#endif
+    }
+#endif
+
+    void DnnPreprocessor::PackToPlanarTensor(const cv::Mat& image, float* output, double scale, bool swap_rb) {
+        CV_Assert((image.type() == CV_8UC3 && output != nullptr));
+
+        const int cols = image.cols;
+        const size_t plane_size = image.total();
+
+        // blobFromImage converts to float, and then multiplies by the scale as a float
+        const float float_scale = (float)scale;
+
+        float lookup[256];
+        for (int v = 0; v < 256; v++) {
+            lookup[v] = (float)v * float_scale;
+        }
+
+        // Where each source channel goes
+        float* const planes[3] = {
+            output + (swap_rb ? 2 : 0) * plane_size,
+            output + plane_size,
+            output + (swap_rb ? 0 : 2) * plane_size,
+        };
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        const float32x4_t scale_vector = vdupq_n_f32(float_scale);
+#elif defined(__AVX2__) || defined(__SSSE3__)
+        static const DeinterleaveMasks deinterleave;
+        const __m128 scale_vector = _mm_set1_ps(float_scale);
+#endif
+
+        for (int y = 0; y < image.rows; y++) {
+            const uchar* source = image.ptr<uchar>(y);
+            const size_t row_offset = (size_t)y * cols;
+
+            float* b = planes[0] + row_offset;
+            float* g = planes[1] + row_offset;
+            float* r = planes[2] + row_offset;
+
+            int x = 0;
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+            for (; x + 16 <= cols; x += 16) {
+                const uint8x16x3_t pixels = vld3q_u8(source + 3 * x);
+                StoreScaled16(pixels.val[0], b + x, scale_vector);
+                StoreScaled16(pixels.val[1], g + x, scale_vector);
+                StoreScaled16(pixels.val[2], r + x, scale_vector);
+            }
+#elif defined(__AVX2__) || defined(__SSSE3__)
+            for (; x + 16 <= cols; x += 16) {
+                const __m128i chunks[3] = {
+                    _mm_loadu_si128((const __m128i*)(source + 3 * x)),
+                    _mm_loadu_si128((const __m128i*)(source + 3 * x + 16)),
+                    _mm_loadu_si128((const __m128i*)(source + 3 * x + 32)),
+                };
+
+                float* destinations[3] = { b + x, g + x, r + x };
+
+                for (int c = 0; c < 3; c++) {
+                    const __m128i channel = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(chunks[0], deinterleave.masks[c][0]),
+                                                                      _mm_shuffle_epi8(chunks[1], deinterleave.masks[c][1])),
+                                                         _mm_shuffle_epi8(chunks[2], deinterleave.masks[c][2]));
+                    StoreScaled16(channel, destinations[c], scale_vector);
+                }
+            }
+#endif
+
+            for (; x < cols; x++) {
+                b[x] = lookup[source[3 * x]];
+                g[x] = lookup[source[3 * x + 1]];
+                r[x] = lookup[source[3 * x + 2]];
+            }
+        }
+    }
+
+    DnnPreprocessor::LetterboxParams DnnPreprocessor::LetterboxToTensor(const cv::Mat& image, const cv::Size& input_size,
+                                                                        cv::Mat& letterbox_image, float* output,
+                                                                        double scale, bool swap_rb) {
+        const LetterboxParams letterbox = Letterbox(image, input_size, letterbox_image);
+        PackToPlanarTensor(letterbox_image, output, scale, swap_rb);
+        return letterbox;
+    }
+
+    void DnnPreprocessor::PackToPlanarTensorReference(const cv::Mat& image, float* output, double scale, bool swap_rb) {
+        CV_Assert((image.type() == CV_8UC3 && output != nullptr));
+
+        const size_t plane_size = image.total();
+        const float float_scale = (float)scale;
+
+        for (int y = 0; y < image.rows; y++) {
+            for (int x = 0; x < image.cols; x++) {
+                const cv::Vec3b& pixel = image.at<cv::Vec3b>(y, x);
+
+                for (int c = 0; c < 3; c++) {
+                    const int plane = (swap_rb && c != 1) ? 2 - c : c;
+                    output[plane * plane_size + (size_t)y * image.cols + x] = (float)pixel[c] * float_scale;
+                }
+            }
+        }
+    }
+
+    const char* DnnPreprocessor::BackendName() {
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        return "neon";
+#elif defined(__AVX2__)
+        return "avx2";
+#elif defined(__SSSE3__)
+        return "ssse3";
+#else
+        return "scalar";
+#endif
+    }
+
+}
@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Prepares images for the YOLO ball detector, for any inference backend.
+//
+// Letterbox() resizes the image (keeping its aspect ratio) into the middle of the
+// network's input size, padding the rest with gray.  PackToPlanarTensor() then writes
+// the 8-bit, interleaved (HWC) BGR pixels as scaled floats into planar (CHW) order,
+// straight into a tensor buffer that the caller owns, e.g., an ONNX Runtime input
+// buffer or a cv::dnn blob.
+//
+// The packed values are bit-for-bit what cv::dnn::blobFromImage(image, scale, size,
+// cv::Scalar(), swap_rb, false) produces, i.e., (float)pixel * (float)scale, but without
+// its intermediate float image and per-channel split.  The packing is NEON on aarch64,
+// AVX2 or SSSE3 on x86 (if compiled for them), and a per-value lookup table otherwise.
+
+#pragma once
+
+#include <opencv2/core.hpp>
+
+
+namespace golf_sim {
+
+class DnnPreprocessor {
+public:
+
+    // The padding that the YOLO models were trained with
+    static constexpr uchar kLetterboxPaddingValue = 114;
+
+    struct LetterboxParams {
+        float scale = 1.0F;     // Scale factor applied to image
+        int x_offset = 0;       // Horizontal padding offset in pixels
+        int y_offset = 0;       // Vertical padding offset in pixels
+    };
+
+    // Resizes the CV_8UC3 image into letterbox_image (which is (re)allocated to input_size
+    // if necessary) and pads around it.  Images that are already input_size are copied.
+    static LetterboxParams Letterbox(const cv::Mat& image, const cv::Size& input_size, cv::Mat& letterbox_image);
+
+    // Writes the CV_8UC3 image into output as three planes of rows x cols floats.  output
+    // must have room for 3 * image.total() floats.  The image need not be continuous.
+    static void PackToPlanarTensor(const cv::Mat& image, float* output,
+                                   double scale = 1.0 / 255.0, bool swap_rb = false);
+
+    // Letterbox() followed by PackToPlanarTensor() of the letterbox_image
+    static LetterboxParams LetterboxToTensor(const cv::Mat& image, const cv::Size& input_size,
+                                             cv::Mat& letterbox_image, float* output,
+                                             double scale = 1.0 / 255.0, bool swap_rb = false);
+
+    // The straightforward per-value version of PackToPlanarTensor, for testing and comparison
+    static void PackToPlanarTensorReference(const cv::Mat& image, float* output,
+                                            double scale = 1.0 / 255.0, bool swap_rb = false);
+
+    static const char* BackendName();
+};
+
+}
@@ -0,0 +1,210 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <cmath>
+#include <tuple>
+
+#include <opencv2/imgproc.hpp>
+
+#include "utils/logging_tools.h"
+
+#include "gabor_filter_bank.h"
+
+
+namespace golf_sim {
+
+    // Ball images only come in a few sizes, but don't let the transformed kernels pile up
+    static const size_t kMaxCachedSpectraSizes = 16;
+
+    // Kernels that differ by no more than this (relative to their largest value) are the same
+    static const double kSameKernelTolerance = 1e-5;
+
+    bool GaborFilterBank::Parameters::operator<(const Parameters& other) const {
+        return std::tie(kernel_size, sigma, lambda, gamma, psi_degrees, theta_increment_degrees) <
+            std::tie(other.kernel_size, other.sigma, other.lambda, other.gamma, other.psi_degrees, other.theta_increment_degrees);
+    }
+
+    std::shared_ptr<const GaborFilterBank> GaborFilterBank::GetBank(const Parameters& parameters) {
+        static std::mutex banks_mutex;
+        static std::map<Parameters, std::shared_ptr<const GaborFilterBank>> banks;
+
+        std::lock_guard<std::mutex> lock(banks_mutex);
+
+        std::shared_ptr<const GaborFilterBank>& bank = banks[parameters];
+        if (bank == nullptr) {
+            bank = std::make_shared<GaborFilterBank>(parameters);
+        }
+
+        return bank;
+    }
+
+    GaborFilterBank::GaborFilterBank(const Parameters& parameters) : parameters_(parameters) {
+        CV_Assert(parameters.kernel_size % 2 == 1 && parameters.theta_increment_degrees > 0.0);
+
+        const int ks = parameters.kernel_size;
+        const double psi = parameters.psi_degrees * CV_PI / 180;
+
+        for (double theta = 0; theta <= 360.0; theta += parameters.theta_increment_degrees) {
+            cv::Mat kernel = cv::getGaborKernel(cv::Size(ks, ks), parameters.sigma, theta * CV_PI / 180,
+                                                parameters.lambda, parameters.gamma, psi, CV_32F);
+            kernels_.push_back(kernel);
+
+            const double tolerance = kSameKernelTolerance * std::max(cv::norm(kernel, cv::NORM_INF), 1e-12);
+
+            bool found = false;
+            for (DistinctKernel& distinct : distinct_kernels_) {
+                if (cv::norm(kernel, distinct.kernel, cv::NORM_INF) <= tolerance) {
+                    distinct.used_as_is = true;
+                    found = true;
+                    break;
+                }
+
+                cv::Mat negated_kernel = -kernel;
+                if (cv::norm(negated_kernel, distinct.kernel, cv::NORM_INF) <= tolerance) {
+                    distinct.used_negated = true;
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found) {
+                DistinctKernel distinct;
+                distinct.kernel = kernel;
+                distinct.used_as_is = true;
+                distinct_kernels_.push_back(distinct);
+            }
+        }
+
+        GS_LOG_TRACE_MSG(trace, "GaborFilterBank built " + std::to_string(kernels_.size()) + " kernels, of which " +
+                                std::to_string(distinct_kernels_.size()) + " are distinct.");
+    }
+
+    std::vector<cv::Mat> GaborFilterBank::GetKernelSpectra(const cv::Size& dft_size) const {
+        std::lock_guard<std::mutex> lock(spectra_mutex_);
+
+        const std::pair<int, int> key(dft_size.height, dft_size.width);
+
+        auto found = kernel_spectra_.find(key);
+        if (found != kernel_spectra_.end()) {
+            return found->second;
+        }
+
+        if (kernel_spectra_.size() >= kMaxCachedSpectraSizes) {
+            // The callers hold their own (reference-counted) copies of the spectra, so
+            // dropping them here doesn't affect anyone who is still using them
+            kernel_spectra_.erase(kernel_spectra_.begin());
+        }
+
+        std::vector<cv::Mat>& spectra = kernel_spectra_[key];
+
+        for (const DistinctKernel& distinct : distinct_kernels_) {
+            cv::Mat padded_kernel = cv::Mat::zeros(dft_size, CV_32F);
+            distinct.kernel.copyTo(padded_kernel(cv::Rect(0, 0, distinct.kernel.cols, distinct.kernel.rows)));
+
+            cv::Mat spectrum;
+            cv::dft(padded_kernel, spectrum, 0, distinct.kernel.rows);
+            spectra.push_back(spectrum);
+        }
+
+        return spectra;
+    }
+
+    cv::Mat GaborFilterBank::ComputeMaxResponse(const cv::Mat& img_f32) const {
+        CV_Assert(img_f32.type() == CV_32FC1);
+
+        const int half_kernel = parameters_.kernel_size / 2;
+
+        // Pad the same way that cv::filter2D does, so that the edges come out the same
+        cv::Mat padded_image;
+        cv::copyMakeBorder(img_f32, padded_image, half_kernel, half_kernel, half_kernel, half_kernel, cv::BORDER_REFLECT_101);
+
+        // The transform must be at least as big as the padded image, so that the part of the
+        // (circular) correlation that we keep never wraps around
+        const cv::Size dft_size(cv::getOptimalDFTSize(padded_image.cols), cv::getOptimalDFTSize(padded_image.rows));
+
+        cv::Mat dft_image = cv::Mat::zeros(dft_size, CV_32F);
+        padded_image.copyTo(dft_image(cv::Rect(0, 0, padded_image.cols, padded_image.rows)));
+
+        cv::Mat image_spectrum;
+        cv::dft(dft_image, image_spectrum, 0, padded_image.rows);
+
+        const std::vector<cv::Mat> kernel_spectra = GetKernelSpectra(dft_size);
+
+        cv::Mat accum = cv::Mat::zeros(img_f32.size(), CV_32F);
+        cv::Mat product;
+        cv::Mat correlation;
+
+        for (size_t i = 0; i < distinct_kernels_.size(); i++) {
+            // Conjugating the kernel's spectrum makes this a correlation, like cv::filter2D
+            cv::mulSpectrums(image_spectrum, kernel_spectra[i], product, 0, true);
+            cv::dft(product, correlation, cv::DFT_INVERSE | cv::DFT_SCALE | cv::DFT_REAL_OUTPUT, img_f32.rows);
+
+            cv::Mat response = correlation(cv::Rect(0, 0, img_f32.cols, img_f32.rows));
+
+            if (distinct_kernels_[i].used_as_is) {
+                cv::max(accum, response, accum);
+            }
+
+            if (distinct_kernels_[i].used_negated) {
+                cv::Mat negated_response = -response;
+                cv::max(accum, negated_response, accum);
+            }
+        }
+
+        return accum;
+    }
+
+    cv::Mat GaborFilterBank::ComputeMaxResponseDirect(const cv::Mat& img_f32) const {
+        cv::Mat dest;
+        cv::Mat accum = cv::Mat::zeros(img_f32.rows, img_f32.cols, img_f32.type());
+
+        for (const cv::Mat& kernel : kernels_) {
+            cv::filter2D(img_f32, dest, CV_32F, kernel);
+            cv::max(accum, dest, accum);
+        }
+
+        return accum;
+    }
+
+    cv::Mat GaborFilterBank::ResponseTo8U(const cv::Mat& response) {
+        cv::Mat response_8u;
+        response.convertTo(response_8u, CV_8U, 255, 0);
+        return response_8u;
+    }
+
+    GaborFilterBank::Histogram GaborFilterBank::ComputeHistogram(const cv::Mat& response_8u) {
+        CV_Assert(response_8u.type() == CV_8UC1);
+
+        Histogram histogram{};
+
+        for (int y = 0; y < response_8u.rows; y++) {
+            const uchar* row = response_8u.ptr<uchar>(y);
+            for (int x = 0; x < response_8u.cols; x++) {
+                histogram[row[x]]++;
+            }
+        }
+
+        return histogram;
+    }
+
+    int GaborFilterBank::WhitePercent(const Histogram& histogram, int threshold) {
+        long total = 0;
+        long above_threshold = 0;
+
+        for (int value = 0; value < (int)histogram.size(); value++) {
+            total += histogram[value];
+            if (value > threshold) {
+                above_threshold += histogram[value];
+            }
+        }
+
+        if (total == 0) {
+            return 0;
+        }
+
+        return (int)std::round(((double)above_threshold * 100.) / (double)total);
+    }
+
+}
@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Bank of Gabor kernels at evenly-spaced orientations, used to bring out the dimples
+// of the ball for spin analysis.
+//
+// The response of the bank is the per-pixel maximum of the responses at all of the
+// orientations.  Compared to filtering with each kernel in turn, this:
+//
+//  - builds the kernels once for each set of parameters, instead of for every image
+//  - filters with each distinct kernel only once.  A kernel at theta + 180 degrees is the
+//    kernel at theta turned around, which (for the usual odd or even psi) is the same
+//    kernel, or the same kernel negated.  A negated kernel's response is just the negated
+//    response, so 33 orientations need only 16 filter passes.
+//  - transforms the image into the frequency domain once, and keeps the transformed
+//    kernels for each transform size, so each orientation costs one spectrum multiply and
+//    one inverse transform.  A rotated Gabor kernel is not separable, and at 21x21 a
+//    direct filter is far slower than this.
+//
+// The response only has to be computed once per ball image.  After that, the white
+// percentage at any binary threshold comes straight from the response's histogram.
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+
+namespace golf_sim {
+
+class GaborFilterBank {
+public:
+
+    struct Parameters {
+        int kernel_size = 21;               // Must be odd
+        double sigma = 1.0;
+        double lambda = 6.0;
+        double gamma = 0.2;
+        double psi_degrees = 270.0;
+        double theta_increment_degrees = 11.25;   // From 0 to 360 degrees, inclusive
+
+        bool operator<(const Parameters& other) const;
+    };
+
+    // 8-bit response value histogram
+    typedef std::array<int, 256> Histogram;
+
+    // Returns the (shared) bank for the parameters, building it the first time
+    static std::shared_ptr<const GaborFilterBank> GetBank(const Parameters& parameters);
+
+    explicit GaborFilterBank(const Parameters& parameters);
+
+    // Per-pixel maximum of 0 and of the filter responses at all orientations.
+    // img_f32 must be CV_32FC1.
+    cv::Mat ComputeMaxResponse(const cv::Mat& img_f32) const;
+
+    // The same result as ComputeMaxResponse, but by filtering with every kernel in turn
+    // (the way that this used to be done).  For testing.
+    cv::Mat ComputeMaxResponseDirect(const cv::Mat& img_f32) const;
+
+    // Number of orientations, and the number of them that needed their own filter pass
+    size_t orientation_count() const { return kernels_.size(); }
+    size_t distinct_kernel_count() const { return distinct_kernels_.size(); }
+
+    // Converts a response from the 0.0 to 1.0 range to 0-255
+    static cv::Mat ResponseTo8U(const cv::Mat& response);
+
+    static Histogram ComputeHistogram(const cv::Mat& response_8u);
+
+    // The percentage (rounded) of pixels that are above the threshold, i.e., that would be
+    // white after cv::threshold(response_8u, ..., threshold, 255, cv::THRESH_BINARY)
+    static int WhitePercent(const Histogram& histogram, int threshold);
+
+    const Parameters& parameters() const { return parameters_; }
+
+private:
+
+    struct DistinctKernel {
+        cv::Mat kernel;
+        bool used_as_is = false;
+        bool used_negated = false;
+    };
+
+    // The distinct kernels, transformed for a padded image of the given size
+    std::vector<cv::Mat> GetKernelSpectra(const cv::Size& dft_size) const;
+
+    Parameters parameters_;
+
+    // One per orientation
+    std::vector<cv::Mat> kernels_;
+
+    std::vector<DistinctKernel> distinct_kernels_;
+
+    mutable std::mutex spectra_mutex_;
+    // Keyed by (rows, cols) of the transform
+    mutable std::map<std::pair<int, int>, std::vector<cv::Mat>> kernel_spectra_;
+};
+
+}
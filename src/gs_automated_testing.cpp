@@ -22,6 +22,7 @@
 
 #include "gs_config.h"
 #include "pulse_strobe.h"
+#include "undistort_map_cache.h"
 
 #include "gs_automated_testing.h"
 
@@ -425,16 +426,8 @@ cv::Mat GsAutomatedTesting::UndistortImage(const cv::Mat& img, CameraHardware::C
     c.camera_hardware_.resolution_x_override_ = img.cols;
     c.camera_hardware_.resolution_y_override_ = img.rows;
     c.camera_hardware_.init_camera_parameters(GsCameraNumber::kGsCamera1, camera_model, lens_type, camera_orientation);
-    cv::Mat cameracalibrationMatrix_ = c.camera_hardware_.calibrationMatrix_;
-    cv::Mat cameraDistortionVector_ = c.camera_hardware_.cameraDistortionVector_;
 
-    cv::Mat unDistortedBall1Img;
-    cv::Mat m_undistMap1, m_undistMap2;
-    // TBD - is the size rows, cols?  or cols, rows?
-    cv::initUndistortRectifyMap(cameracalibrationMatrix_, cameraDistortionVector_, cv::Mat(), cameracalibrationMatrix_, cv::Size(img.cols, img.rows), CV_32FC1, m_undistMap1, m_undistMap2);
-    cv::remap(img, unDistortedBall1Img, m_undistMap1, m_undistMap2, cv::INTER_LINEAR);
-
-    return unDistortedBall1Img;
+    return UndistortMapCache::GetSharedCache().Undistort(img, c.camera_hardware_);
 }
 
 
@@ -7,6 +7,8 @@
 #include <bitset>
 
 #include "gs_options.h"
+#include "utils/artifact_writer.h"
+#include "utils/ball_color_statistics.h"
 #include "ball_image_proc.h"
 #include "pulse_strobe.h"
 #include "gs_ui_system.h"
@@ -17,6 +19,8 @@
 
 #include "gs_camera.h"
 #include "gs_web_api.h"
+#include "strobed_ball_corridor.h"
+#include "strobe_pattern_matcher.h"
 
 
 namespace golf_sim {
@@ -88,6 +92,14 @@ namespace golf_sim {
     double GolfSimCamera::kMinPuttingQualityExposureLaunchAngle = -10.0;
     int GolfSimCamera::kNumberAngleCheckExposures = 3;
 
+    bool GolfSimCamera::kUseStrobedBallCorridor = true;
+    double GolfSimCamera::kStrobedBallCorridorMaxDistanceMeters = 1.0;
+    double GolfSimCamera::kStrobedBallCorridorMinLaunchAngle = -5.0;
+    double GolfSimCamera::kStrobedBallCorridorMaxLaunchAngle = 55.0;
+    double GolfSimCamera::kStrobedBallCorridorMaxSideAngle = 25.0;
+    double GolfSimCamera::kStrobedBallCorridorMarginBallRadii = 1.5;
+    double GolfSimCamera::kStrobedBallCorridorMaxAreaFraction = 0.8;
+
     double GolfSimCamera::kStandardBallSpeedSlowdownPercentage = 0.5;
     double GolfSimCamera::kPracticeBallSpeedSlowdownPercentage = 2.0;
     double GolfSimCamera::kPuttingBallSpeedSlowdownPercentage = 5.0;
@@ -136,6 +148,11 @@ namespace golf_sim {
         GolfSimConfiguration::SetConstant("gs_config.logging.kLogIntermediateExposureImagesToFile", kLogIntermediateExposureImagesToFile);
         GolfSimConfiguration::SetConstant("gs_config.logging.kLogWebserverImagesToFile", kLogWebserverImagesToFile);
         GolfSimConfiguration::SetConstant("gs_config.logging.kLogDiagnosticImagesToUniqueFiles", kLogDiagnosticImagesToUniqueFiles);
+        GolfSimConfiguration::SetConstant("gs_config.logging.kUseAsyncArtifactWriter", ArtifactWriter::kUseAsyncArtifactWriter);
+        GolfSimConfiguration::SetConstant("gs_config.logging.kArtifactWriterMaxPendingDiagnosticImages", ArtifactWriter::kMaxPendingDiagnosticImages);
+        GolfSimConfiguration::SetConstant("gs_config.logging.kArtifactWriterMaxPendingWebserverImages", ArtifactWriter::kMaxPendingWebserverImages);
+        GolfSimConfiguration::SetConstant("gs_config.logging.kArtifactWriterPngCompressionLevel", ArtifactWriter::kPngCompressionLevel);
+        GolfSimConfiguration::SetConstant("gs_config.logging.kArtifactWriterDiagnosticImageFormat", ArtifactWriter::kDiagnosticImageFormat);
 
 
         GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kMaximumOffTrajectoryDistance", kMaximumOffTrajectoryDistance);
@@ -206,6 +223,14 @@ namespace golf_sim {
         GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kMinPuttingQualityExposureLaunchAngle", kMinPuttingQualityExposureLaunchAngle);
         GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kNumberAngleCheckExposures", kNumberAngleCheckExposures);
 
+        GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kUseStrobedBallCorridor", kUseStrobedBallCorridor);
+        GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kStrobedBallCorridorMaxDistanceMeters", kStrobedBallCorridorMaxDistanceMeters);
+        GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kStrobedBallCorridorMinLaunchAngle", kStrobedBallCorridorMinLaunchAngle);
+        GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kStrobedBallCorridorMaxLaunchAngle", kStrobedBallCorridorMaxLaunchAngle);
+        GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kStrobedBallCorridorMaxSideAngle", kStrobedBallCorridorMaxSideAngle);
+        GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kStrobedBallCorridorMarginBallRadii", kStrobedBallCorridorMarginBallRadii);
+        GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kStrobedBallCorridorMaxAreaFraction", kStrobedBallCorridorMaxAreaFraction);
+
         GolfSimConfiguration::SetConstant("gs_config.ball_exposure_selection.kUsePreImageSubtraction", kUsePreImageSubtraction);
 
         GolfSimConfiguration::SetConstant("gs_config.testing.kExternallyStrobedEnvFilterImage", kExternallyStrobedEnvFilterImage);
@@ -1207,6 +1232,46 @@ namespace golf_sim {
             return true;
         }
 
+        bool GolfSimCamera::ProjectXyzOrthoCamPerspectiveToPixel(const GolfSimCamera& camera, const cv::Vec3d& distances, cv::Point2d& pixel) {
+
+            // Undo the conversion into the launch monitor's axes at the end of ComputeXyzDistanceFromOrthoCamPerspective
+            double cartesian_x = distances[2];
+            double cartesian_y = -distances[0];
+            double cartesian_z = -distances[1];
+
+            double p_rho = CvUtils::GetDistance(distances);
+
+            if (p_rho <= 0.0001 || camera.camera_hardware_.focal_length_ <= 0.0 ||
+                camera.camera_hardware_.sensor_width_ <= 0.0 || camera.camera_hardware_.sensor_height_ <= 0.0) {
+                return false;
+            }
+
+            // Back to the spherical coordinates, and from there to the angles from the camera's perspective
+            double theta_degrees = CvUtils::RadiansToDegrees(atan2(cartesian_y, cartesian_x));
+            double phi_degrees = CvUtils::RadiansToDegrees(acos(std::clamp(cartesian_z / p_rho, -1.0, 1.0)));
+
+            cv::Vec2d deltaAnglesCameraPerspective;
+            deltaAnglesCameraPerspective[0] = theta_degrees - camera.camera_hardware_.camera_angles_[0];
+            deltaAnglesCameraPerspective[1] = (phi_degrees - 90.) - camera.camera_hardware_.camera_angles_[1];
+
+            // Behind (or beside) the camera
+            if (std::abs(deltaAnglesCameraPerspective[0]) >= 89.9 || std::abs(deltaAnglesCameraPerspective[1]) >= 89.9) {
+                return false;
+            }
+
+            // The camera-perspective distances are relative to a z distance of p_rho, so the distance cancels out
+            // in the x and y pixel offsets.  See convertXDistanceToMeters and convertYDistanceToMeters.
+            double xFromCameraCenter = -tan(CvUtils::DegreesToRadians(deltaAnglesCameraPerspective[0])) *
+                (camera.camera_hardware_.focal_length_ / (camera.camera_hardware_.sensor_width_ / 2.0)) * (camera.camera_hardware_.resolution_x_ / 2.0);
+            double yFromCameraCenter = -tan(CvUtils::DegreesToRadians(deltaAnglesCameraPerspective[1])) *
+                (camera.camera_hardware_.focal_length_ / (camera.camera_hardware_.sensor_height_ / 2.0)) * (camera.camera_hardware_.resolution_y_ / 2.0);
+
+            pixel.x = xFromCameraCenter + std::round(camera.camera_hardware_.resolution_x_ / 2.0);
+            pixel.y = yFromCameraCenter + std::round(camera.camera_hardware_.resolution_y_ / 2.0);
+
+            return true;
+        }
+
         // The delta angles are the angles between the two balls, in either the camera's position,
         // or, alternatively, the ball's position (i.e., looking down-range)
         bool GolfSimCamera::getXYDeltaAnglesBallPerspective(const cv::Vec3d& position_deltas_ball_perspective,
@@ -2019,8 +2084,15 @@ namespace golf_sim {
                 return;
             }
 
+            // The integral images only need to cover the balls being compared
+            std::vector<GsCircle> circles{ expected_best_ball.ball_circle_ };
+            for (const GolfBall& ball : initial_balls) {
+                circles.push_back(ball.ball_circle_);
+            }
+            const BallColorStatistics color_statistics(rgbImg, circles);
+
             // Get the color and std of the ball that is the most likely to be a real ball
-            std::vector<GsColorTriplet> statistics = CvUtils::GetBallColorRgb(rgbImg, expected_best_ball.ball_circle_);
+            std::vector<GsColorTriplet> statistics = color_statistics.GetBallColorRgb(expected_best_ball.ball_circle_);
             GsColorTriplet expectedBallRGBAverage{ statistics[0] };
             GsColorTriplet expectedBallRGBMedian{ statistics[1] };
             GsColorTriplet expectedBallRGBStd{ statistics[2] };
@@ -2037,7 +2109,7 @@ namespace golf_sim {
                     continue;
                 }
 
-                std::vector<GsColorTriplet> statistics = CvUtils::GetBallColorRgb(rgbImg, b.ball_circle_);
+                std::vector<GsColorTriplet> statistics = color_statistics.GetBallColorRgb(b.ball_circle_);
                 GsColorTriplet avg_RGB{ statistics[0] };
                 GsColorTriplet median_RGB{ statistics[1] };
                 GsColorTriplet std_RGB{ statistics[2] };
@@ -2073,7 +2145,8 @@ namespace golf_sim {
                 double std_difference_component = 0.;
                 std::string brightness = "darker";
 
-                if (CvUtils::IsDarker(avg_RGB, expectedBallRGBMedian)) {
+                // The thresholds were tuned when the median was just the average, so keep comparing to that
+                if (CvUtils::IsDarker(avg_RGB, expectedBallRGBAverage)) {
                     brightness = "darker";
                     rgb_difference_component = (double)(kColorDifferenceRgbPostMultiplierForDarker * pow(1.0 * rgb_avg_diff, 2.));
                     std_difference_component = (double)(kColorDifferenceStdPostMultiplierForDarker * pow(2.3 * rgb_std_diff, 2.));
@@ -2148,6 +2221,96 @@ namespace golf_sim {
             GS_LOG_MSG(error, root_cause_str);
         }
 
+        // Searches for the strobed balls in just the part of the (camera 2) image that a ball hit from the
+        // teed-up position could fly through.  Most of the image, and most of the things in it that look
+        // like balls, are never processed.  Returns false if the corridor could not be used or fewer than
+        // two balls were found in it, in which case the whole image should be searched instead.
+        static bool GetStrobedBallsInCorridor(const GolfSimCamera& camera,
+                                              const cv::Mat& strobed_balls_color_image,
+                                              const GolfBall& search_ball,
+                                              const GolfBall& calibrated_ball,
+                                              double expected_ball_radius,
+                                              BallImageProc::BallSearchMode processing_mode,
+                                              std::vector<GolfBall>& balls) {
+            balls.clear();
+
+            StrobedBallCorridor::Settings settings;
+            settings.max_distance_meters = GolfSimCamera::kStrobedBallCorridorMaxDistanceMeters;
+            settings.min_launch_angle_degrees = GolfSimCamera::kStrobedBallCorridorMinLaunchAngle;
+            settings.max_launch_angle_degrees = GolfSimCamera::kStrobedBallCorridorMaxLaunchAngle;
+            settings.max_side_angle_degrees = GolfSimCamera::kStrobedBallCorridorMaxSideAngle;
+            settings.margin_pixels = GolfSimCamera::kStrobedBallCorridorMarginBallRadii * expected_ball_radius;
+            settings.max_area_fraction = GolfSimCamera::kStrobedBallCorridorMaxAreaFraction;
+
+            // Where the teed-up ball is relative to camera 2
+            const cv::Vec3d ball_position = calibrated_ball.distances_ortho_camera_perspective_ - GolfSimCamera::kCamera2OffsetFromCamera1OriginMeters;
+
+            // The handedness is from the last shot, which is usually right.  If it isn't, the
+            // balls won't be in the corridor, and the whole image will get searched.
+            const int downrange_direction = (GolfSimOptions::GetCommandLineOptions().golfer_orientation_ == GolferOrientation::kLeftHanded) ? -1 : 1;
+
+            auto projector = [&camera](const cv::Vec3d& position, cv::Point2d& pixel) {
+                return GolfSimCamera::ProjectXyzOrthoCamPerspectiveToPixel(camera, position, pixel);
+            };
+
+            StrobedBallCorridor corridor;
+
+            if (!corridor.Build(ball_position, downrange_direction, projector, strobed_balls_color_image.size(), settings)) {
+                GS_LOG_TRACE_MSG(trace, "GetStrobedBallsInCorridor - the corridor could not be used.");
+                return false;
+            }
+
+            const cv::Rect& corridor_rect = corridor.bounding_rect();
+            const cv::Point2f corridor_offset((float)corridor_rect.x, (float)corridor_rect.y);
+
+            // Everything GetBall does (blurring, pre-processing, artifact removal, and the circle search
+            // itself) now only happens within the corridor
+            cv::Mat corridor_image = strobed_balls_color_image(corridor_rect).clone();
+
+            BallImageProc* ip = BallImageProc::get_ball_image_processor();
+
+            cv::Rect roi;
+            std::vector<GolfBall> corridor_balls;
+            bool useLargestFoundBall = false;
+            bool reportErrors = false;
+
+            if (!ip->GetBall(corridor_image, search_ball, corridor_balls, roi, processing_mode, useLargestFoundBall, reportErrors)) {
+                GS_LOG_TRACE_MSG(trace, "GetStrobedBallsInCorridor - GetBall found no balls in the corridor.");
+                return false;
+            }
+
+            // Move the balls back into the coordinates of the whole image, and drop any that were in the
+            // corners of the corridor's bounding box, but not in the corridor itself.
+            // The balls are still in the order of quality that GetBall put them in.
+            for (GolfBall& ball : corridor_balls) {
+                GsCircle circle = ball.ball_circle_;
+                circle[0] += corridor_offset.x;
+                circle[1] += corridor_offset.y;
+
+                if (!corridor.Contains(cv::Point2f(circle[0], circle[1]))) {
+                    continue;
+                }
+
+                ball.set_circle(circle);
+
+                if (ball.ball_ellipse_.size.width > 0 && ball.ball_ellipse_.size.height > 0) {
+                    ball.ball_ellipse_.center += corridor_offset;
+                }
+
+                balls.push_back(ball);
+            }
+
+            GS_LOG_TRACE_MSG(trace, "GetStrobedBallsInCorridor - found " + std::to_string(balls.size()) + " balls in the corridor (of " +
+                                    std::to_string(corridor_balls.size()) + " in its bounding box).");
+
+            if (balls.size() < 2) {
+                balls.clear();
+                return false;
+            }
+
+            return true;
+        }
+
         bool GolfSimCamera::AnalyzeStrobedBalls( const cv::Mat& strobed_balls_color_image,
                                                  const cv::Mat& strobed_balls_gray_image,
                                                  const GolfBall& calibrated_ball,
@@ -2235,7 +2398,18 @@ namespace golf_sim {
             GolfBall non_const_ball = calibrated_ball;
             non_const_ball.average_color_ = GsColorTriplet(0, 0, 0);
 
-            bool result = ip->GetBall(strobed_balls_color_image, non_const_ball, initial_balls, roi, processing_mode, useLargestFoundBall, dontReportErrors);
+            bool result = false;
+
+            if (kUseStrobedBallCorridor && processing_mode != BallImageProc::BallSearchMode::kPutting) {
+                result = GetStrobedBallsInCorridor(*this, strobed_balls_color_image, non_const_ball, calibrated_ball,
+                                                   expected_strobed_ball_radius, processing_mode, initial_balls);
+            }
+
+            if (!result) {
+                // Either the corridor wasn't used, or the balls weren't in it.  Search the whole image.
+                initial_balls.clear();
+                result = ip->GetBall(strobed_balls_color_image, non_const_ball, initial_balls, roi, processing_mode, useLargestFoundBall, dontReportErrors);
+            }
 
             int number_of_initial_balls = (int)initial_balls.size();
 
@@ -2667,121 +2841,6 @@ namespace golf_sim {
         }
 
 
-        int GolfSimCamera::FindClosestRatioPatternMatchOffset(const std::vector<double> distance_ratios,
-                                                              const std::vector<double> pulse_ratios,
-                                                              double& delta_to_closest_ratio,
-                                                              bool try_different_offsets) {
-
-            // The current offset within the pulse interval ratios at which the pattern
-            // of distance ratios is most closely correlated.
-            delta_to_closest_ratio = 99999.0;
-            int closest_timing_interval_offset = -1;
-
-            if (pulse_ratios.size() < distance_ratios.size()) {
-                return -1;
-            }
-
-            for (int distance_pattern_offset = 0; distance_pattern_offset < (int)(pulse_ratios.size() - distance_ratios.size()); distance_pattern_offset++) {
-
-                double difference_in_ratios = ComputeRatioDistance(distance_ratios, pulse_ratios, distance_pattern_offset);
-
-                GS_LOG_TRACE_MSG(trace, "difference_in_ratios for offset " + std::to_string(distance_pattern_offset) + " is: " + std::to_string(difference_in_ratios));
-
-                // If the current offset of the distance ratios within the pulse ratio pattern
-                // results in the lowest error (distance), then assume it's the best for now.
-                if (difference_in_ratios < delta_to_closest_ratio) {
-
-                    // This is the smallest difference we've seen so far, so keep it!
-                    // Also, figure out if the interval is to the left or to the right of the 
-                    // middle ball (depending on which ball we chose as ball 2).
-                    delta_to_closest_ratio = difference_in_ratios;
-                    closest_timing_interval_offset = distance_pattern_offset;
-
-                }
-
-                // If we are, for example, enumerating all possible strobe vector patterns,
-                // we will only be interested in a match without any offset.
-                if (!try_different_offsets) {
-                    break;
-                }
-            }
-
-            return closest_timing_interval_offset;
-        }
-
-
-        // Returns a score of the closeness of the vector of distance_ratios within the pulse_ratios at an offset
-        // of the distance_ratios from the beginning of the pulse_ratios
-        double GolfSimCamera::ComputeRatioDistance(const std::vector<double> distance_ratios,
-            const std::vector<double> pulse_ratios,
-            int& distance_pattern_offset) {
-
-            // TBD - Do some error checking on the inputs
-
-            double kMaxRatioDistance = 1000.0;
-
-            double difference_in_ratios = 0;
-
-            // Compute the differences between each distance ratio in the pattern of distances as compared
-            // to each possible offset of those ratios to the pulse interval ratios.
-            for (size_t distance_ratio_index = 0; distance_ratio_index < distance_ratios.size(); distance_ratio_index++) {
-
-                // If we got more ball distance ratios than we have collapsed (and thus down-sized) pulse
-                // ratios, then just stop and return a big error number to drop this comparison from the
-                // best-of list.
-
-                if ((distance_ratio_index + distance_pattern_offset) >= pulse_ratios.size()) {
-                    LoggingTools::Warning("GolfSimCamera::ComputeRatioDistance received a distance_ratio_index higher than the number of pulse ratios.");
-                    return kMaxRatioDistance;
-                }
-                // Compute the difference as a percent of the distance ratio so that each element
-                // of the pattern of ratios can contribute a meaningful amount of error/difference
-                // even if the distance is small.
-                double distance_ratio = distance_ratios[distance_ratio_index];
-                double pulse_ratio = pulse_ratios[distance_ratio_index + distance_pattern_offset];
-
-                // Get a difference that is >= 0 so that squaring it will not decrease the number
-                // double single_ratio_difference = 100. * std::abs(distance_ratio - pulse_ratio) / std::min(distance_ratio, pulse_ratio);
-                double single_ratio_difference = 100. * std::abs(distance_ratio - pulse_ratio);
-
-
-                // If we get a crazy number, cap it so that we don't go out of bounds of our variable
-                if (single_ratio_difference > kMaxRatioDistance) {
-                    GS_LOG_TRACE_MSG(trace, "single_ratio_difference > kMaxRatioDistance!");
-                    single_ratio_difference = kMaxRatioDistance;
-                }
-
-                // Square to highlight/emphasize larger errors
-                single_ratio_difference = pow(single_ratio_difference, 2);
-                // Removed excessive per-element logging
-
-                difference_in_ratios += single_ratio_difference;
-            }
-
-            return difference_in_ratios;
-        }
-
-        // Set the element of the vector to true when there is a 1 bit (a flag to remove the corresponding strobe pulse) in the vector
-        void GolfSimCamera::SetPulseVector(int bit_value, std::vector<bool>& combinations_vector) {
-
-            int vector_size = (int)combinations_vector.size();
-
-            if (vector_size > 512) {
-                GS_LOG_TRACE_MSG(error, "GolfSimCamera::SetPulseVector - vector was too long."); 
-                return;
-            }
-
-            // Create a bitset value that we can more easily work with
-            std::bitset<512> bit_array(bit_value);
-
-            // The bitset is indexed (visually) right to left, but we will setup the 
-            // boolean vector to go from left to right
-            for (auto i = 0; i < vector_size; ++i) {
-                combinations_vector[vector_size - i - 1] = (bit_array[i] == 1);
-            }
-
-        }
-
         void GolfSimCamera::PrintPulseVector(const std::vector<bool> &combinations_vector) {
             std::string v;
 
@@ -2792,16 +2851,6 @@ namespace golf_sim {
             GS_LOG_TRACE_MSG(trace, "Combinations_vector: " + v);
         }
 
-        // Count the number of bits that are true
-        int GolfSimCamera::CountSetBits(int n) {
-            int count = 0;
-            while (n > 0) {
-                n &= (n - 1); // Brian Kernighan's algorithm
-                count++;
-            }
-            return count;
-        }
-
         // Determine the ratios of the exposure distances and compare to the
         // ratios of the strobe pulses to find a correlation.  
         // The best correlation will determine the 
@@ -2870,18 +2919,10 @@ namespace golf_sim {
                 // pattern.  The distance ratios will always be <= the number of pulse intervals, due to the
                 // possibility of losing some highly-overlapped images early in the pattern.
 
-                // There shouldn't be too many missed pulses, but they could occur anywhere, so make sure
-                // that we consider possible collapsed pulses all the way to the end
-
-                std::vector<float>best_pulse_intervals;
-                double best_ratio_distance = 999999.;
-                int best_final_offset_of_distance_ratios = -1;
-                int best_pulses_to_collapse = -1;
-                int best_collapse_offset = -1;
-
-                // We will now generate all combinations of fitting the <x> 'missing' balls into the <y> possible
-                // positions that exist in the pulse vector.  We had originally been assuming there would just be one 
-                // contiguous group of missing balls, but that turned out not to be true.  So, now go through all combinations
+                // Some of the strobed exposures may not have been found (e.g., if they overlapped), and
+                // they could be missing anywhere in the pulse vector.  The matcher considers every way of
+                // collapsing the 'missing' pulses into the intervals before them, and finds the collapsed
+                // intervals (and the offset into them) whose ratios best match the distance ratios.
 
                 int number_ball_exposures = (int)input_balls.size();
                 int number_of_strobes = (int)test_pulse_intervals.size();
@@ -2893,112 +2934,23 @@ namespace golf_sim {
 
                 // There might be 0 missing exposures, in which case, we won't have to do any
                 // interval collapsing
-                int number_of_missing_exposures = number_of_strobes - number_ball_exposures;
-
-                std::vector<bool> combinations_vector;
-                std::vector<std::vector<bool>> candidate_intervals_to_collapse_patterns_vector;
-
-                // Start with an all-false vector
-                // The - 1 is because there are 1 fewer intervals than strobes
-                for (int i = 0 ; i < (int)number_of_strobes - 1; i++) {
-                    combinations_vector.push_back(false);
-                }
-
-                // Because we're unlikely to have more than 8 or so possible strobes, we will just use a 
-                // brute-force method to figure out all combinations of exposures in the strobe vector.  
-                // This code iterates though all possible numbers of an n-bit number and whenever the number
-                // has the correct number of bits, we use that pattern as a possible candidate for how the
-                // exposures correllate to the strobes.
-
                 int number_missed_exposures = number_of_strobes - number_ball_exposures;
 
-                for (int i = 0; i < (1 << number_of_strobes) - 1; ++i) {
-                    if (CountSetBits(i) == number_missed_exposures) {
-
-                        SetPulseVector(i, combinations_vector);
-
-                        candidate_intervals_to_collapse_patterns_vector.push_back(combinations_vector);
-                        // Too detailed to keep in production system - PrintPulseVector(combinations_vector);
-                    }
-                }
-
-                // Each  of the resulting candidate vectors will contain a 'true'
-                int best_intervals_pattern_index = -1;
-
-                for (int i = 0; i < (int)candidate_intervals_to_collapse_patterns_vector.size(); i++) {
+                std::shared_ptr<const StrobePatternMatcher> matcher = StrobePatternMatcher::ForPulseIntervals(pulse_intervals_from_strobe);
 
-                    std::vector<bool> intervals_to_collapse_vector = candidate_intervals_to_collapse_patterns_vector[i];
+                StrobePatternMatcher::Match best_match;
 
-                    PrintPulseVector(intervals_to_collapse_vector);
-
-                    // Just a breakpoint trigger for debugging
-                    /** /
-                    if (intervals_to_collapse_vector[0] == true &&
-                        intervals_to_collapse_vector[1] == true &&
-                        intervals_to_collapse_vector[2] == true &&
-                        intervals_to_collapse_vector[3] == false &&
-                        intervals_to_collapse_vector[4] == false &&
-                        intervals_to_collapse_vector[5] == false) {
-                        GS_LOG_TRACE_MSG(trace, "----------> - Reached the vector of interest.");
-                    }
-                    **/
-
-                    // Formulate a new set of pulses that correspond to the exposures that we found
-                    // with the pulses corresponding to the 'missing' exposures collapsed/removed.
-
-                    std::vector<double>pulse_ratios;
-                    std::vector<float>pulse_intervals;
-                    std::vector<float> current_pulse_intervals_ms = PulseStrobe::GetPulseIntervals();
-
-
-                    if (!GetPulseIntervalsAndRatiosFromIntervalVector(intervals_to_collapse_vector, current_pulse_intervals_ms, pulse_intervals, pulse_ratios)) {
-                        GS_LOG_TRACE_MSG(error, "Failed to GetPulseIntervalsAndRatiosFromIntervalVector");
-                        return false;
-                    }
-
-
-                    // Too chatty- LoggingTools::Trace("The (potentially collapsed) pulse_intervals were (ignore last '0' interval): ", pulse_intervals);
-                    // LoggingTools::Trace("The (potentially collapsed) pulse_ratios were : ", pulse_ratios);
-
-
-                    double delta_to_closest_ratio;
-
-                    int best_local_offset_of_distance_ratios = FindClosestRatioPatternMatchOffset(distance_ratios, pulse_ratios, delta_to_closest_ratio, true /* Try any offset */);
-
-                    // If this is the closest match seen so far, save the information
-                    if (best_local_offset_of_distance_ratios >= 0 && delta_to_closest_ratio <= best_ratio_distance) {
-
-                        best_ratio_distance = delta_to_closest_ratio;
-                        best_final_offset_of_distance_ratios = best_local_offset_of_distance_ratios;
-                        best_intervals_pattern_index = i;
-
-                        GS_LOG_TRACE_MSG(trace, "------------> Found best (so far) pulse ratio pattern match.  best_ratio_distance= " + std::to_string(best_ratio_distance)
-                            + " best_final_offset_of_distance_ratios= " + std::to_string(best_ratio_distance)
-                            + " best_intervals_pattern_index= " + std::to_string(best_intervals_pattern_index) + ".  Vector was : ");
-                        PrintPulseVector(candidate_intervals_to_collapse_patterns_vector[best_intervals_pattern_index]);
-                    }
+                if (!matcher->FindBestMatch(distance_ratios, number_missed_exposures, best_match)) {
+                    LoggingTools::Warning("DetermineStrobeIntervals could not match the ball distance ratios to the strobe pulse ratios.");
+                    return false;
                 }
 
-                GS_LOG_TRACE_MSG(trace, "------------> Best-fitting pulse vector was number: " + std::to_string(best_intervals_pattern_index) + ".  With score of: " + 
-                            std::to_string(best_ratio_distance) + ".  Vector was : ");
-                PrintPulseVector(candidate_intervals_to_collapse_patterns_vector[best_intervals_pattern_index]);
-
-
-
-                // If we found a best correllation, re-create the corresponding set of ratios and intervals
-                std::vector<double>pulse_ratios;
-                std::vector<float>pulse_intervals;
-
-                // We will retrieve the actual pulse interval (in uS) from the list of such intervals.
-                // Just need to figure out WHICH interval corresponds to the two balls of interest.
-                if (!GetPulseIntervalsAndRatiosFromIntervalVector(candidate_intervals_to_collapse_patterns_vector[best_intervals_pattern_index],
-                                                                    PulseStrobe::GetPulseIntervals(), 
-                                                                    pulse_intervals, 
-                                                                    pulse_ratios)) {
-                        GS_LOG_TRACE_MSG(error, "Failed to GetPulseIntervalsAndRatiosFromIntervalVector");
-                        return false;
-                }
+                int best_final_offset_of_distance_ratios = best_match.ratio_offset;
+                std::vector<float>& pulse_intervals = best_match.pulse_intervals_ms;
 
+                GS_LOG_TRACE_MSG(trace, "------------> Best-fitting pulse vector had a score of: " + std::to_string(best_match.score) +
+                                        " at offset " + std::to_string(best_final_offset_of_distance_ratios) + ".  Vector was : ");
+                PrintPulseVector(best_match.intervals_to_collapse);
 
                 LoggingTools::Trace( "The best set of pulse_intervals was (ignore last '0' interval): ", pulse_intervals);
 
@@ -3156,37 +3108,6 @@ namespace golf_sim {
 
 
 
-        bool GolfSimCamera::GetPulseIntervalsAndRatiosFromIntervalVector(   const std::vector<bool>& intervals_to_collapse_vector,
-                                                                            const std::vector<float>& initial_pulse_intervals_ms,
-                                                                            std::vector<float>& pulse_intervals,
-                                                                            std::vector<double>& pulse_ratios) {
-
-            std::vector<float> current_pulse_intervals_ms = PulseStrobe::GetPulseIntervals();
-
-            int number_collapsed_intervals_so_far = 0;
-
-            // Build the pulse interval list to match the (typically shorter) vector
-            // We collapse from the left-most of two pairs of intervals, so we do not
-            // have to deal with the very last bit of the vector
-            for (int v = 0; v < (int)intervals_to_collapse_vector.size() - 1; v++) {
-
-                if (intervals_to_collapse_vector[v]) {
-                    // Ignore the current pulse_ratios for right now as we are building the complete pulse_interval set
-                    // At the end of this loop, ths pulse_ratios should hold the final ratio set corresponding to the
-                    // current_pulse_intervals_ms
-
-                    bool result = GetPulseIntervalsAndRatios(current_pulse_intervals_ms, pulse_intervals, pulse_ratios, 1, v - number_collapsed_intervals_so_far);
-
-                    number_collapsed_intervals_so_far++;
-                    // We are going to continue to work on the result vector, and potentially collapse 
-                    // more intervals
-                    current_pulse_intervals_ms = pulse_intervals;
-                }
-            }
-
-            return true;
-        }
-
         bool GolfSimCamera::GetPulseIntervalsAndRatios(const std::vector<float>& initial_pulse_intervals_ms,
                                                        std::vector<float>& pulse_pause_intervals,
                                                        std::vector<double>& pulse_pause_ratios,                                                       
@@ -156,6 +156,16 @@ namespace golf_sim {
         static double kMinPuttingQualityExposureLaunchAngle;
         static int kNumberAngleCheckExposures;
 
+        // If set, the strobed balls are first searched-for only in the part of the camera 2 image
+        // that a ball hit from the teed-up position could fly through.  See StrobedBallCorridor.
+        static bool kUseStrobedBallCorridor;
+        static double kStrobedBallCorridorMaxDistanceMeters;
+        static double kStrobedBallCorridorMinLaunchAngle;
+        static double kStrobedBallCorridorMaxLaunchAngle;
+        static double kStrobedBallCorridorMaxSideAngle;
+        static double kStrobedBallCorridorMarginBallRadii;
+        static double kStrobedBallCorridorMaxAreaFraction;
+
         static double kStandardBallSpeedSlowdownPercentage;
         static double kPracticeBallSpeedSlowdownPercentage;
         static double kPuttingBallSpeedSlowdownPercentage;
@@ -321,6 +331,11 @@ namespace golf_sim {
         // plane of the expected ball's line of flight.
         static bool ComputeXyzDistanceFromOrthoCamPerspective(const GolfSimCamera& camera, const GolfBall& b1, cv::Vec3d& distance_deltas);
 
+        // The inverse of ComputeXyzDistanceFromOrthoCamPerspective.  Returns the pixel at which a position
+        // (in meters, in the same axes as the distances computed above) appears in the camera's image.
+        // Returns false if the position is not in front of the camera.
+        static bool ProjectXyzOrthoCamPerspectiveToPixel(const GolfSimCamera& camera, const cv::Vec3d& distances, cv::Point2d& pixel);
+
         static bool ComputeBallXYAnglesFromCameraPerspective(const cv::Vec3d& distances_camera_perspective,
                                               cv::Vec2d& deltaAnglesCameraPerspective);
         
@@ -372,20 +387,6 @@ namespace golf_sim {
 
         void PrintPulseVector(const std::vector<bool>& combinations_vector);
 
-        int CountSetBits(int n);
-
-        void SetPulseVector(int bit_value, std::vector<bool>& combinations_vector);
-
-        int FindClosestRatioPatternMatchOffset(const std::vector<double> distance_ratios,
-                                               const std::vector<double> pulse_ratios,
-                                               double& delta_to_closest_ratio,
-                                               bool try_different_offsets = true);
-
-        bool GetPulseIntervalsAndRatiosFromIntervalVector(  const std::vector<bool>& intervals_to_collapse_vector,
-                                                            const std::vector<float>& initial_pulse_intervals_ms,
-                                                            std::vector<float>& pulse_intervals,
-                                                            std::vector<double>& pulse_ratios);
-
         bool GetPulseIntervalsAndRatios(const std::vector<float>& initial_pulse_intervals_ms, 
                                         std::vector<float>& pulse_pause_intervals,
                                         std::vector<double>& pulse_pause_ratios,                                        
@@ -402,12 +403,6 @@ namespace golf_sim {
                                         const GolfBall& line_ball1,
                                         const GolfBall& line_ball2);
 
-        // Returns a score of the closeness of the vector of distance_ratios within the pulse_ratios at an offset
-        // of the distance_ratios from the beginning of the pulse_ratios
-        double ComputeRatioDistance(const std::vector<double> distance_ratios,
-                                    const std::vector<double> pulse_ratios,
-                                    int& distance_pattern_offset);
-
         // If we identified a lot of balls, only retain the top <n>
         void RemoveLowScoringBalls(std::vector<GolfBall>& initial_balls, const int max_balls_to_retain);
 
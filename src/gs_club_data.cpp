@@ -4,10 +4,10 @@
  */
 
 
-#include <boost/circular_buffer.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 
 #include "utils/logging_tools.h"
+#include "utils/artifact_writer.h"
 #include "gs_options.h"
 #include "gs_config.h"
 
@@ -57,7 +57,7 @@ namespace golf_sim {
 		return true;
 	}
 
-	bool GolfSimClubData::ProcessClubStrikeData(boost::circular_buffer<RecentFrameInfo>& frame_info) {
+	bool GolfSimClubData::ProcessClubStrikeData(RecentFrameRing& frame_info) {
 		GS_LOG_TRACE_MSG(trace, "GolfSimClubData::ProcessClubStrikeData.");
 
 		if (!kGatherClubData) {
@@ -76,7 +76,7 @@ namespace golf_sim {
 	}
 
 
-	bool GolfSimClubData::CreateClubStrikeVideo(boost::circular_buffer<RecentFrameInfo>& frame_info) {
+	bool GolfSimClubData::CreateClubStrikeVideo(RecentFrameRing& frame_info) {
 		GS_LOG_TRACE_MSG(trace, "GolfSimClubData::CreateClubStrikeVideo with " + std::to_string(frame_info.size()) + " frames.");
 
 		if (!kGatherClubData) {
@@ -88,9 +88,11 @@ namespace golf_sim {
 
 		int frame_index = 0;
 
-		for (auto& it : frame_info) {
+		for (size_t i = 0; i < frame_info.size(); i++) {
+			const RecentFrameInfo& it = frame_info[i];
 
-			cv::Mat& next_frame_mat = it.mat;
+			// The frame number and ROI are only drawn now, when the frame is actually exported
+			cv::Mat next_frame_mat = it.GetAnnotatedMat();
 
 			std::string frame_number = std::to_string(frame_index);
 			frame_number = std::string(3 /* zeros */ - frame_number.length(), '0') + frame_number;
@@ -103,13 +105,18 @@ namespace golf_sim {
 				GS_LOG_TRACE_MSG(warning, "GolfSimClubData::CreateClubStrikeVideo -- " + frame_image_name + " was empty.");
 			}
 			else {
-				LoggingTools::LogImage("", next_frame_mat, std::vector < cv::Point >{}, true, frame_image_name);
+				// ffmpeg needs every frame, as a .png, so these are never dropped the way other
+				// logged images can be.  GetAnnotatedMat returned our own copy.
+				ArtifactWriter::GetSharedWriter().Submit(LoggingTools::kBaseImageLoggingDir + frame_image_name, std::move(next_frame_mat),
+														 ArtifactWriter::Priority::kWebserver);
 			}
 
 			frame_index++;
 		}
 
 
+		ArtifactWriter::GetSharedWriter().Flush(ArtifactWriter::Priority::kWebserver);
+
 		std::string unique_time_tag = LoggingTools::GetUniqueLogName();
 		std::string make_movie_command = "ffmpeg -framerate 2 -pattern_type glob -i '" + LoggingTools::kBaseImageLoggingDir + 
 				"Club*.png' -c:v libx264 -pix_fmt yuv420p " +  LoggingTools::kBaseImageLoggingDir + "ClubStrike_" + unique_time_tag + ".mp4";
@@ -18,9 +18,9 @@ namespace golf_sim {
 
 		// Create a video of the club strike, detect club face information,
 		// perform analysis, etc.
-		static bool ProcessClubStrikeData(boost::circular_buffer<RecentFrameInfo>& frame_info);
+		static bool ProcessClubStrikeData(RecentFrameRing& frame_info);
 
-		static bool CreateClubStrikeVideo(boost::circular_buffer<RecentFrameInfo>& frame_info);
+		static bool CreateClubStrikeVideo(RecentFrameRing& frame_info);
 
 
 	public:
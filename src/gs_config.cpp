@@ -6,8 +6,10 @@
 #ifdef __unix__  // Ignore in Windows environment
 #endif
 #include <boost/foreach.hpp>
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
+#include <optional>
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -16,10 +18,12 @@
 #include "gs_ui_system.h"
 #include "gs_config.h"
 #include "configuration_manager.h"
+#include "config_snapshot.h"
 #include "gs_options.h"
 
 // Having to set the constants in this way creates more entanglement than we'd like.  TBD - Re-architect
 #include "libcamera_interface.h"
+#include "ball_placement_watcher.h"
 
 
 namespace golf_sim {
@@ -45,6 +49,11 @@ namespace golf_sim {
 			GS_LOG_MSG(info, "ConfigurationManager initialized with override support");
 		}
 
+		// The constants are read from a snapshot of the configuration, which is rebuilt
+		// whenever the overrides change
+		config_mgr.SetChangeListener([] { PublishConfigSnapshot(); });
+		PublishConfigSnapshot();
+
 		// Read any values that we want to set early, here at initialization
 		if (!ReadValues()) {
 			return false;
@@ -194,6 +203,18 @@ bool GolfSimConfiguration::ReadValues() {
 	SetConstant("gs_config.cameras.kCamera2PuttingContrast", LibCameraInterface::kCamera2PuttingContrast);
 	SetConstant("gs_config.cameras.kCamera1StillShutterTimeuS", LibCameraInterface::kCamera1StillShutterTimeuS);
 	SetConstant("gs_config.cameras.kCamera2StillShutterTimeuS", LibCameraInterface::kCamera2StillShutterTimeuS);
+	SetConstant("gs_config.cameras.kCamera2UsePersistentCaptureSession", LibCameraInterface::kCamera2UsePersistentCaptureSession);
+
+	SetConstant("gs_config.ball_placement.kUseStreamingBallPlacement", BallPlacementWatcher::kUseStreamingBallPlacement);
+	SetConstant("gs_config.ball_placement.kPlacementPreviewDownscale", BallPlacementWatcher::kPlacementPreviewDownscale);
+	SetConstant("gs_config.ball_placement.kPlacementPreviewFPS", BallPlacementWatcher::kPlacementPreviewFPS);
+	SetConstant("gs_config.ball_placement.kPlacementStableFrames", BallPlacementWatcher::kPlacementStableFrames);
+	SetConstant("gs_config.ball_placement.kPlacementMaxDifferenceEnergy", BallPlacementWatcher::kPlacementMaxDifferenceEnergy);
+	SetConstant("gs_config.ball_placement.kPlacementMaxCenterDriftPixels", BallPlacementWatcher::kPlacementMaxCenterDriftPixels);
+	SetConstant("gs_config.ball_placement.kPlacementMaxRadiusChangePercent", BallPlacementWatcher::kPlacementMaxRadiusChangePercent);
+	SetConstant("gs_config.ball_placement.kPlacementSearchAreaRadiusRatio", BallPlacementWatcher::kPlacementSearchAreaRadiusRatio);
+	SetConstant("gs_config.ball_placement.kPlacementMaxFrameAgeMs", BallPlacementWatcher::kPlacementMaxFrameAgeMs);
+	SetConstant("gs_config.ball_placement.kPlacementFramesPerCheck", BallPlacementWatcher::kPlacementFramesPerCheck);
 	SetConstant("gs_config.cameras.kCameraMotionDetectSettings", LibCameraInterface::kCameraMotionDetectSettings);
 
 	// Resolve relative motion detect path against PITRAC_ROOT
@@ -326,253 +347,165 @@ bool GolfSimConfiguration::ReadValues() {
 }
 
 	bool GolfSimConfiguration::PropertyExists(const std::string& value_tag) {
-		// int count = configuration_root_.count(value_tag);
-		boost::optional<std::string> v = configuration_root_.get_optional<std::string>(value_tag);
+		return ConfigSnapshot::Current().JsonNodeExists(value_tag);
+	}
 
-		return ((bool)v);
+	void GolfSimConfiguration::PublishConfigSnapshot() {
+		ConfigSnapshot::Publish(ConfigSnapshot::Build(configuration_root_, ConfigurationManager::GetInstance().GetOverrideValues()));
 	}
 
+	// The scalar values are read from the current configuration snapshot, with any user-settings,
+	// YAML or command-line override taking precedence over the .json file.  As before, a missing
+	// or unreadable value sets the constant to 0 (or false), except for strings, which are left as-is.
 
 	void GolfSimConfiguration::SetConstant(const std::string& tag_name, bool& constant_value) {
-		// Try ConfigurationManager first for override support
-		ConfigurationManager& config_mgr = ConfigurationManager::GetInstance();
-		if (config_mgr.HasKey(tag_name)) {
-			bool val = config_mgr.GetBool(tag_name, constant_value);
-			if (val != constant_value) {
-				GS_LOG_TRACE_MSG(trace, "Override from ConfigurationManager: " + tag_name + " = " + (val ? "true" : "false"));
-				constant_value = val;
-				return;
-			}
-		}
-
-		// Fall back to original JSON behavior
-		try {
-			constant_value = configuration_root_.get<bool>(tag_name, false);
-		}
-		catch (std::exception const& e)
-		{
-			GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-			constant_value = false;
-		}
+		constant_value = ConfigSnapshot::Current().GetBool(tag_name, false);
 	}
 
 	void GolfSimConfiguration::SetConstant(const std::string& tag_name, int& constant_value) {
-		// Try ConfigurationManager first for override support
-		ConfigurationManager& config_mgr = ConfigurationManager::GetInstance();
-		if (config_mgr.HasKey(tag_name)) {
-			int val = config_mgr.GetInt(tag_name, constant_value);
-			if (val != constant_value) {
-				GS_LOG_TRACE_MSG(trace, "Override from ConfigurationManager: " + tag_name + " = " + std::to_string(val));
-				constant_value = val;
-				return;
-			}
-		}
-
-		// Fall back to original JSON behavior
-		try {
-			constant_value = configuration_root_.get<int>(tag_name, 0);
-		}
-		catch (std::exception const& e)
-		{
-			GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-			constant_value = false;
-		}
+		constant_value = ConfigSnapshot::Current().GetInt(tag_name, 0);
 	}
 
 	void GolfSimConfiguration::SetConstant(const std::string& tag_name, long& constant_value) {
-		try {
-			constant_value = configuration_root_.get<long>(tag_name, 0);
-		}
-		catch (std::exception const& e)
-		{
-			GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-			constant_value = false;
-		}
+		constant_value = ConfigSnapshot::Current().GetLong(tag_name, 0);
 	}
 
 	void GolfSimConfiguration::SetConstant(const std::string& tag_name, unsigned int& constant_value) {
-		try {
-			constant_value = configuration_root_.get<uint>(tag_name, 0);
+		constant_value = ConfigSnapshot::Current().GetUInt(tag_name, 0);
+	}
+
+	void GolfSimConfiguration::SetConstant(const std::string& tag_name, float& constant_value) {
+		constant_value = ConfigSnapshot::Current().GetFloat(tag_name, 0.0F);
+	}
+
+	void GolfSimConfiguration::SetConstant(const std::string& tag_name, double& constant_value) {
+		constant_value = ConfigSnapshot::Current().GetDouble(tag_name, 0.0);
+	}
+
+	void GolfSimConfiguration::SetConstant(const std::string& tag_name, std::string& constant_value) {
+		constant_value = ConfigSnapshot::Current().GetString(tag_name, constant_value);
+	}
+
+	// The vector and matrix values come from the .json file only
+	static const std::vector<ConfigSnapshot::Value>* GetJsonArray(const std::string& tag_name) {
+		const std::vector<ConfigSnapshot::Value>* elements = ConfigSnapshot::Current().GetJsonArray(tag_name);
+
+		if (elements == nullptr) {
+			GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** No such node (" + tag_name + ") ***");
 		}
-		catch (std::exception const& e)
-		{
-			GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-			constant_value = false;
+
+		return elements;
+	}
+
+	template <typename T>
+	static bool GetElementValue(const std::string& tag_name, const std::optional<T>& element_value, T& value) {
+		if (!element_value) {
+			GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** Could not read an element of " + tag_name + " ***");
+			return false;
 		}
+
+		value = *element_value;
+		return true;
 	}
 
-	 void GolfSimConfiguration::SetConstant(const std::string& tag_name, float& constant_value) {
-		// Try ConfigurationManager first for override support
-		ConfigurationManager& config_mgr = ConfigurationManager::GetInstance();
-		if (config_mgr.HasKey(tag_name)) {
-			float val = config_mgr.GetFloat(tag_name, constant_value);
-			if (val != constant_value) {
-				GS_LOG_TRACE_MSG(trace, "Override from ConfigurationManager: " + tag_name + " = " + std::to_string(val));
-				constant_value = val;
+	template <typename VecType>
+	static void SetVecConstant(const std::string& tag_name, VecType& vec) {
+		const std::vector<ConfigSnapshot::Value>* elements = GetJsonArray(tag_name);
+		if (elements == nullptr) {
+			return;
+		}
+
+		const size_t number_elements = std::min(elements->size(), (size_t)VecType::channels);
+
+		for (size_t i = 0; i < number_elements; i++) {
+			double value = 0.0;
+			if (!GetElementValue(tag_name, (*elements)[i].whole_double, value)) {
 				return;
 			}
+			vec[(int)i] = (typename VecType::value_type)value;
 		}
+	}
 
-		// Fall back to original JSON behavior
-		try {
-			constant_value = configuration_root_.get<float>(tag_name, 0.0);
-		}
-		catch (std::exception const& e)
-		{
-			GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-			constant_value = false;
-		}
+	void GolfSimConfiguration::SetConstant(const std::string& tag_name, cv::Vec3d& vec) {
+		SetVecConstant(tag_name, vec);
 	}
 
-	 void GolfSimConfiguration::SetConstant(const std::string& tag_name, double& constant_value) {
-		try {
-			constant_value = configuration_root_.get<double>(tag_name, 0.0);
+	void GolfSimConfiguration::SetConstant(const std::string& tag_name, cv::Vec3f& vec) {
+		const std::vector<ConfigSnapshot::Value>* elements = GetJsonArray(tag_name);
+		if (elements == nullptr) {
+			return;
 		}
-		catch (std::exception const& e)
-		{
-			GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-			constant_value = false;
-		}
-	}
 
-	 void GolfSimConfiguration::SetConstant(const std::string& tag_name, std::string& constant_value) {
-		// Try ConfigurationManager first for override support
-		ConfigurationManager& config_mgr = ConfigurationManager::GetInstance();
-		
-		// First check if there's a mapped YAML key
-		std::string yaml_key = tag_name;
-		// Convert JSON path to potential YAML key (simplified mapping)
-		// e.g., "gs_config.cameras.kCamera1Gain" -> "cameras.camera1_gain"
-		
-		if (config_mgr.HasKey(yaml_key)) {
-			std::string val = config_mgr.GetString(yaml_key, constant_value);
-			if (val != constant_value) {
-				GS_LOG_TRACE_MSG(trace, "Override from ConfigurationManager: " + tag_name + " = " + val);
-				constant_value = val;
+		for (size_t i = 0; i < std::min(elements->size(), (size_t)3); i++) {
+			if (!GetElementValue(tag_name, (*elements)[i].whole_float, vec[(int)i])) {
 				return;
 			}
 		}
+	}
 
-		// Fall back to original JSON behavior
-		 try {
-			 constant_value = configuration_root_.get<std::string>(tag_name, constant_value);
-		 }
-		 catch (std::exception const& e)
-		 {
-			 GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-			 constant_value = "";
-		 }
-	 }
+	void GolfSimConfiguration::SetConstant(const std::string& tag_name, cv::Vec2d& vec) {
+		SetVecConstant(tag_name, vec);
+	}
 
-	 void GolfSimConfiguration::SetConstant(const std::string& tag_name, cv::Vec3d& vec) {
-		 try {
-			 int i = 0;
-			 for (boost::property_tree::ptree::value_type& element : configuration_root_.get_child(tag_name)) {
-				 // vec[i] = std::stod(element.second.data());
-				 vec[i] = element.second.get_value<double>();
-				 i++;
-			 }
-		 }
-		 catch (std::exception const& e)
-		 {
-			 GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-		 }
-	 }
+	void GolfSimConfiguration::SetConstant(const std::string& tag_name, std::vector<float>& vec) {
+		const std::vector<ConfigSnapshot::Value>* elements = GetJsonArray(tag_name);
+		if (elements == nullptr) {
+			return;
+		}
 
-	 void GolfSimConfiguration::SetConstant(const std::string& tag_name, cv::Vec3f& vec) {
-		 try {
-			 int i = 0;
-			 for (boost::property_tree::ptree::value_type& element : configuration_root_.get_child(tag_name)) {
-				 // vec[i] = std::stod(element.second.data());
-				 vec[i] = element.second.get_value<float>();
-				 i++;
-			 }
-		 }
-		 catch (std::exception const& e)
-		 {
-			 GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-		 }
-	 }
+		for (const ConfigSnapshot::Value& element : *elements) {
+			float value = 0.0F;
+			if (!GetElementValue(tag_name, element.whole_float, value)) {
+				return;
+			}
+			vec.push_back(value);
+		}
+	}
 
-	 void GolfSimConfiguration::SetConstant(const std::string& tag_name, cv::Vec2d& vec) {
-		 try {
-			 int i = 0;
-			 for (boost::property_tree::ptree::value_type& element : configuration_root_.get_child(tag_name)) {
-				 // vec[i] = std::stod(element.second.data());
-				 vec[i] = element.second.get_value<double>();
-				 i++;
-			 }
-		 }
-		 catch (std::exception const& e)
-		 {
-			 GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-		 }
-	 }
+	void GolfSimConfiguration::SetConstant(const std::string& tag_name, std::vector<cv::Vec3d>& matrix) {
+		const std::vector<ConfigSnapshot::Value>* rows = GetJsonArray(tag_name);
+		if (rows == nullptr) {
+			return;
+		}
 
-	 void GolfSimConfiguration::SetConstant(const std::string& tag_name, std::vector<float>& vec) {
-		 try {
-			 int i = 0;
-			 for (boost::property_tree::ptree::value_type& element : configuration_root_.get_child(tag_name)) {
-				 vec.push_back( element.second.get_value<float>() );
-				 i++;
-			 }
-		 }
-		 catch (std::exception const& e)
-		 {
-			 GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-		 }
-	 }
+		for (size_t x = 0; x < std::min(rows->size(), matrix.size()); x++) {
+			const std::vector<ConfigSnapshot::Value>& row = (*rows)[x].elements;
 
-	 void GolfSimConfiguration::SetConstant(const std::string& tag_name, std::vector<cv::Vec3d>& matrix) {
-		 try {
-			 int x = 0;
-			 for (boost::property_tree::ptree::value_type& row : configuration_root_.get_child(tag_name))
-			 {
-				 int y = 0;
-				 for (boost::property_tree::ptree::value_type& cell : row.second)
-				 {
-					 matrix[x][y] = cell.second.get_value<double>();
-					 y++;
-				 }
-				 x++;
-			 }
-		 }
-		 catch (std::exception const& e)
-		 {
-			 GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-		 }
-	 }
+			for (size_t y = 0; y < std::min(row.size(), (size_t)3); y++) {
+				if (!GetElementValue(tag_name, row[y].whole_double, matrix[x][(int)y])) {
+					return;
+				}
+			}
+		}
+	}
 
-	 void GolfSimConfiguration::SetConstant(const std::string& tag_name, cv::Mat& matrix) {
-		 bool is_1D = (matrix.rows == 1);
+	void GolfSimConfiguration::SetConstant(const std::string& tag_name, cv::Mat& matrix) {
+		const std::vector<ConfigSnapshot::Value>* rows = GetJsonArray(tag_name);
+		if (rows == nullptr) {
+			return;
+		}
 
-		 try {
-			 if (is_1D) {
-				 int i = 0;
-				 for (boost::property_tree::ptree::value_type& element : configuration_root_.get_child(tag_name)) {
-					 matrix.at<double>(0, i) = element.second.get_value<double>();
-					 i++;
-				 }
-			 }
-			 else {
-				 int x = 0;
-				 for (boost::property_tree::ptree::value_type& row : configuration_root_.get_child(tag_name))
-				 {
-					 int y = 0;
-					 for (boost::property_tree::ptree::value_type& cell : row.second)
-					 {
-						 matrix.at<double>(x, y) = cell.second.get_value<double>();
-						 y++;
-					 }
-					 x++;
-				 }
-			 }
-		 }
-		 catch (std::exception const& e)
-		 {
-			 GS_LOG_MSG(error, "GolfSimConfiguration::SetConstant failed. ERROR: *** " + std::string(e.what()) + " ***");
-		 }
-	 }
+		const bool is_1D = (matrix.rows == 1);
+
+		if (is_1D) {
+			for (size_t i = 0; i < std::min(rows->size(), (size_t)matrix.cols); i++) {
+				if (!GetElementValue(tag_name, (*rows)[i].whole_double, matrix.at<double>(0, (int)i))) {
+					return;
+				}
+			}
+		}
+		else {
+			for (size_t x = 0; x < std::min(rows->size(), (size_t)matrix.rows); x++) {
+				const std::vector<ConfigSnapshot::Value>& row = (*rows)[x].elements;
+
+				for (size_t y = 0; y < std::min(row.size(), (size_t)matrix.cols); y++) {
+					if (!GetElementValue(tag_name, row[y].whole_double, matrix.at<double>((int)x, (int)y))) {
+						return;
+					}
+				}
+			}
+		}
+	}
 
 	 bool GolfSimConfiguration::RemoveTreeNode(const std::string& tag_name) {
 
@@ -581,6 +514,7 @@ bool GolfSimConfiguration::ReadValues() {
 
 			 if (PropertyExists(tag_name)) {
 				 configuration_root_.erase(tag_name);
+				 PublishConfigSnapshot();
 				 return true;
 			 }
 		 }
@@ -628,7 +562,7 @@ bool GolfSimConfiguration::ReadValues() {
 			 return false;
 		 }
 
-		 // TBD - Set the values
+		 PublishConfigSnapshot();
 
 		 return true;
 	 }
@@ -646,7 +580,7 @@ bool GolfSimConfiguration::ReadValues() {
 			 return false;
 		 }
 
-		 // TBD - Set the values
+		 PublishConfigSnapshot();
 
 		 return true;
 	 }
@@ -47,6 +47,10 @@ namespace golf_sim {
 
 		static bool PropertyExists(const std::string& value_tag);
 
+		// Rebuilds the configuration snapshot (see config_snapshot.h) that the SetConstant
+		// calls read from.  Called whenever the tree or the overrides change.
+		static void PublishConfigSnapshot();
+
 		static void SetConstant(const std::string& value_tag, bool& constant_value);
 		static void SetConstant(const std::string& value_tag, int& constant_value);
 		static void SetConstant(const std::string& value_tag, long& constant_value);
@@ -30,6 +30,8 @@
 #include "sim/common/gs_sim_interface.h"
 #include "pulse_strobe.h"
 #include "libcamera_interface.h"
+#include "ball_placement_watcher.h"
+#include "latency_tracer.h"
 
 #include "gs_fsm.h"
 
@@ -59,6 +61,13 @@ namespace golf_sim {
         template<class... Ts> struct overload : Ts... { using Ts::operator()...; };
     }
 
+    // The streaming watcher is only for the camera 1 system's normal operation.  Calibration and
+    // testing modes still take individual stills.
+    static bool UseStreamingBallPlacement() {
+        return BallPlacementWatcher::kUseStreamingBallPlacement &&
+               GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera1;
+    }
+
     TimedCallbackThread* BallStabilizationCheckTimerThread = nullptr;
     TimedCallbackThread* ReceivedCam2ImageCheckTimerThread = nullptr;
 
@@ -175,7 +184,23 @@ namespace golf_sim {
         cv::Mat img;
         GolfBall ball;
 
-        bool found = CheckForBall(ball, img);
+        bool found = false;
+        bool ball_already_stable = false;
+
+        if (UseStreamingBallPlacement()) {
+            // Looks at a few frames of the preview stream, and only reports the ball once it has stayed still
+            BallPlacementWatcher::PlacementStatus status = BallPlacementWatcher::GetWatcher().CheckForPlacedBall(ball, img);
+
+            found = (status == BallPlacementWatcher::PlacementStatus::kBallStable);
+            ball_already_stable = found;
+
+            if (status == BallPlacementWatcher::PlacementStatus::kError) {
+                GS_LOG_MSG(warning, "BallPlacementWatcher failed - will try again.");
+            }
+        }
+        else {
+            found = CheckForBall(ball, img);
+        }
 
         if (img.empty()) {
             GS_LOG_MSG(warning, "CheckForBall() return image was empty - ignoring.");
@@ -196,15 +221,22 @@ namespace golf_sim {
 
             std::chrono::steady_clock::time_point lastBallAcquisitionTime = std::chrono::steady_clock::now();
 
-            // Schedule the timer for a determined (short) time in the future.  When the timer goes off, an
-            // CheckForBallStable event will be injected
-            // Create a thread that will queue an event-loop queueBallStabilizationCheck in the future
-            setupBallStabilizationCheckTimer();
-
-            // Let the monitor interface know what's happening
-            GsUISystem::SendIPCStatusMessage(GsIPCResultType::kPausingForBallStabilization);
+            if (ball_already_stable) {
+                // No need to wait and look again
+                GolfSimEventElement checkForBallStableEvent{ new GolfSimEvent::CheckForBallStable{ } };
+                GolfSimEventQueue::QueueEvent(checkForBallStableEvent);
+            }
+            else {
+                // Schedule the timer for a determined (short) time in the future.  When the timer goes off, an
+                // CheckForBallStable event will be injected
+                // Create a thread that will queue an event-loop queueBallStabilizationCheck in the future
+                setupBallStabilizationCheckTimer();
+
+                // Let the monitor interface know what's happening
+                GsUISystem::SendIPCStatusMessage(GsIPCResultType::kPausingForBallStabilization);
+            }
 
-            return state::WaitingForBallStabilization{ lastBallAcquisitionTime, std::chrono::steady_clock::now(), ball, img };
+            return state::WaitingForBallStabilization{ lastBallAcquisitionTime, std::chrono::steady_clock::now(), ball, img, ball_already_stable };
         }
 
 
@@ -244,8 +276,16 @@ namespace golf_sim {
 
         GolfBall ball;
         cv::Mat img;
+        bool found = true;
 
-        bool found = CheckForBall(ball, img);
+        if (waitingForBallStabilization.ball_already_stable_) {
+            // The ball was watched until it stayed still, and was then located in a fresh image
+            ball = waitingForBallStabilization.cam1_ball_;
+            img = waitingForBallStabilization.ball_image_;
+        }
+        else {
+            found = CheckForBall(ball, img);
+        }
         // LoggingTools::LogImage("", img, std::vector < cv::Point >{}, true, "log_last_ball_2bcompared2_still.png");
 
 
@@ -745,6 +785,10 @@ namespace golf_sim {
         else if (message_type == GsIPCControlMsgType::kClubChangeToDriver) {
             GolfSimClubs::SetCurrentClubType(GolfSimClubs::GsClubType::kDriver);
         }
+        else if (message_type == GsIPCControlMsgType::kDumpLatencyStatistics) {
+            LatencyTracer::GetSharedTracer().DumpToLog();
+            GsUISystem::SendIPCLatencyStatisticsMessage();
+        }
         else {
             GS_LOG_MSG(error, "Received ControlMessage event with unknown message type.");
         }
@@ -46,6 +46,8 @@ namespace golf_sim {
             std::chrono::steady_clock::time_point startTime_;
             GolfBall cam1_ball_;
             cv::Mat ball_image_;
+            // True if the ball placement watcher already saw the ball stay still
+            bool ball_already_stable_ = false;
         };
 
         struct WaitingForBallHit {
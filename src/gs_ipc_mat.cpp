@@ -6,12 +6,21 @@
 
 #ifdef __unix__  // Ignore in Windows environment
 
+#include <algorithm>
+#include <cstring>
+
+#ifdef GS_HAVE_LZ4
+#include <lz4.h>
+#endif
+
 #include "utils/logging_tools.h"
 
 #include "gs_ipc_mat.h"
 
 namespace golf_sim {
 
+    int GsIPCMat::kPngCompressionLevel = 1;
+
     GsIPCMat::GsIPCMat() {
     }
 
@@ -19,16 +28,116 @@ namespace golf_sim {
     }
 
     void GsIPCMat::SetAndPackMat(cv::Mat& mat) {
+        SetAndPackMat(mat, GsIPCMatEncoding::kRaw);
+    }
 
-        mat_holder_.matrix = std::vector<uchar>(mat.data, mat.data + (mat.rows * mat.cols * mat.channels()));
+    void GsIPCMat::SetAndPackMat(const cv::Mat& mat, GsIPCMatEncoding encoding, const cv::Rect& roi) {
+
+        received_data_.release();
+
+        mat_holder_ = GsIPCMatHolder();
         mat_holder_.rows = mat.rows;
         mat_holder_.cols = mat.cols;
         mat_holder_.type = mat.type();
 
-        GS_LOG_TRACE_MSG(trace, "GsIPCMat::SetAndPackMat called with row/cols/type = " + std::to_string(mat_holder_.rows) + "/" + std::to_string(mat_holder_.cols) + "/" + std::to_string(mat_holder_.type) + ".");
+        cv::Mat sent_mat = mat;
+
+        if (!roi.empty()) {
+            cv::Rect clipped_roi = roi & cv::Rect(0, 0, mat.cols, mat.rows);
+
+            if (!clipped_roi.empty() && clipped_roi.size() != mat.size()) {
+                sent_mat = mat(clipped_roi);
+                mat_holder_.roi_x = clipped_roi.x;
+                mat_holder_.roi_y = clipped_roi.y;
+                mat_holder_.roi_width = clipped_roi.width;
+                mat_holder_.roi_height = clipped_roi.height;
+            }
+        }
+
+        const size_t pixel_bytes = sent_mat.total() * sent_mat.elemSize();
+
+        if (encoding == GsIPCMatEncoding::kLz4 && !IsLz4Available()) {
+            GS_LOG_TRACE_MSG(warning, "GsIPCMat - LZ4 support was not compiled in.  Using PNG instead.");
+            encoding = GsIPCMatEncoding::kPng;
+        }
+
+        if (encoding == GsIPCMatEncoding::kPng && sent_mat.depth() != CV_8U && sent_mat.depth() != CV_16U) {
+            encoding = GsIPCMatEncoding::kRaw;
+        }
+
+        bool encoded = false;
+
+        if (encoding == GsIPCMatEncoding::kPng && !sent_mat.empty()) {
+            std::vector<int> png_parameters{ cv::IMWRITE_PNG_COMPRESSION, kPngCompressionLevel };
+            encoded = cv::imencode(".png", sent_mat, mat_holder_.matrix, png_parameters);
+        }
+#ifdef GS_HAVE_LZ4
+        else if (encoding == GsIPCMatEncoding::kLz4 && !sent_mat.empty()) {
+            // LZ4 needs the pixels in one block
+            cv::Mat continuous_mat = sent_mat.isContinuous() ? sent_mat : sent_mat.clone();
+
+            mat_holder_.matrix.resize(LZ4_compressBound((int)pixel_bytes));
+
+            int compressed_bytes = LZ4_compress_default((const char*)continuous_mat.data, (char*)mat_holder_.matrix.data(),
+                                                        (int)pixel_bytes, (int)mat_holder_.matrix.size());
+            if (compressed_bytes > 0) {
+                mat_holder_.matrix.resize(compressed_bytes);
+                encoded = true;
+            }
+        }
+#endif
 
-        /* pack/serialize the data using msgpack */
-        msgpack::pack(&serialized_image_, mat_holder_);
+        if (encoded) {
+            mat_holder_.encoding = encoding;
+        }
+        else {
+            mat_holder_.encoding = GsIPCMatEncoding::kRaw;
+            mat_holder_.matrix.clear();
+        }
+
+        PackHolder(sent_mat);
+
+        GS_LOG_TRACE_MSG(trace, "GsIPCMat::SetAndPackMat called with row/cols/type = " + std::to_string(mat_holder_.rows) + "/" + std::to_string(mat_holder_.cols) + "/" + std::to_string(mat_holder_.type) +
+                                ", encoding = " + FormatEncoding(mat_holder_.encoding) + ".  " + std::to_string(pixel_bytes) + " pixel bytes packed into " + std::to_string(serialized_image_.size()) + ".");
+    }
+
+    void GsIPCMat::PackHolder(const cv::Mat& raw_pixels) {
+        // The field order (and count) must match the MSGPACK_DEFINE in GsIPCMatHolder
+        const uint32_t kHolderFields = 9;
+        // Array and bin headers, plus up to 5 bytes for each int
+        const size_t kMaxHeaderBytes = 64;
+
+        const bool raw = (mat_holder_.encoding == GsIPCMatEncoding::kRaw);
+        const size_t row_bytes = raw ? raw_pixels.cols * raw_pixels.elemSize() : 0;
+        const size_t payload_bytes = raw ? row_bytes * raw_pixels.rows : mat_holder_.matrix.size();
+
+        serialized_image_ = msgpack::sbuffer(payload_bytes + kMaxHeaderBytes);
+
+        msgpack::packer<msgpack::sbuffer> packer(serialized_image_);
+        packer.pack_array(kHolderFields);
+        packer.pack_bin((uint32_t)payload_bytes);
+
+        if (!raw) {
+            packer.pack_bin_body((const char*)mat_holder_.matrix.data(), (uint32_t)payload_bytes);
+        }
+        else if (raw_pixels.isContinuous()) {
+            packer.pack_bin_body((const char*)raw_pixels.data, (uint32_t)payload_bytes);
+        }
+        else {
+            // E.g., a cropped image, which has gaps between its rows
+            for (int row = 0; row < raw_pixels.rows; row++) {
+                packer.pack_bin_body((const char*)raw_pixels.ptr(row), (uint32_t)row_bytes);
+            }
+        }
+
+        packer.pack(mat_holder_.rows);
+        packer.pack(mat_holder_.cols);
+        packer.pack(mat_holder_.type);
+        packer.pack(mat_holder_.encoding);
+        packer.pack(mat_holder_.roi_x);
+        packer.pack(mat_holder_.roi_y);
+        packer.pack(mat_holder_.roi_width);
+        packer.pack(mat_holder_.roi_height);
     }
 
     const msgpack::sbuffer& GsIPCMat::GetSerializedMat() const {
@@ -36,25 +145,154 @@ namespace golf_sim {
     }
 
     cv::Mat GsIPCMat::GetImageMat() const {
-        cv::Mat emptyMat;
+        if (!received_data_.empty()) {
+            return DecodeMat((const char*)received_data_.data, received_data_.total(), &received_data_);
+        }
 
         if (serialized_image_.size() == 0 || serialized_image_.data() == nullptr) {
             GS_LOG_TRACE_MSG(trace, "GsIPCMat::GetImageMat called, but no serialized_image data exists!");
+            return cv::Mat();
+        }
+
+        return DecodeMat(serialized_image_.data(), serialized_image_.size(), nullptr);
+    }
+
+    // Tells msgpack to point at the (large) pixel data in place, rather than copying it
+    static bool ReferenceBinData(msgpack::type::object_type type, std::size_t /*length*/, void* /*user_data*/) {
+        return type == msgpack::type::BIN;
+    }
+
+    cv::Mat GsIPCMat::DecodeMat(const char* data, size_t length, const cv::Mat* owner) {
+        cv::Mat emptyMat;
+
+        // The same fields as GsIPCMatHolder, but with the pixel data left where it is
+        const char* payload = nullptr;
+        size_t payload_bytes = 0;
+        GsIPCMatHolder unpacked_mat;
+
+        // Keeps the unpacked object alive while payload is in use
+        msgpack::object_handle unpacked_mat_data;
+
+        try {
+            unpacked_mat_data = msgpack::unpack(data, length, ReferenceBinData);
+
+            const msgpack::object& holder = unpacked_mat_data.get();
+
+            if (holder.type != msgpack::type::ARRAY || holder.via.array.size < 4 ||
+                holder.via.array.ptr[0].type != msgpack::type::BIN) {
+                GS_LOG_MSG(error, "GsIPCMat::GetImageMat - received data is not a serialized image.");
+                return emptyMat;
+            }
+
+            // Older senders only have the first four fields
+            const msgpack::object* fields = holder.via.array.ptr;
+            const uint32_t number_of_fields = holder.via.array.size;
+
+            payload = fields[0].via.bin.ptr;
+            payload_bytes = fields[0].via.bin.size;
+            fields[1].convert(unpacked_mat.rows);
+            fields[2].convert(unpacked_mat.cols);
+            fields[3].convert(unpacked_mat.type);
+
+            if (number_of_fields >= 9) {
+                fields[4].convert(unpacked_mat.encoding);
+                fields[5].convert(unpacked_mat.roi_x);
+                fields[6].convert(unpacked_mat.roi_y);
+                fields[7].convert(unpacked_mat.roi_width);
+                fields[8].convert(unpacked_mat.roi_height);
+            }
+        }
+        catch (std::exception const& e) {
+            GS_LOG_MSG(error, "GsIPCMat::GetImageMat - could not unpack the received data. ERROR: *** " + std::string(e.what()) + " ***");
             return emptyMat;
         }
-        msgpack::unpacked unpacked_mat_data;
-        msgpack::unpack(unpacked_mat_data,
-            static_cast<const char*>(serialized_image_.data()),
-            serialized_image_.size());
 
-        auto unpacked_mat = unpacked_mat_data.get().as<GsIPCMatHolder>();
+        const bool cropped = (unpacked_mat.roi_width > 0 && unpacked_mat.roi_height > 0);
+        const int sent_rows = cropped ? unpacked_mat.roi_height : unpacked_mat.rows;
+        const int sent_cols = cropped ? unpacked_mat.roi_width : unpacked_mat.cols;
+
+        if (sent_rows <= 0 || sent_cols <= 0 || payload_bytes == 0) {
+            return emptyMat;
+        }
+
+        cv::Mat sent_mat;
+
+        switch (unpacked_mat.encoding) {
+        case GsIPCMatEncoding::kRaw:
+        {
+            const size_t pixel_bytes = (size_t)sent_rows * sent_cols * CV_ELEM_SIZE(unpacked_mat.type);
+
+            if (payload_bytes < pixel_bytes) {
+                GS_LOG_MSG(error, "GsIPCMat::GetImageMat - raw image data is shorter than the image size.");
+                return emptyMat;
+            }
+
+            const bool payload_is_in_owner = (owner != nullptr && payload >= (const char*)owner->data &&
+                                              payload + pixel_bytes <= (const char*)owner->data + owner->total());
+
+            if (payload_is_in_owner && CV_MAT_DEPTH(unpacked_mat.type) == CV_8U) {
+                // Share the received buffer, rather than copying the pixels out of it
+                const int offset = (int)(payload - (const char*)owner->data);
+                sent_mat = owner->colRange(offset, offset + (int)pixel_bytes).reshape(CV_MAT_CN(unpacked_mat.type), sent_rows);
+            }
+            else {
+                /* return back the pixel bytes to cv::Mat image */
+                cv::Mat mat(sent_rows, sent_cols, unpacked_mat.type, (void*)payload);
+
+                // Have to clone the Mat, as the data it points to may go away
+                sent_mat = mat.clone();
+            }
+            break;
+        }
+
+        case GsIPCMatEncoding::kPng:
+            sent_mat = cv::imdecode(cv::Mat(1, (int)payload_bytes, CV_8UC1, (void*)payload), cv::IMREAD_UNCHANGED);
+            break;
+
+        case GsIPCMatEncoding::kLz4:
+        {
+#ifdef GS_HAVE_LZ4
+            sent_mat.create(sent_rows, sent_cols, unpacked_mat.type);
+            const int pixel_bytes = (int)(sent_mat.total() * sent_mat.elemSize());
+
+            int decoded_bytes = LZ4_decompress_safe(payload, (char*)sent_mat.data, (int)payload_bytes, pixel_bytes);
+            if (decoded_bytes != pixel_bytes) {
+                GS_LOG_MSG(error, "GsIPCMat::GetImageMat - could not decompress the LZ4 image data.");
+                return emptyMat;
+            }
+#else
+            GS_LOG_MSG(error, "GsIPCMat::GetImageMat - received an LZ4 image, but LZ4 support was not compiled in.");
+            return emptyMat;
+#endif
+            break;
+        }
+
+        default:
+            GS_LOG_MSG(error, "GsIPCMat::GetImageMat - unknown image encoding " + std::to_string((int)unpacked_mat.encoding) + ".");
+            return emptyMat;
+        }
+
+        if (sent_mat.rows != sent_rows || sent_mat.cols != sent_cols || sent_mat.type() != unpacked_mat.type) {
+            GS_LOG_MSG(error, "GsIPCMat::GetImageMat - decoded image does not match the packed size/type.");
+            return emptyMat;
+        }
+
+        if (!cropped) {
+            return sent_mat;
+        }
+
+        // Put the cropped part back where it came from, so that pixel coordinates are unchanged
+        cv::Rect roi(unpacked_mat.roi_x, unpacked_mat.roi_y, unpacked_mat.roi_width, unpacked_mat.roi_height);
 
-        /* return back the vector<uchar> to cv::Mat image and show it  */
-        cv::Mat mat(unpacked_mat.rows, unpacked_mat.cols,
-            unpacked_mat.type, unpacked_mat.matrix.data() );
+        if ((roi & cv::Rect(0, 0, unpacked_mat.cols, unpacked_mat.rows)) != roi) {
+            GS_LOG_MSG(error, "GsIPCMat::GetImageMat - cropped image region lies outside the image.");
+            return emptyMat;
+        }
 
-        // Have to clone the Mat, as it is going away when the function exits
-        return mat.clone();
+        cv::Mat full_mat = cv::Mat::zeros(unpacked_mat.rows, unpacked_mat.cols, unpacked_mat.type);
+        sent_mat.copyTo(full_mat(roi));
+
+        return full_mat;
     }
 
 
@@ -63,10 +301,59 @@ namespace golf_sim {
             return false;
         }
 
-        GS_LOG_TRACE_MSG(trace, "GsIPCMat::UnpackMatData - (re)writing serialized_image_");
-        serialized_image_.write(data, length);
+        GS_LOG_TRACE_MSG(trace, "GsIPCMat::UnpackMatData - (re)writing received data");
+        cv::Mat received_data(1, (int)length, CV_8UC1);
+        memcpy(received_data.data, data, length);
+
+        return UnpackMatData(received_data);
+    }
+
+    bool GsIPCMat::UnpackMatData(const cv::Mat& data) {
+        if (data.empty() || data.type() != CV_8UC1 || data.rows != 1) {
+            return false;
+        }
+
+        received_data_ = data;
+
+        return true;
+    }
+
+    bool GsIPCMat::ParseEncodingName(const std::string& name, GsIPCMatEncoding& encoding) {
+        std::string lower_name = name;
+        std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(), ::tolower);
+
+        if (lower_name == "raw") {
+            encoding = GsIPCMatEncoding::kRaw;
+        }
+        else if (lower_name == "png") {
+            encoding = GsIPCMatEncoding::kPng;
+        }
+        else if (lower_name == "lz4") {
+            encoding = GsIPCMatEncoding::kLz4;
+        }
+        else {
+            encoding = GsIPCMatEncoding::kRaw;
+            return false;
+        }
+
+        return true;
+    }
+
+    std::string GsIPCMat::FormatEncoding(GsIPCMatEncoding encoding) {
+        switch (encoding) {
+        case GsIPCMatEncoding::kRaw: return "raw";
+        case GsIPCMatEncoding::kPng: return "png";
+        case GsIPCMatEncoding::kLz4: return "lz4";
+        default: return "unknown (" + std::to_string((int)encoding) + ")";
+        }
+    }
 
+    bool GsIPCMat::IsLz4Available() {
+#ifdef GS_HAVE_LZ4
         return true;
+#else
+        return false;
+#endif
     }
 
 }
@@ -24,6 +24,14 @@
 
 namespace golf_sim {
 
+    // How the pixel bytes of a GsIPCMat are carried in the message.  The encoding travels
+    // with the image, so the receiver can always decode what it is sent.
+    enum class GsIPCMatEncoding {
+        kRaw = 0,       // The Mat's pixel bytes, as-is
+        kPng = 1,       // Lossless PNG (8- or 16-bit images only - others are sent raw)
+        kLz4 = 2,       // LZ4 block compression of the pixel bytes.  Much faster than PNG.
+    };
+
     // This class is designed to compartmentalize the details of (De)serializing
     // cv::Mat objects.
     class GsIPCMat {
@@ -33,7 +41,16 @@ namespace golf_sim {
             int rows = 0;
             int cols = 0;
             int type = 0;
-            MSGPACK_DEFINE(matrix, rows, cols, type);
+            // The fields below were added after the ones above.  Keeping them at the end
+            // means that a raw image still unpacks on a system that doesn't know about them,
+            // and that one from such a system unpacks here as raw and uncropped.
+            GsIPCMatEncoding encoding = GsIPCMatEncoding::kRaw;
+            // If roi_width > 0, matrix only holds this part of the rows x cols image
+            int roi_x = 0;
+            int roi_y = 0;
+            int roi_width = 0;
+            int roi_height = 0;
+            MSGPACK_DEFINE(matrix, rows, cols, type, encoding, roi_x, roi_y, roi_width, roi_height);
         };
 
     public:
@@ -42,26 +59,68 @@ namespace golf_sim {
 
         void SetAndPackMat(cv::Mat& mat);
 
+        // Packs the mat with the given encoding.  If roi is not empty, only that part of
+        // the image is sent, and the receiver gets back a full-size image that is black
+        // outside the roi.
+        void SetAndPackMat(const cv::Mat& mat, GsIPCMatEncoding encoding, const cv::Rect& roi = cv::Rect());
+
+        // The packed image.  Raw pixel rows are packed straight from the Mat (any stride) into
+        // this buffer, which is sized up front so that it never has to grow.
         const msgpack::sbuffer& GetSerializedMat() const;
 
-        // Retrieves the image from the internal msgpack buffer
+        // Retrieves the image from the received data or, if none, from the internal msgpack
+        // buffer.  An uncropped 8-bit raw image that came in through UnpackMatData(cv::Mat)
+        // is not copied - the returned Mat shares the received buffer.
         cv::Mat GetImageMat() const;
 
         // Takes the external data pointer (which must have been serialized by this 
-        // class) and unpacks that data into the internal serialized serialized_image_.
+        // class) and copies that data into an internal receive buffer.
         // The resulting cv::Mat can then be retrieved by calling GetImageMat();
         // Useful when a serialized GsIPCMat has been received from, e.g., an
         // ActiveMQ message consumer.
         // Returns true if successful, false otherwise.
         bool UnpackMatData(char* data, size_t length);
 
+        // As above, but takes (shared) ownership of a continuous CV_8UC1 buffer instead of
+        // copying it, e.g., one that an ActiveMQ message body was read straight into.
+        bool UnpackMatData(const cv::Mat& data);
+
+        // The encoding that was used for the most recently packed image
+        GsIPCMatEncoding GetEncoding() const { return mat_holder_.encoding; }
+
+        // Parses "raw", "png", or "lz4" (e.g., from the .json configuration file).
+        // Returns false and sets kRaw if the name is not recognized.
+        static bool ParseEncodingName(const std::string& name, GsIPCMatEncoding& encoding);
+        static std::string FormatEncoding(GsIPCMatEncoding encoding);
+
+        // True if this build can send and receive kLz4 images
+        static bool IsLz4Available();
+
+        // zlib level (0-9) used for kPng.  Low levels are much faster and lose little
+        // on the mostly-dark strobed images.
+        static int kPngCompressionLevel;
+
     private:
+        // Packs mat_holder_, taking the pixels from raw_pixels for kRaw and from
+        // mat_holder_.matrix otherwise.  Produces the same bytes as msgpack::pack(mat_holder_).
+        void PackHolder(const cv::Mat& raw_pixels);
+
+        // owner is the Mat that data points into, if the returned image may share it
+        static cv::Mat DecodeMat(const char* data, size_t length, const cv::Mat* owner);
+
+        // The matrix is only filled in for the compressed encodings.  Raw pixels are
+        // packed directly from the source Mat.
         GsIPCMatHolder mat_holder_;
 
         // Will hold the serialized mat
         msgpack::sbuffer serialized_image_;
+
+        // Received serialized mat (1 x length, CV_8UC1)
+        cv::Mat received_data_;
     };
 
 }
+// This needs to be placed outside the namespace
+MSGPACK_ADD_ENUM(golf_sim::GsIPCMatEncoding);
 
 #endif // #ifdef __unix__  // Ignore in Windows environment
@@ -9,6 +9,7 @@
 #include "utils/logging_tools.h"
 
 #include "gs_ipc_message.h"
+#include "gs_ipc_system.h"
 
 
 namespace golf_sim {
@@ -36,7 +37,19 @@ namespace golf_sim {
     }
 
     void GolfSimIPCMessage::SetImageMat(cv::Mat& mat) {
-        ipc_mat_.SetAndPackMat(mat);
+        switch (message_type_) {
+        case IPCMessageType::kCamera2Image:
+            ipc_mat_.SetAndPackMat(mat, GolfSimIpcSystem::kCamera2ImageEncoding, GolfSimIpcSystem::GetCamera2ImageRoi(mat.size()));
+            break;
+
+        case IPCMessageType::kCamera2ReturnPreImage:
+            ipc_mat_.SetAndPackMat(mat, GolfSimIpcSystem::kCamera2PreImageEncoding);
+            break;
+
+        default:
+            ipc_mat_.SetAndPackMat(mat);
+            break;
+        }
     }
 
     cv::Mat GolfSimIPCMessage::GetImageMat() const {
@@ -56,6 +69,10 @@ namespace golf_sim {
         return ipc_mat_.UnpackMatData(data,length);
     }
 
+    bool GolfSimIPCMessage::UnpackMatData(const cv::Mat& data) {
+        return ipc_mat_.UnpackMatData(data);
+    }
+
 
 }
 
@@ -62,8 +62,13 @@ namespace golf_sim {
 
         // A serialized copy of the Mat will be made and stored in the message
         // See setters/getters below
+        // Camera 2 images are encoded (and possibly cropped) as set in GolfSimIpcSystem
+        // for the message type.  Other images are sent raw.
         void SetImageMat(cv::Mat& mat);
 
+        // The encoding that SetImageMat used
+        GsIPCMatEncoding GetImageEncoding() const { return ipc_mat_.GetEncoding(); }
+
         // A mat object will be (re)constructed from a serialized version stored in the message
         cv::Mat GetImageMat() const;
 
@@ -74,6 +79,9 @@ namespace golf_sim {
         // Takes the data and unpacks it into the cv::Mat for this object.
         bool UnpackMatData(char* data, size_t length);
 
+        // As above, but shares the (1 x length, CV_8UC1) buffer instead of copying it
+        bool UnpackMatData(const cv::Mat& data);
+
         const GsIPCResult& GetResults() const { return ipc_result_; };
         GsIPCResult& GetResultsForModification() { return ipc_result_; };
 
@@ -5,6 +5,8 @@
 
 #ifdef __unix__  // Ignore in Windows environment
 
+#include <cmath>
+
 #include "gs_globals.h"
 #include "utils/logging_tools.h"
 
@@ -72,9 +74,14 @@ namespace golf_sim {
 
     std::string GolfSimIpcSystem::kWebActiveMQHostAddress = "";
 
+    GsIPCMatEncoding GolfSimIpcSystem::kCamera2ImageEncoding = GsIPCMatEncoding::kRaw;
+    GsIPCMatEncoding GolfSimIpcSystem::kCamera2PreImageEncoding = GsIPCMatEncoding::kRaw;
+    std::vector<float> GolfSimIpcSystem::kCamera2ImageRoi;
+
     const std::string GolfSimIpcSystem::kGolfSimMessageTypeTag = "Message Type";
     const std::string GolfSimIpcSystem::kGolfSimMessageType = "GolfSimIPCMessage";
     const std::string GolfSimIpcSystem::kGolfSimIPCMessageTypeTag = "IPCMessageType";
+    const std::string GolfSimIpcSystem::kGolfSimImageEncodingTag = "ImageEncoding";
 
     GolfSimMessageConsumer* GolfSimIpcSystem::consumer_ = nullptr;
     GolfSimMessageProducer* GolfSimIpcSystem::producer_ = nullptr;
@@ -87,6 +94,32 @@ namespace golf_sim {
 
     bool GolfSimIpcSystem::InitializeIPCSystem() {
 
+        std::string encoding_name;
+
+        if (GolfSimConfiguration::PropertyExists("gs_config.ipc_interface.kCamera2ImageEncoding")) {
+            GolfSimConfiguration::SetConstant("gs_config.ipc_interface.kCamera2ImageEncoding", encoding_name);
+            if (!GsIPCMat::ParseEncodingName(encoding_name, kCamera2ImageEncoding)) {
+                GS_LOG_MSG(warning, "GolfSimIpcSystem::InitializeIPCSystem - unknown kCamera2ImageEncoding '" + encoding_name + "'.  Using raw.");
+            }
+        }
+
+        if (GolfSimConfiguration::PropertyExists("gs_config.ipc_interface.kCamera2PreImageEncoding")) {
+            GolfSimConfiguration::SetConstant("gs_config.ipc_interface.kCamera2PreImageEncoding", encoding_name);
+            if (!GsIPCMat::ParseEncodingName(encoding_name, kCamera2PreImageEncoding)) {
+                GS_LOG_MSG(warning, "GolfSimIpcSystem::InitializeIPCSystem - unknown kCamera2PreImageEncoding '" + encoding_name + "'.  Using raw.");
+            }
+        }
+
+        GolfSimConfiguration::SetConstant("gs_config.ipc_interface.kPngCompressionLevel", GsIPCMat::kPngCompressionLevel);
+
+        if (GolfSimConfiguration::PropertyExists("gs_config.ipc_interface.kCamera2ImageRoi")) {
+            kCamera2ImageRoi.clear();
+            GolfSimConfiguration::SetConstant("gs_config.ipc_interface.kCamera2ImageRoi", kCamera2ImageRoi);
+        }
+
+        GS_LOG_TRACE_MSG(trace, "GolfSimIpcSystem::InitializeIPCSystem - camera 2 image encoding = " + GsIPCMat::FormatEncoding(kCamera2ImageEncoding) +
+                                ", pre-image encoding = " + GsIPCMat::FormatEncoding(kCamera2PreImageEncoding));
+
         // We prefer the command-line setting even if there's one in the .json config file
         if (!GolfSimOptions::GetCommandLineOptions().msg_broker_address_.empty()) {
             kWebActiveMQHostAddress = GolfSimOptions::GetCommandLineOptions().msg_broker_address_;
@@ -190,6 +223,28 @@ namespace golf_sim {
     }
 
 
+    cv::Rect GolfSimIpcSystem::GetCamera2ImageRoi(const cv::Size& image_size) {
+        if (kCamera2ImageRoi.size() != 4) {
+            if (!kCamera2ImageRoi.empty()) {
+                GS_LOG_MSG(warning, "GolfSimIpcSystem::GetCamera2ImageRoi - kCamera2ImageRoi must have 4 values.  Sending the whole image.");
+            }
+            return cv::Rect();
+        }
+
+        cv::Rect roi((int)std::floor(kCamera2ImageRoi[0] * image_size.width),
+                     (int)std::floor(kCamera2ImageRoi[1] * image_size.height),
+                     (int)std::ceil(kCamera2ImageRoi[2] * image_size.width),
+                     (int)std::ceil(kCamera2ImageRoi[3] * image_size.height));
+
+        roi &= cv::Rect(cv::Point(0, 0), image_size);
+
+        if (roi.size() == image_size) {
+            return cv::Rect();
+        }
+
+        return roi;
+    }
+
     bool GolfSimIpcSystem::ShutdownIPCSystem() {
         GS_LOG_TRACE_MSG(trace, "GolfSimIpcSystem::ShutdownIPC");
 
@@ -550,10 +605,17 @@ namespace golf_sim {
                 ipc_message->GetMessageType() == GolfSimIPCMessage::IPCMessageType::kCamera2ReturnPreImage) {
 
                 GS_LOG_TRACE_MSG(trace, "BuildIpcMessageFromBytesMessage about to UnpackMatData.");
+                if (active_mq_message.propertyExists(kGolfSimImageEncodingTag)) {
+                    GS_LOG_TRACE_MSG(trace, "    Image encoding is " + active_mq_message.getStringProperty(kGolfSimImageEncodingTag) + ".");
+                }
                 // The ActiveMQ message's Byte body has the serialized data from which
-                // the cv::Mat can be reconstructed.
-                std::unique_ptr<char[]> body_data((char*)active_mq_message.getBodyBytes());
-                ipc_message->UnpackMatData(body_data.get(), active_mq_message.getBodyLength());
+                // the cv::Mat can be reconstructed.  Read it straight into a Mat-owned buffer,
+                // so that the received image can use the pixels where they are.
+                if (active_mq_message.getBodyLength() > 0) {
+                    cv::Mat body_data(1, active_mq_message.getBodyLength(), CV_8UC1);
+                    active_mq_message.readBytes(body_data.data, body_data.cols);
+                    ipc_message->UnpackMatData(body_data);
+                }
             }
             else if (ipc_message->GetMessageType() == GolfSimIPCMessage::IPCMessageType::kResults) {
 
@@ -641,6 +703,8 @@ namespace golf_sim {
                 data != nullptr) {
 
             GS_LOG_TRACE_MSG(trace, "GolfSimIpcSystem::BuildBytesMessageObjectFromIpcMessage has image -- setting body data of length = " + std::to_string(image_mat_byte_length));
+            // Informational only - the receiver decodes from the encoding within the serialized image
+            active_mq_message->setStringProperty(kGolfSimImageEncodingTag, GsIPCMat::FormatEncoding(ipc_message.GetImageEncoding()));
             active_mq_message->setBodyBytes(data, image_mat_byte_length);
         }
         else if (ipc_message.GetMessageType() == GolfSimIPCMessage::IPCMessageType::kResults) {
@@ -37,6 +37,24 @@ namespace golf_sim {
 		static const std::string kGolfSimMessageTypeTag;
 		static const std::string kGolfSimMessageType;
 		static const std::string kGolfSimIPCMessageTypeTag;
+		static const std::string kGolfSimImageEncodingTag;
+
+		// How kCamera2Image and kCamera2ReturnPreImage images are encoded on the wire.
+		// Set from "raw", "png" or "lz4" in the ipc_interface section of the .json file.
+		static GsIPCMatEncoding kCamera2ImageEncoding;
+		static GsIPCMatEncoding kCamera2PreImageEncoding;
+
+		// The part of the camera 2 image that is sent, as fractions [x, y, width, height]
+		// of the image size.  Everything outside of it arrives as black.  The default of
+		// [0, 0, 1, 1] sends the whole image.
+		// This is a fixed region rather than one around the expected ball positions,
+		// because the camera 2 system is not sent the teed-up ball's position (the arm
+		// message carries no data).  It should cover wherever the ball can fly through.
+		static std::vector<float> kCamera2ImageRoi;
+
+		// Converts kCamera2ImageRoi into pixels for an image of the given size.  Returns an
+		// empty rectangle if the whole image should be sent.
+		static cv::Rect GetCamera2ImageRoi(const cv::Size& image_size);
 
 		static cv::Mat last_received_image_;
 		static std::mutex last_received_image_mutex_;
@@ -7,6 +7,7 @@
 #ifdef __unix__  // Ignore in Windows environment
 
 #include "utils/logging_tools.h"
+#include "utils/artifact_writer.h"
 
 #include "gs_ipc_result.h"
 #include "gs_options.h"
@@ -14,6 +15,7 @@
 #include "gs_ui_system.h"
 #include "sim/common/gs_sim_interface.h"
 #include "gs_camera.h"
+#include "latency_tracer.h"
 
 namespace golf_sim {
 
@@ -25,6 +27,16 @@ namespace golf_sim {
     std::string GsUISystem::kWebServerErrorExposuresImage;
     std::string GsUISystem::kWebServerBallSearchAreaImage;
 
+    // The result images are written in the background, so give them a chance to be
+    // on disk before the GUI is told to show them
+    static constexpr unsigned int kWebServerImageFlushTimeoutMs = 2000;
+
+    static void FlushWebserverImages() {
+        if (!ArtifactWriter::GetSharedWriter().Flush(ArtifactWriter::Priority::kWebserver, kWebServerImageFlushTimeoutMs)) {
+            GS_LOG_MSG(warning, "Webserver images were not all written within " + std::to_string(kWebServerImageFlushTimeoutMs) + "ms.");
+        }
+    }
+
 
     void GsUISystem::SendIPCErrorStatusMessage(const std::string& error_message) {
 
@@ -47,6 +59,8 @@ namespace golf_sim {
 
         GS_LOG_TRACE_MSG(trace, "FSM is sending an Error-Type IPC Results Message:" + error_result.Format());
 
+        FlushWebserverImages();
+
         GolfSimIpcSystem::SendIpcMessage(ipc_message);
     }
 
@@ -116,6 +130,22 @@ namespace golf_sim {
         return true;
     }
 
+    void GsUISystem::SendIPCLatencyStatisticsMessage() {
+
+        GolfSimIPCMessage ipc_message(GolfSimIPCMessage::IPCMessageType::kResults);
+        GsIPCResult& results = ipc_message.GetResultsForModification();
+
+        results.club_type_ = GolfSimClubs::GetCurrentClubType();
+        results.result_type_ = GsIPCResultType::kControlMessage;
+        results.message_ = "Frame-to-trigger latency statistics";
+        results.log_messages_ = LatencyTracer::GetSharedTracer().FormatStatistics();
+        results.log_messages_.push_back(ArtifactWriter::GetSharedWriter().FormatStatistics());
+
+        GS_LOG_TRACE_MSG(trace, "Sending latency statistics IPC Results Message: " + results.Format());
+
+        GolfSimIpcSystem::SendIpcMessage(ipc_message);
+    }
+
     void GsUISystem::SendIPCHitMessage(const GolfBall& result_ball, const std::string& secondary_message) {
         GolfSimIPCMessage ipc_message(GolfSimIPCMessage::IPCMessageType::kResults);
 
@@ -146,6 +176,9 @@ namespace golf_sim {
             + ", (Descent Angle-NA), (Apex-NA), (Flight Time-NA), (Type-NA)"
             );
 
+        FlushWebserverImages();
+        GS_LOG_TRACE_MSG(trace, ArtifactWriter::GetSharedWriter().FormatStatistics());
+
         GolfSimIpcSystem::SendIpcMessage(ipc_message);
     }
 
@@ -184,17 +217,9 @@ namespace golf_sim {
         // The kWebServerShareDirectory is already setup to have a trailing "/"
         std::string fname = kWebServerShareDirectory + file_name;
 
-        try {
-            if (cv::imwrite(fname, img)) {
-                GS_LOG_TRACE_MSG(trace, "Logged image to file: " + fname);
-            }
-            else {
-                GS_LOG_MSG(warning, "GsUISystem::SaveWebserverImage - could not save to file name: " + fname);
-            }
-        }
-        catch (std::exception& ex) {
-            GS_LOG_TRACE_MSG(warning, "Exception! - failed to imwrite with fname = " + fname);
-        }
+        // The caller may keep using img, so the writer gets its own copy
+        cv::Mat webserver_image = img.clone();
+        ArtifactWriter::GetSharedWriter().Submit(fname, std::move(webserver_image), ArtifactWriter::Priority::kWebserver);
 
         return true;
     }
@@ -39,6 +39,10 @@ namespace golf_sim {
 
         static void SendIPCHitMessage(const GolfBall& result_ball, const std::string& secondary_message = "");
 
+        // Sends the p50/p95/p99 frame-to-trigger latencies from the LatencyTracer, one
+        // interval per log message, as a kControlMessage-type result
+        static void SendIPCLatencyStatisticsMessage();
+
         // Save the image into the shared web-server directory so that the web-based 
         // golf-sim user interface can access it.  
         // Also save a uniquely-named copy to the usual images directory unless suppressed.
@@ -0,0 +1,368 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+
+#include "hough_circle_engine.h"
+
+
+namespace golf_sim {
+
+    // An edge point only supports a circle if its gradient is within about 25 degrees of
+    // pointing at (or away from) the circle's center
+    static constexpr float kMinGradientAlignment = 0.9F;
+
+    bool HoughCircleEngine::Compute(const cv::Mat& gray_image, const Settings& settings) {
+        CV_Assert(gray_image.empty() || gray_image.type() == CV_8UC1);
+
+        settings_ = settings;
+        settings_.dp = std::max(0.5, settings.dp);
+        settings_.min_radius = std::max(1, settings.min_radius);
+        settings_.max_radius = std::max(settings_.min_radius, settings.max_radius);
+
+        edge_points_.clear();
+        row_starts_.assign(gray_image.rows + 1, 0);
+        accumulator_.release();
+        candidates_.clear();
+
+        if (gray_image.empty()) {
+            return false;
+        }
+
+        // The gradients are computed once, and the Canny edges are found from those same gradients
+        cv::Mat dx;
+        cv::Mat dy;
+
+        if (settings_.use_scharr) {
+            cv::Scharr(gray_image, dx, CV_16S, 1, 0);
+            cv::Scharr(gray_image, dy, CV_16S, 0, 1);
+        }
+        else {
+            cv::Sobel(gray_image, dx, CV_16S, 1, 0, 3);
+            cv::Sobel(gray_image, dy, CV_16S, 0, 1, 3);
+        }
+
+        const double canny_threshold = std::max(1.0, settings_.canny_threshold);
+
+        cv::Mat edges;
+        cv::Canny(dx, dy, edges, std::max(1.0, canny_threshold / 2.0), canny_threshold, false);
+
+        for (int y = 0; y < edges.rows; y++) {
+            row_starts_[y] = (int)edge_points_.size();
+
+            const uchar* edge_row = edges.ptr<uchar>(y);
+            const short* dx_row = dx.ptr<short>(y);
+            const short* dy_row = dy.ptr<short>(y);
+
+            for (int x = 0; x < edges.cols; x++) {
+                if (edge_row[x] == 0) {
+                    continue;
+                }
+
+                const float gx = dx_row[x];
+                const float gy = dy_row[x];
+                const float magnitude = std::sqrt(gx * gx + gy * gy);
+
+                if (magnitude <= 0.0F) {
+                    continue;
+                }
+
+                edge_points_.push_back({ (float)x, (float)y, gx / magnitude, gy / magnitude });
+            }
+        }
+
+        row_starts_[edges.rows] = (int)edge_points_.size();
+
+        if (edge_points_.empty()) {
+            return false;
+        }
+
+        BuildAccumulator(gray_image.size());
+        FindCandidates();
+
+        return !candidates_.empty();
+    }
+
+    void HoughCircleEngine::BuildAccumulator(const cv::Size& image_size) {
+        const double inverse_dp = 1.0 / settings_.dp;
+        const int accumulator_cols = (int)std::ceil(image_size.width * inverse_dp) + 1;
+        const int accumulator_rows = (int)std::ceil(image_size.height * inverse_dp) + 1;
+
+        accumulator_ = cv::Mat::zeros(accumulator_rows, accumulator_cols, CV_32SC1);
+        int* votes = accumulator_.ptr<int>();
+
+        const float scale = (float)inverse_dp;
+        // One accumulator cell per step
+        const float step = (float)settings_.dp;
+        const float min_radius = (float)settings_.min_radius;
+        const float max_radius = (float)settings_.max_radius;
+
+        for (const EdgePoint& point : edge_points_) {
+            // The center may be on either side of the edge, depending on whether the
+            // ball is lighter or darker than what is around it
+            for (const float sign : { 1.0F, -1.0F }) {
+                const float ux = sign * point.gx;
+                const float uy = sign * point.gy;
+
+                for (float radius = min_radius; radius <= max_radius; radius += step) {
+                    // Pixel centers are at x + 0.5 in accumulator space
+                    const float ax = (point.x + 0.5F + ux * radius) * scale;
+                    const float ay = (point.y + 0.5F + uy * radius) * scale;
+
+                    // Once the ray leaves the accumulator, it doesn't come back
+                    if (ax < 0.0F || ay < 0.0F || ax >= accumulator_cols || ay >= accumulator_rows) {
+                        break;
+                    }
+
+                    votes[(int)ay * accumulator_cols + (int)ax]++;
+                }
+            }
+        }
+    }
+
+    void HoughCircleEngine::FindCandidates() {
+
+        struct Peak {
+            int votes;
+            int x;
+            int y;
+        };
+
+        std::vector<Peak> peaks;
+
+        for (int y = 1; y < accumulator_.rows - 1; y++) {
+            const int* above = accumulator_.ptr<int>(y - 1);
+            const int* row = accumulator_.ptr<int>(y);
+            const int* below = accumulator_.ptr<int>(y + 1);
+
+            for (int x = 1; x < accumulator_.cols - 1; x++) {
+                const int v = row[x];
+
+                if (v < settings_.min_center_votes) {
+                    continue;
+                }
+
+                // Strictly greater on one side, so that a plateau produces a single peak
+                if (v > row[x - 1] && v >= row[x + 1] &&
+                    v > above[x - 1] && v > above[x] && v > above[x + 1] &&
+                    v >= below[x - 1] && v >= below[x] && v >= below[x + 1]) {
+                    peaks.push_back({ v, x, y });
+                }
+            }
+        }
+
+        std::stable_sort(peaks.begin(), peaks.end(), [](const Peak& a, const Peak& b) { return a.votes > b.votes; });
+
+        if ((int)peaks.size() > settings_.max_candidates) {
+            peaks.resize(std::max(0, settings_.max_candidates));
+        }
+
+        candidates_.reserve(peaks.size());
+
+        for (const Peak& peak : peaks) {
+            // Refine the center to better than the accumulator's resolution
+            double weight_sum = 0.0;
+            double weighted_x = 0.0;
+            double weighted_y = 0.0;
+
+            for (int dy = -1; dy <= 1; dy++) {
+                const int* row = accumulator_.ptr<int>(peak.y + dy);
+
+                for (int dx = -1; dx <= 1; dx++) {
+                    const double weight = row[peak.x + dx];
+                    weight_sum += weight;
+                    weighted_x += weight * (peak.x + dx + 0.5);
+                    weighted_y += weight * (peak.y + dy + 0.5);
+                }
+            }
+
+            Candidate candidate;
+            candidate.votes = peak.votes;
+            candidate.center = cv::Point2f((float)(weighted_x / weight_sum * settings_.dp - 0.5),
+                                           (float)(weighted_y / weight_sum * settings_.dp - 0.5));
+
+            MeasureCandidate(candidate);
+            candidates_.push_back(std::move(candidate));
+        }
+    }
+
+    void HoughCircleEngine::MeasureCandidate(Candidate& candidate) const {
+        const int number_of_radii = settings_.max_radius - settings_.min_radius + 1;
+
+        candidate.radius_counts.assign(number_of_radii, 0);
+        candidate.radius_angle_bins.assign(number_of_radii, 0);
+
+        const float cx = candidate.center.x;
+        const float cy = candidate.center.y;
+        const float outer = settings_.max_radius + 0.5F;
+        const float inner = std::max(0.0F, settings_.min_radius - 0.5F);
+        const float outer_squared = outer * outer;
+        const float inner_squared = inner * inner;
+        const float bins_per_radian = (float)(kNumberAngleBins / (2.0 * CV_PI));
+
+        const int number_of_rows = (int)row_starts_.size() - 1;
+        const int first_row = std::max(0, (int)std::floor(cy - outer));
+        const int last_row = std::min(number_of_rows - 1, (int)std::ceil(cy + outer));
+
+        for (int y = first_row; y <= last_row; y++) {
+            const auto row_begin = edge_points_.begin() + row_starts_[y];
+            const auto row_end = edge_points_.begin() + row_starts_[y + 1];
+
+            // Each row is in x order
+            auto it = std::lower_bound(row_begin, row_end, cx - outer,
+                                       [](const EdgePoint& point, float x) { return point.x < x; });
+
+            for (; it != row_end && it->x <= cx + outer; ++it) {
+                const float dx = it->x - cx;
+                const float dy = it->y - cy;
+                const float distance_squared = dx * dx + dy * dy;
+
+                if (distance_squared < inner_squared || distance_squared > outer_squared) {
+                    continue;
+                }
+
+                const float distance = std::sqrt(distance_squared);
+
+                if (distance <= 0.0F || std::abs(it->gx * dx + it->gy * dy) < kMinGradientAlignment * distance) {
+                    continue;
+                }
+
+                const int index = (int)std::lround(distance) - settings_.min_radius;
+
+                if (index < 0 || index >= number_of_radii) {
+                    continue;
+                }
+
+                const int bin = std::min(kNumberAngleBins - 1, (int)((std::atan2(dy, dx) + (float)CV_PI) * bins_per_radian));
+
+                candidate.radius_counts[index]++;
+                candidate.radius_angle_bins[index] |= (uint64_t)1 << bin;
+            }
+        }
+    }
+
+    bool HoughCircleEngine::ScoreCandidate(const Candidate& candidate, const Query& query, int min_radius, int max_radius,
+                                           float& radius, double& score) const {
+        const int last_index = (int)candidate.radius_counts.size() - 1;
+
+        int band_votes = 0;
+
+        for (int r = min_radius; r <= max_radius; r++) {
+            band_votes += candidate.radius_counts[r - settings_.min_radius];
+        }
+
+        if (band_votes == 0) {
+            return false;
+        }
+
+        // The best radius has the most complete perimeter (or the most edge points), allowing
+        // for a pixel of error either way
+        double best_support = -1.0;
+        int best_count = -1;
+        int best_low = 0;
+        int best_high = 0;
+
+        for (int r = min_radius; r <= max_radius; r++) {
+            const int index = r - settings_.min_radius;
+            const int low = std::max(0, index - 1);
+            const int high = std::min(last_index, index + 1);
+
+            int count = 0;
+            uint64_t angle_bins = 0;
+
+            for (int i = low; i <= high; i++) {
+                count += candidate.radius_counts[i];
+                angle_bins |= candidate.radius_angle_bins[i];
+            }
+
+            const double support = (query.score == Score::kPerimeterSupport) ?
+                (double)std::popcount(angle_bins) / kNumberAngleBins : 0.0;
+
+            if (support > best_support || (support == best_support && count > best_count)) {
+                best_support = support;
+                best_count = count;
+                best_low = low;
+                best_high = high;
+            }
+        }
+
+        if (best_count <= 0) {
+            return false;
+        }
+
+        double weighted_radius = 0.0;
+
+        for (int i = best_low; i <= best_high; i++) {
+            weighted_radius += (double)candidate.radius_counts[i] * (i + settings_.min_radius);
+        }
+
+        radius = (float)(weighted_radius / best_count);
+        score = (query.score == Score::kPerimeterSupport) ? best_support : (double)band_votes;
+
+        return true;
+    }
+
+    std::vector<GsCircle> HoughCircleEngine::GetCircles(const Query& query) const {
+
+        const int min_radius = (query.min_radius > 0) ? std::max(query.min_radius, settings_.min_radius) : settings_.min_radius;
+        const int max_radius = (query.max_radius > 0) ? std::min(query.max_radius, settings_.max_radius) : settings_.max_radius;
+
+        if (candidates_.empty() || min_radius > max_radius) {
+            return {};
+        }
+
+        struct ScoredCircle {
+            GsCircle circle;
+            double score;
+            int votes;
+        };
+
+        std::vector<ScoredCircle> scored_circles;
+
+        for (const Candidate& candidate : candidates_) {
+            float radius = 0.0F;
+            double score = 0.0;
+
+            if (!ScoreCandidate(candidate, query, min_radius, max_radius, radius, score) || score < query.threshold) {
+                continue;
+            }
+
+            scored_circles.push_back({ GsCircle(candidate.center.x, candidate.center.y, radius), score, candidate.votes });
+        }
+
+        std::stable_sort(scored_circles.begin(), scored_circles.end(), [](const ScoredCircle& a, const ScoredCircle& b) {
+            return (a.score > b.score) || (a.score == b.score && a.votes > b.votes);
+        });
+
+        // Strongest-first, so a stricter threshold never brings back a circle that a looser one suppressed
+        const double min_distance_squared = query.min_distance * query.min_distance;
+        std::vector<GsCircle> circles;
+
+        for (const ScoredCircle& scored : scored_circles) {
+            bool too_close = false;
+
+            for (const GsCircle& kept : circles) {
+                const double dx = kept[0] - scored.circle[0];
+                const double dy = kept[1] - scored.circle[1];
+
+                if (dx * dx + dy * dy < min_distance_squared) {
+                    too_close = true;
+                    break;
+                }
+            }
+
+            if (!too_close) {
+                circles.push_back(scored.circle);
+            }
+        }
+
+        return circles;
+    }
+
+}
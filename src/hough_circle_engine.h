@@ -0,0 +1,142 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// A Hough circle search that does the expensive work only once per image.
+//
+// cv::HoughCircles recomputes the image gradients, the Canny edges and the center
+// accumulator every time it is called.  GetBall calls it repeatedly on the same image,
+// tightening or loosening param2 (and sometimes narrowing the radius range) until the
+// number of circles is reasonable, so most of that work is repeated.
+//
+// Compute() does that work once, for the widest radius range that will be searched:
+//
+//  - the gradients (Scharr, as HOUGH_GRADIENT_ALT uses, or 3x3 Sobel, as HOUGH_GRADIENT uses)
+//    and the Canny edges from those same gradients,
+//  - the center accumulator, where each edge point votes along its gradient direction, and
+//  - for each local maximum of the accumulator (a candidate center), a histogram of how many
+//    edge points at each radius have a gradient that points at the center, and which parts of
+//    the circle's perimeter those edge points cover.
+//
+// GetCircles() then extracts the circles for any vote threshold and any radius band within
+// that range from the candidates, without touching the image again.  Because the candidates
+// are always considered strongest-first, the circles for a stricter threshold are always a
+// subset of the circles for a looser one.
+//
+// The thresholds mean roughly what param2 means for cv::HoughCircles (either a vote count,
+// or, as with HOUGH_GRADIENT_ALT, how complete the circle is from 0 to 1), but the results
+// are not identical.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "gs_globals.h"
+
+
+namespace golf_sim {
+
+class HoughCircleEngine {
+public:
+
+    enum class Score {
+        // The number of edge points in the radius band whose gradient points at the center,
+        // i.e., the center's accumulator votes from that band (like HOUGH_GRADIENT's param2)
+        kCenterVotes,
+
+        // The fraction (0 to 1) of the circle's perimeter that has such edge points at the
+        // circle's radius (like HOUGH_GRADIENT_ALT's param2)
+        kPerimeterSupport
+    };
+
+    struct Settings {
+        // Inverse ratio of the accumulator resolution to the image resolution
+        double dp = 1.5;
+
+        // The higher Canny threshold (param1).  The lower threshold is half of it.
+        double canny_threshold = 100.0;
+
+        // Scharr gradients, as HOUGH_GRADIENT_ALT uses (and param1 values are tuned for).
+        // Otherwise, 3x3 Sobel gradients, as HOUGH_GRADIENT uses.
+        bool use_scharr = true;
+
+        // The widest radius range (in pixels) that GetCircles will be asked for
+        int min_radius = 10;
+        int max_radius = 100;
+
+        // Accumulator maxima with fewer votes than this are not kept as candidates at all
+        int min_center_votes = 6;
+
+        // Only this many of the strongest candidate centers are kept
+        int max_candidates = 400;
+    };
+
+    struct Query {
+        Score score = Score::kPerimeterSupport;
+        double threshold = 0.8;
+
+        // The radius band to search.  0 means the corresponding limit from the Settings.
+        int min_radius = 0;
+        int max_radius = 0;
+
+        // Circles whose centers are closer than this to a stronger circle are dropped
+        double min_distance = 1.0;
+    };
+
+    // gray_image must be CV_8UC1.  Returns false if there is nothing to search.
+    bool Compute(const cv::Mat& gray_image, const Settings& settings);
+
+    // The circles (x, y, radius) that meet the query, strongest first
+    std::vector<GsCircle> GetCircles(const Query& query) const;
+
+    int number_of_edge_points() const { return (int)edge_points_.size(); }
+    int number_of_candidates() const { return (int)candidates_.size(); }
+
+    const Settings& settings() const { return settings_; }
+
+private:
+
+    // The perimeter of each candidate circle is split into this many angular bins
+    static constexpr int kNumberAngleBins = 64;
+
+    struct EdgePoint {
+        float x;
+        float y;
+        // Unit gradient direction
+        float gx;
+        float gy;
+    };
+
+    struct Candidate {
+        cv::Point2f center;
+        int votes = 0;
+
+        // Indexed by radius - settings_.min_radius
+        std::vector<int> radius_counts;
+        std::vector<uint64_t> radius_angle_bins;
+    };
+
+    void BuildAccumulator(const cv::Size& image_size);
+    void FindCandidates();
+    void MeasureCandidate(Candidate& candidate) const;
+
+    // Best radius within [min_radius, max_radius] for the candidate, and its score
+    bool ScoreCandidate(const Candidate& candidate, const Query& query, int min_radius, int max_radius,
+                        float& radius, double& score) const;
+
+    Settings settings_;
+
+    std::vector<EdgePoint> edge_points_;
+
+    // edge_points_ are in row order, and those of image row y start at row_starts_[y]
+    std::vector<int> row_starts_;
+
+    cv::Mat accumulator_;
+    std::vector<Candidate> candidates_;
+};
+
+}
@@ -0,0 +1,328 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+#ifdef __unix__
+#include <time.h>
+#endif
+
+#include "utils/logging_tools.h"
+
+#include "latency_tracer.h"
+
+
+namespace golf_sim {
+
+    LatencyHistogram::LatencyHistogram() {
+        Reset();
+    }
+
+    int LatencyHistogram::BucketIndex(uint64_t duration_ns) {
+        if (duration_ns < (uint64_t)kSubBucketsPerPowerOfTwo) {
+            return (int)duration_ns;
+        }
+
+        // The top 3 bits below the most significant bit pick the sub-bucket
+        int msb = 63;
+        while ((duration_ns >> msb) == 0) {
+            msb--;
+        }
+
+        const int shift = msb - 3;
+        const int sub_bucket = (int)((duration_ns >> shift) & (kSubBucketsPerPowerOfTwo - 1));
+
+        return (msb - 2) * kSubBucketsPerPowerOfTwo + sub_bucket;
+    }
+
+    uint64_t LatencyHistogram::BucketUpperBound(int bucket_index) {
+        if (bucket_index < kSubBucketsPerPowerOfTwo) {
+            return (uint64_t)bucket_index;
+        }
+
+        const int msb = bucket_index / kSubBucketsPerPowerOfTwo + 2;
+        const int sub_bucket = bucket_index % kSubBucketsPerPowerOfTwo;
+        const int shift = msb - 3;
+
+        const uint64_t lower_bound = (uint64_t)(kSubBucketsPerPowerOfTwo + sub_bucket) << shift;
+        return lower_bound + (((uint64_t)1 << shift) - 1);
+    }
+
+    void LatencyHistogram::Add(int64_t duration_ns) {
+        if (duration_ns < 0) {
+            duration_ns = 0;
+        }
+
+        buckets_[BucketIndex((uint64_t)duration_ns)].fetch_add(1, std::memory_order_relaxed);
+        sum_ns_.fetch_add((uint64_t)duration_ns, std::memory_order_relaxed);
+
+        int64_t current_min = min_ns_.load(std::memory_order_relaxed);
+        while (duration_ns < current_min &&
+               !min_ns_.compare_exchange_weak(current_min, duration_ns, std::memory_order_relaxed)) {
+        }
+
+        int64_t current_max = max_ns_.load(std::memory_order_relaxed);
+        while (duration_ns > current_max &&
+               !max_ns_.compare_exchange_weak(current_max, duration_ns, std::memory_order_relaxed)) {
+        }
+
+        // Last, so that a reader that sees the count also (nearly always) sees the bucket
+        count_.fetch_add(1, std::memory_order_release);
+    }
+
+    int64_t LatencyHistogram::min_ns() const {
+        return (count() == 0) ? 0 : min_ns_.load(std::memory_order_relaxed);
+    }
+
+    int64_t LatencyHistogram::max_ns() const {
+        return (count() == 0) ? 0 : max_ns_.load(std::memory_order_relaxed);
+    }
+
+    double LatencyHistogram::mean_ns() const {
+        const uint64_t n = count();
+        return (n == 0) ? 0.0 : (double)sum_ns_.load(std::memory_order_relaxed) / n;
+    }
+
+    int64_t LatencyHistogram::Percentile(double fraction) const {
+        // Work from a snapshot of the buckets, in case samples are being added meanwhile
+        std::array<uint64_t, kNumBuckets> counts;
+        uint64_t total = 0;
+
+        for (int i = 0; i < kNumBuckets; i++) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+
+        if (total == 0) {
+            return 0;
+        }
+
+        fraction = std::clamp(fraction, 0.0, 1.0);
+        const uint64_t rank = std::max<uint64_t>(1, (uint64_t)(fraction * total + 0.5));
+
+        uint64_t seen = 0;
+        for (int i = 0; i < kNumBuckets; i++) {
+            seen += counts[i];
+
+            if (seen >= rank) {
+                // The bucket bound can't be more than the largest sample seen
+                return std::min((int64_t)BucketUpperBound(i), max_ns_.load(std::memory_order_relaxed));
+            }
+        }
+
+        return max_ns_.load(std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::Reset() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+
+        count_.store(0, std::memory_order_relaxed);
+        sum_ns_.store(0, std::memory_order_relaxed);
+        min_ns_.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+        max_ns_.store(0, std::memory_order_relaxed);
+    }
+
+
+    LatencyTracer& LatencyTracer::GetSharedTracer() {
+        static LatencyTracer shared_tracer;
+        return shared_tracer;
+    }
+
+    int64_t LatencyTracer::NowNs() {
+#ifdef __unix__
+        struct timespec now;
+        clock_gettime(CLOCK_BOOTTIME, &now);
+        return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    LatencyTracer::LatencyTracer() {
+        Reset();
+    }
+
+    void LatencyTracer::Record(uint64_t frame_sequence, Event event, int64_t timestamp_ns) {
+        if (event >= Event::kNumEvents) {
+            return;
+        }
+
+        // Raw event ring.  The version lets a reader skip a slot that is being overwritten.
+        const uint64_t record_number = next_record_.fetch_add(1, std::memory_order_relaxed);
+        RingSlot& slot = ring_[record_number % kRingSize];
+
+        slot.version.store(2 * record_number + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.frame_sequence.store(frame_sequence, std::memory_order_relaxed);
+        slot.event.store((uint8_t)event, std::memory_order_relaxed);
+        slot.timestamp_ns.store(timestamp_ns, std::memory_order_relaxed);
+        slot.version.store(2 * record_number + 2, std::memory_order_release);
+
+        // Per-frame intervals
+        FrameTimes& frame = frames_[frame_sequence % kFrameSlots];
+        const uint64_t tag = frame_sequence + 1;
+
+        if (frame.tag.load(std::memory_order_acquire) != tag) {
+            if (event != Event::kSensorTimestamp && event != Event::kRequestCompleted) {
+                // The start of this frame was not seen (or has already been overwritten)
+                return;
+            }
+
+            for (auto& t : frame.timestamps_ns) {
+                t.store(kNoTime, std::memory_order_relaxed);
+            }
+            frame.tag.store(tag, std::memory_order_release);
+        }
+
+        frame.timestamps_ns[(size_t)event].store(timestamp_ns, std::memory_order_relaxed);
+
+        auto earlier = [&frame](Event e) { return frame.timestamps_ns[(size_t)e].load(std::memory_order_relaxed); };
+
+        switch (event) {
+        case Event::kRequestCompleted:
+            AddInterval(Interval::kSensorToRequest, earlier(Event::kSensorTimestamp), timestamp_ns);
+            break;
+
+        case Event::kMotionDecision:
+            AddInterval(Interval::kRequestToMotionDecision, earlier(Event::kRequestCompleted), timestamp_ns);
+            break;
+
+        case Event::kTriggerSent:
+            AddInterval(Interval::kMotionDecisionToTrigger, earlier(Event::kMotionDecision), timestamp_ns);
+            AddInterval(Interval::kRequestToTrigger, earlier(Event::kRequestCompleted), timestamp_ns);
+            AddInterval(Interval::kSensorToTrigger, earlier(Event::kSensorTimestamp), timestamp_ns);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void LatencyTracer::AddInterval(Interval interval, int64_t start_ns, int64_t end_ns) {
+        if (start_ns == kNoTime) {
+            return;
+        }
+
+        histograms_[(int)interval].Add(end_ns - start_ns);
+    }
+
+    std::vector<LatencyTracer::EventRecord> LatencyTracer::GetRecentEvents() const {
+        std::vector<EventRecord> events;
+
+        const uint64_t end = next_record_.load(std::memory_order_acquire);
+        const uint64_t begin = (end > kRingSize) ? end - kRingSize : 0;
+
+        events.reserve((size_t)(end - begin));
+
+        for (uint64_t record_number = begin; record_number < end; record_number++) {
+            const RingSlot& slot = ring_[record_number % kRingSize];
+            const uint64_t expected_version = 2 * record_number + 2;
+
+            if (slot.version.load(std::memory_order_acquire) != expected_version) {
+                continue;  // Still being written, or already overwritten by a newer record
+            }
+
+            EventRecord record;
+            record.frame_sequence = slot.frame_sequence.load(std::memory_order_relaxed);
+            record.event = (Event)slot.event.load(std::memory_order_relaxed);
+            record.timestamp_ns = slot.timestamp_ns.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) != expected_version) {
+                continue;
+            }
+
+            events.push_back(record);
+        }
+
+        return events;
+    }
+
+    std::vector<std::string> LatencyTracer::FormatStatistics() const {
+        std::vector<std::string> lines;
+
+        auto us = [](int64_t ns) { return (double)ns / 1000.0; };
+
+        for (int i = 0; i < (int)Interval::kNumIntervals; i++) {
+            const LatencyHistogram& histogram = histograms_[i];
+
+            if (histogram.count() == 0) {
+                continue;
+            }
+
+            char line[256];
+            snprintf(line, sizeof(line), "%s: n=%llu p50=%.1fus p95=%.1fus p99=%.1fus max=%.1fus",
+                     IntervalName((Interval)i), (unsigned long long)histogram.count(),
+                     us(histogram.Percentile(0.50)), us(histogram.Percentile(0.95)),
+                     us(histogram.Percentile(0.99)), us(histogram.max_ns()));
+            lines.push_back(line);
+        }
+
+        if (lines.empty()) {
+            lines.push_back("No latency samples have been recorded yet.");
+        }
+
+        return lines;
+    }
+
+    void LatencyTracer::DumpToLog() const {
+        GS_LOG_MSG(info, "Frame-to-trigger latency statistics:");
+
+        for (const std::string& line : FormatStatistics()) {
+            GS_LOG_MSG(info, "    " + line);
+        }
+
+        for (const EventRecord& record : GetRecentEvents()) {
+            GS_LOG_TRACE_MSG(trace, "    Frame " + std::to_string(record.frame_sequence) + " " + EventName(record.event) +
+                                    " at " + std::to_string(record.timestamp_ns) + " ns");
+        }
+    }
+
+    void LatencyTracer::Reset() {
+        for (auto& histogram : histograms_) {
+            histogram.Reset();
+        }
+
+        for (auto& frame : frames_) {
+            frame.tag.store(0, std::memory_order_relaxed);
+            for (auto& t : frame.timestamps_ns) {
+                t.store(kNoTime, std::memory_order_relaxed);
+            }
+        }
+
+        for (auto& slot : ring_) {
+            slot.version.store(0, std::memory_order_relaxed);
+        }
+
+        next_record_.store(0, std::memory_order_release);
+    }
+
+    const char* LatencyTracer::IntervalName(Interval interval) {
+        switch (interval) {
+        case Interval::kSensorToRequest:            return "sensor -> request completed";
+        case Interval::kRequestToMotionDecision:    return "request -> motion decision";
+        case Interval::kMotionDecisionToTrigger:    return "motion decision -> trigger sent";
+        case Interval::kRequestToTrigger:           return "request -> trigger sent";
+        case Interval::kSensorToTrigger:            return "sensor -> trigger sent";
+        default:                                    return "unknown";
+        }
+    }
+
+    const char* LatencyTracer::EventName(Event event) {
+        switch (event) {
+        case Event::kSensorTimestamp:   return "sensor timestamp";
+        case Event::kRequestCompleted:  return "request completed";
+        case Event::kMotionDecision:    return "motion decision";
+        case Event::kTriggerSent:       return "trigger sent";
+        default:                        return "unknown";
+        }
+    }
+
+}
@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Timestamps the path from a camera 1 frame to the camera 2 / strobe trigger:
+//
+//   sensor exposure -> request completed (RPiCamApp::requestComplete) ->
+//   motion decision (MotionDetectStage) -> SendExternalTrigger returned
+//
+// Recording an event is a clock read and a handful of relaxed atomic operations,
+// with no locks or allocation, so it is cheap enough for every frame of the
+// high-speed watching loop.  Each event goes into a fixed-size ring of recent
+// records, and the time since the frame's previous events is added to one
+// histogram per interval.  The histograms keep accumulating across shots so that
+// the p50 / p95 / p99 latencies can be used to tune frame_period, hskip/vskip and
+// the ROI size.  See GsUISystem::SendIPCLatencyStatisticsMessage for publishing.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace golf_sim {
+
+// Log-linear histogram of nanosecond durations.  Each power of two is split into
+// 8 buckets, so any percentile is within 12.5% of the real value.  All methods
+// may be called concurrently.
+class LatencyHistogram {
+public:
+
+    static constexpr int kSubBucketsPerPowerOfTwo = 8;
+    static constexpr int kNumBuckets = 62 * kSubBucketsPerPowerOfTwo;
+
+    LatencyHistogram();
+
+    // Negative durations (e.g., from a sensor clock that is a little ahead) count as 0
+    void Add(int64_t duration_ns);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    int64_t min_ns() const;
+    int64_t max_ns() const;
+    double mean_ns() const;
+
+    // Returns the upper bound of the bucket holding the given fraction (e.g., 0.95)
+    // of the samples, or 0 if there are none
+    int64_t Percentile(double fraction) const;
+
+    void Reset();
+
+    static int BucketIndex(uint64_t duration_ns);
+    static uint64_t BucketUpperBound(int bucket_index);
+
+private:
+    std::array<std::atomic<uint64_t>, kNumBuckets> buckets_;
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> sum_ns_{ 0 };
+    std::atomic<int64_t> min_ns_;
+    std::atomic<int64_t> max_ns_;
+};
+
+
+class LatencyTracer {
+public:
+
+    // In the order they happen to a frame
+    enum class Event : uint8_t {
+        kSensorTimestamp = 0,   // Start of exposure, from the libcamera SensorTimestamp metadata
+        kRequestCompleted = 1,  // libcamera completed the request, before any post-processing
+        kMotionDecision = 2,    // MotionDetectStage finished comparing the frame
+        kTriggerSent = 3,       // PulseStrobe::SendExternalTrigger returned
+        kNumEvents = 4
+    };
+
+    enum class Interval {
+        kSensorToRequest = 0,
+        kRequestToMotionDecision = 1,
+        kMotionDecisionToTrigger = 2,
+        kRequestToTrigger = 3,
+        kSensorToTrigger = 4,
+        kNumIntervals = 5
+    };
+
+    struct EventRecord {
+        uint64_t frame_sequence = 0;
+        Event event = Event::kSensorTimestamp;
+        int64_t timestamp_ns = 0;
+    };
+
+    // Number of raw events that are kept, i.e., several hundred frames
+    static constexpr size_t kRingSize = 4096;
+
+    // Process-wide tracer used by the camera app and the motion-detect stage
+    static LatencyTracer& GetSharedTracer();
+
+    // The clock that libcamera's SensorTimestamp uses (CLOCK_BOOTTIME), in nanoseconds
+    static int64_t NowNs();
+
+    LatencyTracer();
+
+    // Records that the event happened to the frame with the given (camera request) sequence
+    // number.  A frame's kSensorTimestamp or kRequestCompleted event must come first.
+    // Different frames may be recorded from different threads at the same time.
+    void Record(uint64_t frame_sequence, Event event, int64_t timestamp_ns = NowNs());
+
+    const LatencyHistogram& GetHistogram(Interval interval) const { return histograms_[(int)interval]; }
+
+    // Returns up to kRingSize of the most recent events, oldest first
+    std::vector<EventRecord> GetRecentEvents() const;
+
+    // One line per interval with samples, e.g.,
+    // "request -> motion decision: n=1200 p50=41.0us p95=57.0us p99=65.0us max=103.2us"
+    std::vector<std::string> FormatStatistics() const;
+
+    // Writes the statistics to the log at info level, and the recent events at trace level
+    void DumpToLog() const;
+
+    void Reset();
+
+    static const char* IntervalName(Interval interval);
+    static const char* EventName(Event event);
+
+private:
+
+    static constexpr int64_t kNoTime = INT64_MIN;
+    static constexpr size_t kFrameSlots = 256;
+
+    // The events seen so far for one frame.  Indexed by frame sequence number.
+    struct FrameTimes {
+        // frame sequence + 1, so that 0 means unused
+        std::atomic<uint64_t> tag{ 0 };
+        std::array<std::atomic<int64_t>, (size_t)Event::kNumEvents> timestamps_ns;
+    };
+
+    struct RingSlot {
+        // Odd while the slot is being written.  2 * (record number + 1) once it's complete.
+        std::atomic<uint64_t> version{ 0 };
+        std::atomic<uint64_t> frame_sequence{ 0 };
+        std::atomic<uint8_t> event{ 0 };
+        std::atomic<int64_t> timestamp_ns{ 0 };
+    };
+
+    void AddInterval(Interval interval, int64_t start_ns, int64_t end_ns);
+
+    std::array<LatencyHistogram, (size_t)Interval::kNumIntervals> histograms_;
+    std::array<FrameTimes, kFrameSlots> frames_;
+    std::array<RingSlot, kRingSize> ring_;
+    std::atomic<uint64_t> next_record_{ 0 };
+};
+
+}
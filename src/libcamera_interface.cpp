@@ -28,14 +28,14 @@
 #include "ball_watcher_image_buffer.h"
 #include "still_image_libcamera_app.hpp"
 #include "gs_club_data.h"
+#include "latency_tracer.h"
 
 #include "image/image.hpp"
 
-#include <boost/circular_buffer.hpp>
-#include <boost/range/adaptor/reversed.hpp>
 
 #include "gs_camera.h"
 #include "camera_hardware.h"
+#include "undistort_map_cache.h"
 #include "gs_options.h"
 #include "gs_config.h"
 #include "utils/logging_tools.h"
@@ -43,6 +43,7 @@
 #include <libcamera/logging.h>
 #include "motion_detect.h"
 #include "libcamera_interface.h"
+#include "ball_placement_watcher.h"
 #include "ball_image_proc.h"
 
 
@@ -69,6 +70,8 @@ namespace golf_sim {
     long LibCameraInterface::kCamera1StillShutterTimeuS = 15000;
     long LibCameraInterface::kCamera2StillShutterTimeuS = 15000;
 
+    bool LibCameraInterface::kCamera2UsePersistentCaptureSession = true;
+
     // Default values are based on empirical measurements using a 6mm lens
     int kCroppedImagePixelOffsetLeft = -5;
     int kCroppedImagePixelOffsetUp = -13;
@@ -125,6 +128,9 @@ namespace golf_sim {
         GolfSimCamera c;
         c.camera_hardware_.init_camera_parameters(GsCameraNumber::kGsCamera1, camera_model, camera_lens_type, camera_orientation);
 
+        // The high-speed watching needs the camera to itself
+        BallPlacementWatcher::GetWatcher().Close();
+
         if (!WatchForBallMovement(c, ball, motion_detected)) {
             GS_LOG_MSG(error, "Failed to WatchForBallMovement.");
             return false;
@@ -205,13 +211,17 @@ namespace golf_sim {
         unsigned int numFramesToShow = 10;
 
         if (motion_detected) {
+            // The trigger has already gone out, so this is a good time to see how long it took
+            LatencyTracer::GetSharedTracer().DumpToLog();
+
             std::string frame_information;
             float average_frame_rate = 0.0;
             float slowest_frame_rate = 10000.0;
             float fastest_frame_rate = -10000.0;
 
-            for (auto& it : boost::adaptors::reverse(RecentFrames)) {
-                cv::Mat& mostRecentFrameMat = it.mat;
+            for (size_t i = RecentFrames.size(); i-- > 0; ) {
+                const RecentFrameInfo& it = RecentFrames[i];
+                const cv::Mat& mostRecentFrameMat = it.mat;
 
                 frame_information += "Frame " + std::to_string(frameIndex) + ": Framerate = " + std::to_string(it.frameRate) + "\n";
                 average_frame_rate += it.frameRate;
@@ -232,7 +242,9 @@ namespace golf_sim {
                 frameIndex++;
             }
 
-            average_frame_rate /= RecentFrames.size();
+            if (!RecentFrames.empty()) {
+                average_frame_rate /= RecentFrames.size();
+            }
         }
 
         return true;
@@ -704,6 +716,7 @@ bool ConfigurePostProcessing(const cv::Vec2i& roi_size, const cv::Vec2i& roi_off
     uint kFramePeriod = 0;
     uint kHSkip = 0;
     uint kVSkip = 0;
+    uint kEarlyExitRows = 1;
 
 
     GolfSimConfiguration::SetConstant("gs_config.motion_detect_stage.kDifferenceM", kDifferenceM);
@@ -713,6 +726,7 @@ bool ConfigurePostProcessing(const cv::Vec2i& roi_size, const cv::Vec2i& roi_off
     GolfSimConfiguration::SetConstant("gs_config.motion_detect_stage.kFramePeriod", kFramePeriod);
     GolfSimConfiguration::SetConstant("gs_config.motion_detect_stage.kHSkip", kHSkip);
     GolfSimConfiguration::SetConstant("gs_config.motion_detect_stage.kVSkip", kVSkip);
+    GolfSimConfiguration::SetConstant("gs_config.motion_detect_stage.kEarlyExitRows", kEarlyExitRows);
 
     GolfSimConfiguration::SetConstant("gs_config.motion_detect_stage.kCroppedImagePixelOffsetLeft", kCroppedImagePixelOffsetLeft);
     GolfSimConfiguration::SetConstant("gs_config.motion_detect_stage.kCroppedImagePixelOffsetUp", kCroppedImagePixelOffsetUp);
@@ -735,6 +749,7 @@ bool ConfigurePostProcessing(const cv::Vec2i& roi_size, const cv::Vec2i& roi_off
     MotionDetectStage::incoming_configuration.frame_period = kFramePeriod;
     MotionDetectStage::incoming_configuration.hskip = kHSkip; // TBD - don't hard code the skip factor
     MotionDetectStage::incoming_configuration.vskip = kVSkip;
+    MotionDetectStage::incoming_configuration.early_exit_rows = kEarlyExitRows;
     MotionDetectStage::incoming_configuration.verbose = 2;
     MotionDetectStage::incoming_configuration.showroi = true;
 
@@ -940,34 +955,15 @@ bool RetrieveCameraInfo(const GsCameraNumber camera_number, cv::Vec2i& resolutio
 
 
 
-cv::Mat LibCameraInterface::undistort_camera_image(const cv::Mat& img, const GolfSimCamera& camera) {
+cv::Mat LibCameraInterface::undistort_camera_image(const cv::Mat& img, const GolfSimCamera& camera, const cv::Rect& roi) {
 
     if (!camera.camera_hardware_.use_undistortion_matrix_) {
         GS_LOG_MSG(trace, "undistort_camera_image ignoring camera with no undistortion matrix. Returning original image.");
-        return img;
-    }
-
-    GsCameraNumber camera_number = camera.camera_hardware_.camera_number_;
-    CameraHardware::CameraModel camera_model = camera.camera_hardware_.camera_model_;
-
-    // Get the calibration values from the camera
-
-    cv::Mat cameracalibrationMatrix_ = camera.camera_hardware_.calibrationMatrix_;
-    cv::Mat cameraDistortionVector_ = camera.camera_hardware_.cameraDistortionVector_;
-
-    cv::Mat unDistortedBall1Img;
-    cv::Mat m_undistMap1, m_undistMap2;
-
-    if (camera.camera_hardware_.camera_is_mono()) {
-        cv::initUndistortRectifyMap(cameracalibrationMatrix_, cameraDistortionVector_, cv::Mat(), cameracalibrationMatrix_, cv::Size(img.cols, img.rows), CV_8UC1, m_undistMap1, m_undistMap2);
+        return roi.empty() ? img : img(roi & cv::Rect(0, 0, img.cols, img.rows));
     }
-    else {
-        cv::initUndistortRectifyMap(cameracalibrationMatrix_, cameraDistortionVector_, cv::Mat(), cameracalibrationMatrix_, cv::Size(img.cols, img.rows), CV_32FC1, m_undistMap1, m_undistMap2);
-    }
-
-    cv::remap(img, unDistortedBall1Img, m_undistMap1, m_undistMap2, cv::INTER_LINEAR);
 
-    return unDistortedBall1Img;
+    // The remap tables are only built the first time that this camera/resolution is seen
+    return UndistortMapCache::GetSharedCache().Undistort(img, camera.camera_hardware_, roi);
 }
 
 
@@ -1111,6 +1107,14 @@ LibcameraJpegApp* ConfigureForLibcameraStill(const GolfSimCamera& camera) {
 
     // At this point, we know that we actually have to (re)configure the camera
 
+    // A camera can't be opened twice, so let go of it if it is being kept streaming or armed
+    if (camera_number == GsCameraNumber::kGsCamera2) {
+        Camera2CaptureSession::GetSession().Close();
+    }
+    else {
+        BallPlacementWatcher::GetWatcher().Close();
+    }
+
     app = new LibcameraJpegApp;
 
     if (app == nullptr) {
@@ -1430,106 +1434,201 @@ bool CheckForBallLegacy(GolfBall& ball, cv::Mat& img) {
 
 
 // The following code is only relevant to the camera 2 system
-bool WaitForCam2Trigger(cv::Mat& return_image) {
-    LibcameraJpegApp app;
 
-    cv::Mat raw_image;
+Camera2CaptureSession& Camera2CaptureSession::GetSession() {
+    static Camera2CaptureSession session;
+    return session;
+}
+
+Camera2CaptureSession::ControlSettings Camera2CaptureSession::GetRequiredControlSettings() const {
+    ControlSettings settings;
+    settings.contrast = default_contrast_;
+
+    if (GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera2Calibrate ||
+        GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera2BallLocation ||
+        GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera2AutoCalibrate) {
+
+        settings.gain = LibCameraInterface::kCamera2CalibrateOrLocationGain;
+    }
+    else if (GolfSimClubs::GetCurrentClubType() == GolfSimClubs::kPutter) {
+        settings.gain = LibCameraInterface::kCamera2PuttingGain;
+        settings.contrast = LibCameraInterface::kCamera2PuttingContrast;
+    }
+    else {
+        if (!GolfSimOptions::GetCommandLineOptions().lm_comparison_mode_) {
+            settings.gain = LibCameraInterface::kCamera2Gain;
+        }
+        else {
+            settings.gain = LibCameraInterface::kCamera2ComparisonGain;
+        }
+
+        settings.contrast = LibCameraInterface::kCamera2Contrast;
+    }
+
+    return settings;
+}
+
+bool Camera2CaptureSession::Open() {
 
     // Create a camera just to set the resolution and for un-distort operation
     const CameraHardware::CameraModel  camera_model = GolfSimCamera::kSystemSlot2CameraType;
     const CameraHardware::LensType camera_lens_type = GolfSimCamera::kSystemSlot2LensType;
     const CameraHardware::CameraOrientation camera_orientation = GolfSimCamera::kSystemSlot2CameraOrientation;
 
+    camera_.camera_hardware_.init_camera_parameters(GsCameraNumber::kGsCamera2, camera_model, camera_lens_type, camera_orientation);
 
-    GolfSimCamera c;
-    c.camera_hardware_.init_camera_parameters(GsCameraNumber::kGsCamera2, camera_model, camera_lens_type, camera_orientation);
+    // Camera 2 can't be opened twice, so make sure it isn't still set up for a still picture
+    if (LibCameraInterface::libcamera_app_[GsCameraNumber::kGsCamera2] != nullptr) {
+        DeConfigureForLibcameraStill(GsCameraNumber::kGsCamera2);
+    }
 
-    try
+    app_ = std::make_unique<LibcameraJpegApp>();
+
+    StillOptions* options = app_->GetOptions();
+
+    char dummy_arguments[] = "DummyExecutableName";
+    char* argv[] = { dummy_arguments, NULL };
+
+    if (!options->Parse(1, argv))
     {
-        StillOptions* options = app.GetOptions();
+        GS_LOG_TRACE_MSG(error, "failed to parse dummy command line.");
+        return false;
+    }
 
-        char dummy_arguments[] = "DummyExecutableName";
-        char* argv[] = { dummy_arguments, NULL };
+    default_contrast_ = options->contrast;
 
-        if (!options->Parse(1, argv))
-        {
-            return -1;
-        }
+    SetLibCameraLoggingOff();
 
-        SetLibCameraLoggingOff();
+    // On a two-Pi system, each Pi has just one camera, and that camera will be in slot 0
+    // On a single-pi system the one Pi 5 has both cameras.  And Camera 2 will be in slot 1
+    // because Camera 1 is in slot 0.
+    if (GolfSimOptions::GetCommandLineOptions().run_single_pi_) {
+        options->camera = 1;
+    }
+    else {
+        options->camera = 0;
+    }
 
-        // On a two-Pi system, each Pi has just one camera, and that camera will be in slot 0
-        // On a single-pi system the one Pi 5 has both cameras.  And Camera 2 will be in slot 1
-        // because Camera 1 is in slot 0.
-        if (GolfSimOptions::GetCommandLineOptions().run_single_pi_) {
-            options->camera = 1;
-        }
-        else {
-            options->camera = 0;
-        }
+    applied_settings_ = GetRequiredControlSettings();
+    options->gain = applied_settings_.gain;
+    options->contrast = applied_settings_.contrast;
 
-        if (GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera2Calibrate ||
-            GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera2BallLocation ||
-            GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera2AutoCalibrate) {
+    options->awb = "indoor";
+    options->immediate = true;
+    options->timeout.set("0ms");  // Wait forever for external trigger
+    const CameraHardware::CameraModel  slot1_camera_model = GolfSimCamera::kSystemSlot1CameraType;
+    if (slot1_camera_model != CameraHardware::CameraModel::InnoMakerIMX296GS_Mono) {
+        options->denoise = "cdn_off";
+    }
+    else {
+        options->denoise = "auto";
+    }
 
-            options->gain = LibCameraInterface::kCamera2CalibrateOrLocationGain;
-        }
-        else if (GolfSimClubs::GetCurrentClubType() == GolfSimClubs::kPutter) {
-            options->gain = LibCameraInterface::kCamera2PuttingGain;
-            options->contrast = LibCameraInterface::kCamera2PuttingContrast;
-        }
-        else {
-            if (!GolfSimOptions::GetCommandLineOptions().lm_comparison_mode_) {
-                options->gain = LibCameraInterface::kCamera2Gain;
-            }
-            else {
-                options->gain = LibCameraInterface::kCamera2ComparisonGain;
-            }
+    GS_LOG_TRACE_MSG(trace, "Camera denoise option set to: " + options->denoise);
+    options->nopreview = true;
+    // TBD - Currently, we are using the viewfinder stream to take the picture.  Should be corrected.
+    options->viewfinder_width = camera_.camera_hardware_.resolution_x_;
+    options->viewfinder_height = camera_.camera_hardware_.resolution_y_;
+    options->width = camera_.camera_hardware_.resolution_x_;
+    options->height = camera_.camera_hardware_.resolution_y_;
+    options->shutter.set("11111us"); // Not actually used for external triggering.  Just needs to be set to something
+    options->info_text = "";
+
+	// We know we are using camera 2
+    if (GolfSimCamera::kSystemSlot2CameraOrientation == CameraHardware::CameraOrientation::kUpsideDown) {
+    	// Tell libcamera to flip the image vertically back to where it should be
+        options->transform = libcamera::Transform::VFlip;
+        GS_LOG_MSG(trace, "Flipping still picture upside down.");
+    }
+	else {
+        GS_LOG_MSG(trace, "NOT flipping still picture upside down.");
+	}
+
+    if (!SetLibcameraTuningFileEnvVariable(camera_)) {
+        GS_LOG_TRACE_MSG(error, "failed to SetLibcameraTuningFileEnvVariable");
+        return false;
+    }
+
+    if (options->verbose >= 2)
+        options->Print();
 
-            options->contrast = LibCameraInterface::kCamera2Contrast;
+    if (!ball_flight_camera_start(*app_)) {
+        GS_LOG_MSG(error, "Camera2CaptureSession failed to start the camera.");
+        return false;
+    }
+
+    armed_ = true;
+
+    GS_LOG_TRACE_MSG(trace, "Camera2CaptureSession opened camera 2 at " + std::to_string(camera_.camera_hardware_.resolution_x_) + "x" +
+                            std::to_string(camera_.camera_hardware_.resolution_y_) + ".");
+    return true;
+}
+
+void Camera2CaptureSession::ApplyControlSettings(const ControlSettings& settings) {
+
+    // Any later (re)start of the camera will pick the settings up from the options
+    StillOptions* options = app_->GetOptions();
+    options->gain = settings.gain;
+    options->contrast = settings.contrast;
+
+    if (settings == applied_settings_) {
+        return;
+    }
+
+    if (armed_) {
+        // The camera is already running, so send just the controls that changed.  They go
+        // out with the next request that is queued, which happens during the priming pulses,
+        // well before the strobed image.
+        libcamera::ControlList controls;
+
+        if (settings.gain != applied_settings_.gain) {
+            controls.set(libcamera::controls::AnalogueGainMode, libcamera::controls::AnalogueGainModeManual);
+            controls.set(libcamera::controls::AnalogueGain, (float)settings.gain);
         }
 
-        options->awb = "indoor";
-        options->immediate = true;
-        options->timeout.set("0ms");  // Wait forever for external trigger
-        const CameraHardware::CameraModel  camera_model = GolfSimCamera::kSystemSlot1CameraType;
-        if (camera_model != CameraHardware::CameraModel::InnoMakerIMX296GS_Mono) {
-            options->denoise = "cdn_off";
+        if (settings.contrast != applied_settings_.contrast) {
+            controls.set(libcamera::controls::Contrast, (float)settings.contrast);
         }
-        else {
-            options->denoise = "auto";
+
+        app_->SetControls(controls);
+    }
+
+    GS_LOG_TRACE_MSG(trace, "Camera2CaptureSession changed gain/contrast from " + std::to_string(applied_settings_.gain) + "/" +
+                            std::to_string(applied_settings_.contrast) + " to " + std::to_string(settings.gain) + "/" +
+                            std::to_string(settings.contrast) + ".");
+
+    applied_settings_ = settings;
+}
+
+bool Camera2CaptureSession::WaitForTrigger(cv::Mat& raw_image) {
+
+    try
+    {
+        if (!IsOpen() && !Open()) {
+            return false;
         }
 
-        GS_LOG_TRACE_MSG(trace, "Camera denoise option set to: " + options->denoise);
-        options->nopreview = true;
-        // TBD - Currently, we are using the viewfinder stream to take the picture.  Should be corrected.
-        options->viewfinder_width = c.camera_hardware_.resolution_x_;
-        options->viewfinder_height = c.camera_hardware_.resolution_y_;
-        options->width = c.camera_hardware_.resolution_x_;
-        options->height = c.camera_hardware_.resolution_y_;
-        options->shutter.set("11111us"); // Not actually used for external triggering.  Just needs to be set to something
-        options->info_text = "";
+        ApplyControlSettings(GetRequiredControlSettings());
 
-	// We know we are using camera 2
-        if (GolfSimCamera::kSystemSlot2CameraOrientation == CameraHardware::CameraOrientation::kUpsideDown) {
-    	    // Tell libcamera to flip the image vertically back to where it should be
-            options->transform = libcamera::Transform::VFlip;
-            GS_LOG_MSG(trace, "Flipping still picture upside down.");
+        if (!armed_) {
+            app_->StartCamera();
+            armed_ = true;
         }
-	else {
-            GS_LOG_MSG(trace, "NOT flipping still picture upside down.");
-	}
 
-        if (!SetLibcameraTuningFileEnvVariable(c)) {
-            GS_LOG_TRACE_MSG(error, "failed to SetLibcameraTuningFileEnvVariable");
+        // This will block until the final image is received.  The camera is stopped at that point.
+        bool status = ball_flight_camera_wait_for_image(*app_, raw_image);
+        armed_ = false;
+
+        if (!status) {
             return false;
         }
 
-        if (options->verbose >= 2)
-            options->Print();
-
-        // This will block until the loop ends
-        ball_flight_camera_event_loop(app, raw_image);
+        // Re-arm right away, so that the camera is ready for the next shot while this one is
+        // still being sent and processed
+        if (LibCameraInterface::kCamera2UsePersistentCaptureSession) {
+            app_->StartCamera();
+            armed_ = true;
+        }
     }
     catch (std::exception const& e)
     {
@@ -1537,15 +1636,52 @@ bool WaitForCam2Trigger(cv::Mat& return_image) {
         return false;
     }
 
-    // GS_LOG_TRACE_MSG(trace, "Tearing down initial camera.");
-    app.StopCamera();  // TBD - Need?
-    app.Teardown();  // TBD - Need?
+    return true;
+}
+
+void Camera2CaptureSession::Close() {
+
+    if (!IsOpen()) {
+        return;
+    }
+
+    GS_LOG_TRACE_MSG(trace, "Camera2CaptureSession closing camera 2.");
+
+    try
+    {
+        app_->StopCamera();
+        app_->Teardown();
+    }
+    catch (std::exception const& e)
+    {
+        GS_LOG_MSG(error, "ERROR in Camera2CaptureSession::Close: *** " + std::string(e.what()) + " ***");
+    }
+
+    app_.reset();
+    armed_ = false;
+}
+
+bool WaitForCam2Trigger(cv::Mat& return_image) {
+
+    Camera2CaptureSession& session = Camera2CaptureSession::GetSession();
+
+    cv::Mat raw_image;
+
+    if (!session.WaitForTrigger(raw_image)) {
+        // Start over from scratch next time
+        session.Close();
+        return false;
+    }
+
+    if (!LibCameraInterface::kCamera2UsePersistentCaptureSession) {
+        session.Close();
+    }
 
     // LoggingTools::LogImage("", raw_image, std::vector < cv::Point >{}, true, "InitialRawImageCam2.png");
 
     // Save the image in memory after un-distorting it for the local camera/lens
 
-    return_image = golf_sim::LibCameraInterface::undistort_camera_image(raw_image, c);
+    return_image = golf_sim::LibCameraInterface::undistort_camera_image(raw_image, session.camera());
 
     if (GolfSimOptions::GetCommandLineOptions().camera_still_mode_ ) {
 
@@ -13,6 +13,8 @@
 #include "core/rpicam_encoder.hpp"
 #include "core/still_options.hpp"
 
+#include <memory>
+
 #include <opencv2/core.hpp>
 
 #include "golf_ball.h"
@@ -46,7 +48,8 @@ namespace golf_sim {
 			kExternallyStrobed
 		};
 
-		static cv::Mat undistort_camera_image(const cv::Mat& img, const GolfSimCamera& camera);
+		// If roi is not empty, only that part of the image is undistorted and returned
+		static cv::Mat undistort_camera_image(const cv::Mat& img, const GolfSimCamera& camera, const cv::Rect& roi = cv::Rect());
 		static bool SendCamera2PreImage(const cv::Mat& raw_image);
 
 		static uint kMaxWatchingCropWidth;
@@ -66,6 +69,9 @@ namespace golf_sim {
 		static long kCamera1StillShutterTimeuS;
 		static long kCamera2StillShutterTimeuS;
 
+		// If true, camera 2 stays open and armed between shots (see Camera2CaptureSession)
+		static bool kCamera2UsePersistentCaptureSession;
+
 		// Once the cropped rectange is determined (usually around the center of the ball)
 		// These offsets can further move that cropping area
 		static int kCroppedImagePixelOffsetLeft;
@@ -87,6 +93,60 @@ namespace golf_sim {
 		static int previously_found_device_number_;
 	};
 
+	// Keeps camera 2 open, configured for external triggering and with its buffers allocated
+	// from one shot to the next.  Building a new LibcameraJpegApp for every shot (open,
+	// configure, allocate, start and then tear it all down again) takes long enough that
+	// a quick second shot could arrive before camera 2 was ready for it.
+	//
+	// After each image, the camera is simply restarted, which re-queues its requests on the
+	// already-allocated buffers.  The gain and contrast depend on the club type, so they are
+	// checked before each shot, and only the controls that have changed are sent to the camera.
+	class Camera2CaptureSession {
+	public:
+
+		static Camera2CaptureSession& GetSession();
+
+		// Opens the camera if it isn't already, and blocks until the next strobed image has
+		// been received.  raw_image is not undistorted.  If this fails, the session should be
+		// closed so that the next call starts from scratch.
+		bool WaitForTrigger(cv::Mat& raw_image);
+
+		// Stops and tears down the camera, if it is open
+		void Close();
+
+		bool IsOpen() const { return app_ != nullptr; }
+
+		// For the resolution and calibration of the images
+		const GolfSimCamera& camera() const { return camera_; }
+
+	private:
+
+		struct ControlSettings {
+			double gain = 1.0;
+			double contrast = 1.0;
+
+			bool operator==(const ControlSettings& other) const = default;
+		};
+
+		// The settings for the current system mode and club
+		ControlSettings GetRequiredControlSettings() const;
+
+		bool Open();
+
+		void ApplyControlSettings(const ControlSettings& settings);
+
+		std::unique_ptr<LibcameraJpegApp> app_;
+		GolfSimCamera camera_;
+
+		ControlSettings applied_settings_;
+
+		// What the options parsing produced, for the modes that don't set a contrast
+		double default_contrast_ = 1.0;
+
+		// True if the camera has been started and is waiting for triggers
+		bool armed_ = false;
+	};
+
 	bool TakeRawPicture(const GolfSimCamera& camera, cv::Mat& img);
 
 	// Takes a picture and then tries to find the ball
@@ -121,6 +181,11 @@ namespace golf_sim {
 
 	bool RetrieveCameraInfo(const GsCameraNumber camera_number, cv::Vec2i& resolution, uint& frameRate, bool restartCamera = false);
 
+	// Removes any sensor cropping, so that the camera sees its full field of view
+	bool ConfigCameraForFullScreenWatching(const GolfSimCamera& c);
+
+	bool SetLibcameraTuningFileEnvVariable(const GolfSimCamera& camera);
+
 	LibcameraJpegApp* ConfigureForLibcameraStill(const GolfSimCamera& camera);
 	bool DeConfigureForLibcameraStill(const GsCameraNumber camera_number);
 
@@ -83,27 +83,25 @@ void SetExternalTrigger(bool& flag) {
 	}
 }
 
-// The main event loop for the the externally-triggered camera.
+// Opens, configures and starts the externally-triggered camera, after which the camera
+// is armed and waiting for trigger pulses.  The buffers allocated here stay allocated
+// until the app is torn down, so a camera that is stopped after an image can be
+// re-armed with just app.StartCamera().
 
-bool ball_flight_camera_event_loop(LibcameraJpegApp& app, cv::Mat& returnImg)
+bool ball_flight_camera_start(LibcameraJpegApp& app)
 {
-	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_event_loop started.  Waiting for external trigger....");
-
-	// MJLMODs BELOW
-
 	StillOptions const * options = app.GetOptions();
 
 	if (options == nullptr) {
-		GS_LOG_TRACE_MSG(trace, "ball_flight_camera_event_loop could not get app.GetOptions()");
+		GS_LOG_TRACE_MSG(trace, "ball_flight_camera_start could not get app.GetOptions()");
 		return false;
 	}
 
-	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_event_loop started.  Opening Camera at slot: " + std::to_string(options->camera));
-
+	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_start.  Opening Camera at slot: " + std::to_string(options->camera));
 
 	app.OpenCamera();
 
-	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_event_loop started.  Opened Camera....");
+	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_start.  Opened Camera....");
 
 	// The RGB flag still works for grayscale mono images
 	uint flags = RPiCamApp::FLAG_STILL_RGB;
@@ -111,8 +109,30 @@ bool ball_flight_camera_event_loop(LibcameraJpegApp& app, cv::Mat& returnImg)
 
 	app.StartCamera();
 
-	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_event_loop started.  Started Camera....");
+	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_start.  Started Camera....");
 
+	return true;
+}
+
+// The main event loop for the the externally-triggered camera.
+
+bool ball_flight_camera_event_loop(LibcameraJpegApp& app, cv::Mat& returnImg)
+{
+	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_event_loop started.  Waiting for external trigger....");
+
+	if (!ball_flight_camera_start(app)) {
+		return false;
+	}
+
+	return ball_flight_camera_wait_for_image(app, returnImg);
+}
+
+// Processes the (priming, pre-image and final) trigger pulses for one shot on a camera that
+// has already been started.  The camera is stopped when the final image is received.
+
+bool ball_flight_camera_wait_for_image(LibcameraJpegApp& app, cv::Mat& returnImg)
+{
+	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_wait_for_image started.  Waiting for external trigger....");
 
 	auto start_time = std::chrono::high_resolution_clock::now();
 
@@ -400,7 +420,7 @@ bool ball_flight_camera_event_loop(LibcameraJpegApp& app, cv::Mat& returnImg)
 		} // switching on state
 	} // for loop
 
-	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_event_loop ended.  Return final image.");
+	GS_LOG_TRACE_MSG(trace, "ball_flight_camera_wait_for_image ended.  Return final image.");
 
 	return return_status;
 }
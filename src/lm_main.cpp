@@ -44,6 +44,7 @@
 #include "gs_fsm.h"
 #include "gs_ipc_system.h"
 #include "libcamera_interface.h"
+#include "ball_placement_watcher.h"
 
 
 namespace fs = std::filesystem;
@@ -1158,6 +1159,11 @@ void run_main(int argc, char* argv[])
             GS_LOG_MSG(info, "Running in kCamera1 or kCamera1TestStandalone mode.");
             state::InitializingCamera1System camera1_state;
             RunGolfSimFsm(camera1_state);
+
+#ifdef __unix__
+            // The ball placement preview stream may still be running
+            BallPlacementWatcher::GetWatcher().Close();
+#endif
             break;
         }
 
@@ -1169,6 +1175,11 @@ void run_main(int argc, char* argv[])
 
             state::InitializingCamera2System camera2_state;
             RunGolfSimFsm(camera2_state);
+
+#ifdef __unix__
+            // Camera 2 is kept open between shots, so release it before exiting
+            Camera2CaptureSession::GetSession().Close();
+#endif
             break;
         }
 
@@ -15,6 +15,8 @@
 
 #include "post_processing_stages/post_processing_stage.hpp"
 
+#include "motion_detect_kernel.h"
+
 
 using Stream = libcamera::Stream;
 
@@ -46,6 +48,8 @@ public:
 		int frame_period;
 		bool verbose;
 		bool showroi;
+		// How many ROI rows to compare between checks of the region threshold
+		int early_exit_rows = 1;
 	};
 
 	// This is the current configuration of the MotionDetectStage
@@ -66,7 +70,8 @@ private:
 	uint roi_width_, roi_height_;
 	uint region_threshold_;
 	uint max_region_threshold_;
-	std::vector<uint8_t> previous_frame_;
+	// Holds the previous frame and does the actual frame differencing
+	golf_sim::MotionDetectKernel motion_kernel_;
 	bool first_time_;
 	bool motion_detected_;
 	uint postMotionFramesToCapture_;
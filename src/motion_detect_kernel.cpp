@@ -0,0 +1,300 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "motion_detect_kernel.h"
+
+
+namespace golf_sim {
+
+    void MotionDetectKernel::Configure(const Settings& settings) {
+        settings_ = settings;
+        settings_.hskip = std::max(settings_.hskip, 1u);
+        settings_.vskip = std::max(settings_.vskip, 1u);
+        settings_.early_exit_rows = std::max(settings_.early_exit_rows, 1u);
+
+        // Evaluate the original threshold expression once for every possible old value.
+        // The comparison is monotonic in |new - old|, so the number of differences that do
+        // NOT count is one more than the largest of them.
+        threshold_always_exceeded_ = false;
+
+        for (int old_value = 0; old_value < 256; old_value++) {
+            int not_different_count = 0;
+
+            for (int difference = 0; difference < 256; difference++) {
+                if (!(difference > (settings_.difference_m * (float)old_value + settings_.difference_c))) {
+                    not_different_count++;
+                }
+            }
+
+            if (not_different_count == 0) {
+                threshold_always_exceeded_ = true;
+                limit_table_[old_value] = 0;
+            }
+            else {
+                limit_table_[old_value] = (uint8_t)(not_different_count - 1);
+            }
+        }
+
+        const size_t roi_pixels = (size_t)settings_.roi_width * settings_.roi_height;
+
+        previous_frame_.assign(roi_pixels, 0);
+        previous_limits_.assign(roi_pixels, 0);
+        row_buffer_.assign(settings_.roi_width, 0);
+        stale_limit_rows_ = settings_.roi_height;
+    }
+
+    void MotionDetectKernel::GatherRow(const uint8_t* image, size_t stride, unsigned int y, uint8_t* dest) const {
+        const unsigned int hskip = settings_.hskip;
+        const unsigned int width = settings_.roi_width;
+
+        const uint8_t* src = image + (size_t)(settings_.roi_y + y) * settings_.vskip * stride + (size_t)settings_.roi_x * hskip;
+
+        unsigned int x = 0;
+
+        if (hskip == 2) {
+            // Each 16 outputs need 32 bytes of input.  Only use the vector loads while
+            // they stay within the row of the full-resolution image.
+            const size_t first_column = (size_t)settings_.roi_x * hskip;
+            const size_t readable_bytes = (settings_.image_width > first_column) ? settings_.image_width - first_column : 0;
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+            for (; x + 16 <= width && (size_t)(x + 16) * 2 <= readable_bytes; x += 16) {
+                vst1q_u8(dest + x, vld2q_u8(src + 2 * x).val[0]);
+            }
+#elif defined(__SSE2__)
+            const __m128i even_byte_mask = _mm_set1_epi16(0x00FF);
+
+            for (; x + 16 <= width && (size_t)(x + 16) * 2 <= readable_bytes; x += 16) {
+                __m128i low = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + 2 * x)), even_byte_mask);
+                __m128i high = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + 2 * x + 16)), even_byte_mask);
+                _mm_storeu_si128((__m128i*)(dest + x), _mm_packus_epi16(low, high));
+            }
+#endif
+        }
+
+        for (const uint8_t* p = src + (size_t)x * hskip; x < width; x++, p += hskip) {
+            dest[x] = *p;
+        }
+    }
+
+    unsigned int MotionDetectKernel::CompareRow(const uint8_t* new_row, uint8_t* old_row, const uint8_t* limit_row, unsigned int width) {
+        unsigned int regions = 0;
+        unsigned int x = 0;
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        while (x + 16 <= width) {
+            // Each lane counts at most one per iteration, so flush before an 8-bit lane can overflow
+            const unsigned int block_end = std::min(width & ~15u, x + 255 * 16);
+            uint8x16_t counts = vdupq_n_u8(0);
+
+            for (; x < block_end; x += 16) {
+                uint8x16_t new_values = vld1q_u8(new_row + x);
+                uint8x16_t old_values = vld1q_u8(old_row + x);
+                uint8x16_t different = vcgtq_u8(vabdq_u8(new_values, old_values), vld1q_u8(limit_row + x));
+
+                // different lanes are 0xFF, i.e., -1
+                counts = vsubq_u8(counts, different);
+                vst1q_u8(old_row + x, new_values);
+            }
+
+            regions += vaddlvq_u8(counts);
+        }
+#elif defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi8(1);
+
+        while (x + 16 <= width) {
+            const unsigned int block_end = std::min(width & ~15u, x + 255 * 16);
+            __m128i counts = zero;
+
+            for (; x < block_end; x += 16) {
+                __m128i new_values = _mm_loadu_si128((const __m128i*)(new_row + x));
+                __m128i old_values = _mm_loadu_si128((const __m128i*)(old_row + x));
+                __m128i abs_difference = _mm_or_si128(_mm_subs_epu8(new_values, old_values), _mm_subs_epu8(old_values, new_values));
+
+                // SSE2 has no unsigned byte compare.  a > b exactly when the saturated a - b is not zero.
+                __m128i not_different = _mm_cmpeq_epi8(_mm_subs_epu8(abs_difference, _mm_loadu_si128((const __m128i*)(limit_row + x))), zero);
+
+                counts = _mm_add_epi8(counts, _mm_andnot_si128(not_different, one));
+                _mm_storeu_si128((__m128i*)(old_row + x), new_values);
+            }
+
+            __m128i sums = _mm_sad_epu8(counts, zero);
+            regions += (unsigned int)(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+        }
+#endif
+
+        for (; x < width; x++) {
+            const int new_value = new_row[x];
+            const int old_value = old_row[x];
+
+            old_row[x] = (uint8_t)new_value;
+
+            if (std::abs(new_value - old_value) > limit_row[x]) {
+                regions++;
+            }
+        }
+
+        return regions;
+    }
+
+    void MotionDetectKernel::Reset(const uint8_t* image, size_t stride) {
+        for (unsigned int y = 0; y < settings_.roi_height; y++) {
+            GatherRow(image, stride, y, &previous_frame_[(size_t)y * settings_.roi_width]);
+        }
+
+        stale_limit_rows_ = settings_.roi_height;
+    }
+
+    bool MotionDetectKernel::DetectMotion(const uint8_t* image, size_t stride, unsigned int* regions) {
+        if (threshold_always_exceeded_) {
+            // Rare configuration (a negative threshold) that the 8-bit limits can't express
+            stale_limit_rows_ = settings_.roi_height;
+            return DetectMotionReference(settings_, image, stride, previous_frame_, regions);
+        }
+
+        UpdateThresholds();
+
+        const unsigned int width = settings_.roi_width;
+        const unsigned int height = settings_.roi_height;
+        const bool gather_needed = (settings_.hskip != 1);
+
+        unsigned int different_pixels = 0;
+        bool motion_detected = false;
+        unsigned int y = 0;
+
+        while (y < height) {
+            const uint8_t* new_row = nullptr;
+
+            if (gather_needed) {
+                GatherRow(image, stride, y, row_buffer_.data());
+                new_row = row_buffer_.data();
+            }
+            else {
+                new_row = image + (size_t)(settings_.roi_y + y) * settings_.vskip * stride + settings_.roi_x;
+            }
+
+            const size_t row_offset = (size_t)y * width;
+            different_pixels += CompareRow(new_row, &previous_frame_[row_offset], &previous_limits_[row_offset], width);
+
+            y++;
+
+            if ((y % settings_.early_exit_rows) == 0 || y == height) {
+                if (different_pixels >= settings_.region_threshold) {
+                    motion_detected = true;
+                    break;
+                }
+            }
+        }
+
+        // Rows past y were not looked at, so they still hold the older frame and its limits
+        stale_limit_rows_ = y;
+
+        if (regions != nullptr) {
+            *regions = different_pixels;
+        }
+
+        return motion_detected;
+    }
+
+    void MotionDetectKernel::UpdateThresholds() {
+        if (stale_limit_rows_ == 0) {
+            return;
+        }
+
+        const size_t count = (size_t)stale_limit_rows_ * settings_.roi_width;
+        const uint8_t* old_values = previous_frame_.data();
+        uint8_t* limits = previous_limits_.data();
+        size_t i = 0;
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        // 256-entry lookup as four 64-byte table lookups.  Out-of-range indexes leave the lane alone.
+        uint8x16x4_t tables[4];
+
+        for (int t = 0; t < 4; t++) {
+            for (int v = 0; v < 4; v++) {
+                tables[t].val[v] = vld1q_u8(limit_table_ + 64 * t + 16 * v);
+            }
+        }
+
+        const uint8x16_t sixty_four = vdupq_n_u8(64);
+
+        for (; i + 16 <= count; i += 16) {
+            uint8x16_t index = vld1q_u8(old_values + i);
+            uint8x16_t result = vqtbl4q_u8(tables[0], index);
+
+            index = vsubq_u8(index, sixty_four);
+            result = vqtbx4q_u8(result, tables[1], index);
+            index = vsubq_u8(index, sixty_four);
+            result = vqtbx4q_u8(result, tables[2], index);
+            index = vsubq_u8(index, sixty_four);
+            result = vqtbx4q_u8(result, tables[3], index);
+
+            vst1q_u8(limits + i, result);
+        }
+#endif
+
+        for (; i < count; i++) {
+            limits[i] = limit_table_[old_values[i]];
+        }
+
+        stale_limit_rows_ = 0;
+    }
+
+    bool MotionDetectKernel::DetectMotionReference(const Settings& settings, const uint8_t* image, size_t stride,
+                                                   std::vector<uint8_t>& previous_frame, unsigned int* regions_out) {
+        const unsigned int hskip = std::max(settings.hskip, 1u);
+        const size_t sampled_frame_stride = stride * std::max(settings.vskip, 1u);
+
+        bool local_motion_detected = false;
+        unsigned int regions = 0;
+
+        for (unsigned int y = 0; !local_motion_detected && y < settings.roi_height; y++)
+        {
+            const uint8_t* new_value_ptr = image + ((settings.roi_y + y) * sampled_frame_stride) + (settings.roi_x * hskip);
+            uint8_t* old_value_ptr = &previous_frame[0] + y * settings.roi_width;
+
+            for (unsigned int x = 0; x < settings.roi_width; x++, new_value_ptr += hskip)
+            {
+                int new_value = *new_value_ptr;
+                int old_value = *old_value_ptr;
+
+                *(old_value_ptr++) = new_value;
+                if (std::abs(new_value - old_value) > (settings.difference_m * (float)old_value + settings.difference_c)) {
+                    regions++;
+                }
+            }
+
+            local_motion_detected = (regions >= settings.region_threshold);
+        }
+
+        if (regions_out != nullptr) {
+            *regions_out = regions;
+        }
+
+        return local_motion_detected;
+    }
+
+    const char* MotionDetectKernel::BackendName() {
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        return "NEON";
+#elif defined(__SSE2__)
+        return "SSE2";
+#else
+        return "scalar";
+#endif
+    }
+
+}
@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// The frame-differencing kernel behind MotionDetectStage.  Each sampled ROI pixel
+// is compared with the same pixel of the previous frame, and the pixel counts as
+// "different" if
+//
+//      |new - old| > difference_m * old + difference_c
+//
+// Motion is declared as soon as region_threshold different pixels have been seen.
+//
+// The threshold only depends on the old value, so it is turned into a 256-entry
+// table when the kernel is configured.  The limit for each pixel of the previous
+// frame is kept next to that pixel, and refreshed by UpdateThresholds().  The
+// comparison itself is then just an absolute difference, an unsigned compare and
+// a count, which is vectorized with NEON on aarch64 and SSE2 on x86, with a
+// portable scalar fallback.  The limits can be refreshed after the external
+// trigger has been sent, so that work is not part of the trigger latency.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace golf_sim {
+
+class MotionDetectKernel {
+public:
+
+    struct Settings {
+        // The ROI in the sampled (i.e., hskip/vskip-decimated) image
+        unsigned int roi_x = 0;
+        unsigned int roi_y = 0;
+        unsigned int roi_width = 0;
+        unsigned int roi_height = 0;
+
+        unsigned int hskip = 1;
+        unsigned int vskip = 1;
+
+        // Width of the full-resolution frame in pixels.  Used to tell how far the
+        // vectorized gather can safely read along a row.
+        unsigned int image_width = 0;
+
+        float difference_m = 0.0;
+        int difference_c = 0;
+
+        // Number of different pixels that indicate motion
+        unsigned int region_threshold = 0;
+
+        // The pixel count is checked against region_threshold after this many rows.
+        // 1 is the original per-row behavior.  Larger values take fewer branches but
+        // may examine (and update) a few more rows of a frame that has motion.
+        // The result of DetectMotion() does not depend on this value.
+        unsigned int early_exit_rows = 1;
+    };
+
+    void Configure(const Settings& settings);
+
+    const Settings& settings() const { return settings_; }
+
+    // Makes the ROI of image the previous frame, e.g., for the first frame after Configure()
+    void Reset(const uint8_t* image, size_t stride);
+
+    // Compares the ROI of image against the previous frame, and replaces the previous
+    // frame's rows with the new ones as they are examined.  Returns true if there was
+    // motion.  If regions is not null, it receives the number of different pixels
+    // that were found before the kernel stopped looking.
+    bool DetectMotion(const uint8_t* image, size_t stride, unsigned int* regions = nullptr);
+
+    // Refreshes the per-pixel limits for the rows that the last DetectMotion() or Reset()
+    // changed.  DetectMotion() will do this itself if it was not called, but calling
+    // it once the motion result has been acted on keeps it out of the trigger latency.
+    void UpdateThresholds();
+
+    // The original (unvectorized) MotionDetectStage loop, for testing and benchmarking.
+    // Works on its own copy of the previous frame, which must be roi_width * roi_height.
+    static bool DetectMotionReference(const Settings& settings, const uint8_t* image, size_t stride,
+                                      std::vector<uint8_t>& previous_frame, unsigned int* regions = nullptr);
+
+    const std::vector<uint8_t>& previous_frame() const { return previous_frame_; }
+
+    // Identifies which comparison implementation was compiled in, for logging
+    static const char* BackendName();
+
+private:
+
+    // Copies the sampled pixels of one ROI row into dest
+    void GatherRow(const uint8_t* image, size_t stride, unsigned int y, uint8_t* dest) const;
+
+    // Returns the number of different pixels in one row, and replaces old_row with new_row
+    static unsigned int CompareRow(const uint8_t* new_row, uint8_t* old_row, const uint8_t* limit_row, unsigned int width);
+
+    Settings settings_;
+
+    // Largest |new - old| that does not count as different, indexed by old
+    uint8_t limit_table_[256] = {};
+
+    // True if some old value would make every pixel count as different (a negative
+    // threshold), which the 8-bit limits cannot represent
+    bool threshold_always_exceeded_ = false;
+
+    std::vector<uint8_t> previous_frame_;
+    std::vector<uint8_t> previous_limits_;
+    std::vector<uint8_t> row_buffer_;
+
+    // The previous_limits_ rows that are out of date, i.e., [0, stale_limit_rows_)
+    unsigned int stale_limit_rows_ = 0;
+};
+
+}
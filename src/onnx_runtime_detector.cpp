@@ -7,6 +7,7 @@
 #include "utils/logging_tools.h"
 #include <algorithm>
 #include <numeric>
+#include <cmath>
 #include <cstring>
 #include <pthread.h>
 #include <sched.h>
@@ -21,9 +22,6 @@ namespace golf_sim {
 
 ONNXRuntimeDetector::ONNXRuntimeDetector(const Config& config)
     : config_(config) {
-    if (config_.use_memory_pool) {
-        memory_pool_ = std::make_unique<MemoryPool>();
-    }
 }
 
 ONNXRuntimeDetector::~ONNXRuntimeDetector() {
@@ -44,11 +42,16 @@ bool ONNXRuntimeDetector::Initialize() {
 
         ConfigureSessionOptions();
 
-        session_ = std::make_unique<Ort::Session>(
-            *env_,
-            config_.model_path.c_str(),
-            *session_options_
-        );
+        // Session::Run is thread-safe, but the XNNPACK provider runs one inference at a time
+        // per session, so concurrent callers each get their own
+        sessions_.clear();
+        for (int i = 0; i < std::max(1, config_.num_sessions); i++) {
+            sessions_.push_back(std::make_unique<Ort::Session>(
+                *env_,
+                config_.model_path.c_str(),
+                *session_options_
+            ));
+        }
 
         allocator_ = std::make_unique<Ort::AllocatorWithDefaultOptions>();
         memory_info_ = std::make_unique<Ort::MemoryInfo>(
@@ -57,7 +60,7 @@ bool ONNXRuntimeDetector::Initialize() {
 
         CacheModelInfo();
 
-        InitializeMemoryPool();
+        InitializeContexts();
 
         if (config_.use_thread_affinity) {
             SetThreadAffinity();
@@ -65,7 +68,8 @@ bool ONNXRuntimeDetector::Initialize() {
 
         WarmUp(5);
 
-        GS_LOG_MSG(info, "ONNX Runtime detector initialized successfully");
+        GS_LOG_MSG(info, "ONNX Runtime detector initialized successfully with " + std::to_string(sessions_.size()) +
+                         " session(s)" + (supports_dynamic_batch_ ? " and batched inference" : ""));
         return true;
 
     } catch (const Ort::Exception& e) {
@@ -131,13 +135,16 @@ void ONNXRuntimeDetector::SetupExecutionProviders() {
 }
 
 void ONNXRuntimeDetector::CacheModelInfo() {
-    size_t num_inputs = session_->GetInputCount();
+    // All of the sessions are of the same model
+    Ort::Session& session = *sessions_[0];
+
+    size_t num_inputs = session.GetInputCount();
     input_names_storage_.reserve(num_inputs);
     input_names_.reserve(num_inputs);
     input_shapes_.reserve(num_inputs);
 
     for (size_t i = 0; i < num_inputs; i++) {
-        auto name_alloc = session_->GetInputNameAllocated(i, *allocator_);
+        auto name_alloc = session.GetInputNameAllocated(i, *allocator_);
         const char* raw_name = name_alloc.get();
 
         size_t name_len = std::strlen(raw_name) + 1;
@@ -147,18 +154,18 @@ void ONNXRuntimeDetector::CacheModelInfo() {
         input_names_.push_back(managed_name.get());
         input_names_storage_.push_back(std::move(managed_name));
 
-        auto type_info = session_->GetInputTypeInfo(i);
+        auto type_info = session.GetInputTypeInfo(i);
         auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
         input_shapes_.push_back(tensor_info.GetShape());
     }
 
-    size_t num_outputs = session_->GetOutputCount();
+    size_t num_outputs = session.GetOutputCount();
     output_names_storage_.reserve(num_outputs);
     output_names_.reserve(num_outputs);
     output_shapes_.reserve(num_outputs);
 
     for (size_t i = 0; i < num_outputs; i++) {
-        auto name_alloc = session_->GetOutputNameAllocated(i, *allocator_);
+        auto name_alloc = session.GetOutputNameAllocated(i, *allocator_);
         const char* raw_name = name_alloc.get();
 
         size_t name_len = std::strlen(raw_name) + 1;
@@ -168,7 +175,7 @@ void ONNXRuntimeDetector::CacheModelInfo() {
         output_names_.push_back(managed_name.get());
         output_names_storage_.push_back(std::move(managed_name));
 
-        auto type_info = session_->GetOutputTypeInfo(i);
+        auto type_info = session.GetOutputTypeInfo(i);
         auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
         output_shapes_.push_back(tensor_info.GetShape());
     }
@@ -197,18 +204,60 @@ void ONNXRuntimeDetector::CacheModelInfo() {
                        std::to_string(dim1) + " and " + std::to_string(dim2));
         }
     }
+
+    // A model exported with a fixed batch size of 1 can only take one image per Run
+    supports_dynamic_batch_ = !input_shapes_.empty() && !input_shapes_[0].empty() && input_shapes_[0][0] <= 0;
 }
 
-void ONNXRuntimeDetector::InitializeMemoryPool() {
-    if (!config_.use_memory_pool) return;
+void ONNXRuntimeDetector::InitializeContexts() {
+    const size_t input_size = 3 * static_cast<size_t>(config_.input_width) * config_.input_height;
+    const size_t batch_size = supports_dynamic_batch_ ? std::max(1, config_.max_batch_size) : 1;
+
+    std::lock_guard<std::mutex> lock(contexts_mutex_);
+    idle_contexts_.clear();
+
+    for (auto& session : sessions_) {
+        auto context = std::make_unique<InferenceContext>();
+        context->session = session.get();
 
-    size_t input_size = 1 * 3 * config_.input_width * config_.input_height;
+        if (config_.use_memory_pool) {
+            context->input_buffer.reserve(input_size * batch_size);
+            context->letterbox_params.reserve(batch_size);
+            context->letterbox_image.create(config_.input_height, config_.input_width, CV_8UC3);
+        }
 
-    size_t output_size = 1 * 84 * 8400; // 84 = 4 bbox + 80 classes
+        idle_contexts_.push_back(std::move(context));
+    }
+}
 
-    size_t preproc_size = config_.input_width * config_.input_height * 3;
+std::unique_ptr<ONNXRuntimeDetector::InferenceContext> ONNXRuntimeDetector::AcquireContext() {
+    std::unique_lock<std::mutex> lock(contexts_mutex_);
+    context_available_.wait(lock, [this] { return !idle_contexts_.empty(); });
 
-    memory_pool_->Reserve(input_size, output_size, preproc_size);
+    std::unique_ptr<InferenceContext> context = std::move(idle_contexts_.back());
+    idle_contexts_.pop_back();
+    return context;
+}
+
+void ONNXRuntimeDetector::ReleaseContext(std::unique_ptr<InferenceContext> context) {
+    if (!config_.use_memory_pool) {
+        context->input_buffer = std::vector<float>();
+        context->letterbox_image.release();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(contexts_mutex_);
+        idle_contexts_.push_back(std::move(context));
+    }
+    context_available_.notify_one();
+}
+
+ONNXRuntimeDetector::ContextLease::ContextLease(ONNXRuntimeDetector& detector)
+    : detector_(detector), context_(detector.AcquireContext()) {
+}
+
+ONNXRuntimeDetector::ContextLease::~ContextLease() {
+    detector_.ReleaseContext(std::move(context_));
 }
 
 std::vector<ONNXRuntimeDetector::Detection> ONNXRuntimeDetector::Detect(
@@ -225,43 +274,225 @@ std::vector<ONNXRuntimeDetector::Detection> ONNXRuntimeDetector::Detect(
         return {};
     }
 
-    if (!session_) {
+    if (sessions_.empty()) {
         GS_LOG_MSG(error, "ONNX session not initialized");
         return {};
     }
 
-    auto start_total = std::chrono::high_resolution_clock::now();
+    ContextLease lease(*this);
 
-    auto start_preproc = std::chrono::high_resolution_clock::now();
+    auto results = RunBatch(lease.context(), { &image }, metrics);
+
+    return results.empty() ? std::vector<Detection>() : std::move(results[0]);
+}
 
-    size_t input_buffer_size = 1 * 3 * config_.input_width * config_.input_height;
-    float* input_data = GetInputBuffer(input_buffer_size);
+std::vector<std::vector<ONNXRuntimeDetector::Detection>> ONNXRuntimeDetector::DetectBatch(
+    const std::vector<cv::Mat>& images,
+    PerformanceMetrics* metrics) {
 
-    if (!input_data) {
-        GS_LOG_MSG(error, "Failed to allocate input buffer of size: " + std::to_string(input_buffer_size));
+    if (images.empty()) {
         return {};
     }
 
-    if (config_.use_neon_preprocessing) {
-        PreprocessImageNEON(image, input_data);
-    } else {
-        PreprocessImageStandard(image, input_data);
+    if (sessions_.empty()) {
+        GS_LOG_MSG(error, "ONNX session not initialized");
+        return std::vector<std::vector<Detection>>(images.size());
+    }
+
+    std::vector<const cv::Mat*> image_pointers;
+    image_pointers.reserve(images.size());
+    for (const auto& image : images) {
+        image_pointers.push_back(&image);
+    }
+
+    ContextLease lease(*this);
+
+    return DetectImages(lease.context(), image_pointers, metrics);
+}
+
+std::vector<ONNXRuntimeDetector::Detection> ONNXRuntimeDetector::DetectTiled(
+    const cv::Mat& image,
+    const std::vector<cv::Point2f>& predicted_centers,
+    PerformanceMetrics* metrics) {
+
+    const cv::Size tile_size(config_.input_width, config_.input_height);
+
+    // Detect reports anything that is wrong with the image
+    if (predicted_centers.empty() || image.channels() != 3 || sessions_.empty() ||
+        image.cols <= tile_size.width || image.rows <= tile_size.height) {
+        return Detect(image, metrics);
+    }
+
+    const std::vector<cv::Rect> tiles = GetTilesForPredictions(image.size(), tile_size, predicted_centers);
+
+    // The crops are input-sized, so they go into the model without any scaling
+    std::vector<cv::Mat> crops;
+    std::vector<const cv::Mat*> crop_pointers;
+    crops.reserve(tiles.size());
+    crop_pointers.reserve(tiles.size());
+
+    for (const auto& tile : tiles) {
+        crops.push_back(image(tile));
+        crop_pointers.push_back(&crops.back());
+    }
+
+    std::vector<std::vector<Detection>> tile_detections;
+    {
+        ContextLease lease(*this);
+        tile_detections = DetectImages(lease.context(), crop_pointers, metrics);
+    }
+
+    std::vector<Detection> detections;
+
+    for (size_t i = 0; i < tile_detections.size(); i++) {
+        for (auto& detection : tile_detections[i]) {
+            detection.bbox.x += tiles[i].x;
+            detection.bbox.y += tiles[i].y;
+            detections.push_back(detection);
+        }
+    }
+
+    // The crops can overlap, so the same ball may have been found more than once
+    return NonMaxSuppression(detections);
+}
+
+std::vector<cv::Rect> ONNXRuntimeDetector::GetTilesForPredictions(
+    const cv::Size& image_size,
+    const cv::Size& tile_size,
+    const std::vector<cv::Point2f>& predicted_centers) {
+
+    std::vector<cv::Rect> tiles;
+
+    if (image_size.width < tile_size.width || image_size.height < tile_size.height) {
+        return tiles;
+    }
+
+    // A ball that is closer than this to the edge of a crop may be cut off by it
+    const int margin_x = tile_size.width / 8;
+    const int margin_y = tile_size.height / 8;
+
+    for (const auto& prediction : predicted_centers) {
+        const cv::Point2f center(std::clamp(prediction.x, 0.0f, static_cast<float>(image_size.width - 1)),
+                                 std::clamp(prediction.y, 0.0f, static_cast<float>(image_size.height - 1)));
+
+        bool covered = false;
+        for (const auto& tile : tiles) {
+            // Crops that are up against the image edge have nothing to cut off on that side
+            const int left = (tile.x == 0) ? 0 : tile.x + margin_x;
+            const int top = (tile.y == 0) ? 0 : tile.y + margin_y;
+            const int right = (tile.br().x == image_size.width) ? image_size.width : tile.br().x - margin_x;
+            const int bottom = (tile.br().y == image_size.height) ? image_size.height : tile.br().y - margin_y;
+
+            if (center.x >= left && center.x < right && center.y >= top && center.y < bottom) {
+                covered = true;
+                break;
+            }
+        }
+
+        if (covered) {
+            continue;
+        }
+
+        const int x = std::clamp(static_cast<int>(std::lround(center.x - tile_size.width / 2.0f)), 0, image_size.width - tile_size.width);
+        const int y = std::clamp(static_cast<int>(std::lround(center.y - tile_size.height / 2.0f)), 0, image_size.height - tile_size.height);
+
+        tiles.emplace_back(x, y, tile_size.width, tile_size.height);
+    }
+
+    return tiles;
+}
+
+std::vector<std::vector<ONNXRuntimeDetector::Detection>> ONNXRuntimeDetector::DetectImages(
+    InferenceContext& context,
+    const std::vector<const cv::Mat*>& images,
+    PerformanceMetrics* metrics) {
+
+    std::vector<std::vector<Detection>> results(images.size());
+
+    // Only the usable images go to the model
+    std::vector<size_t> valid_indices;
+    valid_indices.reserve(images.size());
+
+    for (size_t i = 0; i < images.size(); i++) {
+        if (images[i]->empty() || images[i]->channels() != 3) {
+            GS_LOG_MSG(warning, "Skipping batch image " + std::to_string(i) + ", which is empty or not BGR");
+            continue;
+        }
+        valid_indices.push_back(i);
+    }
+
+    const size_t batch_limit = supports_dynamic_batch_ ? static_cast<size_t>(std::max(1, config_.max_batch_size)) : 1;
+
+    PerformanceMetrics total_metrics;
+
+    for (size_t start = 0; start < valid_indices.size(); start += batch_limit) {
+        const size_t end = std::min(valid_indices.size(), start + batch_limit);
+
+        std::vector<const cv::Mat*> batch;
+        batch.reserve(end - start);
+        for (size_t i = start; i < end; i++) {
+            batch.push_back(images[valid_indices[i]]);
+        }
+
+        PerformanceMetrics batch_metrics;
+        auto batch_results = RunBatch(context, batch, &batch_metrics);
+
+        for (size_t i = start; i < end && (i - start) < batch_results.size(); i++) {
+            results[valid_indices[i]] = std::move(batch_results[i - start]);
+        }
+
+        total_metrics.preprocessing_ms += batch_metrics.preprocessing_ms;
+        total_metrics.inference_ms += batch_metrics.inference_ms;
+        total_metrics.postprocessing_ms += batch_metrics.postprocessing_ms;
+        total_metrics.total_ms += batch_metrics.total_ms;
+        total_metrics.memory_usage_bytes = batch_metrics.memory_usage_bytes;
+    }
+
+    if (metrics) {
+        *metrics = total_metrics;
+    }
+
+    return results;
+}
+
+std::vector<std::vector<ONNXRuntimeDetector::Detection>> ONNXRuntimeDetector::RunBatch(
+    InferenceContext& context,
+    const std::vector<const cv::Mat*>& images,
+    PerformanceMetrics* metrics) {
+
+    if (images.empty()) {
+        return {};
+    }
+
+    auto start_total = std::chrono::high_resolution_clock::now();
+
+    auto start_preproc = std::chrono::high_resolution_clock::now();
+
+    const int64_t batch_size = static_cast<int64_t>(images.size());
+    const size_t image_tensor_size = 3 * static_cast<size_t>(config_.input_width) * config_.input_height;
+
+    context.input_buffer.resize(image_tensor_size * images.size());
+    context.letterbox_params.resize(images.size());
+
+    for (size_t i = 0; i < images.size(); i++) {
+        PreprocessImage(*images[i], context.input_buffer.data() + i * image_tensor_size,
+                        context.letterbox_params[i], context.letterbox_image);
     }
 
     auto end_preproc = std::chrono::high_resolution_clock::now();
 
-    std::vector<int64_t> input_shape = {1, 3, config_.input_height, config_.input_width};
+    std::vector<int64_t> input_shape = {batch_size, 3, config_.input_height, config_.input_width};
     auto input_tensor = Ort::Value::CreateTensor<float>(
         *memory_info_,
-        input_data,
-        1 * 3 * config_.input_width * config_.input_height,
+        context.input_buffer.data(),
+        context.input_buffer.size(),
         input_shape.data(),
         input_shape.size()
     );
 
     auto start_inference = std::chrono::high_resolution_clock::now();
 
-    auto output_tensors = session_->Run(
+    auto output_tensors = context.session->Run(
         Ort::RunOptions{nullptr},
         input_names_.data(),
         &input_tensor,
@@ -292,122 +523,72 @@ std::vector<ONNXRuntimeDetector::Detection> ONNXRuntimeDetector::Detect(
     }
 
     int64_t output_size = std::accumulate(
-        output_shape.begin(), output_shape.end(), 1, std::multiplies<int64_t>()
+        output_shape.begin(), output_shape.end(), int64_t{1}, std::multiplies<int64_t>()
     );
 
-    if (output_size <= 0) {
-        GS_LOG_MSG(error, "Invalid output tensor size: " + std::to_string(output_size));
+    if (output_size <= 0 || output_size % batch_size != 0) {
+        GS_LOG_MSG(error, "Invalid output tensor size: " + std::to_string(output_size) +
+                   " for a batch of " + std::to_string(batch_size));
         return {};
     }
 
-    auto detections = PostprocessYOLO(output_data, output_size, letterbox_params_);
+    // The output is [batch, channels, predictions], so each image's part is contiguous
+    const int64_t per_image_output_size = output_size / batch_size;
+
+    std::vector<std::vector<Detection>> results;
+    results.reserve(images.size());
+
+    for (size_t i = 0; i < images.size(); i++) {
+        results.push_back(PostprocessYOLO(output_data + i * per_image_output_size,
+                                          static_cast<int>(per_image_output_size),
+                                          context.letterbox_params[i]));
+    }
 
     auto end_postproc = std::chrono::high_resolution_clock::now();
 
-    ReleaseBuffers();
+    auto duration = [](auto start, auto end) {
+        return std::chrono::duration<float, std::milli>(end - start).count();
+    };
 
-    if (metrics) {
-        auto duration = [](auto start, auto end) {
-            return std::chrono::duration<float, std::milli>(end - start).count();
-        };
+    const float inference_ms = duration(start_inference, end_inference);
 
+    if (metrics) {
         metrics->preprocessing_ms = duration(start_preproc, end_preproc);
-        metrics->inference_ms = duration(start_inference, end_inference);
+        metrics->inference_ms = inference_ms;
         metrics->postprocessing_ms = duration(start_postproc, end_postproc);
         metrics->total_ms = duration(start_total, std::chrono::high_resolution_clock::now());
         metrics->memory_usage_bytes = GetMemoryUsage();
     }
 
-    total_inferences_++;
-    float current_time = metrics ? metrics->inference_ms : 0;
-    float prev_avg = avg_inference_time_ms_.load();
-    avg_inference_time_ms_ = (prev_avg * (total_inferences_ - 1) + current_time) / total_inferences_;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        total_inferences_ += images.size();
+        avg_inference_time_ms_ += (inference_ms / batch_size - avg_inference_time_ms_) * images.size() / total_inferences_;
+    }
 
-    return detections;
+    return results;
 }
 
-void ONNXRuntimeDetector::PreprocessImage(const cv::Mat& image, float* output_tensor) {
-    if (config_.use_neon_preprocessing) {
-        PreprocessImageNEON(image, output_tensor);
-    } else {
-        PreprocessImageStandard(image, output_tensor);
-    }
+ONNXRuntimeDetector::LetterboxParams ONNXRuntimeDetector::LetterboxImage(const cv::Mat& image, cv::Mat& letterbox_image) const {
+    return DnnPreprocessor::Letterbox(image, cv::Size(config_.input_width, config_.input_height), letterbox_image);
 }
 
-void ONNXRuntimeDetector::PreprocessImageStandard(const cv::Mat& image, float* output_tensor) {
-    float scale = std::min(
-        static_cast<float>(config_.input_width) / image.cols,
-        static_cast<float>(config_.input_height) / image.rows
-    );
-
-    int new_width = static_cast<int>(image.cols * scale);
-    int new_height = static_cast<int>(image.rows * scale);
-
-    cv::Mat resized;
-    cv::resize(image, resized, cv::Size(new_width, new_height), 0, 0, cv::INTER_LINEAR);
-
-    cv::Mat letterbox(config_.input_height, config_.input_width, CV_8UC3, cv::Scalar(114, 114, 114));
-
-    int x_offset = (config_.input_width - new_width) / 2;
-    int y_offset = (config_.input_height - new_height) / 2;
+void ONNXRuntimeDetector::PreprocessImage(const cv::Mat& image, float* output_tensor,
+                                          LetterboxParams& letterbox, cv::Mat& letterbox_image) const {
+    letterbox = LetterboxImage(image, letterbox_image);
 
-    letterbox_params_.scale = scale;
-    letterbox_params_.x_offset = x_offset;
-    letterbox_params_.y_offset = y_offset;
-
-    resized.copyTo(letterbox(cv::Rect(x_offset, y_offset, new_width, new_height)));
-
-    cv::Mat float_img;
-    letterbox.convertTo(float_img, CV_32F, 1.0f/255.0f);
-
-    const float* src_ptr = float_img.ptr<float>();
-    for (int c = 0; c < 3; c++) {
-        for (int h = 0; h < config_.input_height; h++) {
-            for (int w = 0; w < config_.input_width; w++) {
-                int src_idx = h * config_.input_width * 3 + w * 3 + c;
-                int dst_idx = c * config_.input_height * config_.input_width +
-                             h * config_.input_width + w;
-                output_tensor[dst_idx] = src_ptr[src_idx];
-            }
-        }
+    // Straight into this image's slot of the input tensor
+    if (config_.use_neon_preprocessing) {
+        DnnPreprocessor::PackToPlanarTensor(letterbox_image, output_tensor);
+    } else {
+        DnnPreprocessor::PackToPlanarTensorReference(letterbox_image, output_tensor);
     }
 }
 
-void ONNXRuntimeDetector::PreprocessImageNEON(const cv::Mat& image, float* output_tensor) {
-#ifdef __ARM_NEON
-    float scale = std::min(
-        static_cast<float>(config_.input_width) / image.cols,
-        static_cast<float>(config_.input_height) / image.rows
-    );
-
-    int new_width = static_cast<int>(image.cols * scale);
-    int new_height = static_cast<int>(image.rows * scale);
-
-    cv::Mat resized;
-    cv::resize(image, resized, cv::Size(new_width, new_height), 0, 0, cv::INTER_LINEAR);
-
-    cv::Mat letterbox(config_.input_height, config_.input_width, CV_8UC3, cv::Scalar(114, 114, 114));
-
-    int x_offset = (config_.input_width - new_width) / 2;
-    int y_offset = (config_.input_height - new_height) / 2;
-
-    letterbox_params_.scale = scale;
-    letterbox_params_.x_offset = x_offset;
-    letterbox_params_.y_offset = y_offset;
-
-    resized.copyTo(letterbox(cv::Rect(x_offset, y_offset, new_width, new_height)));
-
-    neon::PreprocessPipelineNEON(letterbox, output_tensor,
-                                 config_.input_width, config_.input_height);
-#else
-    PreprocessImageStandard(image, output_tensor);
-#endif
-}
-
 std::vector<ONNXRuntimeDetector::Detection> ONNXRuntimeDetector::PostprocessYOLO(
     const float* output_tensor,
     int output_size,
-    const LetterboxParams& letterbox) {
+    const LetterboxParams& letterbox) const {
 
     std::vector<Detection> detections;
 
@@ -487,7 +668,7 @@ int ONNXRuntimeDetector::CalculatePredictionCount(int width, int height) const {
 }
 
 std::vector<ONNXRuntimeDetector::Detection> ONNXRuntimeDetector::NonMaxSuppression(
-    std::vector<Detection>& detections) {
+    std::vector<Detection>& detections) const {
 
     if (detections.empty()) return detections;
 
@@ -549,204 +730,32 @@ void ONNXRuntimeDetector::PinThreadToCore(int core_id) {
 void ONNXRuntimeDetector::WarmUp(int iterations) {
     cv::Mat dummy = cv::Mat::zeros(config_.input_height, config_.input_width, CV_8UC3);
 
-    for (int i = 0; i < iterations; i++) {
-        PerformanceMetrics metrics;
-        Detect(dummy, &metrics);
+    // Lease every context at once, so that every session gets warmed up
+    std::vector<std::unique_ptr<ContextLease>> leases;
+    for (size_t i = 0; i < sessions_.size(); i++) {
+        leases.push_back(std::make_unique<ContextLease>(*this));
     }
-}
 
-float* ONNXRuntimeDetector::GetInputBuffer(size_t size) {
-    if (memory_pool_) {
-        try {
-            return memory_pool_->GetInputBuffer(size);
-        } catch (const std::runtime_error&) {
-            // Fall through to dynamic allocation
-        }
-    }
-
-    thread_local std::vector<float> fallback_input_buffer;
-    fallback_input_buffer.resize(size);
-    return fallback_input_buffer.data();
-}
-
-float* ONNXRuntimeDetector::GetOutputBuffer(size_t size) {
-    if (memory_pool_) {
-        try {
-            return memory_pool_->GetOutputBuffer(size);
-        } catch (const std::runtime_error&) {
-            // Fall through to dynamic allocation
+    for (int i = 0; i < iterations; i++) {
+        for (auto& lease : leases) {
+            PerformanceMetrics metrics;
+            RunBatch(lease->context(), { &dummy }, &metrics);
         }
     }
-
-    thread_local std::vector<float> fallback_output_buffer;
-    fallback_output_buffer.resize(size);
-    return fallback_output_buffer.data();
-}
-
-void ONNXRuntimeDetector::ReleaseBuffers() {
-    if (memory_pool_) {
-        memory_pool_->ReleaseBuffers();
-    }
 }
 
 size_t ONNXRuntimeDetector::GetMemoryUsage() const {
-    if (memory_pool_) {
-        return memory_pool_->input_buffer.capacity() * sizeof(float) +
-               memory_pool_->output_buffer.capacity() * sizeof(float) +
-               memory_pool_->preprocessing_buffer.capacity();
-    }
-    return 0;
-}
-
-std::vector<std::vector<ONNXRuntimeDetector::Detection>> ONNXRuntimeDetector::DetectBatch(
-    const std::vector<cv::Mat>& images) {
-
-    std::vector<std::vector<Detection>> results;
-    results.reserve(images.size());
-
-    // For now, process sequentially
-    // TODO: Implement true batch processing if model supports it
-    for (const auto& image : images) {
-        results.push_back(Detect(image));
-    }
-
-    return results;
-}
-
-namespace neon {
-
-#ifdef __ARM_NEON
-
-void ResizeImageNEON(const uint8_t* src, int src_width, int src_height,
-                     uint8_t* dst, int dst_width, int dst_height) {
-    float x_ratio = static_cast<float>(src_width) / dst_width;
-    float y_ratio = static_cast<float>(src_height) / dst_height;
-
-    for (int y = 0; y < dst_height; y++) {
-        float src_y = y * y_ratio;
-        int y1 = static_cast<int>(src_y);
-        int y2 = std::min(y1 + 1, src_height - 1);
-        float dy = src_y - y1;
-
-        for (int x = 0; x < dst_width; x += 4) { // Process 4 pixels at once
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Warray-bounds"
-            int32_t x_vals[4] = {x, x+1, x+2, x+3};
-            float32x4_t src_x = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(x_vals)), x_ratio);
-#pragma GCC diagnostic pop
-            int32x4_t x1 = vcvtq_s32_f32(src_x);
-            int32x4_t x2 = vminq_s32(vaddq_s32(x1, vdupq_n_s32(1)), vdupq_n_s32(src_width - 1));
-            float32x4_t dx = vsubq_f32(src_x, vcvtq_f32_s32(x1));
-
-            // Bilinear interpolation using NEON
-            // This is simplified - full implementation would be more complex
-            // but maintains exact same output as cv::resize(INTER_LINEAR)
-        }
-    }
-}
-
-void BGRtoRGBNormalizeNEON(const uint8_t* bgr_data, float* rgb_data,
-                           int width, int height, float scale) {
-    const int pixels = width * height;
-    const float32x4_t scale_vec = vdupq_n_f32(scale);
-
-    for (int i = 0; i < pixels; i += 4) {
-        // Load 4 BGR pixels (12 bytes)
-        uint8x16_t bgr = vld1q_u8(bgr_data + i * 3);
-
-        // Convert to float and normalize
-        uint16x8_t bgr_16 = vmovl_u8(vget_low_u8(bgr));
-        float32x4_t b = vcvtq_f32_u32(vmovl_u16(vget_low_u16(bgr_16)));
-        float32x4_t g = vcvtq_f32_u32(vmovl_u16(vget_high_u16(bgr_16)));
-
-        // Apply scale
-        b = vmulq_f32(b, scale_vec);
-        g = vmulq_f32(g, scale_vec);
-
-        // Store as RGB (swapped channels)
-        // Output matches cv::dnn::blobFromImage exactly
-    }
-}
-
-void HWCtoCHWNEON(const float* hwc_data, float* chw_data,
-                  int channels, int height, int width) {
-    const int hw_size = height * width;
-
-    for (int h = 0; h < height; h++) {
-        for (int w = 0; w < width; w += 4) { // Process 4 pixels at once
-            int remaining_pixels = std::min(4, width - w);
-
-            for (int c = 0; c < channels; c++) {
-                if (remaining_pixels == 4) {
-                    // Load 4 values when safe
-                    float32x4_t vals = vld1q_f32(hwc_data + (h * width + w) * channels + c);
-                    vst1q_f32(chw_data + c * hw_size + h * width + w, vals);
-                } else {
-                    // Handle remaining pixels individually to avoid buffer overflow
-                    for (int i = 0; i < remaining_pixels; i++) {
-                        chw_data[c * hw_size + h * width + w + i] =
-                            hwc_data[(h * width + w + i) * channels + c];
-                    }
-                }
-            }
-        }
-    }
-}
-
-void PreprocessPipelineNEON(const cv::Mat& input, float* output,
-                           int target_width, int target_height) {
-    // Input is already letterboxed from PreprocessImageNEON - do NOT resize again
-    const cv::Mat& resized = input;
-
-    const int pixels = target_width * target_height;
-    const float32x4_t scale = vdupq_n_f32(1.0f / 255.0f);
-
-    const int block_size = 64; // Tune for L1 cache
+    // Only counts the contexts that aren't in use
+    std::lock_guard<std::mutex> lock(contexts_mutex_);
 
-    for (int i = 0; i < pixels; i += 4) {
-        int remaining_pixels = std::min(4, pixels - i);
-
-        if (remaining_pixels == 4 && (i + 3) * 3 + 2 < static_cast<int>(resized.total() * resized.elemSize())) {
-            const uint8_t* src = resized.ptr<uint8_t>() + i * 3;
-
-            // Load 12 bytes using vld3_u8 for automatic BGR deinterleaving
-            uint8x8x3_t bgr_pixels = vld3_u8(src);
-
-            uint16x8_t b_u16 = vmovl_u8(bgr_pixels.val[0]);
-            uint16x8_t g_u16 = vmovl_u8(bgr_pixels.val[1]);
-            uint16x8_t r_u16 = vmovl_u8(bgr_pixels.val[2]);
-
-            float32x4_t b_f32 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(b_u16)));
-            float32x4_t g_f32 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(g_u16)));
-            float32x4_t r_f32 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(r_u16)));
-
-            b_f32 = vmulq_f32(b_f32, scale);
-            g_f32 = vmulq_f32(g_f32, scale);
-            r_f32 = vmulq_f32(r_f32, scale);
-
-            vst1q_f32(&output[0 * pixels + i], b_f32);
-            vst1q_f32(&output[1 * pixels + i], g_f32);
-            vst1q_f32(&output[2 * pixels + i], r_f32);
-        } else {
-            for (int j = 0; j < remaining_pixels; j++) {
-                const uint8_t* pixel = resized.ptr<uint8_t>() + (i + j) * 3;
-                float b = pixel[0] / 255.0f;
-                float g = pixel[1] / 255.0f;
-                float r = pixel[2] / 255.0f;
-
-                // Keep BGR order (matches OpenCV DNN swapRB=false)
-                output[0 * pixels + i + j] = b;
-                output[1 * pixels + i + j] = g;
-                output[2 * pixels + i + j] = r;
-            }
-        }
+    size_t usage = 0;
+    for (const auto& context : idle_contexts_) {
+        usage += context->input_buffer.capacity() * sizeof(float) +
+                 context->letterbox_image.total() * context->letterbox_image.elemSize();
     }
+    return usage;
 }
 
-#endif // __ARM_NEON
-
-} // namespace neon
-
 PreprocessingThreadPool::PreprocessingThreadPool(int num_threads) {
     for (int i = 0; i < num_threads; i++) {
         workers_.emplace_back(&PreprocessingThreadPool::WorkerThread, this);
@@ -776,12 +785,8 @@ void PreprocessingThreadPool::WorkerThread() {
             tasks_.pop();
         }
 
-        // Process task
-#ifdef __ARM_NEON
-        neon::PreprocessPipelineNEON(*task.image, task.output, task.width, task.height);
-#else
-        // Standard preprocessing
-#endif
+        // The images are already letterboxed to task.width x task.height
+        DnnPreprocessor::PackToPlanarTensor(*task.image, task.output);
     }
 }
 
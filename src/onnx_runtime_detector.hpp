@@ -23,12 +23,20 @@
 #include <limits>
 #include <stdexcept>
 
-#ifdef __ARM_NEON
-#include <arm_neon.h>
-#endif
+#include "dnn_preprocessor.h"
 
 namespace golf_sim {
 
+// YOLO golf ball detector running on ONNX Runtime.
+//
+// Detect, DetectBatch and DetectTiled can be called from several threads at once.  Each
+// call leases an inference context (its own input buffer and letterbox parameters, bound
+// to one of config.num_sessions sessions) for its duration.  If every context is in use,
+// the call waits for one, rather than oversubscribing the cores.
+//
+// If the model has a dynamic batch dimension, DetectBatch and DetectTiled run up to
+// config.max_batch_size images through the model in a single Session::Run.  Otherwise,
+// they run the images one at a time.
 class ONNXRuntimeDetector {
 public:
     struct Detection {
@@ -37,11 +45,7 @@ public:
         int class_id;
     };
 
-    struct LetterboxParams {
-        float scale;        // Scale factor applied to image
-        int x_offset;       // Horizontal padding offset in pixels
-        int y_offset;       // Vertical padding offset in pixels
-    };
+    using LetterboxParams = DnnPreprocessor::LetterboxParams;
 
     struct PerformanceMetrics {
         float preprocessing_ms = 0;
@@ -70,11 +74,18 @@ public:
         bool use_memory_pool = true;
         size_t memory_pool_size_mb = 64;
 
+        // SIMD (NEON, AVX2 or SSSE3) tensor packing.  Otherwise, the per-value reference version.
         bool use_neon_preprocessing = true;
         bool use_zero_copy = true;
 
         bool is_single_class_model = true;
         int num_classes = 1;
+
+        // Each session can run one inference at a time
+        int num_sessions = 1;
+
+        // Largest number of images per Session::Run, for models with a dynamic batch dimension
+        int max_batch_size = 8;
     };
 
     explicit ONNXRuntimeDetector(const Config& config);
@@ -86,7 +97,26 @@ public:
                                   PerformanceMetrics* metrics = nullptr);
 
     std::vector<std::vector<Detection>> DetectBatch(
-        const std::vector<cv::Mat>& images);
+        const std::vector<cv::Mat>& images,
+        PerformanceMetrics* metrics = nullptr);
+
+    // Runs the model on input-sized crops of the image around each of the predicted ball
+    // centers, instead of on the whole (letterboxed and therefore shrunk) image.  Small
+    // balls keep their full resolution, and there are fewer pixels to run the model on.
+    // The detections are in image coordinates.  Falls back to Detect if there are no
+    // predictions or the image is no bigger than the model input.
+    std::vector<Detection> DetectTiled(const cv::Mat& image,
+                                       const std::vector<cv::Point2f>& predicted_centers,
+                                       PerformanceMetrics* metrics = nullptr);
+
+    // The crops that DetectTiled uses.  A prediction that is already well inside an earlier
+    // crop doesn't get its own.  The crops are tile_size and lie within the image, which
+    // must be at least tile_size.
+    static std::vector<cv::Rect> GetTilesForPredictions(const cv::Size& image_size,
+                                                        const cv::Size& tile_size,
+                                                        const std::vector<cv::Point2f>& predicted_centers);
+
+    bool SupportsDynamicBatch() const { return supports_dynamic_batch_; }
 
     void WarmUp(int iterations = 10);
 
@@ -96,11 +126,10 @@ public:
 
 private:
     Config config_;
-    LetterboxParams letterbox_params_;  // Store letterbox parameters for coordinate conversion
 
     std::unique_ptr<Ort::Env> env_;
     std::unique_ptr<Ort::SessionOptions> session_options_;
-    std::unique_ptr<Ort::Session> session_;
+    std::vector<std::unique_ptr<Ort::Session>> sessions_;
     std::unique_ptr<Ort::AllocatorWithDefaultOptions> allocator_;
     std::unique_ptr<Ort::MemoryInfo> memory_info_;
 
@@ -111,76 +140,74 @@ private:
     std::vector<std::vector<int64_t>> input_shapes_;
     std::vector<std::vector<int64_t>> output_shapes_;
 
-    struct MemoryPool {
-        std::vector<float> input_buffer;
-        std::vector<float> output_buffer;
-        std::vector<uint8_t> preprocessing_buffer;
-        mutable std::mutex mutex;
+    bool supports_dynamic_batch_ = false;
 
-        std::atomic<bool> input_buffer_in_use{false};
-        std::atomic<bool> output_buffer_in_use{false};
+    // Everything that a single call needs for itself
+    struct InferenceContext {
+        Ort::Session* session = nullptr;
+        std::vector<float> input_buffer;                // [batch, 3, height, width]
+        std::vector<LetterboxParams> letterbox_params;  // One per image in the batch
+        cv::Mat letterbox_image;
+    };
 
-        void Reserve(size_t input_size, size_t output_size, size_t preproc_size) {
-            std::lock_guard<std::mutex> lock(mutex);
-            input_buffer.reserve(input_size);
-            output_buffer.reserve(output_size);
-            preprocessing_buffer.reserve(preproc_size);
-        }
+    // Returns its context to the detector when it goes out of scope
+    class ContextLease {
+    public:
+        explicit ContextLease(ONNXRuntimeDetector& detector);
+        ~ContextLease();
 
-        float* GetInputBuffer(size_t size) {
-            std::lock_guard<std::mutex> lock(mutex);
-            if (input_buffer_in_use.load()) {
-                throw std::runtime_error("Input buffer already in use");
-            }
-            input_buffer.resize(size);
-            input_buffer_in_use.store(true);
-            return input_buffer.data();
-        }
+        ContextLease(const ContextLease&) = delete;
+        ContextLease& operator=(const ContextLease&) = delete;
 
-        float* GetOutputBuffer(size_t size) {
-            std::lock_guard<std::mutex> lock(mutex);
-            if (output_buffer_in_use.load()) {
-                throw std::runtime_error("Output buffer already in use");
-            }
-            output_buffer.resize(size);
-            output_buffer_in_use.store(true);
-            return output_buffer.data();
-        }
+        InferenceContext& context() { return *context_; }
 
-        void ReleaseBuffers() {
-            input_buffer_in_use.store(false);
-            output_buffer_in_use.store(false);
-        }
+    private:
+        ONNXRuntimeDetector& detector_;
+        std::unique_ptr<InferenceContext> context_;
     };
-    std::unique_ptr<MemoryPool> memory_pool_;
 
-    std::atomic<size_t> total_inferences_{0};
-    std::atomic<float> avg_inference_time_ms_{0};
+    std::vector<std::unique_ptr<InferenceContext>> idle_contexts_;
+    mutable std::mutex contexts_mutex_;
+    std::condition_variable context_available_;
+
+    std::unique_ptr<InferenceContext> AcquireContext();
+    void ReleaseContext(std::unique_ptr<InferenceContext> context);
+
+    std::mutex stats_mutex_;
+    size_t total_inferences_ = 0;
+    float avg_inference_time_ms_ = 0;
 
-    void InitializeSession();
     void ConfigureSessionOptions();
     void SetupExecutionProviders();
     void CacheModelInfo();
-    void InitializeMemoryPool();
+    void InitializeContexts();
+
+    // Runs the images through the model in as few Session::Run calls as the model allows.
+    // Empty or non-BGR images get no detections.
+    std::vector<std::vector<Detection>> DetectImages(InferenceContext& context,
+                                                     const std::vector<const cv::Mat*>& images,
+                                                     PerformanceMetrics* metrics);
+
+    // A single Session::Run over all of the images
+    std::vector<std::vector<Detection>> RunBatch(InferenceContext& context,
+                                                 const std::vector<const cv::Mat*>& images,
+                                                 PerformanceMetrics* metrics);
 
-    void PreprocessImage(const cv::Mat& image, float* output_tensor);
-    void PreprocessImageNEON(const cv::Mat& image, float* output_tensor);
-    void PreprocessImageStandard(const cv::Mat& image, float* output_tensor);
+    LetterboxParams LetterboxImage(const cv::Mat& image, cv::Mat& letterbox_image) const;
+
+    void PreprocessImage(const cv::Mat& image, float* output_tensor,
+                         LetterboxParams& letterbox, cv::Mat& letterbox_image) const;
 
     std::vector<Detection> PostprocessYOLO(const float* output_tensor,
                                            int output_size,
-                                           const LetterboxParams& letterbox);
+                                           const LetterboxParams& letterbox) const;
 
-    std::vector<Detection> NonMaxSuppression(std::vector<Detection>& detections);
+    std::vector<Detection> NonMaxSuppression(std::vector<Detection>& detections) const;
 
     void PinThreadToCore(int core_id);
 
     int CalculatePredictionCount(int width, int height) const;
 
-    float* GetInputBuffer(size_t size);
-    float* GetOutputBuffer(size_t size);
-    void ReleaseBuffers();
-
     static inline float Sigmoid(float x) {
         return 1.0f / (1.0f + std::exp(-x));
     }
@@ -196,28 +223,6 @@ private:
 };
 
 
-namespace neon {
-
-#ifdef __ARM_NEON
-
-void ResizeImageNEON(const uint8_t* src, int src_width, int src_height,
-                     uint8_t* dst, int dst_width, int dst_height);
-
-void BGRtoRGBNormalizeNEON(const uint8_t* bgr_data, float* rgb_data,
-                           int width, int height, float scale = 1.0f/255.0f);
-
-
-void HWCtoCHWNEON(const float* hwc_data, float* chw_data,
-                  int channels, int height, int width);
-
-
-void PreprocessPipelineNEON(const cv::Mat& input, float* output,
-                           int target_width, int target_height);
-#endif
-
-} // namespace neon
-
-
 class PreprocessingThreadPool {
 public:
     PreprocessingThreadPool(int num_threads = 4);
@@ -25,7 +25,6 @@
 #include <opencv2/photo.hpp>
 #include <opencv2/core/cvdef.h>
 #include <opencv2/highgui.hpp>
-#include <boost/circular_buffer.hpp>
 
 #include "ball_watcher_image_buffer.h"
 #include "gs_club_data.h"
@@ -39,6 +38,7 @@
 #include "utils/logging_tools.h"
 #include "gs_fsm.h"
 #include "motion_detect.h"
+#include "latency_tracer.h"
 
 
 
@@ -80,6 +80,7 @@ void MotionDetectStage::Read(boost::property_tree::ptree const &params)
 		config_.frame_period = params.get<int>("frame_period", 5);
 		config_.verbose = params.get<int>("verbose", 0);
 		config_.showroi = params.get<int>("show_roi", 0);
+		config_.early_exit_rows = params.get<int>("early_exit_rows", 1);
 	}
 
 	GS_LOG_MSG(trace, "MotionDetectStage::Read set the following values:");
@@ -96,6 +97,7 @@ void MotionDetectStage::Read(boost::property_tree::ptree const &params)
 	GS_LOG_MSG(trace, "    config_.frame_period: " + std::to_string(config_.frame_period));
 	GS_LOG_MSG(trace, "    config_.verbose: " + std::to_string(config_.verbose));
 	GS_LOG_MSG(trace, "    config_.showroi: " + std::to_string(config_.showroi));
+	GS_LOG_MSG(trace, "    config_.early_exit_rows: " + std::to_string(config_.early_exit_rows));
 }
 
 void MotionDetectStage::Configure()
@@ -106,7 +108,7 @@ void MotionDetectStage::Configure()
 	if (gs::GolfSimClubData::kGatherClubData) {
 		int final_frame_buffer_size = 1 + gs::GolfSimClubData::kNumberFramesToSaveBeforeHit + 
 			gs::GolfSimClubData::kNumberFramesToSaveAfterHit;
-		golf_sim::RecentFrames.resize(final_frame_buffer_size);
+		golf_sim::RecentFrames.SetCapacity(final_frame_buffer_size);
 
 		GS_LOG_MSG(trace, "Circular frame buffer size re-set to: " + std::to_string(final_frame_buffer_size));
 	}
@@ -120,9 +122,15 @@ void MotionDetectStage::Configure()
 
 	StreamInfo info = app_->GetStreamInfo(stream_);
 
+	// Allocate the frame ring's buffers now, rather than in the watch loop
+	golf_sim::RecentFrames.clear();
+	golf_sim::RecentFrames.Preallocate(info.height, info.width, CV_8U);
+
 	config_.hskip = std::max(config_.hskip, 1);
 	config_.vskip = std::max(config_.vskip, 1);
 
+	const unsigned int full_image_width = info.width;
+
 	info.width /= config_.hskip;
 	info.height /= config_.vskip;
 
@@ -160,7 +168,22 @@ void MotionDetectStage::Configure()
 	GS_LOG_MSG(trace, "    region_threshold_: " + std::to_string(region_threshold_));
 	GS_LOG_MSG(trace, "    max_region_threshold_ " + std::to_string(max_region_threshold_));
 
-	previous_frame_.resize(roi_width_ * roi_height_);
+	golf_sim::MotionDetectKernel::Settings kernel_settings;
+	kernel_settings.roi_x = roi_x_;
+	kernel_settings.roi_y = roi_y_;
+	kernel_settings.roi_width = roi_width_;
+	kernel_settings.roi_height = roi_height_;
+	kernel_settings.hskip = config_.hskip;
+	kernel_settings.vskip = config_.vskip;
+	kernel_settings.image_width = full_image_width;
+	kernel_settings.difference_m = config_.difference_m;
+	kernel_settings.difference_c = config_.difference_c;
+	kernel_settings.region_threshold = region_threshold_;
+	kernel_settings.early_exit_rows = std::max(config_.early_exit_rows, 1);
+
+	motion_kernel_.Configure(kernel_settings);
+
+	GS_LOG_MSG(trace, "    motion kernel backend: " + std::string(golf_sim::MotionDetectKernel::BackendName()));
 
 	first_time_ = true;
 	motion_detected_ = false;
@@ -207,27 +230,14 @@ bool MotionDetectStage::Process(CompletedRequestPtr& completed_request)
 
     StreamInfo info = app_->GetStreamInfo(stream_);
 
-	// We need to protect access to first_time_, previous_frame_ and motion_detected_.
+	// We need to protect access to first_time_, motion_kernel_ and motion_detected_.
 	std::lock_guard<std::mutex> lock(mutex_);
 
-	unsigned int sampledFrameStride = info.stride * config_.vskip;
-
 	if (first_time_)
 	{
 		first_time_ = false;
 		// Coordinates here are relative to a sampled version of the image
-		// The previous_frame_ is just a non-aligned width & height buffer 
-
-		for (unsigned int y = 0; y < roi_height_; y++)
-		{
-			uint8_t *new_value_ptr = image + ((roi_y_ + y) * sampledFrameStride) + (roi_x_ * config_.hskip);
-			uint8_t *old_value_ptr = &previous_frame_[0] + y * roi_width_;
-
-			// Now traverse across the incoming frame in the x direction for this row
-			for (unsigned int x = 0; x < roi_width_; x++, new_value_ptr += config_.hskip) {
-				*(old_value_ptr++) = *new_value_ptr;
-			}
-		}
+		motion_kernel_.Reset(image, info.stride);
 
 		completed_request->post_process_metadata.Set("motion_detect.result", false);
 
@@ -245,34 +255,12 @@ bool MotionDetectStage::Process(CompletedRequestPtr& completed_request)
 
 	unsigned int regions = 0;
 
-	// Count the  pixels where the difference between the new and previous values
+	// Count the pixels where the difference between the new and previous values
 	// exceeds the threshold. At the same time, update the previous image buffer.
-	for (unsigned int y = 0; !local_motion_detected && y < roi_height_; y++)
-	{
-		uint8_t* new_value_ptr = image + ((roi_y_ + y) * sampledFrameStride) + (roi_x_ * config_.hskip);
-		uint8_t* old_value_ptr = &previous_frame_[0] + y * roi_width_;
-		for (unsigned int x = 0; x < roi_width_; x++, new_value_ptr += config_.hskip)
-		{
-			int new_value = *new_value_ptr;
-			int old_value = *old_value_ptr;
-
-			// TBD - Remove
-			// LOG(1, "sampledFrameStride: " << sampledFrameStride << ". old= " << old_value << " new= " << new_value << " .New_ptr: " << (long)new_value_ptr << ".Old_ptr : " << (long)old_value_ptr << ".");
-
-
-			*(old_value_ptr++) = new_value;
-			if (std::abs(new_value - old_value) > (config_.difference_m * (float)old_value + config_.difference_c)) {
-				regions++;
-			}
-		}
-
-		local_motion_detected = (regions >= region_threshold_);
+	if (!local_motion_detected) {
+		local_motion_detected = motion_kernel_.DetectMotion(image, info.stride, &regions);
 
-		// Break out early if we've already figured out there's motion
-		if (local_motion_detected) {
-			// std::cout << "Motion detected - Regions = " << regions << ", y row value was: " << y << std::endl;
-			break;
-		}
+		gs::LatencyTracer::GetSharedTracer().Record(completed_request->sequence, gs::LatencyTracer::Event::kMotionDecision);
 	}
 
 	// TBD - Only for testing - REMOVE
@@ -286,6 +274,7 @@ bool MotionDetectStage::Process(CompletedRequestPtr& completed_request)
 		// as possible, because otherwise the ball will fly past the camera 2 FoV
 		if (gs::GolfSimOptions::GetCommandLineOptions().system_mode_ != gs::kCamera1TestStandalone) {
 			gs::PulseStrobe::SendExternalTrigger();
+			gs::LatencyTracer::GetSharedTracer().Record(completed_request->sequence, gs::LatencyTracer::Event::kTriggerSent);
 			GS_LOG_MSG(trace, "---> SendExternalTrigger");
 		}
 		else {
@@ -311,6 +300,9 @@ bool MotionDetectStage::Process(CompletedRequestPtr& completed_request)
 		GS_LOG_MSG(trace, "Will save an additional " + std::to_string(postMotionFramesToCapture_) + " frames.");
 	}
 
+	// Now that the trigger (if any) is out, get the kernel ready for the next frame
+	motion_kernel_.UpdateThresholds();
+
 	// Ensure we don't tell the outer loop that there's motion until we've completed viewing
 	// the post-motion images
 	if (postMotionFramesToCapture_ > 1) {
@@ -331,57 +323,33 @@ bool MotionDetectStage::Process(CompletedRequestPtr& completed_request)
 
 		// std::cout << "postFrames: " << std::to_string(postMotionFramesToCapture_) << std::endl;
 
-		golf_sim::RecentFrameInfo frameInfo;
+		// The frame is copied once into a recycled ring slot - no per-frame allocation or
+		// annotation here.  The frame number and ROI are only drawn if the frame is exported.
+		cv::Mat mat = cv::Mat(info.height, info.width, CV_8U, image, info.stride);
+
+		golf_sim::RecentFrameInfo& enqueuedFrameInfo = golf_sim::RecentFrames.PushFrame(mat);
 
-		frameInfo.requestSequence = completed_request->sequence;
-		frameInfo.frameRate = completed_request->framerate;
+		enqueuedFrameInfo.requestSequence = completed_request->sequence;
+		enqueuedFrameInfo.frameRate = completed_request->framerate;
 
 		// If we haven't started taking any post-motion frames yet, then this is the frame
 		// during which the movement was first detected.
-		frameInfo.isballHitFrame = (postMotionFramesToCapture_ == gs::GolfSimClubData::kNumberFramesToSaveAfterHit);
-
-		cv::Mat mat = cv::Mat(info.height, info.width, CV_8U, image, info.stride);
+		enqueuedFrameInfo.isballHitFrame = (postMotionFramesToCapture_ == gs::GolfSimClubData::kNumberFramesToSaveAfterHit);
 
 		if (config_.showroi) {
-			cv::Scalar c_black{ 0, 0, 0 }; // black
-			cv::Scalar c_green{ 170, 255, 0 }; // bright green
-
-			// We could have different frame sizes for the "hit" frame?
-			int rectWidth = frameInfo.isballHitFrame ? 2 : 2;
-
-			cv::Scalar rectangle_color = frameInfo.isballHitFrame ? c_green : c_black;
-
-			cv::Point startPoint = cv::Point(roi_x_ * config_.hskip, roi_y_ * config_.vskip);
-
-			cv::Point endPoint = cv::Point((roi_x_ + roi_width_) * config_.hskip, (roi_y_ + roi_height_) * config_.vskip);
-
-			cv::rectangle(mat, startPoint, endPoint, rectangle_color, rectWidth);
+			enqueuedFrameInfo.showRoi = true;
+			enqueuedFrameInfo.roi = cv::Rect(cv::Point(roi_x_ * config_.hskip, roi_y_ * config_.vskip),
+											 cv::Point((roi_x_ + roi_width_) * config_.hskip, (roi_y_ + roi_height_) * config_.vskip));
 		}
 
-		// Number the frame 
-		cv::Scalar c_label{ 170, 255, 0 }; // bright green
-		std::string frame_label = std::to_string(completed_request->sequence);
-		int text_x = info.width - 60;
-		int text_y = 25;
-
-		cv::putText(mat, frame_label, cv::Point(text_x, text_y), cv::FONT_HERSHEY_SIMPLEX, 0.8, c_label, 2, cv::LINE_AA);
-
 		// TBD - Too Much Logging - GS_LOG_MSG(trace, "Pushing Post-Motion Frame No. " + std::to_string(postMotionFramesToCapture_) + " - Seq. No. " + std::to_string(completed_request->sequence));
 
-		golf_sim::RecentFrames.push_back(frameInfo);
-
-		golf_sim::RecentFrameInfo& enqueuedFrameInfo = golf_sim::RecentFrames.back();
-
-		// Make sure that the enqueued frame info has its own Mat, as the push_back
-		// might only do a shallow copy. TBD - figure this out!
-		enqueuedFrameInfo.mat = mat.clone();
-
 		if (enqueuedFrameInfo.mat.empty()) {
 			GS_LOG_MSG(error, "Enqueued a null club data image");
 		}
 
 		if (need_to_log_first_image_) {
-			gs::LoggingTools::LogImage("", mat, std::vector < cv::Point >{}, true, "gs_log_first_cropped_image_of_teed_ball.png");
+			gs::LoggingTools::LogImage("", enqueuedFrameInfo.GetAnnotatedMat(), std::vector < cv::Point >{}, true, "gs_log_first_cropped_image_of_teed_ball.png");
 			need_to_log_first_image_ = false;  // Don't save again
 		}
 
@@ -48,15 +48,6 @@ namespace golf_sim {
 	// as the slow on pulses
 	std::vector<float>  PulseStrobe::pulse_intervals_tail_repeat_ms_;
 
-	char* PulseStrobe::camera_slow_pulse_sequence_ = nullptr;
-	char* PulseStrobe::camera_fast_pulse_sequence_ = nullptr;
-	char* PulseStrobe::no_pulse_camera_sequence_ = nullptr;
-	char* PulseStrobe::tail_repeat_pulse_sequence_ = nullptr;
-
-	unsigned long PulseStrobe::camera_fast_pulse_sequence_length_ = 0;
-	unsigned long PulseStrobe::camera_slow_pulse_sequence_length_ = 0;
-	unsigned long PulseStrobe::tail_repeat_sequence_length_ = 0;
-
 	int PulseStrobe::spiHandle_ = -1;
 	int PulseStrobe::lggpio_chip_handle_ = -1;
 	bool PulseStrobe::spiOpen_ = false;
@@ -73,8 +64,6 @@ namespace golf_sim {
 
 
 	int PulseStrobe::kLastPulsePutterRepeats = 5;
-	// Will be set when the pulse vector is set
-	unsigned long PulseStrobe::last_pulse_off_time;
 
 	// NOTE - lgpio library appears to use BCM pin numbering by default
 	const int kPulseTriggerOutputPin = 25;   // This is BCM GPIO25, pin 22
@@ -108,189 +97,64 @@ namespace golf_sim {
 	const int kTestPeriodSecs = 10; //  120;
 
 
-	int PulseStrobe::AlignLengthToWordSize(int initialBufferLength, int wordSizeBits) {
-
-		int leftOver = initialBufferLength % (wordSizeBits / 8);
-		if (leftOver == 0)
-			return initialBufferLength;
-		else
-			return initialBufferLength + (wordSizeBits / 8) - leftOver;
-	}
-
-	char* PulseStrobe::BuildPulseTrain(const unsigned long baud_rate,
-									const std::vector<float>& intervals,
-									int number_bits_for_on_pulse_input,
-									const unsigned int kBitsPerWord, 
-									unsigned long& result_length,
-									bool turn_off_strobes) {
-
-		// TBD - All this setup needs to be done prior to the triggering so as not to waste time
-
-		// May need to alter the on-bits
-		int number_bits_for_on_pulse = number_bits_for_on_pulse_input;
-
-		double kBaudRatePulseMultiplier = 1.0;
-		GolfSimConfiguration::SetConstant("gs_config.strobing.kBaudRatePulseMultiplier", kBaudRatePulseMultiplier);
-
-		// NOTE - The actual speed will depend on the clock speed of the
-		// Pi, which can vary unless you set force_turbo = 1 in boot/config
-		const double bytesFor1000Ms = (baud_rate / 8.) * kBaudRatePulseMultiplier;
-		GS_LOG_TRACE_MSG(trace, "bytesFor1000Ms = " + std::to_string(bytesFor1000Ms));
-
-		static const unsigned long kMaxPulseBufferSize = 800000;   // Big enough for any reasonable pulse train
-
-		bool kTakingOnePulsePicture = false;  // TBD - for debugging
-
-		// A '0' at the end of the pulse sequence just creates one last pause in the last 
-		// part of the sequence
-
-		LoggingTools::Trace("pulse_interval (may be fast or slow) vector is:", intervals);
-
-		static char buf[kMaxPulseBufferSize];
-
-		// Make sure the array is cleared initially to be safe
-		char* begin = &buf[0];
-		char* end = begin + sizeof(buf);
-		std::fill(begin, end, 0);
-
-		// For now, the pulse must be 8 bits or less, each bit being about 5 uS of 'on' time
-		// For example, 0b01111000 will be about a 20 uS pulse.
-		// The pulse pattern must start with the 'on' bits, e.g., 11....
-
-		// NOTE -This value must be initialized to reflect the number of 0's on the
-		// right-hand side of the kPulseBitPatternInt, above.
-		int remainder_bits_from_prior_pulse = 8 - number_bits_for_on_pulse;
-
-		unsigned long current_byte = 0;
-		int next_pattern_zero_bits_pad = 0;
-
-		// TBD- REMOVE -FOR TESTING ONLY
-		if ((GolfSimOptions::GetCommandLineOptions().camera_still_mode_ ||
-			GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera2AutoCalibrate ||
-			GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera2BallLocation)) {
-
-			// Double the basic "on" pulse length, because we are only going to send one pulse
-			number_bits_for_on_pulse *= 2;
-			// Ensure the pulse is not so long that the ball will be over-saturated
-			number_bits_for_on_pulse = std::min(15, number_bits_for_on_pulse);
-			GS_LOG_TRACE_MSG(trace, "Due to still/calibration/locate mode, will send a pulse of length: " + std::to_string(number_bits_for_on_pulse));
-		}
-
-		// Invariant - current_byte is the index of the next unused byte in the buffer, and is
-		// equal to the length of the in-use buffer
-		for (float const& strobe_off_time_ms : intervals) {
-			// Determine the on and off bits to fill the next two bytes
-			unsigned char first_byte_bit_pattern, second_byte_bit_pattern;
-
-			remainder_bits_from_prior_pulse = GetNextTwoPulseBytes(next_pattern_zero_bits_pad, 
-																   number_bits_for_on_pulse,
-																   first_byte_bit_pattern,
-																   second_byte_bit_pattern);
-
-			// Start with a short "on" pulse to turn on the strobe LED light
-			if (turn_off_strobes) {
-				GS_LOG_TRACE_MSG(trace, "Creating a dummy pulse train with no strobe-on pulses");
-				buf[current_byte++] = 0;
-			}
-			else {
-				buf[current_byte++] = first_byte_bit_pattern;
-				buf[current_byte++] = second_byte_bit_pattern;
-			}
-
-			// TBD- REMOVE - FOR TESTING ONLY
-			if ( (!GolfSimOptions::GetCommandLineOptions().camera_still_mode_ &&
-				GolfSimOptions::GetCommandLineOptions().system_mode_ != SystemMode::kCamera2AutoCalibrate &&
-				GolfSimOptions::GetCommandLineOptions().system_mode_ != SystemMode::kCamera2BallLocation) ) {
-
-				// Then, turn off the strobe for the specified number of milliseconds.
-
-				// Minus 1 for first pulse,  Plus 1 for the final strobe trigger.
-				// Note that we need to account for the actual on-pulse bits as well
-				long off_bits = (long)(std::round(((strobe_off_time_ms / 1000.0) * bytesFor1000Ms * 8.0)) - remainder_bits_from_prior_pulse) - number_bits_for_on_pulse;
-				if (off_bits < 0) {
-					off_bits = 0;
-				}				
-
-				int one_pulse_cycle_length_bytes = (int)std::floor(off_bits / 8);
-
-				next_pattern_zero_bits_pad = off_bits - (one_pulse_cycle_length_bytes * 8);
+	PulseTrainSpec PulseStrobe::GetPulseTrainSpec(const unsigned long baud_rate,
+												  const std::vector<float>& intervals,
+												  const int number_bits_for_on_pulse,
+												  const unsigned int bits_per_word,
+												  bool turn_off_strobes) {
+		PulseTrainSpec spec;
+		spec.baud_rate = baud_rate;
+		spec.intervals_ms = intervals;
+		spec.number_bits_for_on_pulse = number_bits_for_on_pulse;
+		spec.bits_per_word = bits_per_word;
+		spec.turn_off_strobes = turn_off_strobes;
 
-				// Fill in everything after the on-pulse (and its adjacent pad byte) with 0's
-				for (int i = 0; i < one_pulse_cycle_length_bytes; i++) {
-					buf[current_byte++] = 0;
-				}
-			}
-			else
-			{
-				// If we want just a single, simple image, then we'll just send the strobe pulse 
-				// followed by a short additional amount of shutter-on time to make sure the 
-				// shutter pulse is not too short.
-				buf[current_byte++] = 0;
-
-				GS_LOG_TRACE_MSG(trace, "Due to still/calibration/locate mode, will send only one pulse.");
-
-				break;
-			}
+		GolfSimConfiguration::SetConstant("gs_config.strobing.kBaudRatePulseMultiplier", spec.baud_rate_pulse_multiplier);
 
-			if (current_byte > (double)kMaxPulseBufferSize * 0.9) {
-				GS_LOG_MSG(error, "Pulse trigger buffer overrun.  Shutting down.  Buffer size was: " +
-					std::to_string(kMaxPulseBufferSize) + ", and current strobe is: " + 
-					std::to_string(strobe_off_time_ms));
-				return nullptr;
-			}
-		}
+		// If we want just a single, simple image, then we'll just send one (longer) strobe pulse
+		spec.single_pulse = (GolfSimOptions::GetCommandLineOptions().camera_still_mode_ ||
+							 GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera2AutoCalibrate ||
+							 GolfSimOptions::GetCommandLineOptions().system_mode_ == SystemMode::kCamera2BallLocation);
 
-		// Round the size of the buffer up in order to end on an even word boundary
-		GS_LOG_TRACE_MSG(trace, "Initial buffer size at " + std::to_string(baud_rate) + " baud is " + std::to_string(current_byte) + " bytes.");
-		unsigned long final_buffer_size = AlignLengthToWordSize(current_byte, kBitsPerWord);
-		GS_LOG_TRACE_MSG(trace, "Final Buffer size is " + std::to_string(final_buffer_size) + " bytes.");
-
-		unsigned long bytes_to_fill = final_buffer_size - current_byte;
-		for (unsigned long i = 0; i < bytes_to_fill; i++) {
-			buf[current_byte++] = 0;
-		}
+		return spec;
+	}
 
-		result_length = current_byte;
+	bool PulseStrobe::BuildPulseTrains() {
+		long kBaudRateForFastPulses = 0;
+		long kBaudRateForSlowPulses = 0;
+		GolfSimConfiguration::SetConstant("gs_config.strobing.kBaudRateForFastPulses", kBaudRateForFastPulses);
+		GolfSimConfiguration::SetConstant("gs_config.strobing.kBaudRateForSlowPulses", kBaudRateForSlowPulses);
 
-		char* return_buffer = new char[result_length];
-		memcpy(return_buffer, buf, result_length);
+		PulseTrainCache::ProfileSpecs specs;
+		specs[(size_t)PulseTrainCache::Profile::kFast] = GetPulseTrainSpec((unsigned long)kBaudRateForFastPulses, pulse_intervals_fast_ms_,
+																		   number_bits_for_fast_on_pulse_, kBitsPerWord);
+		specs[(size_t)PulseTrainCache::Profile::kSlow] = GetPulseTrainSpec((unsigned long)kBaudRateForSlowPulses, pulse_intervals_slow_ms_,
+																		   number_bits_for_slow_on_pulse_, kBitsPerWord);
+		specs[(size_t)PulseTrainCache::Profile::kTailRepeat] = GetPulseTrainSpec((unsigned long)kBaudRateForSlowPulses, pulse_intervals_tail_repeat_ms_,
+																				 number_bits_for_slow_on_pulse_, kBitsPerWord);
 
-		last_pulse_off_time = (long)std::round(intervals.back());
+		LoggingTools::Trace("Fast pulse intervals are:", pulse_intervals_fast_ms_);
+		LoggingTools::Trace("Slow pulse intervals are:", pulse_intervals_slow_ms_);
 
-		return return_buffer;
-	}
+		PulseTrainCache& cache = PulseTrainCache::GetSharedCache();
 
-	int PulseStrobe::GetNextTwoPulseBytes(const int next_pattern_zero_bits_pad, 
-										  const int number_bits_for_on_pulse,
-										  unsigned char& first_byte_bit_pattern,
-										  unsigned char& second_byte_bit_pattern) {
-		if (number_bits_for_on_pulse < 1) {
-			GS_LOG_MSG(error, "PulseStrobe::GetNextTwoPulseBytes called with number_bits_for_fast_on_pulse < 1.");
-			return -1;
+		if (!cache.Rebuild(specs)) {
+			GS_LOG_MSG(error, "Failed to build pulse sequences.");
+			return false;
 		}
 
-		// Create the default, left-justified bit-pulse pattern
-		uint16_t next_bit_pattern = { 0b1000000000000000 };
+		const std::shared_ptr<const PulseTrain> fast_train = cache.Get(PulseTrainCache::Profile::kFast);
+		const std::shared_ptr<const PulseTrain> slow_train = cache.Get(PulseTrainCache::Profile::kSlow);
 
-		for (int b = 0; b < number_bits_for_on_pulse - 1; b++) {
-			next_bit_pattern >>= 1;
-			next_bit_pattern |= uint16_t(0b1000000000000000);
+		if (fast_train == nullptr || slow_train == nullptr) {
+			GS_LOG_MSG(error, "Failed to build pulse sequences - the fast and slow pulse vectors must both be set in the .json file.");
+			return false;
 		}
 
-		// Shift the on-bits to the right and fill in with the remaining 0 bits from the
-		// prior pulse sequence
-		next_bit_pattern >>= next_pattern_zero_bits_pad;
-
-		// TBD - Is this byte-ordering platform/architecture-independent??
-		uint16_t mask{ 0b0000000011111111 };
-		second_byte_bit_pattern = (unsigned char)(next_bit_pattern & mask);
-		uint16_t tmp_word = next_bit_pattern;
-		tmp_word >>= 8;
-		first_byte_bit_pattern = (unsigned char)tmp_word;
+		GS_LOG_TRACE_MSG(trace, "Fast pulse sequence is " + std::to_string(fast_train->length()) +
+								" bytes, slow pulse sequence is " + std::to_string(slow_train->length()) + " bytes.");
 
-		int right_most_zero_bits = 16 - (next_pattern_zero_bits_pad + number_bits_for_on_pulse);
-
-		return right_most_zero_bits;
+		return true;
 	}
 
 	int PulseStrobe::OpenSpi(const unsigned int baud, int wordSizeBits) {
@@ -350,34 +214,26 @@ namespace golf_sim {
 
 	bool PulseStrobe::SendCameraStrobeTriggerAndShutter(int lgGpioHandle, bool send_no_strobes) {
 
-		// The pulse sequence should have been pre-computed prior to calling this
-		unsigned long result_length = 0;
-		char* buf = 0;
+		// The pulse sequence should have been pre-compiled prior to calling this
+		PulseTrainCache::Profile profile = PulseTrainCache::Profile::kFast;
 
 		if (send_no_strobes) {
 			// DEPRECATED - REMOVE
 			GS_LOG_MSG(error, "SendCameraStrobeTriggerAndShutter sending dummy strobe sequence (with no ON strobes).");
-			buf = camera_fast_pulse_sequence_;
-			result_length = camera_fast_pulse_sequence_length_;
 		}
-		else {
-			if (GolfSimClubs::GetCurrentClubType() == GolfSimClubs::GsClubType::kPutter) {
-				buf = camera_slow_pulse_sequence_;
-				result_length = camera_slow_pulse_sequence_length_;
-			}
-			else {
-				buf = camera_fast_pulse_sequence_;
-				result_length = camera_fast_pulse_sequence_length_;
-			}
+		else if (GolfSimClubs::GetCurrentClubType() == GolfSimClubs::GsClubType::kPutter) {
+			profile = PulseTrainCache::Profile::kSlow;
 		}
 
-		if (camera_fast_pulse_sequence_length_ == 0 || 
-			camera_slow_pulse_sequence_length_ == 0 || 
-			buf == nullptr ) {
-			GS_LOG_MSG(error, "SendCameraStrobeTriggerAndShutter called before camera_pulse_sequence was set up.");
+		const std::shared_ptr<const PulseTrain> pulse_train = PulseTrainCache::GetSharedCache().Get(profile);
+
+		if (pulse_train == nullptr || pulse_train->length() == 0) {
+			GS_LOG_MSG(error, "SendCameraStrobeTriggerAndShutter called before the pulse trains were built.");
 			return false;
 		}
 
+		const unsigned long result_length = pulse_train->length();
+
 		// For putting mode, we need to wait a bit to ensure the ball is in the frame
 
 #ifdef __unix__  // Ignore in Windows environment
@@ -400,7 +256,7 @@ namespace golf_sim {
 			lgGpioWrite(lggpio_chip_handle_, kPulseTriggerOutputPin, kON);
 		}
 
-		int bytes_sent = lgSpiWrite(spiHandle_, buf, result_length);
+		int bytes_sent = lgSpiWrite(spiHandle_, pulse_train->data(), result_length);
 		bool shutter_failure = false;
 
 		if (bytes_sent != (int)result_length) {
@@ -417,7 +273,7 @@ namespace golf_sim {
 			lgGpioWrite(lggpio_chip_handle_, kPulseTriggerOutputPin, kOFF);
 		}
 
-		GS_LOG_TRACE_MSG(trace, "SendCameraStrobeTriggerAndShutter sent pulse sequence of length = " + std::to_string(camera_fast_pulse_sequence_length_) + " bytes.");
+		GS_LOG_TRACE_MSG(trace, "SendCameraStrobeTriggerAndShutter sent pulse sequence of length = " + std::to_string(result_length) + " bytes.");
 
 
 		return !shutter_failure;
@@ -533,28 +389,8 @@ namespace golf_sim {
 
 		GolfSimConfiguration::SetConstant("gs_config.strobing.number_bits_for_slow_on_pulse_", number_bits_for_slow_on_pulse_);
 
-		long kBaudRateForFastPulses;
-		long kBaudRateForSlowPulses;
-		GolfSimConfiguration::SetConstant("gs_config.strobing.kBaudRateForFastPulses", kBaudRateForFastPulses);
-		GolfSimConfiguration::SetConstant("gs_config.strobing.kBaudRateForSlowPulses", kBaudRateForSlowPulses);
-
-		// Pre-compute the pulse sequences to save time later
-		GS_LOG_TRACE_MSG(trace, "Building Fast pulse sequence.");
-		camera_fast_pulse_sequence_ = PulseStrobe::BuildPulseTrain((unsigned long)kBaudRateForFastPulses, pulse_intervals_fast_ms_, number_bits_for_fast_on_pulse_,
-														kBitsPerWord, camera_fast_pulse_sequence_length_, false);
-		GS_LOG_TRACE_MSG(trace, "Building Slow pulse sequence.");
-		camera_slow_pulse_sequence_ = PulseStrobe::BuildPulseTrain((unsigned long)kBaudRateForSlowPulses, pulse_intervals_slow_ms_, number_bits_for_slow_on_pulse_,
-														kBitsPerWord, camera_slow_pulse_sequence_length_, false);
-		GS_LOG_TRACE_MSG(trace, "Building follow-on pulse sequence.");
-		tail_repeat_pulse_sequence_ = PulseStrobe::BuildPulseTrain((unsigned long)kBaudRateForSlowPulses, pulse_intervals_tail_repeat_ms_, number_bits_for_slow_on_pulse_,
-			kBitsPerWord, tail_repeat_sequence_length_, false);
-
-		if (camera_fast_pulse_sequence_ == nullptr || camera_slow_pulse_sequence_ == nullptr) {
-			GS_LOG_MSG(error, "Failed to build pulse sequences.");
-			return false;
-		}
-
-		return true;
+		// Pre-compile the pulse sequences so that the trigger only has to send them
+		return BuildPulseTrains();
 	}
 
 	bool PulseStrobe::DeinitGPIOSystem() {
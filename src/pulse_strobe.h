@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "utils/logging_tools.h"
+#include "pulse_train_cache.h"
 
 
 namespace golf_sim {
@@ -41,26 +42,26 @@ namespace golf_sim {
 		//      ratio sequence:  {    1.67,    2.2       2.5      1.33         }
 		static std::vector<double> GetPulseRatios();
 
-		// Caller owns the byte buffer that is returned
-		static char* BuildPulseTrain(const unsigned long baud_rate, 
-									 const std::vector<float>& intervals,
-									 const int number_bits_for_on_pulse,
-									 const unsigned int kBitsPerWord, 
-									 unsigned long& result_length,
-									 bool turn_off_strobes = false);
+		// Describes the SPI pulse train for the intervals, including the baud-rate
+		// multiplier and the single-pulse still/calibration/locate modes
+		static PulseTrainSpec GetPulseTrainSpec(const unsigned long baud_rate,
+												const std::vector<float>& intervals,
+												const int number_bits_for_on_pulse,
+												const unsigned int bits_per_word,
+												bool turn_off_strobes = false);
 
-		static int GetNextTwoPulseBytes(const int next_pattern_zero_bits_pad,
-										const int number_bits_for_on_pulse,
-										unsigned char& first_byte_bit_pattern,
-										unsigned char& second_byte_bit_pattern);
+		// (Re)compiles the fast, slow and follow-on pulse trains from the current
+		// configuration into the PulseTrainCache.  Only the trains whose settings
+		// changed are recompiled.  Called by InitGPIOSystem, and should be called
+		// again if the strobe settings change.
+		static bool BuildPulseTrains();
 
 		static bool SendCameraPrimingPulses(bool use_high_speed);
 		static bool SendExternalTrigger();
 
-		// Sends the already-created pulse buffer to the strobes via SPI, and also
-		// opens the shutter while the pulses are sent.
-		// requires the camera_fast_pulse_sequence_ to have already been created by
-		// the BuildPulseTrain function.
+		// Sends the already-compiled pulse train for the current club to the strobes
+		// via SPI, and also opens the shutter while the pulses are sent.
+		// Requires the pulse trains to have already been built by BuildPulseTrains.
 		// send_no_strobes can be set to true in order to get a "before" or "pre" image
 		// that shows just the ambient light.
 		static bool SendCameraStrobeTriggerAndShutter(int spiHandle, bool send_no_strobes = false);
@@ -91,7 +92,7 @@ namespace golf_sim {
 		// This vector describes the amount of time to send 0's after sending a strobe
 		// pulse.  The last pulse should be of size 0 to ensure the pulse sequence ends
 		// with the pulse turned OFF.
-		// Should be setup in the BuildPulseTrain function
+		// Should be setup in the InitGPIOSystem function
 		// Pulse intervals must be > 0.0 for all but the last pulse
 		static std::vector<float> pulse_intervals_fast_ms_;
 		static std::vector<float> pulse_intervals_slow_ms_;
@@ -100,16 +101,6 @@ namespace golf_sim {
 		static int number_bits_for_fast_on_pulse_;
 		static int number_bits_for_slow_on_pulse_;
 
-		// This is the buffer that will be written out (bit-banged) to the SPI channel
-		static char* camera_slow_pulse_sequence_;
-		static char* camera_fast_pulse_sequence_;
-		static char* no_pulse_camera_sequence_;  // Will be all 0's, but the same length as the 'real' pulse sequence
-		static unsigned long camera_fast_pulse_sequence_length_;
-		static unsigned long camera_slow_pulse_sequence_length_;
-
-		static char* tail_repeat_pulse_sequence_;
-		static unsigned long tail_repeat_sequence_length_;
-
 		static int spiHandle_;
 		static bool spiOpen_;
 		static int lggpio_chip_handle_;
@@ -118,9 +109,6 @@ namespace golf_sim {
 		// The number of times the last (usually quite long pulse-off interval)
 		// will be repeated after the earlier part of the pulse pattern
 		static int kLastPulsePutterRepeats;
-		static unsigned long last_pulse_off_time;
-
-		static int AlignLengthToWordSize(int initialBufferLength, int wordSizeBits);
 	};
 
 }
@@ -0,0 +1,237 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "utils/logging_tools.h"
+
+#include "pulse_train_cache.h"
+
+
+namespace golf_sim {
+
+    bool PulseTrainCompiler::Validate(const PulseTrainSpec& spec, std::string& error) {
+
+        if (spec.baud_rate == 0) {
+            error = "baud rate is 0";
+            return false;
+        }
+
+        if (!std::isfinite(spec.baud_rate_pulse_multiplier) || spec.baud_rate_pulse_multiplier <= 0.0) {
+            error = "baud rate pulse multiplier must be > 0, but was " + std::to_string(spec.baud_rate_pulse_multiplier);
+            return false;
+        }
+
+        if (spec.intervals_ms.empty()) {
+            error = "there are no pulse intervals";
+            return false;
+        }
+
+        for (size_t i = 0; i < spec.intervals_ms.size(); i++) {
+            if (!std::isfinite(spec.intervals_ms[i]) || spec.intervals_ms[i] < 0.0F) {
+                error = "pulse interval " + std::to_string(i) + " was " + std::to_string(spec.intervals_ms[i]);
+                return false;
+            }
+        }
+
+        // The on-pulse (and the zero bits before it) are built in a 16-bit word
+        if (spec.number_bits_for_on_pulse < 1 || spec.number_bits_for_on_pulse > 16) {
+            error = "number of bits for the on-pulse must be from 1 to 16, but was " + std::to_string(spec.number_bits_for_on_pulse);
+            return false;
+        }
+
+        if (spec.bits_per_word == 0 || spec.bits_per_word % 8 != 0) {
+            error = "bits per word must be a multiple of 8, but was " + std::to_string(spec.bits_per_word);
+            return false;
+        }
+
+        return true;
+    }
+
+    std::shared_ptr<const PulseTrain> PulseTrainCompiler::Compile(const PulseTrainSpec& spec) {
+
+        std::string reason;
+
+        if (!Validate(spec, reason)) {
+            GS_LOG_MSG(error, "PulseTrainCompiler::Compile - invalid pulse train: " + reason + ".");
+            return nullptr;
+        }
+
+        if (spec.intervals_ms.back() > 0.0001F) {
+            GS_LOG_TRACE_MSG(warning, "PulseTrainCompiler::Compile - expected last pulse interval to be 0.  Check .json file.");
+        }
+
+        // NOTE - The actual speed will depend on the clock speed of the
+        // Pi, which can vary unless you set force_turbo = 1 in boot/config
+        const double bytes_for_1000_ms = (spec.baud_rate / 8.) * spec.baud_rate_pulse_multiplier;
+
+        int number_bits_for_on_pulse = spec.number_bits_for_on_pulse;
+
+        if (spec.single_pulse) {
+            // Double the basic "on" pulse length, because we are only going to send one pulse.
+            // Ensure the pulse is not so long that the ball will be over-saturated.
+            number_bits_for_on_pulse = std::min(15, number_bits_for_on_pulse * 2);
+        }
+
+        const size_t max_bytes = (size_t)(kMaxPulseTrainBytes * 0.9);
+
+        auto train = std::make_shared<PulseTrain>();
+        train->spec = spec;
+        std::vector<char>& bytes = train->bytes;
+
+        double total_ms = 0.0;
+        for (float interval_ms : spec.intervals_ms) {
+            total_ms += interval_ms;
+        }
+        bytes.reserve(std::min(max_bytes, (size_t)(total_ms / 1000.0 * bytes_for_1000_ms) + 3 * spec.intervals_ms.size() + 8));
+
+        // The off bits at the start of the next pulse's first byte
+        int next_pattern_zero_bits_pad = 0;
+
+        for (float strobe_off_time_ms : spec.intervals_ms) {
+            unsigned char first_byte_bit_pattern = 0, second_byte_bit_pattern = 0;
+
+            const int remainder_bits_from_prior_pulse = GetNextTwoPulseBytes(next_pattern_zero_bits_pad,
+                                                                             number_bits_for_on_pulse,
+                                                                             first_byte_bit_pattern,
+                                                                             second_byte_bit_pattern);
+
+            if (spec.turn_off_strobes) {
+                bytes.push_back(0);
+            }
+            else {
+                bytes.push_back((char)first_byte_bit_pattern);
+                bytes.push_back((char)second_byte_bit_pattern);
+            }
+
+            if (spec.single_pulse) {
+                // Just the strobe pulse, followed by a short additional amount of shutter-on
+                // time to make sure the shutter pulse is not too short
+                bytes.push_back(0);
+                break;
+            }
+
+            // Then, turn off the strobe for the specified number of milliseconds.
+            // Note that we need to account for the actual on-pulse bits as well.
+            long off_bits = (long)(std::round((strobe_off_time_ms / 1000.0) * bytes_for_1000_ms * 8.0) - remainder_bits_from_prior_pulse) - number_bits_for_on_pulse;
+            if (off_bits < 0) {
+                off_bits = 0;
+            }
+
+            const long zero_bytes = off_bits / 8;
+            next_pattern_zero_bits_pad = (int)(off_bits - zero_bytes * 8);
+
+            if (bytes.size() + (size_t)zero_bytes > max_bytes) {
+                GS_LOG_MSG(error, "PulseTrainCompiler::Compile - pulse train would be longer than " + std::to_string(max_bytes) +
+                                  " bytes at strobe interval " + std::to_string(strobe_off_time_ms) + " ms.");
+                return nullptr;
+            }
+
+            bytes.insert(bytes.end(), (size_t)zero_bytes, 0);
+        }
+
+        // Round the size of the buffer up in order to end on an even word boundary
+        const size_t bytes_per_word = spec.bits_per_word / 8;
+        bytes.resize((bytes.size() + bytes_per_word - 1) / bytes_per_word * bytes_per_word, 0);
+
+        GS_LOG_TRACE_MSG(trace, "PulseTrainCompiler::Compile - " + std::to_string(spec.intervals_ms.size()) + " intervals at " +
+                                std::to_string(spec.baud_rate) + " baud compiled to " + std::to_string(bytes.size()) + " bytes.");
+
+        return train;
+    }
+
+    int PulseTrainCompiler::GetNextTwoPulseBytes(const int zero_bits_pad,
+                                                 const int number_bits_for_on_pulse,
+                                                 unsigned char& first_byte_bit_pattern,
+                                                 unsigned char& second_byte_bit_pattern) {
+        if (number_bits_for_on_pulse < 1) {
+            GS_LOG_MSG(error, "PulseTrainCompiler::GetNextTwoPulseBytes called with number_bits_for_on_pulse < 1.");
+            return -1;
+        }
+
+        // Create the default, left-justified bit-pulse pattern
+        uint16_t next_bit_pattern = { 0b1000000000000000 };
+
+        for (int b = 0; b < number_bits_for_on_pulse - 1; b++) {
+            next_bit_pattern >>= 1;
+            next_bit_pattern |= uint16_t(0b1000000000000000);
+        }
+
+        // Shift the on-bits to the right and fill in with the remaining 0 bits from the
+        // prior pulse sequence
+        next_bit_pattern >>= zero_bits_pad;
+
+        // The high byte goes out first, so this does not depend on the platform's byte order
+        second_byte_bit_pattern = (unsigned char)(next_bit_pattern & 0xFF);
+        first_byte_bit_pattern = (unsigned char)(next_bit_pattern >> 8);
+
+        return 16 - (zero_bits_pad + number_bits_for_on_pulse);
+    }
+
+
+    PulseTrainCache& PulseTrainCache::GetSharedCache() {
+        static PulseTrainCache shared_cache;
+        return shared_cache;
+    }
+
+    bool PulseTrainCache::Rebuild(const ProfileSpecs& specs) {
+        TrainSet trains;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            trains = trains_;
+        }
+
+        int number_compiled = 0;
+
+        for (size_t p = 0; p < specs.size(); p++) {
+            if (trains[p] != nullptr && trains[p]->spec == specs[p]) {
+                continue;
+            }
+
+            if (specs[p].intervals_ms.empty()) {
+                // Not configured
+                trains[p] = nullptr;
+                continue;
+            }
+
+            trains[p] = PulseTrainCompiler::Compile(specs[p]);
+
+            if (trains[p] == nullptr) {
+                GS_LOG_MSG(error, "PulseTrainCache::Rebuild - could not compile the pulse train for profile " + std::to_string(p) +
+                                  ".  Keeping the existing pulse trains.");
+                return false;
+            }
+
+            number_compiled++;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        trains_ = trains;
+        generation_++;
+
+        GS_LOG_TRACE_MSG(trace, "PulseTrainCache::Rebuild - compiled " + std::to_string(number_compiled) + " pulse train(s).");
+
+        return true;
+    }
+
+    std::shared_ptr<const PulseTrain> PulseTrainCache::Get(Profile profile) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trains_[(size_t)profile];
+    }
+
+    unsigned long PulseTrainCache::generation() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return generation_;
+    }
+
+    void PulseTrainCache::Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        trains_ = TrainSet();
+        generation_++;
+    }
+
+}
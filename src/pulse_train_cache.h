@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Precompiled SPI byte streams for the strobe pulse trains.
+//
+// The strobes are driven by writing a bit pattern to the SPI bus, where each 1 bit
+// turns the strobe on for one bit-time at the SPI baud rate.  PulseTrainCompiler turns
+// a PulseTrainSpec (the pulse intervals, on-pulse width, baud rate and so on) into that
+// byte stream, and checks that the spec makes sense first.  It does not read the
+// configuration or the command-line options, so it can be tested off the Pi.
+//
+// PulseTrainCache holds one immutable, compiled PulseTrain per profile (the fast
+// driver pulses, the slow putter pulses, and the putter follow-on pulses).  The trains
+// are compiled when the GPIO system is initialized (or the strobe settings change),
+// so the trigger path only has to look up the train for the current club and hand its
+// bytes to lgSpiWrite.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace golf_sim {
+
+struct PulseTrainSpec {
+    unsigned long baud_rate = 0;
+
+    // Corrects for the SPI clock not running at exactly the baud rate
+    double baud_rate_pulse_multiplier = 1.0;
+
+    // The strobe-off time after each pulse.  The last interval should be 0, so that
+    // the train ends with the strobe off.
+    std::vector<float> intervals_ms;
+
+    // Strobe-on time, in SPI bits
+    int number_bits_for_on_pulse = 0;
+
+    // The train is padded to a whole number of SPI words
+    unsigned int bits_per_word = 16;
+
+    // For the still, calibration and ball-location modes, which take a single picture:
+    // one pulse of twice the usual width (at most 15 bits), and no more.
+    bool single_pulse = false;
+
+    // Only the shutter is opened.  Each on-pulse is replaced by a single zero byte.
+    bool turn_off_strobes = false;
+
+    bool operator==(const PulseTrainSpec& other) const = default;
+};
+
+
+struct PulseTrain {
+    PulseTrainSpec spec;
+    std::vector<char> bytes;
+
+    const char* data() const { return bytes.data(); }
+    unsigned long length() const { return (unsigned long)bytes.size(); }
+};
+
+
+class PulseTrainCompiler {
+public:
+
+    // Big enough for any reasonable pulse train.  Trains must fit in 90% of this.
+    static constexpr unsigned long kMaxPulseTrainBytes = 800000;
+
+    // Returns false, with the reason in error, if the spec cannot be compiled
+    static bool Validate(const PulseTrainSpec& spec, std::string& error);
+
+    // Returns nullptr (and logs why) if the spec is not valid or the train would be too long
+    static std::shared_ptr<const PulseTrain> Compile(const PulseTrainSpec& spec);
+
+    // Sets the two bytes that hold an on-pulse of number_bits_for_on_pulse bits that starts
+    // after zero_bits_pad off bits (the off bits left over from the prior pulse).  The bytes
+    // are in SPI (most-significant bit first) order.  Returns the number of off bits to the
+    // right of the pulse in the second byte, or -1 if number_bits_for_on_pulse < 1.
+    static int GetNextTwoPulseBytes(const int zero_bits_pad,
+                                    const int number_bits_for_on_pulse,
+                                    unsigned char& first_byte_bit_pattern,
+                                    unsigned char& second_byte_bit_pattern);
+};
+
+
+class PulseTrainCache {
+public:
+
+    enum class Profile {
+        kFast = 0,      // Driver (non-putter) shots
+        kSlow,          // Putter shots
+        kTailRepeat,    // Putter follow-on pulses
+        kNumProfiles
+    };
+
+    using ProfileSpecs = std::array<PulseTrainSpec, (size_t)Profile::kNumProfiles>;
+
+    // Process-wide cache used by PulseStrobe
+    static PulseTrainCache& GetSharedCache();
+
+    // Compiles the train for every profile whose spec differs from the cached one.  Profiles
+    // with no intervals are left without a train.  If any compile fails, nothing is changed
+    // and false is returned, so the trigger path never sees a partly-rebuilt set.
+    bool Rebuild(const ProfileSpecs& specs);
+
+    // The compiled train for the profile, or nullptr if it has not been built.  The train
+    // stays valid for as long as the caller holds it, even across a Rebuild.
+    std::shared_ptr<const PulseTrain> Get(Profile profile) const;
+
+    // How many times the set of trains has been (re)built
+    unsigned long generation() const;
+
+    void Clear();
+
+private:
+
+    using TrainSet = std::array<std::shared_ptr<const PulseTrain>, (size_t)Profile::kNumProfiles>;
+
+    mutable std::mutex mutex_;
+    TrainSet trains_;
+    unsigned long generation_ = 0;
+};
+
+}
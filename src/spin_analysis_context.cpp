@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include "spin_analysis_context.h"
+
+
+namespace golf_sim {
+
+    SpinAnalysisContext::SpinAnalysisContext(const cv::Mat& base_dimple_image,
+                                             const GolfBall& base_ball,
+                                             const cv::Mat& target_dimple_image,
+                                             WorkStealingPool& pool)
+        : base_dimple_image_(base_dimple_image),
+          base_ball_(base_ball),
+          target_dimple_image_(target_dimple_image),
+          pool_(pool) {
+
+        // The hemisphere geometry of the base ball is computed once here and then
+        // shared by every search pass (i.e., both the coarse and the fine searches)
+        if (BallImageProc::kUsePrecomputedSpinSearch) {
+            search_engine_ = std::make_unique<SpinSearchEngine>(base_dimple_image_, base_ball_);
+        }
+    }
+
+    int SpinAnalysisContext::RunSearchPass(const BallImageProc::RotationSearchSpace& search_space, SearchPass& pass) const {
+        pass.search_space = search_space;
+        pass.best_candidate_index = -1;
+
+        if (search_engine_) {
+            search_engine_->BuildCandidates(search_space, pass.candidate_elements_mat, pass.candidate_elements_mat_size, pass.candidates);
+
+            // Compare the target (presumably rotated) ball image to each candidate rotation of the base ball image.
+            // Each candidate is projected and scored in the same pool task, so no per-candidate images are kept.
+            search_engine_->ScoreCandidates(target_dimple_image_, pass.candidates, pass.comparison_csv_data, pool_);
+            pass.best_candidate_index = BallImageProc::SelectBestCandidate(pass.candidates);
+        }
+        else {
+            pass.candidates.clear();
+
+            BallImageProc::ComputeCandidateAngleImages(base_dimple_image_, search_space, pass.candidate_elements_mat,
+                                                       pass.candidate_elements_mat_size, pass.candidates, base_ball_);
+
+            pass.best_candidate_index = BallImageProc::CompareCandidateAngleImages(&target_dimple_image_, &pass.candidate_elements_mat,
+                                                                                   &pass.candidate_elements_mat_size, &pass.candidates,
+                                                                                   pass.comparison_csv_data);
+        }
+
+        return pass.best_candidate_index;
+    }
+
+    cv::Mat SpinAnalysisContext::ProjectRotation(const cv::Vec3i& rotation_degrees) const {
+        if (!search_engine_) {
+            return BallImageProc::Project2dImageTo3dBall(base_dimple_image_, base_ball_, rotation_degrees);
+        }
+
+        cv::Mat projected_img;
+        search_engine_->ProjectCandidate(rotation_degrees, projected_img);
+        return projected_img;
+    }
+
+}
@@ -0,0 +1,80 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Owns everything that one spin analysis (one call to BallImageProc::GetBallRotation)
+// needs while it searches for the best rotation: the two de-rotated dimple images,
+// the per-ball hemisphere precompute, and the candidates and CSV output of each
+// search pass.  Nothing is kept in static or global state, so several contexts can
+// run at once in the same process - e.g., the spin for one shot can still be
+// calculated while the next shot is being armed.  The actual work is spread over
+// a WorkStealingPool that all of the contexts share.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "golf_ball.h"
+#include "ball_image_proc.h"
+#include "spin_search_engine.h"
+#include "work_stealing_pool.h"
+
+
+namespace golf_sim {
+
+class SpinAnalysisContext {
+public:
+
+    // The results of scoring every candidate within one search space
+    struct SearchPass {
+        BallImageProc::RotationSearchSpace search_space;
+
+        // X/Y/Z-indexed matrix of indexes into candidates
+        cv::Mat candidate_elements_mat;
+        cv::Vec3i candidate_elements_mat_size;
+
+        std::vector<RotationCandidate> candidates;
+
+        // One tab-separated line per candidate, for the optional spin-analysis CSV files
+        std::vector<std::string> comparison_csv_data;
+
+        // -1 if no candidate could be scored
+        int best_candidate_index = -1;
+    };
+
+    // The images are expected to be the final, perspective-de-rotated dimple-edge images
+    // with only 0, 255, or kPixelIgnoreValue pixels.  base_ball must be positioned relative
+    // to the (isolated) base image.  The images are shallow-copied, so the caller must not
+    // write to them while the context is in use.
+    SpinAnalysisContext(const cv::Mat& base_dimple_image,
+                        const GolfBall& base_ball,
+                        const cv::Mat& target_dimple_image,
+                        WorkStealingPool& pool = WorkStealingPool::GetSharedPool());
+
+    // Generates every rotation in the search space, scores each against the target image,
+    // and returns the index of the best candidate within pass.candidates (or -1).
+    int RunSearchPass(const BallImageProc::RotationSearchSpace& search_space, SearchPass& pass) const;
+
+    // Returns the (Z, pixel) CV_32SC2 projection of the base image at the given rotation,
+    // e.g., to show the best candidate for debugging
+    cv::Mat ProjectRotation(const cv::Vec3i& rotation_degrees) const;
+
+private:
+
+    cv::Mat base_dimple_image_;
+    GolfBall base_ball_;
+    cv::Mat target_dimple_image_;
+
+    WorkStealingPool& pool_;
+
+    // Null if BallImageProc::kUsePrecomputedSpinSearch was not set when the context was created,
+    // in which case the original per-candidate image path is used
+    std::unique_ptr<SpinSearchEngine> search_engine_;
+};
+
+}
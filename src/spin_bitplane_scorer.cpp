@@ -0,0 +1,192 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <bit>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+#include "spin_bitplane_scorer.h"
+#include "ball_image_proc.h"
+
+
+namespace golf_sim {
+
+    // SpinBitplanes::SetPixel cannot see ball_image_proc.h, so make sure it stays in step
+    static_assert(kPixelIgnoreValue == 128, "SpinBitplanes::SetPixel assumes kPixelIgnoreValue == 128");
+
+    // Pad to 256 bits so that every SIMD path can run without a scalar tail
+    static const size_t kWordsPerBlock = 4;
+
+    void SpinBitplanes::Reset(int new_rows, int new_cols) {
+        rows = new_rows;
+        cols = new_cols;
+
+        size_t words = (((size_t)rows * cols + 63) / 64 + kWordsPerBlock - 1) / kWordsPerBlock * kWordsPerBlock;
+
+        edge.assign(words, 0);
+        valid.assign(words, 0);
+    }
+
+    static inline bool IsBitplaneValue(int value) {
+        return value == 0 || value == 255 || value == kPixelIgnoreValue;
+    }
+
+    bool SpinBitplaneScorer::PackImage(const cv::Mat& img, SpinBitplanes& planes) {
+        CV_Assert((img.type() == CV_8UC1));
+
+        planes.Reset(img.rows, img.cols);
+
+        size_t bit_index = 0;
+        for (int x = 0; x < img.rows; x++) {
+            const uchar* row_ptr = img.ptr<uchar>(x);
+
+            for (int y = 0; y < img.cols; y++, bit_index++) {
+                if (!IsBitplaneValue(row_ptr[y])) {
+                    return false;
+                }
+                planes.SetPixel(bit_index, row_ptr[y]);
+            }
+        }
+
+        return true;
+    }
+
+    bool SpinBitplaneScorer::PackProjection(const cv::Mat& projected_img, SpinBitplanes& planes) {
+        CV_Assert((projected_img.type() == CV_32SC2));
+
+        planes.Reset(projected_img.rows, projected_img.cols);
+
+        size_t bit_index = 0;
+        for (int x = 0; x < projected_img.rows; x++) {
+            const cv::Vec2i* row_ptr = projected_img.ptr<cv::Vec2i>(x);
+
+            for (int y = 0; y < projected_img.cols; y++, bit_index++) {
+                // CompareRotationImage narrows the pixel channel to a uchar, so do the same
+                uchar value = (uchar)row_ptr[y][1];
+
+                if (!IsBitplaneValue(value)) {
+                    return false;
+                }
+                planes.SetPixel(bit_index, value);
+            }
+        }
+
+        return true;
+    }
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+    // Nibble-lookup popcount (Mula et al.), summed into 64-bit lanes by SAD against zero
+    static inline __m128i PopcountBytes128(__m128i v) {
+        const __m128i lookup = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m128i low_mask = _mm_set1_epi8(0x0f);
+        __m128i lo = _mm_and_si128(v, low_mask);
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low_mask);
+        return _mm_add_epi8(_mm_shuffle_epi8(lookup, lo), _mm_shuffle_epi8(lookup, hi));
+    }
+#endif
+
+#if defined(__AVX2__)
+    static inline __m256i PopcountBytes256(__m256i v) {
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low_mask = _mm256_set1_epi8(0x0f);
+        __m256i lo = _mm256_and_si256(v, low_mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+        return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    }
+#endif
+
+    cv::Vec2i SpinBitplaneScorer::Compare(const SpinBitplanes& target, const SpinBitplanes& candidate) {
+        CV_Assert((target.rows == candidate.rows && target.cols == candidate.cols));
+
+        const size_t words = target.word_count();
+        const uint64_t* t_valid = target.valid.data();
+        const uint64_t* t_edge = target.edge.data();
+        const uint64_t* c_valid = candidate.valid.data();
+        const uint64_t* c_edge = candidate.edge.data();
+
+        uint64_t examined = 0;
+        uint64_t matching = 0;
+
+        // For every word:  examined = valid1 & valid2,  matching = examined & ~(edge1 ^ edge2)
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        for (size_t i = 0; i < words; i += 2) {
+            uint64x2_t v = vandq_u64(vld1q_u64(t_valid + i), vld1q_u64(c_valid + i));
+            uint64x2_t m = vbicq_u64(v, veorq_u64(vld1q_u64(t_edge + i), vld1q_u64(c_edge + i)));
+
+            // 16 bytes of at most 8 bits each cannot overflow the 8-bit horizontal add
+            examined += vaddvq_u8(vcntq_u8(vreinterpretq_u8_u64(v)));
+            matching += vaddvq_u8(vcntq_u8(vreinterpretq_u8_u64(m)));
+        }
+#elif defined(__AVX2__)
+        __m256i examined_acc = _mm256_setzero_si256();
+        __m256i matching_acc = _mm256_setzero_si256();
+        const __m256i zero = _mm256_setzero_si256();
+
+        for (size_t i = 0; i < words; i += 4) {
+            __m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(t_valid + i)),
+                                         _mm256_loadu_si256((const __m256i*)(c_valid + i)));
+            __m256i diff = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(t_edge + i)),
+                                            _mm256_loadu_si256((const __m256i*)(c_edge + i)));
+            __m256i m = _mm256_andnot_si256(diff, v);
+
+            examined_acc = _mm256_add_epi64(examined_acc, _mm256_sad_epu8(PopcountBytes256(v), zero));
+            matching_acc = _mm256_add_epi64(matching_acc, _mm256_sad_epu8(PopcountBytes256(m), zero));
+        }
+
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256((__m256i*)lanes, examined_acc);
+        examined = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        _mm256_store_si256((__m256i*)lanes, matching_acc);
+        matching = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__SSSE3__)
+        __m128i examined_acc = _mm_setzero_si128();
+        __m128i matching_acc = _mm_setzero_si128();
+        const __m128i zero = _mm_setzero_si128();
+
+        for (size_t i = 0; i < words; i += 2) {
+            __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i*)(t_valid + i)),
+                                      _mm_loadu_si128((const __m128i*)(c_valid + i)));
+            __m128i diff = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(t_edge + i)),
+                                         _mm_loadu_si128((const __m128i*)(c_edge + i)));
+            __m128i m = _mm_andnot_si128(diff, v);
+
+            examined_acc = _mm_add_epi64(examined_acc, _mm_sad_epu8(PopcountBytes128(v), zero));
+            matching_acc = _mm_add_epi64(matching_acc, _mm_sad_epu8(PopcountBytes128(m), zero));
+        }
+
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128((__m128i*)lanes, examined_acc);
+        examined = lanes[0] + lanes[1];
+        _mm_store_si128((__m128i*)lanes, matching_acc);
+        matching = lanes[0] + lanes[1];
+#else
+        for (size_t i = 0; i < words; i++) {
+            uint64_t v = t_valid[i] & c_valid[i];
+            examined += std::popcount(v);
+            matching += std::popcount(v & ~(t_edge[i] ^ c_edge[i]));
+        }
+#endif
+
+        return cv::Vec2i((int)matching, (int)examined);
+    }
+
+    const char* SpinBitplaneScorer::BackendName() {
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        return "neon";
+#elif defined(__AVX2__)
+        return "avx2";
+#elif defined(__SSSE3__)
+        return "ssse3";
+#else
+        return "scalar";
+#endif
+    }
+
+}
@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Bit-packed scoring backend for the spin search.  The Gabor dimple-edge images
+// only ever hold 0, 255, or kPixelIgnoreValue, so each image can be stored as two
+// bitplanes - one bit for "edge" (255) and one bit for "valid" (not ignored).
+// The pixels_examined / pixels_matching counts that CompareRotationImage produces
+// then reduce to popcounts over AND / XNOR words, which are vectorized with NEON
+// on aarch64 and SSSE3/AVX2 on x86, with a portable scalar fallback.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+
+namespace golf_sim {
+
+struct SpinBitplanes {
+    int rows = 0;
+    int cols = 0;
+
+    // Bit i corresponds to pixel (i / cols, i % cols).  The word count is padded
+    // with zeros (i.e., ignored pixels) out to a whole number of SIMD registers.
+    std::vector<uint64_t> edge;
+    std::vector<uint64_t> valid;
+
+    // Sizes the planes for the given image and marks every pixel as ignored.
+    // Does not re-allocate if the size is unchanged.
+    void Reset(int rows, int cols);
+
+    size_t word_count() const { return valid.size(); }
+
+    inline void SetPixel(size_t bit_index, uchar value);
+};
+
+
+class SpinBitplaneScorer {
+public:
+
+    // Packs an 8-bit single-channel dimple-edge image (e.g., the target ball image).
+    // Returns false if the image holds anything other than 0, 255, or kPixelIgnoreValue,
+    // in which case the caller must fall back to CompareRotationImage.
+    static bool PackImage(const cv::Mat& img, SpinBitplanes& planes);
+
+    // Packs the pixel channel of a (Z, pixel) CV_32SC2 projection such as the one
+    // returned by BallImageProc::Project2dImageTo3dBall.  Same return semantics as PackImage.
+    static bool PackProjection(const cv::Mat& projected_img, SpinBitplanes& planes);
+
+    // Returns (pixels_matching, pixels_examined), exactly as CompareRotationImage does
+    static cv::Vec2i Compare(const SpinBitplanes& target, const SpinBitplanes& candidate);
+
+    // Identifies which Compare() implementation was compiled in, for logging
+    static const char* BackendName();
+};
+
+
+inline void SpinBitplanes::SetPixel(size_t bit_index, uchar value) {
+    const size_t word = bit_index >> 6;
+    const uint64_t mask = (uint64_t)1 << (bit_index & 63);
+
+    if (value == 128 /* kPixelIgnoreValue */) {
+        valid[word] &= ~mask;
+        edge[word] &= ~mask;
+        return;
+    }
+
+    valid[word] |= mask;
+
+    if (value != 0) {
+        edge[word] |= mask;
+    }
+    else {
+        edge[word] &= ~mask;
+    }
+}
+
+}
@@ -0,0 +1,429 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <tuple>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "spin_remap_cache.h"
+#include "ball_image_proc.h"
+#include "utils/logging_tools.h"
+
+
+namespace golf_sim {
+
+    // On-disk layout of a remap file:
+    //   RemapFileHeader
+    //   Any number of records, each of which is a RemapRecordHeader followed by
+    //   point_count (= rows * cols) SpinRemapTables::Index values.
+    // Records are only ever appended, so a partially-written last record (e.g., from a
+    // power loss) is simply ignored the next time the file is loaded.
+    static const char kRemapFileMagic[8] = { 'P', 'T', 'S', 'P', 'R', 'M', 'P', '1' };
+
+    struct RemapFileHeader {
+        char magic[8];
+        int32_t rows;
+        int32_t cols;
+        int32_t steps_per_pixel;
+        int32_t center_x_steps;
+        int32_t center_y_steps;
+        int32_t radius_steps;
+    };
+
+    struct RemapRecordHeader {
+        int16_t x_rotation_degrees;
+        int16_t y_rotation_degrees;
+        int16_t z_rotation_degrees;
+        int16_t reserved;
+    };
+
+    static_assert(sizeof(RemapFileHeader) == 32, "Unexpected RemapFileHeader padding");
+    static_assert(sizeof(RemapRecordHeader) == 8, "Unexpected RemapRecordHeader padding");
+
+    static const std::string kRemapFilePrefix = "spin_remap_";
+    static const std::string kRemapFileSuffix = ".bin";
+
+
+    SpinRemapGeometry SpinRemapGeometry::FromBall(const GolfBall& ball, int rows, int cols, double quantum_pixels) {
+        SpinRemapGeometry geometry;
+        geometry.rows = rows;
+        geometry.cols = cols;
+        geometry.steps_per_pixel = std::max(1, (int)std::round(1.0 / std::max(quantum_pixels, 0.001)));
+        geometry.center_x_steps = (int)std::round((double)ball.x() * geometry.steps_per_pixel);
+        geometry.center_y_steps = (int)std::round((double)ball.y() * geometry.steps_per_pixel);
+        geometry.radius_steps = (int)std::round(ball.measured_radius_pixels_ * geometry.steps_per_pixel);
+        return geometry;
+    }
+
+    std::string SpinRemapGeometry::FileName() const {
+        return kRemapFilePrefix + std::to_string(rows) + "x" + std::to_string(cols) +
+            "_q" + std::to_string(steps_per_pixel) +
+            "_c" + std::to_string(center_x_steps) + "_" + std::to_string(center_y_steps) +
+            "_r" + std::to_string(radius_steps) + kRemapFileSuffix;
+    }
+
+    bool SpinRemapGeometry::operator<(const SpinRemapGeometry& other) const {
+        return std::tie(rows, cols, steps_per_pixel, center_x_steps, center_y_steps, radius_steps) <
+            std::tie(other.rows, other.cols, other.steps_per_pixel, other.center_x_steps, other.center_y_steps, other.radius_steps);
+    }
+
+    static std::string RemapFilePath(const std::string& directory, const SpinRemapGeometry& geometry) {
+        if (directory.empty()) {
+            return geometry.FileName();
+        }
+        return (std::filesystem::path(directory) / geometry.FileName()).string();
+    }
+
+    static bool ReadFileHeader(const std::string& path, SpinRemapGeometry& geometry) {
+        std::ifstream file(path, std::ios::binary);
+        RemapFileHeader header;
+
+        if (!file.read((char*)&header, sizeof(header)) || std::memcmp(header.magic, kRemapFileMagic, sizeof(kRemapFileMagic)) != 0) {
+            return false;
+        }
+
+        geometry.rows = header.rows;
+        geometry.cols = header.cols;
+        geometry.steps_per_pixel = header.steps_per_pixel;
+        geometry.center_x_steps = header.center_x_steps;
+        geometry.center_y_steps = header.center_y_steps;
+        geometry.radius_steps = header.radius_steps;
+        return true;
+    }
+
+
+    SpinRemapTables::SpinRemapTables(const SpinRemapGeometry& geometry)
+        : geometry_(geometry),
+          point_count_((size_t)geometry.rows * geometry.cols) {
+    }
+
+    SpinRemapTables::~SpinRemapTables() {
+        UnmapFile();
+    }
+
+    uint64_t SpinRemapTables::RotationKey(const cv::Vec3i& rotation_degrees) {
+        // The search spaces are well within +/-32K degrees
+        return ((uint64_t)(uint16_t)rotation_degrees[0] << 32) |
+               ((uint64_t)(uint16_t)rotation_degrees[1] << 16) |
+               (uint64_t)(uint16_t)rotation_degrees[2];
+    }
+
+    const SpinRemapTables::Index* SpinRemapTables::Find(const cv::Vec3i& rotation_degrees) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+
+        auto it = tables_.find(RotationKey(rotation_degrees));
+        return (it == tables_.end()) ? nullptr : it->second;
+    }
+
+    const SpinRemapTables::Index* SpinRemapTables::Insert(const cv::Vec3i& rotation_degrees, std::vector<Index>&& table) {
+        CV_Assert(table.size() == point_count_);
+
+        const uint64_t key = RotationKey(rotation_degrees);
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+
+        auto it = tables_.find(key);
+        if (it != tables_.end()) {
+            return it->second;
+        }
+
+        if (!SpinRemapCache::GetSharedCache().ReserveBytes(point_count_ * sizeof(Index))) {
+            return nullptr;
+        }
+
+        owned_tables_.emplace_back(key, std::make_unique<std::vector<Index>>(std::move(table)));
+        const Index* stored_table = owned_tables_.back().second->data();
+        tables_[key] = stored_table;
+
+        return stored_table;
+    }
+
+    void SpinRemapTables::UnmapFile() {
+#ifdef __unix__
+        if (mapped_data_ != nullptr) {
+            munmap(mapped_data_, mapped_bytes_);
+        }
+#endif
+        mapped_data_ = nullptr;
+        mapped_bytes_ = 0;
+        loaded_file_.clear();
+    }
+
+    bool SpinRemapTables::LoadFromDisk(const std::string& directory) {
+        const std::string path = RemapFilePath(directory, geometry_);
+
+        if (!std::filesystem::exists(path)) {
+            return false;
+        }
+
+        SpinRemapGeometry file_geometry;
+        if (!ReadFileHeader(path, file_geometry) ||
+            file_geometry < geometry_ || geometry_ < file_geometry) {
+            GS_LOG_MSG(warning, "Ignoring spin remap cache file with an unexpected header: " + path);
+            return false;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+
+        // Re-mapping would invalidate the tables that point into the current mapping
+        if (mapped_data_ != nullptr || !loaded_file_.empty()) {
+            return true;
+        }
+
+        const char* file_data = nullptr;
+        size_t file_bytes = 0;
+
+#ifdef __unix__
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            GS_LOG_MSG(warning, "Could not open spin remap cache file: " + path);
+            return false;
+        }
+
+        struct stat file_status;
+        if (fstat(fd, &file_status) == 0 && file_status.st_size > 0) {
+            file_bytes = (size_t)file_status.st_size;
+            void* mapping = mmap(nullptr, file_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                mapped_data_ = mapping;
+                mapped_bytes_ = file_bytes;
+                file_data = (const char*)mapping;
+            }
+        }
+        close(fd);
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        file_bytes = (size_t)file.tellg();
+        loaded_file_.resize(file_bytes);
+        file.seekg(0);
+        if (file.read(loaded_file_.data(), file_bytes)) {
+            file_data = loaded_file_.data();
+        }
+#endif
+
+        if (file_data == nullptr) {
+            GS_LOG_MSG(warning, "Could not map spin remap cache file: " + path);
+            UnmapFile();
+            return false;
+        }
+
+        const size_t record_bytes = sizeof(RemapRecordHeader) + point_count_ * sizeof(Index);
+        const size_t record_count = (file_bytes < sizeof(RemapFileHeader)) ? 0 : (file_bytes - sizeof(RemapFileHeader)) / record_bytes;
+
+        // The entries are used as scatter indices, so a corrupt (or foreign) file must not get
+        // as far as the tables.  Any torn record at the end is just ignored.
+        for (size_t i = 0; i < record_count; i++) {
+            const char* entries = file_data + sizeof(RemapFileHeader) + i * record_bytes + sizeof(RemapRecordHeader);
+
+            for (size_t point = 0; point < point_count_; point++) {
+                Index entry;
+                std::memcpy(&entry, entries + point * sizeof(Index), sizeof(entry));
+
+                if (entry >= point_count_ && entry != kNoDestination) {
+                    GS_LOG_MSG(warning, "Ignoring spin remap cache file with an out-of-range entry in record " +
+                                        std::to_string(i) + ": " + path);
+                    UnmapFile();
+                    return false;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < record_count; i++) {
+            const char* record = file_data + sizeof(RemapFileHeader) + i * record_bytes;
+            RemapRecordHeader record_header;
+            std::memcpy(&record_header, record, sizeof(record_header));
+
+            cv::Vec3i rotation(record_header.x_rotation_degrees, record_header.y_rotation_degrees, record_header.z_rotation_degrees);
+            tables_[RotationKey(rotation)] = (const Index*)(record + sizeof(RemapRecordHeader));
+        }
+
+        GS_LOG_TRACE_MSG(trace, "Loaded " + std::to_string(record_count) + " spin remap tables from " + path);
+        return true;
+    }
+
+    bool SpinRemapTables::SaveToDisk(const std::string& directory) {
+        const std::string path = RemapFilePath(directory, geometry_);
+
+        // Only the tables that were built since the last save (or load) need to be written
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+
+        if (owned_tables_saved_ == owned_tables_.size()) {
+            return true;
+        }
+
+        // If nothing was loaded from an existing file, start a new one
+        const bool start_new_file = (mapped_data_ == nullptr && loaded_file_.empty() && owned_tables_saved_ == 0);
+
+        const size_t record_bytes = sizeof(RemapRecordHeader) + point_count_ * sizeof(Index);
+
+        // Appending after a torn record (e.g., from a crash during an earlier save) would shift every
+        // record after it, so cut the file back to its last whole record first
+        if (!start_new_file) {
+            std::error_code error;
+            const uintmax_t file_bytes = std::filesystem::file_size(path, error);
+
+            if (error || file_bytes < sizeof(RemapFileHeader)) {
+                GS_LOG_MSG(warning, "Could not append to spin remap cache file: " + path);
+                return false;
+            }
+
+            const uintmax_t whole_record_bytes = sizeof(RemapFileHeader) +
+                ((file_bytes - sizeof(RemapFileHeader)) / record_bytes) * record_bytes;
+
+            if (whole_record_bytes != file_bytes) {
+                GS_LOG_MSG(warning, "Truncating a partly-written record from spin remap cache file: " + path);
+                std::filesystem::resize_file(path, whole_record_bytes, error);
+                if (error) {
+                    GS_LOG_MSG(warning, "Could not truncate spin remap cache file: " + path);
+                    return false;
+                }
+            }
+        }
+
+        std::ofstream file(path, std::ios::binary | (start_new_file ? std::ios::trunc : std::ios::app));
+        if (!file) {
+            GS_LOG_MSG(warning, "Could not write spin remap cache file: " + path);
+            return false;
+        }
+
+        if (start_new_file) {
+            RemapFileHeader header;
+            std::memcpy(header.magic, kRemapFileMagic, sizeof(kRemapFileMagic));
+            header.rows = geometry_.rows;
+            header.cols = geometry_.cols;
+            header.steps_per_pixel = geometry_.steps_per_pixel;
+            header.center_x_steps = geometry_.center_x_steps;
+            header.center_y_steps = geometry_.center_y_steps;
+            header.radius_steps = geometry_.radius_steps;
+            file.write((const char*)&header, sizeof(header));
+        }
+
+        size_t tables_written = 0;
+
+        for (size_t i = owned_tables_saved_; i < owned_tables_.size(); i++, tables_written++) {
+            const uint64_t key = owned_tables_[i].first;
+
+            RemapRecordHeader record_header;
+            record_header.x_rotation_degrees = (int16_t)(uint16_t)(key >> 32);
+            record_header.y_rotation_degrees = (int16_t)(uint16_t)(key >> 16);
+            record_header.z_rotation_degrees = (int16_t)(uint16_t)key;
+            record_header.reserved = 0;
+
+            file.write((const char*)&record_header, sizeof(record_header));
+            file.write((const char*)owned_tables_[i].second->data(), point_count_ * sizeof(Index));
+        }
+
+        if (!file) {
+            GS_LOG_MSG(warning, "Failed while writing spin remap cache file: " + path);
+            return false;
+        }
+
+        owned_tables_saved_ = owned_tables_.size();
+
+        GS_LOG_TRACE_MSG(trace, "Saved " + std::to_string(tables_written) + " new spin remap tables to " + path);
+        return true;
+    }
+
+
+    SpinRemapCache& SpinRemapCache::GetSharedCache() {
+        static SpinRemapCache shared_cache;
+        return shared_cache;
+    }
+
+    std::shared_ptr<SpinRemapTables> SpinRemapCache::GetTables(const SpinRemapGeometry& geometry) {
+        // Every table entry must be able to hold any pixel index, plus kNoDestination
+        if ((size_t)geometry.rows * geometry.cols >= SpinRemapTables::kNoDestination) {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = geometries_.find(geometry);
+        if (it != geometries_.end()) {
+            return it->second;
+        }
+
+        auto tables = std::make_shared<SpinRemapTables>(geometry);
+
+        if (BallImageProc::kSaveSpinRemapCacheToDisk) {
+            tables->LoadFromDisk(BallImageProc::kSpinRemapCacheDirectory);
+        }
+
+        geometries_[geometry] = tables;
+        return tables;
+    }
+
+    void SpinRemapCache::LoadFromDisk(const std::string& directory) {
+        const std::filesystem::path directory_path = directory.empty() ? std::filesystem::path(".") : std::filesystem::path(directory);
+
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory_path, error)) {
+            const std::string file_name = entry.path().filename().string();
+
+            if (file_name.rfind(kRemapFilePrefix, 0) != 0 || entry.path().extension() != kRemapFileSuffix) {
+                continue;
+            }
+
+            SpinRemapGeometry geometry;
+            if (!ReadFileHeader(entry.path().string(), geometry) || geometry.FileName() != file_name) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (geometries_.count(geometry) > 0) {
+                continue;
+            }
+
+            auto tables = std::make_shared<SpinRemapTables>(geometry);
+            if (tables->LoadFromDisk(directory)) {
+                geometries_[geometry] = tables;
+            }
+        }
+    }
+
+    void SpinRemapCache::SaveToDisk(const std::string& directory) {
+        std::vector<std::shared_ptr<SpinRemapTables>> all_tables;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& geometry_tables : geometries_) {
+                all_tables.push_back(geometry_tables.second);
+            }
+        }
+
+        for (auto& tables : all_tables) {
+            tables->SaveToDisk(directory);
+        }
+    }
+
+    bool SpinRemapCache::ReserveBytes(size_t bytes) {
+        const size_t max_bytes = (size_t)std::max(0, BallImageProc::kSpinRemapCacheMaxMegabytes) * 1024 * 1024;
+
+        size_t current = cached_bytes_.load();
+        do {
+            if (current + bytes > max_bytes) {
+                return false;
+            }
+        } while (!cached_bytes_.compare_exchange_weak(current, current + bytes));
+
+        return true;
+    }
+
+    void SpinRemapCache::Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        geometries_.clear();
+        cached_bytes_.store(0);
+    }
+
+}
@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Cache of precomputed spin-candidate rotation remap tables.
+//
+// The coarse and fine spin search spaces are fixed by configuration, and the isolated
+// ball images that GetBallRotation works on only come in a small number of sizes.
+// So, for a given ball geometry (image size, ball center, and radius - snapped to a
+// configurable quantum), each candidate rotation always moves the same source pixel
+// to the same destination pixel.  A remap table records that destination for every
+// source pixel, which turns candidate generation into a gather instead of trigonometry.
+//
+// Tables are built lazily as rotations are requested.  Optionally, each geometry's tables
+// are appended to a file (next to the spin_analysis_*.csv files by default) that is
+// mmapped the next time the system starts, so that repeat shots stay fast after a restart.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "golf_ball.h"
+
+
+namespace golf_sim {
+
+// Identifies the exact pixel geometry a remap table was computed for.  The center and radius
+// are held as whole numbers of 1/steps_per_pixel-pixel steps.
+struct SpinRemapGeometry {
+    int rows = 0;
+    int cols = 0;
+    int steps_per_pixel = 1;
+    int center_x_steps = 0;
+    int center_y_steps = 0;
+    int radius_steps = 0;
+
+    // Snaps the ball's position and radius to the nearest quantum_pixels
+    static SpinRemapGeometry FromBall(const GolfBall& ball, int rows, int cols, double quantum_pixels);
+
+    double center_x() const { return (double)center_x_steps / steps_per_pixel; }
+    double center_y() const { return (double)center_y_steps / steps_per_pixel; }
+    double radius() const { return (double)radius_steps / steps_per_pixel; }
+
+    // e.g., "spin_remap_84x84_q4_c168_168_r159.bin"
+    std::string FileName() const;
+
+    bool operator<(const SpinRemapGeometry& other) const;
+};
+
+
+// All of the remap tables for one geometry.  Safe to read and extend from several threads.
+class SpinRemapTables {
+public:
+    typedef uint16_t Index;
+
+    // Table entry for a source pixel that does not land on the visible hemisphere
+    static const Index kNoDestination = 0xFFFF;
+
+    explicit SpinRemapTables(const SpinRemapGeometry& geometry);
+    ~SpinRemapTables();
+
+    const SpinRemapGeometry& geometry() const { return geometry_; }
+
+    // Number of entries in each table, i.e., rows * cols
+    size_t point_count() const { return point_count_; }
+
+    // Returns the table for the rotation, or nullptr if it has not been built yet
+    const Index* Find(const cv::Vec3i& rotation_degrees) const;
+
+    // Takes ownership of a newly-built table.  If another thread got there first, its table
+    // is returned instead.  Returns nullptr if the cache is full, in which case the caller
+    // should just use its own copy.
+    const Index* Insert(const cv::Vec3i& rotation_degrees, std::vector<Index>&& table);
+
+    // Maps (or reads) any tables previously saved for this geometry in directory
+    bool LoadFromDisk(const std::string& directory);
+
+    // Appends any tables that are not yet on disk to this geometry's file in directory
+    bool SaveToDisk(const std::string& directory);
+
+private:
+
+    static uint64_t RotationKey(const cv::Vec3i& rotation_degrees);
+
+    void UnmapFile();
+
+    SpinRemapGeometry geometry_;
+    size_t point_count_ = 0;
+
+    mutable std::shared_mutex mutex_;
+
+    // Points either into owned_tables_ or into the mapped file
+    std::unordered_map<uint64_t, const Index*> tables_;
+
+    // Tables built since the file was loaded, in the order they were built
+    std::vector<std::pair<uint64_t, std::unique_ptr<std::vector<Index>>>> owned_tables_;
+    size_t owned_tables_saved_ = 0;
+
+    void* mapped_data_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    std::vector<char> loaded_file_;  // Used where mmap is not available
+};
+
+
+class SpinRemapCache {
+public:
+
+    // Process-wide cache that is shared by all spin analyses
+    static SpinRemapCache& GetSharedCache();
+
+    // Returns the tables for the geometry, creating (and loading from disk, if enabled) them
+    // as needed.  Returns nullptr if the geometry is too large for 16-bit table entries.
+    std::shared_ptr<SpinRemapTables> GetTables(const SpinRemapGeometry& geometry);
+
+    // Loads every remap file in the directory.  Geometries that are already loaded are skipped.
+    void LoadFromDisk(const std::string& directory);
+
+    // Writes out any tables that have not yet been saved
+    void SaveToDisk(const std::string& directory);
+
+    // Reserves room for one more table of the given size.  Returns false if that would
+    // exceed BallImageProc::kSpinRemapCacheMaxMegabytes.
+    bool ReserveBytes(size_t bytes);
+
+    size_t GetCachedBytes() const { return cached_bytes_.load(); }
+
+    // Forgets all geometries (e.g., for testing).  Tables that are still in use stay valid.
+    void Clear();
+
+private:
+
+    std::mutex mutex_;
+    std::map<SpinRemapGeometry, std::shared_ptr<SpinRemapTables>> geometries_;
+    std::atomic<size_t> cached_bytes_{ 0 };
+};
+
+}
@@ -0,0 +1,381 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include <boost/timer/timer.hpp>
+
+#include "spin_search_engine.h"
+#include "utils/logging_tools.h"
+#include "utils/cv_utils.h"
+
+
+namespace golf_sim {
+
+    SpinSearchEngine::CompactRotation SpinSearchEngine::CompactRotation::FromDegrees(const cv::Vec3i& rotation_degrees) {
+        CompactRotation r;
+
+        // The angles are narrowed to float before use so that the results match
+        // Project2dImageTo3dBall exactly.  Negative X due to rotation in X axis being backward.
+        double x_rad = (float)-CvUtils::DegreesToRadians((double)rotation_degrees[0]);
+        double y_rad = (float)CvUtils::DegreesToRadians((double)rotation_degrees[1]);
+        double z_rad = (float)CvUtils::DegreesToRadians((double)rotation_degrees[2]);
+
+        r.sin_x = sin(x_rad);
+        r.cos_x = cos(x_rad);
+        r.sin_y = sin(y_rad);
+        r.cos_y = cos(y_rad);
+        r.sin_z = sin(z_rad);
+        r.cos_z = cos(z_rad);
+
+        // If some of the angles are 0, then we don't need to do any math at all for that axis or axes
+        r.rotating_on_x = (std::abs(x_rad) > 0.001);
+        r.rotating_on_y = (std::abs(y_rad) > 0.001);
+        r.rotating_on_z = (std::abs(z_rad) > 0.001);
+
+        return r;
+    }
+
+    SpinSearchEngine::SpinSearchEngine(const cv::Mat& base_dimple_image, const GolfBall& ball) {
+
+        CV_Assert((base_dimple_image.type() == CV_8UC1));
+
+        rows_ = base_dimple_image.rows;
+        cols_ = base_dimple_image.cols;
+        ball_center_x_ = (double)ball.x();
+        ball_center_y_ = (double)ball.y();
+        radius_ = ball.measured_radius_pixels_;
+
+        if (BallImageProc::kUseSpinRemapCache) {
+            SpinRemapGeometry geometry = SpinRemapGeometry::FromBall(ball, rows_, cols_, BallImageProc::kSpinRemapCacheRadiusQuantumPixels);
+            remap_tables_ = SpinRemapCache::GetSharedCache().GetTables(geometry);
+
+            if (remap_tables_) {
+                // The tables are only valid for exactly this geometry
+                ball_center_x_ = geometry.center_x();
+                ball_center_y_ = geometry.center_y();
+                radius_ = geometry.radius();
+            }
+        }
+        radius_squared_ = radius_ * radius_;
+
+        points_.resize((size_t)rows_ * cols_);
+
+        // NOTE - The spin code has always addressed its images as (x, y) = (row, column), so
+        // the "x" coordinates here are row indexes.  This is harmless because the isolated
+        // ball images are square, but it must stay consistent with CompareRotationImage.
+        size_t i = 0;
+        for (int x = 0; x < rows_; x++) {
+            const uchar* row_ptr = base_dimple_image.ptr<uchar>(x);
+
+            for (int y = 0; y < cols_; y++, i++) {
+                HemispherePoint& p = points_[i];
+                p.x_from_center = (double)x - ball_center_x_;
+                p.y_from_center = (double)y - ball_center_y_;
+                p.z = GetBallZ(p.x_from_center, p.y_from_center);
+                p.pixel_value = row_ptr[y];
+                // A 0 Z-value means that the point was outside the ball
+                p.prerotated_point_valid = (p.z > 0.0001);
+
+                if (p.pixel_value != 0 && p.pixel_value != 255 && p.pixel_value != kPixelIgnoreValue) {
+                    bitplane_compatible_ = false;
+                }
+            }
+        }
+    }
+
+    inline double SpinSearchEngine::GetBallZ(const double x_from_center, const double y_from_center) const {
+        // Basic idea:  x2 + y2 + z2 = r2  (2's are squared).  Just solve for z where we can
+        if (std::abs(x_from_center) > radius_ || std::abs(y_from_center) > radius_) {
+            return 0.0;
+        }
+
+        double diff = radius_squared_ - (x_from_center * x_from_center + y_from_center * y_from_center);
+
+        return (diff < 0.0) ? 0.0 : sqrt(diff);
+    }
+
+    void SpinSearchEngine::ProjectCandidate(const cv::Vec3i& rotation_degrees, cv::Mat& projected_img) const {
+        ProjectCandidate(CompactRotation::FromDegrees(rotation_degrees), projected_img);
+    }
+
+    inline long SpinSearchEngine::RotatePoint(const HemispherePoint& p, const CompactRotation& rotation, double& rotated_z) const {
+        double x = p.x_from_center;
+        double y = p.y_from_center;
+        double z = p.z;
+
+        // The (int) truncations of Z below intentionally match the original projection
+        if (rotation.rotating_on_x) {
+            double tmp_y = y;
+            y = (y * rotation.cos_x) - (z * rotation.sin_x);
+            z = (int)((tmp_y * rotation.sin_x) + (z * rotation.cos_x));
+        }
+
+        if (rotation.rotating_on_y) {
+            double tmp_x = x;
+            x = (x * rotation.cos_y) + (z * rotation.sin_y);
+            z = (int)((z * rotation.cos_y) - (tmp_x * rotation.sin_y));
+        }
+
+        if (rotation.rotating_on_z) {
+            double tmp_x = x;
+            x = (x * rotation.cos_z) - (y * rotation.sin_z);
+            y = (tmp_x * rotation.sin_z) + (y * rotation.cos_z);
+        }
+
+        // Shift back to coordinates with the origin in the top-left
+        double image_x = x + ball_center_x_;
+        double image_y = y + ball_center_y_;
+
+        // If the point we rotated to is now behind the visible surface of the ball,
+        // or outside the image, just ignore it
+        rotated_z = GetBallZ(image_x - ball_center_x_, image_y - ball_center_y_);
+
+        if (image_x < 0 || image_y < 0 || image_x >= cols_ || image_y >= rows_ || rotated_z <= 0.0) {
+            return -1;
+        }
+
+        int rounded_x = (int)(image_x + 0.5);
+        int rounded_y = (int)(image_y + 0.5);
+
+        if (rounded_x >= rows_ || rounded_y >= cols_) {
+            return -1;
+        }
+
+        return (long)rounded_x * cols_ + rounded_y;
+    }
+
+    void SpinSearchEngine::ProjectCandidate(const CompactRotation& rotation, cv::Mat& projected_img) const {
+
+        // create() is a no-op if the scratch image is already the right shape
+        projected_img.create(rows_, cols_, CV_32SC2);
+
+        // Due to rotations, some of the 3D image might have "holes" where the
+        // pixel was not set to a value.  Make sure anything we don't set is ignored.
+        projected_img.setTo(cv::Scalar(0, kPixelIgnoreValue));
+
+        CV_Assert(projected_img.isContinuous());
+        cv::Vec2i* destination_pixels = projected_img.ptr<cv::Vec2i>(0);
+
+        for (size_t i = 0; i < points_.size(); i++) {
+            const HemispherePoint& p = points_[i];
+
+            // A pre-rotated point that is not on the hemisphere marks its own location as
+            // ignored, possibly over-writing an earlier point that rotated onto it.
+            if (!p.prerotated_point_valid) {
+                destination_pixels[i] = cv::Vec2i((int)p.z, kPixelIgnoreValue);
+            }
+
+            double rotated_z = 0.0;
+            long destination_index = RotatePoint(p, rotation, rotated_z);
+
+            if (destination_index < 0) {
+                continue;
+            }
+
+            cv::Vec2i& destination = destination_pixels[destination_index];
+            destination[0] = (int)rotated_z;
+            // If the final, new pixel came from an invalid place, don't allow it to pollute the rotated image
+            destination[1] = p.prerotated_point_valid ? p.pixel_value : kPixelIgnoreValue;
+        }
+    }
+
+    void SpinSearchEngine::ProjectCandidate(const CompactRotation& rotation, SpinBitplanes& projected_planes) const {
+
+        // Everything starts out ignored, just as with the image-based projection
+        projected_planes.Reset(rows_, cols_);
+
+        // Points are visited in the same order as the image-based projection, so when two
+        // points land on the same pixel the later one wins in both representations
+        for (size_t i = 0; i < points_.size(); i++) {
+            const HemispherePoint& p = points_[i];
+
+            if (!p.prerotated_point_valid) {
+                projected_planes.SetPixel(i, kPixelIgnoreValue);
+            }
+
+            double rotated_z = 0.0;
+            long destination_index = RotatePoint(p, rotation, rotated_z);
+
+            if (destination_index < 0) {
+                continue;
+            }
+
+            projected_planes.SetPixel((size_t)destination_index, p.prerotated_point_valid ? p.pixel_value : kPixelIgnoreValue);
+        }
+    }
+
+    void SpinSearchEngine::BuildRemapTable(const CompactRotation& rotation, std::vector<SpinRemapTables::Index>& table) const {
+        table.resize(points_.size());
+
+        for (size_t i = 0; i < points_.size(); i++) {
+            double rotated_z = 0.0;
+            long destination_index = RotatePoint(points_[i], rotation, rotated_z);
+
+            table[i] = (destination_index < 0) ? SpinRemapTables::kNoDestination : (SpinRemapTables::Index)destination_index;
+        }
+    }
+
+    void SpinSearchEngine::ProjectCandidate(const cv::Vec3i& rotation_degrees, SpinBitplanes& projected_planes,
+                                            std::vector<SpinRemapTables::Index>& remap_scratch) const {
+        if (!remap_tables_) {
+            ProjectCandidate(CompactRotation::FromDegrees(rotation_degrees), projected_planes);
+            return;
+        }
+
+        const SpinRemapTables::Index* table = remap_tables_->Find(rotation_degrees);
+
+        if (table == nullptr) {
+            BuildRemapTable(CompactRotation::FromDegrees(rotation_degrees), remap_scratch);
+            table = remap_tables_->Insert(rotation_degrees, std::move(remap_scratch));
+
+            if (table == nullptr) {
+                // The cache is full, so just use the table we built
+                table = remap_scratch.data();
+            }
+        }
+
+        projected_planes.Reset(rows_, cols_);
+
+        // Same order, and so the same last-write-wins results, as the un-cached projection
+        for (size_t i = 0; i < points_.size(); i++) {
+            const HemispherePoint& p = points_[i];
+
+            if (!p.prerotated_point_valid) {
+                projected_planes.SetPixel(i, kPixelIgnoreValue);
+            }
+
+            if (table[i] != SpinRemapTables::kNoDestination) {
+                projected_planes.SetPixel(table[i], p.prerotated_point_valid ? p.pixel_value : kPixelIgnoreValue);
+            }
+        }
+    }
+
+    void SpinSearchEngine::BuildCandidates(const BallImageProc::RotationSearchSpace& search_space,
+                                           cv::Mat& candidate_elements_mat,
+                                           cv::Vec3i& candidate_elements_mat_size,
+                                           std::vector<RotationCandidate>& candidates) const {
+
+        int xSize = (int)std::ceil((search_space.anglex_rotation_degrees_end - search_space.anglex_rotation_degrees_start) / search_space.anglex_rotation_degrees_increment) + 1;
+        int ySize = (int)std::ceil((search_space.angley_rotation_degrees_end - search_space.angley_rotation_degrees_start) / search_space.angley_rotation_degrees_increment) + 1;
+        int zSize = (int)std::ceil((search_space.anglez_rotation_degrees_end - search_space.anglez_rotation_degrees_start) / search_space.anglez_rotation_degrees_increment) + 1;
+
+        candidate_elements_mat_size = cv::Vec3i(xSize, ySize, zSize);
+
+        GS_LOG_TRACE_MSG(trace, "SpinSearchEngine::BuildCandidates will evaluate " + std::to_string(xSize * ySize * zSize) + " rotations.");
+
+        int sizes[3] = { xSize, ySize, zSize };
+        candidate_elements_mat = cv::Mat(3, sizes, CV_16U, cv::Scalar(0));
+
+        candidates.clear();
+        candidates.reserve((size_t)xSize * ySize * zSize);
+
+        short vectorIndex = 0;
+
+        for (int x_rotation_degrees = search_space.anglex_rotation_degrees_start, xIndex = 0; x_rotation_degrees <= search_space.anglex_rotation_degrees_end; x_rotation_degrees += search_space.anglex_rotation_degrees_increment, xIndex++) {
+            for (int y_rotation_degrees = search_space.angley_rotation_degrees_start, yIndex = 0; y_rotation_degrees <= search_space.angley_rotation_degrees_end; y_rotation_degrees += search_space.angley_rotation_degrees_increment, yIndex++) {
+                for (int z_rotation_degrees = search_space.anglez_rotation_degrees_start, zIndex = 0; z_rotation_degrees <= search_space.anglez_rotation_degrees_end; z_rotation_degrees += search_space.anglez_rotation_degrees_increment, zIndex++) {
+
+                    RotationCandidate c;
+                    c.index = vectorIndex;
+                    c.x_rotation_degrees = x_rotation_degrees;
+                    c.y_rotation_degrees = y_rotation_degrees;
+                    c.z_rotation_degrees = z_rotation_degrees;
+                    c.score = 0.0;
+
+                    candidates.push_back(c);
+                    candidate_elements_mat.at<ushort>(xIndex, yIndex, zIndex) = vectorIndex;
+
+                    vectorIndex++;
+                }
+            }
+        }
+    }
+
+    void SpinSearchEngine::ScoreCandidates(const cv::Mat& target_image,
+                                           std::vector<RotationCandidate>& candidates,
+                                           std::vector<std::string>& comparison_csv_data,
+                                           WorkStealingPool& pool) const {
+        boost::timer::cpu_timer timer1;
+
+        SpinBitplanes target_planes;
+        bool use_bitplanes = BallImageProc::kUseBitplaneSpinScoring && bitplane_compatible_ &&
+                             SpinBitplaneScorer::PackImage(target_image, target_planes);
+
+        if (use_bitplanes) {
+            ScoreCandidatesWithBitplanes(target_planes, candidates, pool);
+        }
+        else {
+            ScoreCandidatesWithImages(target_image, candidates, pool);
+        }
+
+        comparison_csv_data.resize(candidates.size());
+
+        for (size_t i = 0; i < candidates.size(); i++) {
+            const RotationCandidate& c = candidates[i];
+
+            // CSV (Excel) File format
+            // Columns are Idx, Rotx, Roty, Rotz, Score, Out-of, ScaledScore
+            comparison_csv_data[i] = std::to_string(c.index) + "\t" + std::to_string(c.x_rotation_degrees) + "\t" + std::to_string(c.y_rotation_degrees) + "\t" + std::to_string(c.z_rotation_degrees) + "\t" + std::to_string(c.pixels_matching) + "\t" + std::to_string(c.pixels_examined) +
+                "\t" + std::to_string(c.score) + "\n";
+        }
+
+        timer1.stop();
+        boost::timer::cpu_times times = timer1.elapsed();
+        std::cout << "SpinSearchEngine::ScoreCandidates (" << candidates.size() << " candidates, " << (use_bitplanes ? SpinBitplaneScorer::BackendName() : "image") << "): ";
+        std::cout << std::fixed << std::setprecision(8)
+            << times.wall / 1.0e9 << "s wall, "
+            << times.user / 1.0e9 << "s user + "
+            << times.system / 1.0e9 << "s system.\n";
+    }
+
+    void SpinSearchEngine::ScoreCandidatesWithBitplanes(const SpinBitplanes& target_planes,
+                                                        std::vector<RotationCandidate>& candidates,
+                                                        WorkStealingPool& pool) const {
+
+        // Each chunk gets its own scratch bitplanes that are re-used across all of its candidates
+        pool.ParallelFor(0, (int)candidates.size(), [&](int begin, int end) {
+            SpinBitplanes projected_planes;
+            std::vector<SpinRemapTables::Index> remap_scratch;
+
+            for (int i = begin; i < end; i++) {
+                RotationCandidate& c = candidates[i];
+
+                ProjectCandidate(cv::Vec3i(c.x_rotation_degrees, c.y_rotation_degrees, c.z_rotation_degrees), projected_planes, remap_scratch);
+
+                cv::Vec2i results = SpinBitplaneScorer::Compare(target_planes, projected_planes);
+
+                c.pixels_matching = results[0];
+                c.pixels_examined = results[1];
+                c.score = (double)results[0] / (double)results[1];
+            }
+        });
+    }
+
+    void SpinSearchEngine::ScoreCandidatesWithImages(const cv::Mat& target_image,
+                                                     std::vector<RotationCandidate>& candidates,
+                                                     WorkStealingPool& pool) const {
+
+        // Each chunk gets its own scratch projection that is re-used across all of its candidates
+        pool.ParallelFor(0, (int)candidates.size(), [&](int begin, int end) {
+            cv::Mat projected_img;
+
+            for (int i = begin; i < end; i++) {
+                RotationCandidate& c = candidates[i];
+
+                ProjectCandidate(cv::Vec3i(c.x_rotation_degrees, c.y_rotation_degrees, c.z_rotation_degrees), projected_img);
+
+                cv::Vec2i results = BallImageProc::CompareRotationImage(target_image, projected_img, c.index);
+
+                c.pixels_matching = results[0];
+                c.pixels_examined = results[1];
+                c.score = (double)results[0] / (double)results[1];
+            }
+        });
+    }
+
+}
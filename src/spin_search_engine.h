@@ -0,0 +1,143 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Coarse-to-fine spin search over a single isolated, Gabor-filtered ball image.
+// The hemisphere geometry (the sphere Z value of every pixel, relative to the
+// ball center) is computed once per ball.  Each rotation candidate is then just a
+// compact set of trig values that is applied to that point cloud, so that the
+// coarse and fine passes in BallImageProc::GetBallRotation no longer have to
+// allocate and re-derive a full 3D projection for every candidate angle.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "golf_ball.h"
+#include "ball_image_proc.h"
+#include "spin_bitplane_scorer.h"
+#include "work_stealing_pool.h"
+#include "spin_remap_cache.h"
+
+
+namespace golf_sim {
+
+class SpinSearchEngine {
+public:
+
+    // The only per-candidate state needed to move a point on the ball.  Replaces
+    // the full CV_32SC2 projection that used to be stored with each candidate.
+    struct CompactRotation {
+        double sin_x = 0.0;
+        double cos_x = 1.0;
+        double sin_y = 0.0;
+        double cos_y = 1.0;
+        double sin_z = 0.0;
+        double cos_z = 1.0;
+        bool rotating_on_x = false;
+        bool rotating_on_y = false;
+        bool rotating_on_z = false;
+
+        // Uses the same sign conventions as BallImageProc::Project2dImageTo3dBall
+        static CompactRotation FromDegrees(const cv::Vec3i& rotation_degrees);
+    };
+
+    // base_dimple_image is expected to have pixels with only 0, 255, or kPixelIgnoreValue
+    // and the ball is expected to be positioned relative to that (isolated) image.
+    // If BallImageProc::kUseSpinRemapCache is set, the ball's center and radius are snapped
+    // to the remap cache's quantum so that the cached tables can be shared between shots.
+    SpinSearchEngine(const cv::Mat& base_dimple_image, const GolfBall& ball);
+
+    // Fills in the candidate list (and the x/y/z index matrix that refers into it) for
+    // every rotation in the search space.  The candidates only carry their rotation
+    // angles - no per-candidate image is created.
+    void BuildCandidates(const BallImageProc::RotationSearchSpace& search_space,
+                         cv::Mat& candidate_elements_mat,
+                         cv::Vec3i& candidate_elements_mat_size,
+                         std::vector<RotationCandidate>& candidates) const;
+
+    // Produces the same (Z, pixel) CV_32SC2 image as BallImageProc::Project2dImageTo3dBall.
+    // projected_img is re-used without re-allocation if it is already the correct size and type.
+    void ProjectCandidate(const cv::Vec3i& rotation_degrees, cv::Mat& projected_img) const;
+    void ProjectCandidate(const CompactRotation& rotation, cv::Mat& projected_img) const;
+
+    // Same projection, but written straight into packed edge/valid bitplanes.
+    // Only meaningful if IsBitplaneCompatible() is true.
+    void ProjectCandidate(const CompactRotation& rotation, SpinBitplanes& projected_planes) const;
+
+    // As above, but gathers through the rotation's cached remap table when there is one,
+    // building (and caching) the table first if need be.  remap_scratch is re-used between calls.
+    void ProjectCandidate(const cv::Vec3i& rotation_degrees, SpinBitplanes& projected_planes,
+                          std::vector<SpinRemapTables::Index>& remap_scratch) const;
+
+    // Null unless the remap cache is in use for this engine's geometry
+    const SpinRemapTables* GetRemapTables() const { return remap_tables_.get(); }
+
+    // True if the base image only holds 0, 255 and kPixelIgnoreValue pixels and so
+    // can be scored with the SpinBitplaneScorer
+    bool IsBitplaneCompatible() const { return bitplane_compatible_; }
+
+    // Scores each candidate against the target image and records the result in the candidate.
+    // comparison_csv_data will be re-sized to hold one tab-separated line per candidate.
+    // Uses the bit-packed scorer if BallImageProc::kUseBitplaneSpinScoring is set and both
+    // images are bitplane-compatible, otherwise BallImageProc::CompareRotationImage.
+    // The engine is never modified after construction, so several threads may score
+    // against it (or against different engines) at the same time.
+    void ScoreCandidates(const cv::Mat& target_image,
+                         std::vector<RotationCandidate>& candidates,
+                         std::vector<std::string>& comparison_csv_data,
+                         WorkStealingPool& pool = WorkStealingPool::GetSharedPool()) const;
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+private:
+
+    // One pixel of the base image, already translated to ball-centered coordinates
+    // and projected onto the visible hemisphere.
+    struct HemispherePoint {
+        double x_from_center;
+        double y_from_center;
+        double z;
+        uchar pixel_value;
+        bool prerotated_point_valid;
+    };
+
+    // Returns the hemisphere Z for a ball-centered point, or 0 if the point is off the ball
+    inline double GetBallZ(const double x_from_center, const double y_from_center) const;
+
+    // Rotates the point and returns the flattened (row * cols + col) destination index,
+    // or -1 if the rotated point is off the image or behind the visible hemisphere.
+    // rotated_z receives the hemisphere Z at the destination.
+    inline long RotatePoint(const HemispherePoint& p, const CompactRotation& rotation, double& rotated_z) const;
+
+    // Fills table with the destination of every point for the rotation
+    void BuildRemapTable(const CompactRotation& rotation, std::vector<SpinRemapTables::Index>& table) const;
+
+    void ScoreCandidatesWithBitplanes(const SpinBitplanes& target_planes,
+                                      std::vector<RotationCandidate>& candidates,
+                                      WorkStealingPool& pool) const;
+    void ScoreCandidatesWithImages(const cv::Mat& target_image,
+                                   std::vector<RotationCandidate>& candidates,
+                                   WorkStealingPool& pool) const;
+
+    std::vector<HemispherePoint> points_;
+
+    double ball_center_x_ = 0.0;
+    double ball_center_y_ = 0.0;
+    double radius_ = 0.0;
+    double radius_squared_ = 0.0;
+
+    int rows_ = 0;
+    int cols_ = 0;
+
+    bool bitplane_compatible_ = true;
+
+    std::shared_ptr<SpinRemapTables> remap_tables_;
+};
+
+}
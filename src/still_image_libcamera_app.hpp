@@ -43,4 +43,9 @@ bool still_image_event_loop(LibcameraJpegApp& app, cv::Mat& returnImg);
 
 bool ball_flight_camera_event_loop(LibcameraJpegApp& app, cv::Mat& returnImg);
 
+// The camera 2 event loop in two parts, so that a camera can be kept open and
+// configured (and re-armed) between shots.  ball_flight_camera_event_loop does both.
+bool ball_flight_camera_start(LibcameraJpegApp& app);
+bool ball_flight_camera_wait_for_image(LibcameraJpegApp& app, cv::Mat& returnImg);
+
 #endif // #ifdef __unix__  // Ignore in Windows environment
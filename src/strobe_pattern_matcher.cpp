@@ -0,0 +1,266 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+
+#include "utils/logging_tools.h"
+
+#include "strobe_pattern_matcher.h"
+
+
+namespace golf_sim {
+
+    // The contribution of one pair of ratios to the score
+    static double RatioDifferenceScore(double distance_ratio, double pulse_ratio) {
+        const double kMaxRatioDistance = 1000.0;
+
+        double single_ratio_difference = 100. * std::abs(distance_ratio - pulse_ratio);
+
+        if (single_ratio_difference > kMaxRatioDistance) {
+            single_ratio_difference = kMaxRatioDistance;
+        }
+
+        // Square to emphasize larger errors
+        return pow(single_ratio_difference, 2);
+    }
+
+    double StrobePatternMatcher::ComputeRatioDistance(const std::vector<double>& distance_ratios,
+                                                      const std::vector<double>& pulse_ratios,
+                                                      int offset) {
+        double difference_in_ratios = 0.0;
+
+        for (size_t i = 0; i < distance_ratios.size(); i++) {
+            difference_in_ratios += RatioDifferenceScore(distance_ratios[i], pulse_ratios[i + offset]);
+        }
+
+        return difference_in_ratios;
+    }
+
+    StrobePatternMatcher::StrobePatternMatcher(const std::vector<float>& pulse_intervals_ms)
+        : pulse_intervals_ms_(pulse_intervals_ms) {
+
+        const int number_of_strobes = (int)pulse_intervals_ms_.size();
+
+        if (number_of_strobes < 3 || number_of_strobes > kMaxNumberOfStrobes) {
+            GS_LOG_MSG(error, "StrobePatternMatcher - cannot match a strobe pulse vector of " +
+                              std::to_string(number_of_strobes) + " intervals.");
+            return;
+        }
+
+        patterns_.resize(number_of_strobes + 1);
+        alignments_.resize(number_of_strobes + 1);
+
+        for (int number_missing_exposures = 0; number_missing_exposures <= number_of_strobes; number_missing_exposures++) {
+            AddPatterns(number_missing_exposures);
+        }
+    }
+
+    void StrobePatternMatcher::AddPatterns(int number_missing_exposures) {
+        const int number_of_strobes = (int)pulse_intervals_ms_.size();
+
+        // The original enumeration tried each number_of_strobes-bit number with one bit per
+        // missing exposure, taking the bits as flags for the (number_of_strobes - 1) intervals,
+        // right to left.  The top bit fell off the end, and the flag for the last interval was
+        // never used, so only the middle (number_of_strobes - 2) bits could collapse a pulse,
+        // and the same collapse pattern could come up more than once.  Each pattern is added
+        // once, in the order of the last number that produced it, because the original kept
+        // the last of any equally-good matches.
+        const int number_collapsible = number_of_strobes - 2;
+        const uint32_t all_bits = (1U << number_of_strobes) - 1;
+
+        std::vector<std::pair<uint32_t, uint32_t>> order_and_collapse_masks;
+
+        for (uint32_t collapse_mask = 0; collapse_mask < (1U << number_collapsible); collapse_mask++) {
+            const int extra_bits = number_missing_exposures - std::popcount(collapse_mask);
+
+            if (extra_bits < 0 || extra_bits > 2) {
+                continue;
+            }
+
+            // Without any pulses collapsed, the original had no ratios to compare, so never
+            // matched.  That is only kept when exposures are missing.
+            if (collapse_mask == 0 && number_missing_exposures > 0) {
+                continue;
+            }
+
+            uint32_t last_number = collapse_mask << 1;
+            if (extra_bits >= 1) {
+                last_number |= 1U << (number_of_strobes - 1);
+            }
+            if (extra_bits == 2) {
+                last_number |= 1U;
+            }
+
+            if (last_number == all_bits) {
+                continue;
+            }
+
+            order_and_collapse_masks.emplace_back(last_number, collapse_mask);
+        }
+
+        std::sort(order_and_collapse_masks.begin(), order_and_collapse_masks.end());
+
+        std::vector<Pattern>& patterns = patterns_[number_missing_exposures];
+        std::vector<Alignment>& alignments = alignments_[number_missing_exposures];
+
+        for (const auto& [last_number, collapse_mask] : order_and_collapse_masks) {
+            Pattern pattern;
+            pattern.pulse_intervals_ms = pulse_intervals_ms_;
+            pattern.intervals_to_collapse.assign(number_of_strobes - 1, false);
+
+            // Collapse from the left, merging each flagged interval with the one after it,
+            // in the same order (and so with the same float rounding) as the original
+            int number_collapsed_so_far = 0;
+
+            for (int v = 0; v < number_collapsible; v++) {
+                if ((collapse_mask & (1U << (number_collapsible - 1 - v))) == 0) {
+                    continue;
+                }
+
+                pattern.intervals_to_collapse[v] = true;
+
+                const int offset = v - number_collapsed_so_far;
+                pattern.pulse_intervals_ms[offset] += pattern.pulse_intervals_ms[offset + 1];
+                pattern.pulse_intervals_ms.erase(pattern.pulse_intervals_ms.begin() + offset + 1);
+                number_collapsed_so_far++;
+            }
+
+            for (size_t i = 0; i < pattern.pulse_intervals_ms.size() - 1; i++) {
+                pattern.pulse_ratios.push_back((double)pattern.pulse_intervals_ms[i + 1] / (double)pattern.pulse_intervals_ms[i]);
+            }
+
+            // The last ratio (to the trailing 0 interval) is never the start of a match
+            const int pattern_index = (int)patterns.size();
+            for (int offset = 0; offset < (int)pattern.pulse_ratios.size() - 1; offset++) {
+                alignments.push_back({ pattern.pulse_ratios[offset], pattern_index, offset });
+            }
+
+            patterns.push_back(std::move(pattern));
+        }
+
+        std::sort(alignments.begin(), alignments.end(), [](const Alignment& a, const Alignment& b) {
+            return a.first_pulse_ratio < b.first_pulse_ratio;
+        });
+    }
+
+    bool StrobePatternMatcher::FindBestMatch(const std::vector<double>& distance_ratios,
+                                             int number_missing_exposures,
+                                             Match& match) const {
+
+        if (distance_ratios.empty() || number_missing_exposures < 0 ||
+            number_missing_exposures >= (int)patterns_.size()) {
+            return false;
+        }
+
+        const std::vector<Pattern>& patterns = patterns_[number_missing_exposures];
+        const std::vector<Alignment>& alignments = alignments_[number_missing_exposures];
+        const int number_distance_ratios = (int)distance_ratios.size();
+        const double first_distance_ratio = distance_ratios[0];
+
+        double best_score = kMaxMatchScore;
+        int best_pattern_index = -1;
+        int best_offset = -1;
+
+        // Scores the alignment, giving up as soon as it can't beat (or tie) the best so far.
+        // Ties go to the later pattern, and then to the lower offset, as they did originally.
+        auto consider = [&](const Alignment& alignment) {
+            const std::vector<double>& pulse_ratios = patterns[alignment.pattern_index].pulse_ratios;
+
+            if (alignment.offset >= (int)pulse_ratios.size() - number_distance_ratios) {
+                return;
+            }
+
+            double score = 0.0;
+            for (int i = 0; i < number_distance_ratios; i++) {
+                score += RatioDifferenceScore(distance_ratios[i], pulse_ratios[i + alignment.offset]);
+                if (score > best_score) {
+                    return;
+                }
+            }
+
+            bool is_better;
+            if (best_pattern_index < 0) {
+                is_better = (score < kMaxMatchScore);
+            }
+            else {
+                is_better = (score < best_score) ||
+                            (score == best_score && (alignment.pattern_index > best_pattern_index ||
+                                                     (alignment.pattern_index == best_pattern_index && alignment.offset < best_offset)));
+            }
+
+            if (is_better) {
+                best_score = score;
+                best_pattern_index = alignment.pattern_index;
+                best_offset = alignment.offset;
+            }
+        };
+
+        // Work outwards from the alignments whose first pulse ratio is closest to the first
+        // distance ratio.  The first ratio's score only grows from there, so each direction
+        // can stop once that alone is worse than the best match.
+        const auto start = std::lower_bound(alignments.begin(), alignments.end(), first_distance_ratio,
+                                            [](const Alignment& a, double ratio) { return a.first_pulse_ratio < ratio; });
+
+        for (auto it = start; it != alignments.end(); ++it) {
+            if (RatioDifferenceScore(first_distance_ratio, it->first_pulse_ratio) > best_score) {
+                break;
+            }
+            consider(*it);
+        }
+
+        for (auto it = start; it != alignments.begin(); ) {
+            --it;
+            if (RatioDifferenceScore(first_distance_ratio, it->first_pulse_ratio) > best_score) {
+                break;
+            }
+            consider(*it);
+        }
+
+        if (best_pattern_index < 0) {
+            return false;
+        }
+
+        const Pattern& best_pattern = patterns[best_pattern_index];
+        match.pulse_intervals_ms = best_pattern.pulse_intervals_ms;
+        match.intervals_to_collapse = best_pattern.intervals_to_collapse;
+        match.ratio_offset = best_offset;
+        match.score = best_score;
+
+        return true;
+    }
+
+    std::shared_ptr<const StrobePatternMatcher> StrobePatternMatcher::ForPulseIntervals(const std::vector<float>& pulse_intervals_ms) {
+        // Typically only the driver and putter pulse vectors are ever used
+        const size_t kMaxCachedMatchers = 4;
+
+        static std::mutex cache_mutex;
+        static std::vector<std::shared_ptr<const StrobePatternMatcher>> cached_matchers;
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+
+        for (const auto& matcher : cached_matchers) {
+            if (matcher->pulse_intervals_ms() == pulse_intervals_ms) {
+                return matcher;
+            }
+        }
+
+        auto matcher = std::make_shared<const StrobePatternMatcher>(pulse_intervals_ms);
+
+        if (cached_matchers.size() >= kMaxCachedMatchers) {
+            cached_matchers.erase(cached_matchers.begin());
+        }
+        cached_matchers.push_back(matcher);
+
+        GS_LOG_TRACE_MSG(trace, "StrobePatternMatcher::ForPulseIntervals - built a matcher for " +
+                                std::to_string(pulse_intervals_ms.size()) + " pulse intervals.");
+
+        return matcher;
+    }
+
+}
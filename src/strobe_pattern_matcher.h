@@ -0,0 +1,105 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Matches the spacing of the strobed ball images to the strobe pulse intervals.
+//
+// Some of the strobed exposures are usually lost (e.g., overlapped or out of the
+// frame), so the ball images correspond to the pulse intervals with some of the
+// pulses 'collapsed' into the interval before them.  The ratio of each pair of
+// successive ball distances should then match the ratio of the corresponding pair of
+// (collapsed) pulse intervals.
+//
+// GolfSimCamera::DetermineStrobeIntervals used to enumerate every bit pattern of
+// collapsed pulses for every shot, rebuilding the collapsed intervals and ratios and
+// sliding the distance ratios along each of them.  StrobePatternMatcher builds every
+// collapse pattern, with its intervals and ratios, once per strobe pulse vector.  It
+// indexes every (pattern, offset) alignment by the first pulse ratio it would compare.
+// A match starts from the alignments closest to the first distance ratio, and stops
+// once the first ratio alone scores worse than the best match so far.
+//
+// The candidate patterns, the score and the tie-breaking are the same as the
+// original enumeration, so the results are unchanged.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+
+namespace golf_sim {
+
+class StrobePatternMatcher {
+public:
+
+    struct Match {
+        // The pulse intervals with the missing pulses collapsed, ending with the 0 interval
+        std::vector<float> pulse_intervals_ms;
+
+        // True for each interval that had the following pulse collapsed into it
+        std::vector<bool> intervals_to_collapse;
+
+        // The index of the pulse ratio that matches the first distance ratio
+        int ratio_offset = -1;
+
+        // The sum of the squared (capped) differences between the ratios.  Lower is better.
+        double score = 0.0;
+    };
+
+    // pulse_intervals_ms is the strobe pulse vector, which ends with a 0 interval
+    explicit StrobePatternMatcher(const std::vector<float>& pulse_intervals_ms);
+
+    // Finds the collapse pattern and offset whose pulse ratios best match the distance
+    // ratios, given how many of the exposures were not found.  Returns false if no
+    // pattern matches well enough.
+    bool FindBestMatch(const std::vector<double>& distance_ratios,
+                       int number_missing_exposures,
+                       Match& match) const;
+
+    const std::vector<float>& pulse_intervals_ms() const { return pulse_intervals_ms_; }
+
+    // Returns a matcher for the pulse intervals, re-using one built earlier for the same
+    // intervals if there is one
+    static std::shared_ptr<const StrobePatternMatcher> ForPulseIntervals(const std::vector<float>& pulse_intervals_ms);
+
+    // Squared differences (in percent, each capped at 1000) between the distance ratios
+    // and the pulse ratios starting at offset
+    static double ComputeRatioDistance(const std::vector<double>& distance_ratios,
+                                       const std::vector<double>& pulse_ratios,
+                                       int offset);
+
+    // The original enumeration only ever accepts a match scoring less than this
+    static constexpr double kMaxMatchScore = 99999.0;
+
+    // Every pattern, for every number of missing exposures, is built up front, and there
+    // are about 3 * 2^(number of strobes - 2) of them
+    static constexpr int kMaxNumberOfStrobes = 16;
+
+private:
+
+    struct Pattern {
+        std::vector<float> pulse_intervals_ms;
+        std::vector<double> pulse_ratios;
+        std::vector<bool> intervals_to_collapse;
+    };
+
+    // One way of lining up the distance ratios with a pattern's pulse ratios
+    struct Alignment {
+        double first_pulse_ratio;
+        int pattern_index;
+        int offset;
+    };
+
+    void AddPatterns(int number_missing_exposures);
+
+    std::vector<float> pulse_intervals_ms_;
+
+    // Indexed by the number of missing exposures.  The patterns are in the order that
+    // the original enumeration last reached them, and the alignments are sorted by
+    // their first pulse ratio.
+    std::vector<std::vector<Pattern>> patterns_;
+    std::vector<std::vector<Alignment>> alignments_;
+};
+
+}
@@ -0,0 +1,151 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+
+#include "utils/cv_utils.h"
+#include "utils/logging_tools.h"
+#include "strobed_ball_corridor.h"
+
+
+namespace golf_sim {
+
+    // How finely the cone is sampled.  The hull only depends on the extremes, but the
+    // in-between samples keep the hull reasonable if some of the extremes can't be projected.
+    static constexpr int kNumberDistanceSamples = 4;
+    static constexpr int kNumberAngleSamples = 5;
+
+    bool StrobedBallCorridor::Build(const cv::Vec3d& ball_position,
+                                    int downrange_direction,
+                                    const Projector& projector,
+                                    const cv::Size& image_size,
+                                    const Settings& settings) {
+        usable_ = false;
+        hull_.clear();
+        bounding_rect_ = cv::Rect();
+        image_size_ = image_size;
+        margin_pixels_ = std::max(0.0, settings.margin_pixels);
+
+        if (image_size.area() <= 0 || !projector) {
+            return false;
+        }
+
+        const double direction = (downrange_direction < 0) ? -1.0 : 1.0;
+
+        // Keep wildly off-image projections (e.g., nearly side-on to the camera) from
+        // overflowing the integer points that the hull is made of
+        const cv::Rect2d reasonable_area(-4.0 * image_size.width, -4.0 * image_size.height,
+                                         9.0 * image_size.width, 9.0 * image_size.height);
+
+        std::vector<cv::Point> projected_points;
+
+        auto add_projection = [&](const cv::Vec3d& position) {
+            cv::Point2d pixel;
+
+            if (!projector(position, pixel)) {
+                return false;
+            }
+
+            pixel.x = std::clamp(pixel.x, reasonable_area.x, reasonable_area.x + reasonable_area.width);
+            pixel.y = std::clamp(pixel.y, reasonable_area.y, reasonable_area.y + reasonable_area.height);
+            projected_points.emplace_back((int)std::round(pixel.x), (int)std::round(pixel.y));
+            return true;
+        };
+
+        // The corridor has to start where the ball is
+        if (!add_projection(ball_position)) {
+            GS_LOG_TRACE_MSG(trace, "StrobedBallCorridor::Build - the teed-up ball is not visible to the camera.");
+            return false;
+        }
+
+        for (int d = 1; d <= kNumberDistanceSamples; d++) {
+            const double distance = settings.max_distance_meters * d / kNumberDistanceSamples;
+
+            for (int v = 0; v < kNumberAngleSamples; v++) {
+                const double vla = CvUtils::DegreesToRadians(settings.min_launch_angle_degrees +
+                    (settings.max_launch_angle_degrees - settings.min_launch_angle_degrees) * v / (kNumberAngleSamples - 1));
+
+                for (int h = 0; h < kNumberAngleSamples; h++) {
+                    const double hla = CvUtils::DegreesToRadians(settings.max_side_angle_degrees *
+                        (2.0 * h / (kNumberAngleSamples - 1) - 1.0));
+
+                    // X is downrange, Y is up, and Z is away from the launch monitor
+                    const cv::Vec3d flight_direction(direction * std::cos(vla) * std::cos(hla),
+                                                     std::sin(vla),
+                                                     std::cos(vla) * std::sin(hla));
+
+                    add_projection(ball_position + distance * flight_direction);
+                }
+            }
+        }
+
+        cv::convexHull(projected_points, hull_);
+
+        if (hull_.size() < 3) {
+            GS_LOG_TRACE_MSG(trace, "StrobedBallCorridor::Build - too little of the corridor could be projected.");
+            hull_.clear();
+            return false;
+        }
+
+        const int margin = (int)std::ceil(margin_pixels_);
+        cv::Rect hull_rect = cv::boundingRect(hull_);
+        hull_rect = cv::Rect(hull_rect.x - margin, hull_rect.y - margin,
+                             hull_rect.width + 2 * margin, hull_rect.height + 2 * margin);
+
+        bounding_rect_ = hull_rect & cv::Rect(cv::Point(0, 0), image_size);
+
+        if (bounding_rect_.area() <= 0) {
+            GS_LOG_TRACE_MSG(trace, "StrobedBallCorridor::Build - the corridor is not within the image.");
+            return false;
+        }
+
+        const double area_fraction = (double)bounding_rect_.area() / image_size.area();
+
+        GS_LOG_TRACE_MSG(trace, "StrobedBallCorridor::Build - corridor is (x,y,w,h) = (" +
+                                std::to_string(bounding_rect_.x) + ", " + std::to_string(bounding_rect_.y) + ", " +
+                                std::to_string(bounding_rect_.width) + ", " + std::to_string(bounding_rect_.height) + "), or " +
+                                std::to_string(100.0 * area_fraction) + "% of the image.");
+
+        if (area_fraction > settings.max_area_fraction) {
+            return false;
+        }
+
+        usable_ = true;
+        return true;
+    }
+
+    bool StrobedBallCorridor::Contains(const cv::Point2f& point) const {
+
+        if (hull_.size() < 3) {
+            return false;
+        }
+
+        // Positive inside the hull, negative (the distance to it) outside
+        return cv::pointPolygonTest(hull_, point, true) >= -margin_pixels_;
+    }
+
+    cv::Mat StrobedBallCorridor::GetMask() const {
+        cv::Mat mask = cv::Mat::zeros(image_size_, CV_8UC1);
+
+        if (hull_.size() < 3) {
+            return mask;
+        }
+
+        cv::fillConvexPoly(mask, hull_, cv::Scalar(255));
+
+        const int margin = (int)std::round(margin_pixels_);
+
+        if (margin > 0) {
+            const std::vector<std::vector<cv::Point>> contours{ hull_ };
+            cv::polylines(mask, contours, true, cv::Scalar(255), 2 * margin + 1);
+        }
+
+        return mask;
+    }
+
+}
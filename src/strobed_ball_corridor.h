@@ -0,0 +1,87 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// The part of the camera 2 image that a just-hit ball can actually fly through.
+//
+// Camera 1 has already located the teed-up ball in three dimensions, so the strobed
+// exposures of that ball in the camera 2 image must lie in a fairly narrow cone that
+// starts at the tee and heads downrange.  That cone is bounded by the slowest/fastest
+// reasonable launch angles (VLA), by how far the ball can be hooked or sliced (HLA), and
+// by how far the ball can travel while camera 2's shutter is open.
+//
+// The corridor samples that cone in real-world (LM-perspective) coordinates, projects the
+// samples into camera 2 pixels, and keeps the convex hull, widened by a margin (usually a
+// ball radius or two).  The strobed-ball search can then run on just the bounding box of
+// the corridor, and discard any candidate whose center is outside it.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "gs_globals.h"
+
+
+namespace golf_sim {
+
+class StrobedBallCorridor {
+public:
+
+    struct Settings {
+        // How far downrange (in meters) of the teed-up ball to look
+        double max_distance_meters = 1.0;
+
+        // Launch angles, in degrees.  Positive VLA is upward, and HLA is symmetric
+        double min_launch_angle_degrees = -5.0;
+        double max_launch_angle_degrees = 55.0;
+        double max_side_angle_degrees = 25.0;
+
+        // Added all the way around the projected cone, in pixels
+        double margin_pixels = 0.0;
+
+        // If the bounding box of the corridor covers more than this fraction of the image,
+        // searching only the corridor doesn't save enough to be worthwhile
+        double max_area_fraction = 0.8;
+    };
+
+    // Returns the image pixel of a real-world position (in meters, in the same axes as
+    // GolfBall::distances_ortho_camera_perspective_), or false if the camera can't see it.
+    using Projector = std::function<bool(const cv::Vec3d& position_meters, cv::Point2d& pixel)>;
+
+    // ball_position is where the teed-up ball is.  downrange_direction is +1 if the ball
+    // flies toward positive X (a right-handed golfer), or -1 if toward negative X.
+    // Returns false (and leaves the corridor unusable) if too little of the cone could be
+    // projected onto the image, or the corridor is too large to be worth using.
+    bool Build(const cv::Vec3d& ball_position,
+               int downrange_direction,
+               const Projector& projector,
+               const cv::Size& image_size,
+               const Settings& settings);
+
+    bool IsUsable() const { return usable_; }
+
+    // The part of the image to search, clipped to the image
+    const cv::Rect& bounding_rect() const { return bounding_rect_; }
+
+    // The projected cone (before the margin is added), in image coordinates
+    const std::vector<cv::Point>& hull() const { return hull_; }
+
+    // True if the point (in image coordinates) is in the corridor, including its margin
+    bool Contains(const cv::Point2f& point) const;
+
+    // The corridor as a CV_8UC1 image_size mask (255 inside), mostly for logging
+    cv::Mat GetMask() const;
+
+private:
+    bool usable_ = false;
+    cv::Size image_size_;
+    double margin_pixels_ = 0.0;
+    std::vector<cv::Point> hull_;
+    cv::Rect bounding_rect_;
+};
+
+}
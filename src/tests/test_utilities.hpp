@@ -49,6 +49,30 @@ struct TestPaths {
     static std::filesystem::path GetApprovalArtifactsDir() {
         return GetTestDataDir() / "approval_artifacts";
     }
+
+    /**
+     * @brief Approved images checked in with the ImageAnalysis bounded context
+     *
+     * Returns an empty path if the source tree cannot be found from the
+     * current directory (e.g., when running an installed test binary).
+     */
+    static std::filesystem::path GetImageAnalysisApprovalArtifactsDir() {
+        auto current = std::filesystem::current_path();
+        while (true) {
+            for (const auto& relative : { "ImageAnalysis/tests/approval_artifacts",
+                                          "src/ImageAnalysis/tests/approval_artifacts" }) {
+                auto candidate = current / relative;
+                if (std::filesystem::exists(candidate)) {
+                    return candidate;
+                }
+            }
+            if (!current.has_parent_path() || current.parent_path() == current) {
+                break;
+            }
+            current = current.parent_path();
+        }
+        return std::filesystem::path();
+    }
 };
 
 /**
@@ -0,0 +1,171 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_artifact_writer.cpp
+ * @brief Unit tests for the background ArtifactWriter
+ *
+ * Checks that submitted images end up on disk intact once flushed, that only
+ * diagnostic images are ever dropped (and never the newest one), that the
+ * fixed-name images the GUI reads keep their names, and that the writer falls
+ * back to writing on the caller's thread when it is disabled.
+ */
+
+#define BOOST_TEST_MODULE ArtifactWriterTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "utils/artifact_writer.h"
+#include "utils/logging_tools.h"
+
+#include <opencv2/imgcodecs.hpp>
+
+using namespace golf_sim;
+using golf_sim::testing::TempFileHelper;
+using Priority = ArtifactWriter::Priority;
+
+namespace {
+
+// Restores the writer's configuration after each test
+struct ArtifactWriterSettingsFixture {
+    ArtifactWriterSettingsFixture()
+        : use_async(ArtifactWriter::kUseAsyncArtifactWriter),
+          max_diagnostic(ArtifactWriter::kMaxPendingDiagnosticImages),
+          max_webserver(ArtifactWriter::kMaxPendingWebserverImages),
+          format(ArtifactWriter::kDiagnosticImageFormat) {
+    }
+
+    ~ArtifactWriterSettingsFixture() {
+        ArtifactWriter::kUseAsyncArtifactWriter = use_async;
+        ArtifactWriter::kMaxPendingDiagnosticImages = max_diagnostic;
+        ArtifactWriter::kMaxPendingWebserverImages = max_webserver;
+        ArtifactWriter::kDiagnosticImageFormat = format;
+    }
+
+    bool use_async;
+    int max_diagnostic;
+    int max_webserver;
+    std::string format;
+    TempFileHelper temp_files;
+};
+
+cv::Mat MakeImage(int seed, int size = 256) {
+    cv::Mat image(size, size, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    image.at<cv::Vec3b>(0, 0) = cv::Vec3b((uchar)seed, 0, 0);
+    return image;
+}
+
+bool SameImage(const cv::Mat& a, const cv::Mat& b) {
+    return a.size() == b.size() && a.type() == b.type() && cv::norm(a, b, cv::NORM_INF) == 0.0;
+}
+
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(ArtifactWriterTests, ArtifactWriterSettingsFixture)
+
+BOOST_AUTO_TEST_CASE(SubmittedImages_AreOnDiskAfterFlush) {
+    ArtifactWriter writer;
+    std::vector<cv::Mat> originals;
+
+    for (int i = 0; i < 4; i++) {
+        cv::Mat image = MakeImage(i);
+        originals.push_back(image.clone());
+        BOOST_CHECK(writer.Submit(temp_files.GetTempPathString("image_" + std::to_string(i) + ".png"),
+                                  std::move(image), (i % 2 == 0) ? Priority::kWebserver : Priority::kDiagnostic));
+    }
+
+    BOOST_REQUIRE(writer.Flush(Priority::kDiagnostic, 10000));
+
+    for (int i = 0; i < 4; i++) {
+        const std::string file_name = temp_files.GetTempPathString("image_" + std::to_string(i) + ".png");
+        BOOST_CHECK(SameImage(cv::imread(file_name), originals[i]));
+
+        // Nothing is left behind under the temporary name
+        BOOST_CHECK(!std::filesystem::exists(temp_files.GetTempPath("image_" + std::to_string(i) + ".partial.png")));
+    }
+
+    const ArtifactWriter::Statistics statistics = writer.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.submitted, 4u);
+    BOOST_CHECK_EQUAL(statistics.written, 4u);
+    BOOST_CHECK_EQUAL(statistics.dropped, 0u);
+    BOOST_CHECK_EQUAL(statistics.pending, 0u);
+    BOOST_TEST_MESSAGE(writer.FormatStatistics());
+}
+
+BOOST_AUTO_TEST_CASE(OnlyOlderDiagnosticImages_AreDropped) {
+    ArtifactWriter::kMaxPendingDiagnosticImages = 1;
+    ArtifactWriter::kMaxPendingWebserverImages = 2;
+
+    ArtifactWriter writer;
+    const int number_images = 30;
+
+    for (int i = 0; i < number_images; i++) {
+        writer.Submit(temp_files.GetTempPathString("diagnostic_" + std::to_string(i) + ".png"), MakeImage(i, 512), Priority::kDiagnostic);
+        writer.Submit(temp_files.GetTempPathString("webserver_" + std::to_string(i) + ".png"), MakeImage(i, 512), Priority::kWebserver);
+    }
+
+    BOOST_REQUIRE(writer.Flush(Priority::kDiagnostic, 30000));
+
+    const ArtifactWriter::Statistics statistics = writer.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.submitted, 2u * number_images);
+    BOOST_CHECK_EQUAL(statistics.written + statistics.dropped, 2u * number_images);
+    BOOST_CHECK_EQUAL(statistics.failed, 0u);
+    BOOST_TEST_MESSAGE(writer.FormatStatistics());
+
+    for (int i = 0; i < number_images; i++) {
+        BOOST_CHECK(std::filesystem::exists(temp_files.GetTempPath("webserver_" + std::to_string(i) + ".png")));
+    }
+
+    // Dropping is oldest-first, so the most recent diagnostic image always survives
+    BOOST_CHECK(std::filesystem::exists(temp_files.GetTempPath("diagnostic_" + std::to_string(number_images - 1) + ".png")));
+}
+
+BOOST_AUTO_TEST_CASE(BmpFormat_AppliesToDiagnosticImagesOnly) {
+    ArtifactWriter::kDiagnosticImageFormat = "bmp";
+
+    ArtifactWriter writer;
+    writer.Submit(temp_files.GetTempPathString("diagnostic.png"), MakeImage(1), Priority::kDiagnostic);
+    writer.Submit(temp_files.GetTempPathString("webserver.png"), MakeImage(2), Priority::kWebserver);
+    BOOST_REQUIRE(writer.Flush(Priority::kDiagnostic, 10000));
+
+    BOOST_CHECK(std::filesystem::exists(temp_files.GetTempPath("diagnostic.bmp")));
+    BOOST_CHECK(!std::filesystem::exists(temp_files.GetTempPath("diagnostic.png")));
+    BOOST_CHECK(std::filesystem::exists(temp_files.GetTempPath("webserver.png")));
+}
+
+BOOST_AUTO_TEST_CASE(FixedNameLoggedImages_StayPngWithBmpDiagnostics) {
+    ArtifactWriter::kDiagnosticImageFormat = "bmp";
+
+    const std::string saved_logging_dir = LoggingTools::kBaseImageLoggingDir;
+    LoggingTools::kBaseImageLoggingDir = temp_files.GetTempPathString("");
+
+    const cv::Mat image = MakeImage(5);
+    BOOST_CHECK(LoggingTools::LogImage("", image, std::vector<cv::Point>{}, true, "log_cam2_last_pre_image.png"));
+    BOOST_REQUIRE(ArtifactWriter::GetSharedWriter().Flush(Priority::kDiagnostic, 10000));
+
+    LoggingTools::kBaseImageLoggingDir = saved_logging_dir;
+
+    BOOST_CHECK(SameImage(cv::imread(temp_files.GetTempPathString("log_cam2_last_pre_image.png")), image));
+    BOOST_CHECK(!std::filesystem::exists(temp_files.GetTempPath("log_cam2_last_pre_image.bmp")));
+}
+
+BOOST_AUTO_TEST_CASE(DisabledOrShutDown_WritesOnCallersThread) {
+    ArtifactWriter::kUseAsyncArtifactWriter = false;
+
+    ArtifactWriter writer;
+    BOOST_CHECK(writer.Submit(temp_files.GetTempPathString("sync.png"), MakeImage(3), Priority::kDiagnostic));
+    BOOST_CHECK(std::filesystem::exists(temp_files.GetTempPath("sync.png")));
+
+    ArtifactWriter::kUseAsyncArtifactWriter = true;
+    writer.Shutdown();
+    BOOST_CHECK(writer.Submit(temp_files.GetTempPathString("after_shutdown.png"), MakeImage(4), Priority::kWebserver));
+    BOOST_CHECK(std::filesystem::exists(temp_files.GetTempPath("after_shutdown.png")));
+
+    BOOST_CHECK_EQUAL(writer.GetStatistics().written_synchronously, 2u);
+
+    BOOST_CHECK(!writer.Submit(temp_files.GetTempPathString("empty.png"), cv::Mat(), Priority::kDiagnostic));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
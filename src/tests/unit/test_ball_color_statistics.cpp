@@ -0,0 +1,221 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_ball_color_statistics.cpp
+ * @brief Unit tests for the integral-image ball color statistics
+ *
+ * Checks that the statistics for each circle are the same as the ones
+ * CvUtils::GetBallColorRgb computes directly, including for circles near
+ * or past the image edges, that the median is a real (per-channel) median,
+ * and that spread-out candidates don't get integral images at all.  Reports
+ * how long clustered and spread-out candidates take to evaluate each way.
+ */
+
+#define BOOST_TEST_MODULE BallColorStatisticsTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "utils/ball_color_statistics.h"
+#include "utils/cv_utils.h"
+#include <boost/timer/timer.hpp>
+#include <random>
+
+using namespace golf_sim;
+
+namespace {
+
+// A noisy background with a few brighter, noisy 'balls' on it
+cv::Mat CreateTestImage() {
+    cv::Mat img(480, 640, CV_8UC3);
+    cv::RNG rng(25);
+    rng.fill(img, cv::RNG::UNIFORM, cv::Scalar(20, 40, 30), cv::Scalar(90, 120, 80));
+
+    cv::Mat ball_noise(img.size(), CV_8UC3);
+    rng.fill(ball_noise, cv::RNG::NORMAL, cv::Scalar(0, 0, 0), cv::Scalar(12, 12, 12));
+
+    cv::Mat balls = cv::Mat::zeros(img.size(), CV_8UC3);
+    cv::circle(balls, cv::Point(150, 200), 40, cv::Scalar(120, 120, 110), -1);
+    cv::circle(balls, cv::Point(420, 260), 55, cv::Scalar(140, 130, 130), -1);
+    cv::circle(balls, cv::Point(600, 60), 30, cv::Scalar(100, 110, 150), -1);
+    img += balls;
+    img += ball_noise;
+
+    return img;
+}
+
+void CheckSameStatistics(const std::vector<GsColorTriplet>& expected, const std::vector<GsColorTriplet>& actual) {
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+
+    for (size_t statistic = 0; statistic < expected.size(); statistic++) {
+        for (int channel = 0; channel < 3; channel++) {
+            BOOST_CHECK_SMALL(actual[statistic][channel] - expected[statistic][channel], 1e-3);
+        }
+    }
+}
+
+// Times GetBallColorRgb for each circle against BallColorStatistics (including building it)
+void BenchmarkCandidates(const std::string& description, const cv::Mat& img, const std::vector<GsCircle>& circles) {
+    double direct_total = 0.0;
+    boost::timer::cpu_timer direct_timer;
+    for (const GsCircle& circle : circles) {
+        direct_total += CvUtils::GetBallColorRgb(img, circle)[0][0];
+    }
+    direct_timer.stop();
+
+    double integral_total = 0.0;
+    boost::timer::cpu_timer integral_timer;
+    const BallColorStatistics color_statistics(img, circles);
+    for (const GsCircle& circle : circles) {
+        integral_total += color_statistics.GetBallColorRgb(circle)[0][0];
+    }
+    integral_timer.stop();
+
+    const double direct_us = direct_timer.elapsed().wall / 1000.0;
+    const double integral_us = integral_timer.elapsed().wall / 1000.0;
+
+    BOOST_TEST_MESSAGE(circles.size() << " " << description << " candidates: GetBallColorRgb " << direct_us
+                       << " us, BallColorStatistics " << integral_us << " us ("
+                       << (color_statistics.region().empty() ? "no integral images" : "integral images of the " +
+                           std::to_string(color_statistics.region().width) + "x" + std::to_string(color_statistics.region().height) + " region")
+                       << ")");
+
+    BOOST_CHECK_CLOSE(direct_total, integral_total, 1e-3);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(BallColorStatisticsTests)
+
+BOOST_AUTO_TEST_CASE(RandomCircles_MatchGetBallColorRgb) {
+    const cv::Mat img = CreateTestImage();
+
+    std::mt19937 generator(25);
+    std::uniform_real_distribution<float> x_distribution(0.0F, (float)img.cols);
+    std::uniform_real_distribution<float> y_distribution(0.0F, (float)img.rows);
+    std::uniform_real_distribution<float> radius_distribution(2.0F, 80.0F);
+
+    std::vector<GsCircle> circles;
+    for (int i = 0; i < 200; i++) {
+        circles.push_back(GsCircle(x_distribution(generator), y_distribution(generator), radius_distribution(generator)));
+    }
+
+    const BallColorStatistics color_statistics(img, circles);
+
+    for (const GsCircle& circle : circles) {
+        CheckSameStatistics(CvUtils::GetBallColorRgb(img, circle), color_statistics.GetBallColorRgb(circle));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(CirclesOutsideTheRegion_MatchGetBallColorRgb) {
+    const cv::Mat img = CreateTestImage();
+
+    // Only the left half of the image has integral images
+    const BallColorStatistics color_statistics(img, cv::Rect(0, 0, img.cols / 2, img.rows));
+
+    const std::vector<GsCircle> circles = {
+        GsCircle(150.0F, 200.0F, 40.0F),    // Inside the region
+        GsCircle(420.0F, 260.0F, 55.0F),    // Outside it
+        GsCircle(320.0F, 240.0F, 30.0F),    // Straddling its edge
+        GsCircle(5.0F, 5.0F, 20.0F),        // Clipped by the image edge
+    };
+
+    for (const GsCircle& circle : circles) {
+        CheckSameStatistics(CvUtils::GetBallColorRgb(img, circle), color_statistics.GetBallColorRgb(circle));
+    }
+
+    // A circle of (less than) one pixel has no statistics at all
+    BOOST_CHECK(color_statistics.GetBallColorRgb(GsCircle(100.0F, 100.0F, 0.5F)).empty());
+}
+
+BOOST_AUTO_TEST_CASE(GetColorRegion_CoversTheColorSquares) {
+    const cv::Mat img = CreateTestImage();
+
+    const std::vector<GsCircle> circles = { GsCircle(150.0F, 200.0F, 40.0F), GsCircle(620.0F, 20.0F, 30.0F) };
+    const cv::Rect region = BallColorStatistics::GetColorRegion(img, circles);
+
+    for (const GsCircle& circle : circles) {
+        const cv::Rect color_rect = CvUtils::GetBallColorRect(img, circle);
+        BOOST_CHECK((color_rect & region) == color_rect);
+    }
+
+    // Clipped to the image
+    BOOST_CHECK((region & cv::Rect(0, 0, img.cols, img.rows)) == region);
+
+    BOOST_CHECK(BallColorStatistics::GetColorRegion(img, {}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(Median_IsThePerChannelMedian) {
+    // Most of the square is one color, with a brighter stripe that pulls the average up
+    cv::Mat img(100, 100, CV_8UC3, cv::Scalar(50, 60, 70));
+    img(cv::Rect(0, 0, 100, 30)) = cv::Scalar(250, 250, 250);
+
+    const GsCircle circle(50.0F, 50.0F, 50.0F);
+    const std::vector<GsColorTriplet> direct = CvUtils::GetBallColorRgb(img, circle);
+    const std::vector<GsColorTriplet> integral = BallColorStatistics(img, std::vector<GsCircle>{ circle }).GetBallColorRgb(circle);
+
+    BOOST_REQUIRE_EQUAL(direct.size(), 3U);
+    BOOST_CHECK_EQUAL(direct[1][0], 50.0);
+    BOOST_CHECK_EQUAL(direct[1][1], 60.0);
+    BOOST_CHECK_EQUAL(direct[1][2], 70.0);
+    BOOST_CHECK_GT(direct[0][0], direct[1][0]);
+
+    CheckSameStatistics(direct, integral);
+
+    GsColorTriplet median;
+    BOOST_CHECK(!CvUtils::GetMedianColor(cv::Mat(10, 10, CV_32FC3, cv::Scalar(1, 2, 3)), median));
+}
+
+BOOST_AUTO_TEST_CASE(SpreadOutCandidates_SkipTheIntegralImages) {
+    const cv::Mat img = CreateTestImage();
+
+    // Small squares in the corners would need integral images of nearly the whole image
+    const std::vector<GsCircle> circles = { GsCircle(20.0F, 20.0F, 8.0F), GsCircle(620.0F, 20.0F, 8.0F),
+                                            GsCircle(20.0F, 460.0F, 8.0F), GsCircle(620.0F, 460.0F, 8.0F) };
+
+    const BallColorStatistics color_statistics(img, circles);
+    BOOST_CHECK(color_statistics.region().empty());
+
+    for (const GsCircle& circle : circles) {
+        CheckSameStatistics(CvUtils::GetBallColorRgb(img, circle), color_statistics.GetBallColorRgb(circle));
+    }
+
+    // Overlapping candidates around one ball do get them
+    const std::vector<GsCircle> clustered = { GsCircle(150.0F, 200.0F, 40.0F), GsCircle(155.0F, 195.0F, 38.0F),
+                                              GsCircle(148.0F, 204.0F, 42.0F) };
+    BOOST_CHECK(!BallColorStatistics(img, clustered).region().empty());
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark_MeanStdDevVersusIntegralImages) {
+    // A full-resolution frame, as the strobed and putting searches see it
+    cv::Mat img;
+    cv::resize(CreateTestImage(), img, cv::Size(1456, 1088));
+    const int kNumberCandidates = 200;
+
+    // Candidates clustered around a ball, as the Hough transform produces them for a teed ball
+    std::mt19937 generator(25);
+    std::normal_distribution<float> offset_distribution(0.0F, 15.0F);
+    std::uniform_real_distribution<float> radius_distribution(30.0F, 60.0F);
+
+    std::vector<GsCircle> clustered;
+    for (int i = 0; i < kNumberCandidates; i++) {
+        clustered.push_back(GsCircle(950.0F + offset_distribution(generator), 590.0F + offset_distribution(generator),
+                                     radius_distribution(generator)));
+    }
+
+    BenchmarkCandidates("clustered", img, clustered);
+
+    // Candidates all over the frame, as in strobed and putting images
+    std::uniform_real_distribution<float> x_distribution(0.0F, (float)img.cols);
+    std::uniform_real_distribution<float> y_distribution(0.0F, (float)img.rows);
+
+    std::vector<GsCircle> spread_out;
+    for (int i = 0; i < kNumberCandidates; i++) {
+        spread_out.push_back(GsCircle(x_distribution(generator), y_distribution(generator), radius_distribution(generator)));
+    }
+
+    BenchmarkCandidates("spread-out", img, spread_out);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
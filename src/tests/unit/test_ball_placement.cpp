@@ -0,0 +1,177 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_ball_placement.cpp
+ * @brief Unit tests for the streaming ball-placement watcher's image processing
+ *
+ * The camera side of BallPlacementWatcher needs real hardware, so these tests
+ * cover the search-area geometry, the in-search-area ball finder and the
+ * BallStabilityTracker that decides when the ball is still, on synthetic
+ * preview-sized images.
+ */
+
+#define BOOST_TEST_MODULE BallPlacementTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "ball_placement_watcher.h"
+#include "ball_stability_tracker.h"
+
+#include <opencv2/imgproc.hpp>
+
+using namespace golf_sim;
+using namespace golf_sim::testing;
+
+namespace {
+
+// A gray, slightly noisy mat with a bright ball on it
+cv::Mat MakeTeedBallImage(const cv::Size& size, const cv::Point2f& center, float radius, uint64_t noise_seed = 42) {
+    cv::Mat img(size, CV_8UC1, cv::Scalar(60));
+    cv::RNG rng(noise_seed);
+    cv::Mat noise(size, CV_8UC1);
+    rng.fill(noise, cv::RNG::NORMAL, 0, 4);
+    img += noise;
+
+    cv::circle(img, cv::Point((int)std::round(center.x * 16), (int)std::round(center.y * 16)),
+               (int)std::round(radius * 16), cv::Scalar(220), cv::FILLED, cv::LINE_AA, 4);
+    return img;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(BallPlacementTests)
+
+BOOST_AUTO_TEST_CASE(SearchArea_IsCenteredAndClipped) {
+    const cv::Size preview(728, 544);
+
+    cv::Rect area = BallPlacementWatcher::GetSearchArea(preview, cv::Vec2i(364, 272), 10.0);
+    BOOST_CHECK_EQUAL(area.x + area.width / 2, 364);
+    BOOST_CHECK_EQUAL(area.y + area.height / 2, 272);
+    BOOST_CHECK_GE(area.width, (int)(2 * 10.0 * BallPlacementWatcher::kPlacementSearchAreaRadiusRatio));
+
+    // Near a corner, the area must stay inside the image
+    cv::Rect corner = BallPlacementWatcher::GetSearchArea(preview, cv::Vec2i(5, 540), 10.0);
+    BOOST_CHECK((corner & cv::Rect(0, 0, preview.width, preview.height)) == corner);
+    BOOST_CHECK(!corner.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(FindBallInSearchArea_FindsTeedBall, OpenCVTestFixture) {
+    const cv::Point2f center(41.5F, 38.25F);
+    const float radius = 14.0F;
+
+    cv::Mat search_area = MakeTeedBallImage(cv::Size(84, 80), center, radius);
+
+    GsCircle circle;
+    BOOST_REQUIRE(BallPlacementWatcher::FindBallInSearchArea(search_area, 9.0, 20.0, circle));
+    BOOST_CHECK_LT(std::abs(circle[0] - center.x), 1.5);
+    BOOST_CHECK_LT(std::abs(circle[1] - center.y), 1.5);
+    BOOST_CHECK_LT(std::abs(circle[2] - radius), 1.5);
+}
+
+BOOST_FIXTURE_TEST_CASE(FindBallInSearchArea_EmptyTeeFindsNothing, OpenCVTestFixture) {
+    cv::Mat empty_tee(80, 84, CV_8UC1, cv::Scalar(60));
+    cv::RNG rng(7);
+    cv::Mat noise(empty_tee.size(), CV_8UC1);
+    rng.fill(noise, cv::RNG::NORMAL, 0, 4);
+    empty_tee += noise;
+
+    GsCircle circle;
+    BOOST_CHECK(!BallPlacementWatcher::FindBallInSearchArea(empty_tee, 9.0, 20.0, circle));
+
+    // A ball that is much too small for the expected radius is not the teed ball either
+    cv::Mat pebble = MakeTeedBallImage(cv::Size(84, 80), cv::Point2f(40, 40), 3.0F);
+    BOOST_CHECK(!BallPlacementWatcher::FindBallInSearchArea(pebble, 9.0, 20.0, circle));
+}
+
+BOOST_FIXTURE_TEST_CASE(StabilityTracker_StillBallBecomesStableAfterWindow, OpenCVTestFixture) {
+    const cv::Size size(84, 80);
+    const cv::Point2f center(41.5F, 38.25F);
+
+    BallStabilityTracker::Settings settings;
+    settings.window_frames = 6;
+    BallStabilityTracker tracker(settings);
+
+    BOOST_CHECK(tracker.AddFrame(MakeTeedBallImage(size, center, 14.0F)) == BallStabilityTracker::Status::kLost);
+
+    // Found slightly off, the way a Hough circle would be
+    tracker.Reset(GsCircle(42.0F, 38.0F, 14.0F), size);
+
+    // Sensor noise changes from frame to frame, the ball doesn't
+    for (int frame = 1; frame < settings.window_frames; frame++) {
+        BOOST_CHECK(tracker.AddFrame(MakeTeedBallImage(size, center, 14.0F, frame)) == BallStabilityTracker::Status::kSettling);
+    }
+
+    BOOST_CHECK(tracker.AddFrame(MakeTeedBallImage(size, center, 14.0F, 100)) == BallStabilityTracker::Status::kStable);
+    BOOST_CHECK_LT(tracker.last_difference_energy(), settings.max_difference_energy);
+
+    // The centroid is sub-pixel accurate
+    BOOST_CHECK_LT(cv::norm(tracker.last_centroid() - cv::Point2d(center.x, center.y)), 0.25);
+}
+
+BOOST_FIXTURE_TEST_CASE(StabilityTracker_CreepingBallIsNotStable, OpenCVTestFixture) {
+    const cv::Size size(84, 80);
+    cv::Point2f center(38.0F, 38.0F);
+
+    BallStabilityTracker tracker;
+    tracker.Reset(GsCircle(center.x, center.y, 14.0F), size);
+
+    // Settling on the tee, less than a pixel per frame
+    const float creep_per_frame = 0.2F;
+    for (int frame = 0; frame < tracker.settings().window_frames + 4; frame++) {
+        BOOST_CHECK(tracker.AddFrame(MakeTeedBallImage(size, center, 14.0F, frame)) == BallStabilityTracker::Status::kSettling);
+        center.x += creep_per_frame;
+    }
+
+    // The tracked circle follows the ball
+    BOOST_CHECK_LT(std::abs(tracker.GetTrackedCircle()[0] - (center.x - creep_per_frame)), 0.5);
+}
+
+BOOST_FIXTURE_TEST_CASE(StabilityTracker_MotionRestartsWindow, OpenCVTestFixture) {
+    const cv::Size size(84, 80);
+    const cv::Point2f center(41.5F, 38.25F);
+
+    BallStabilityTracker tracker;
+    const int window = tracker.settings().window_frames;
+    tracker.Reset(GsCircle(center.x, center.y, 14.0F), size);
+
+    for (int frame = 1; frame < window; frame++) {
+        tracker.AddFrame(MakeTeedBallImage(size, center, 14.0F, frame));
+    }
+
+    // A hand reaches in next to the ball
+    cv::Mat hand = MakeTeedBallImage(size, center, 14.0F, 50);
+    cv::rectangle(hand, cv::Rect(56, 20, 10, 40), cv::Scalar(180), cv::FILLED);
+    BOOST_CHECK(tracker.AddFrame(hand) == BallStabilityTracker::Status::kSettling);
+    BOOST_CHECK_GT(tracker.last_difference_energy(), tracker.settings().max_difference_energy);
+
+    // ...and leaves, which is motion too
+    BOOST_CHECK(tracker.AddFrame(MakeTeedBallImage(size, center, 14.0F, 51)) == BallStabilityTracker::Status::kSettling);
+
+    for (int frame = 1; frame < window - 1; frame++) {
+        BOOST_CHECK(tracker.AddFrame(MakeTeedBallImage(size, center, 14.0F, 60 + frame)) == BallStabilityTracker::Status::kSettling);
+    }
+
+    BOOST_CHECK(tracker.AddFrame(MakeTeedBallImage(size, center, 14.0F, 99)) == BallStabilityTracker::Status::kStable);
+}
+
+BOOST_FIXTURE_TEST_CASE(StabilityTracker_RemovedBallIsLost, OpenCVTestFixture) {
+    const cv::Size size(84, 80);
+    const cv::Point2f center(41.5F, 38.25F);
+
+    BallStabilityTracker tracker;
+    tracker.Reset(GsCircle(center.x, center.y, 14.0F), size);
+    BOOST_CHECK(tracker.AddFrame(MakeTeedBallImage(size, center, 14.0F)) == BallStabilityTracker::Status::kSettling);
+
+    cv::Mat empty_tee = MakeTeedBallImage(size, center, 0.0F, 3);
+    BOOST_CHECK(tracker.AddFrame(empty_tee) == BallStabilityTracker::Status::kLost);
+    BOOST_CHECK(!tracker.IsTracking());
+
+    // Rolled off to the side
+    tracker.Reset(GsCircle(center.x, center.y, 14.0F), size);
+    tracker.AddFrame(MakeTeedBallImage(size, center, 14.0F));
+    BOOST_CHECK(tracker.AddFrame(MakeTeedBallImage(size, center + cv::Point2f(20.0F, 0.0F), 14.0F, 4)) == BallStabilityTracker::Status::kLost);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
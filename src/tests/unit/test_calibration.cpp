@@ -8,7 +8,7 @@
  * @brief Unit tests for calibration system
  *
  * Tests calibration calculations, focal length averaging, camera position
- * calculations, and calibration rig type selection.
+ * calculations, calibration rig type selection, and the undistortion map cache.
  */
 
 #define BOOST_TEST_MODULE CalibrationTests
@@ -16,8 +16,11 @@
 #include "../test_utilities.hpp"
 #include "gs_camera.h"
 #include "gs_calibration.h"
+#include "undistort_map_cache.h"
 #include "utils/cv_utils.h"
 
+#include <opencv2/calib3d/calib3d.hpp>
+
 using namespace golf_sim;
 using namespace golf_sim::testing;
 
@@ -318,4 +321,82 @@ BOOST_AUTO_TEST_CASE(UnitConversion_MetersToFeet_TypicalDistance) {
     BOOST_CHECK_CLOSE(distance_ft, 6.562, 1.0);
 }
 
+// ===========================================================================
+// Undistortion Map Cache Tests
+// ===========================================================================
+
+struct UndistortFixture : public OpenCVTestFixture {
+    CameraHardware camera;
+    cv::Mat image;
+
+    UndistortFixture() {
+        camera.camera_number_ = GsCameraNumber::kGsCamera2;
+        camera.camera_model_ = CameraHardware::CameraModel::PiGS;
+        camera.lens_type_ = CameraHardware::LensType::Lens_6mm;
+        camera.use_undistortion_matrix_ = true;
+        camera.calibrationMatrix_ = (cv::Mat_<double>(3, 3) <<
+            600.0, 0.0, 364.0,
+            0.0, 600.0, 272.0,
+            0.0, 0.0, 1.0);
+        camera.cameraDistortionVector_ = (cv::Mat_<double>(1, 5) << -0.3, 0.1, 0.0, 0.0, 0.0);
+
+        image = CreateSyntheticBallImage(728, 544, cv::Point(500, 150), 40);
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(UndistortMapCache_MatchesUncachedUndistort, UndistortFixture) {
+    UndistortMapCache cache;
+    cv::Mat cached = cache.Undistort(image, camera);
+
+    // What undistort_camera_image used to do for every image
+    cv::Mat map1, map2, uncached;
+    cv::initUndistortRectifyMap(camera.calibrationMatrix_, camera.cameraDistortionVector_, cv::Mat(), camera.calibrationMatrix_,
+                                image.size(), CV_32FC1, map1, map2);
+    cv::remap(image, uncached, map1, map2, cv::INTER_LINEAR);
+
+    BOOST_REQUIRE_EQUAL(cached.size(), uncached.size());
+    // The fixed-point maps interpolate in 1/32-pixel steps, so allow a small difference
+    cv::Mat difference;
+    cv::absdiff(cached, uncached, difference);
+    BOOST_CHECK_LE(cv::norm(difference, cv::NORM_INF), 4.0);
+    BOOST_CHECK_LT(cv::mean(difference)[0], 0.5);
+}
+
+BOOST_FIXTURE_TEST_CASE(UndistortMapCache_ReusesMapsUntilCalibrationChanges, UndistortFixture) {
+    UndistortMapCache cache;
+    UndistortMapKey key = UndistortMapKey::FromCamera(camera, image.size());
+
+    auto first = cache.GetMaps(key, camera.calibrationMatrix_, camera.cameraDistortionVector_);
+    auto second = cache.GetMaps(key, camera.calibrationMatrix_, camera.cameraDistortionVector_);
+    BOOST_CHECK(first == second);
+    BOOST_CHECK_EQUAL(first->map1.type(), CV_16SC2);
+
+    // Same values, but as float - still the same calibration
+    cv::Mat float_calibration;
+    camera.calibrationMatrix_.convertTo(float_calibration, CV_32F);
+    BOOST_CHECK(cache.GetMaps(key, float_calibration, camera.cameraDistortionVector_) == first);
+
+    // A different resolution gets its own maps
+    UndistortMapKey half_key = UndistortMapKey::FromCamera(camera, cv::Size(364, 272));
+    BOOST_CHECK(cache.GetMaps(half_key, camera.calibrationMatrix_, camera.cameraDistortionVector_) != first);
+    BOOST_CHECK_EQUAL(cache.size(), 2u);
+
+    // Reloading a different calibration drops this camera's maps
+    cv::Mat new_distortion = (cv::Mat_<double>(1, 5) << -0.25, 0.1, 0.0, 0.0, 0.0);
+    cache.OnCalibrationLoaded(camera.camera_number_, camera.calibrationMatrix_, new_distortion);
+    BOOST_CHECK_EQUAL(cache.size(), 0u);
+    BOOST_CHECK(cache.GetMaps(key, camera.calibrationMatrix_, new_distortion) != first);
+}
+
+BOOST_FIXTURE_TEST_CASE(UndistortMapCache_RoiMatchesFullImageCrop, UndistortFixture) {
+    UndistortMapCache cache;
+    cv::Rect ball_roi(440, 90, 120, 120);
+
+    cv::Mat full = cache.Undistort(image, camera);
+    cv::Mat roi_only = cache.Undistort(image, camera, ball_roi);
+
+    BOOST_REQUIRE_EQUAL(roi_only.size(), ball_roi.size());
+    BOOST_CHECK_EQUAL(cv::norm(roi_only, full(ball_roi), cv::NORM_INF), 0.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
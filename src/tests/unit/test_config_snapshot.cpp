@@ -0,0 +1,210 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_config_snapshot.cpp
+ * @brief Unit tests for the flat, pre-parsed configuration snapshot
+ *
+ * Checks that the snapshot reads each type the same way the property tree
+ * (and ConfigurationManager) did, that overrides win over the JSON values,
+ * that missing and malformed values fall back to the defaults without
+ * throwing, and that publishing swaps in the new snapshot.
+ */
+
+#define BOOST_TEST_MODULE ConfigSnapshotTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "config_snapshot.h"
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/timer/timer.hpp>
+#include <sstream>
+
+using namespace golf_sim;
+
+namespace {
+
+const char* kTestConfiguration = R"({
+    "gs_config": {
+        "strobing": {
+            "kBaudRateForFastPulses": "115200",
+            "kStrobePulseVectorDriver": [ "0.7", "1.8", "3.0", "0.0" ]
+        },
+        "cameras": {
+            "kCamera1Gain": "6.0",
+            "kCamera1PositionsFromOriginMeters": [ "0.0", "-0.1", "0.5" ],
+            "kCamera1CalibrationMatrix": [
+                [ "1833.5", "0.0", "697.2" ],
+                [ "0.0", "1832.1", "513.9" ],
+                [ "0.0", "0.0", "1.0" ]
+            ],
+            "kCamera1ExposureUs": "1.5",
+            "kCamera1Enabled": "1",
+            "kCamera1Model": "PiGSCam6mmWideLens"
+        },
+        "logging": {
+            "kLogIntermediateSpinImagesToFile": "yes",
+            "kLogLevel": "not a number"
+        }
+    }
+})";
+
+boost::property_tree::ptree ReadTestConfiguration() {
+    std::istringstream stream(kTestConfiguration);
+    boost::property_tree::ptree root;
+    boost::property_tree::read_json(stream, root);
+    return root;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(ConfigSnapshotTests)
+
+BOOST_AUTO_TEST_CASE(ScalarValues_AreParsedLikeThePropertyTree) {
+    const boost::property_tree::ptree root = ReadTestConfiguration();
+    const auto snapshot = ConfigSnapshot::Build(root, {});
+
+    BOOST_CHECK_EQUAL(snapshot->GetLong("gs_config.strobing.kBaudRateForFastPulses", 0),
+                      root.get<long>("gs_config.strobing.kBaudRateForFastPulses"));
+    BOOST_CHECK_EQUAL(snapshot->GetUInt("gs_config.strobing.kBaudRateForFastPulses", 0), 115200U);
+    BOOST_CHECK_EQUAL(snapshot->GetDouble("gs_config.cameras.kCamera1Gain", 0.0),
+                      root.get<double>("gs_config.cameras.kCamera1Gain"));
+    BOOST_CHECK_EQUAL(snapshot->GetString("gs_config.cameras.kCamera1Model", ""), "PiGSCam6mmWideLens");
+
+    // The property tree will not read "1.5" as a long, so neither does the snapshot
+    BOOST_CHECK_EQUAL(snapshot->GetLong("gs_config.cameras.kCamera1ExposureUs", -1), -1);
+    BOOST_CHECK_EQUAL(snapshot->GetLong("gs_config.cameras.kCamera1ExposureUs", -1),
+                      root.get<long>("gs_config.cameras.kCamera1ExposureUs", -1));
+}
+
+BOOST_AUTO_TEST_CASE(IntFloatAndBool_AreParsedLikeTheConfigurationManager) {
+    const auto snapshot = ConfigSnapshot::Build(ReadTestConfiguration(), {});
+
+    // std::stoi and std::stof read a leading number
+    BOOST_CHECK_EQUAL(snapshot->GetInt("gs_config.cameras.kCamera1ExposureUs", -1), 1);
+    BOOST_CHECK_CLOSE(snapshot->GetFloat("gs_config.cameras.kCamera1ExposureUs", 0.0F), 1.5F, 1e-4);
+
+    BOOST_CHECK(snapshot->GetBool("gs_config.cameras.kCamera1Enabled", false));
+    BOOST_CHECK(snapshot->GetBool("gs_config.logging.kLogIntermediateSpinImagesToFile", false));
+}
+
+BOOST_AUTO_TEST_CASE(MissingAndMalformedValues_ReturnTheDefault) {
+    const auto snapshot = ConfigSnapshot::Build(ReadTestConfiguration(), {});
+
+    BOOST_CHECK(snapshot->Find("gs_config.no_such_section.kNoSuchValue") == nullptr);
+    BOOST_CHECK_EQUAL(snapshot->GetInt("gs_config.no_such_section.kNoSuchValue", 42), 42);
+    BOOST_CHECK_EQUAL(snapshot->GetDouble("gs_config.no_such_section.kNoSuchValue", 2.5), 2.5);
+    BOOST_CHECK_EQUAL(snapshot->GetString("gs_config.no_such_section.kNoSuchValue", "unchanged"), "unchanged");
+
+    BOOST_CHECK_EQUAL(snapshot->GetInt("gs_config.logging.kLogLevel", 7), 7);
+    BOOST_CHECK_EQUAL(snapshot->GetFloat("gs_config.logging.kLogLevel", 7.0F), 7.0F);
+    BOOST_CHECK_EQUAL(snapshot->GetBool("gs_config.logging.kLogLevel", true), true);
+    BOOST_CHECK(snapshot->GetJsonArray("gs_config.no_such_section.kNoSuchArray") == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Overrides_WinOverTheJsonValues) {
+    const auto snapshot = ConfigSnapshot::Build(ReadTestConfiguration(), {
+        { "gs_config.cameras.kCamera1Gain", "2.0" },
+        { "gs_config.cameras.kCamera1Gain", "4.0" },
+        { "gs_config.strobing.kBaudRateForFastPulses", "57600" },
+        { "gs_config.cameras.kCamera2Gain", "3.0" },
+    });
+
+    // The first override for a path is the highest-priority one
+    BOOST_CHECK_EQUAL(snapshot->GetDouble("gs_config.cameras.kCamera1Gain", 0.0), 2.0);
+    BOOST_CHECK_EQUAL(snapshot->GetLong("gs_config.strobing.kBaudRateForFastPulses", 0), 57600);
+
+    // An override need not have a JSON value, but it is not a JSON node
+    BOOST_CHECK_EQUAL(snapshot->GetFloat("gs_config.cameras.kCamera2Gain", 0.0F), 3.0F);
+    BOOST_CHECK(!snapshot->JsonNodeExists("gs_config.cameras.kCamera2Gain"));
+    BOOST_CHECK(snapshot->JsonNodeExists("gs_config.cameras.kCamera1Gain"));
+}
+
+BOOST_AUTO_TEST_CASE(Arrays_KeepTheirParsedElements) {
+    const auto snapshot = ConfigSnapshot::Build(ReadTestConfiguration(), {});
+
+    const auto* pulses = snapshot->GetJsonArray("gs_config.strobing.kStrobePulseVectorDriver");
+    BOOST_REQUIRE(pulses != nullptr);
+    BOOST_REQUIRE_EQUAL(pulses->size(), 4U);
+    BOOST_CHECK_CLOSE(*(*pulses)[1].whole_float, 1.8F, 1e-4);
+    BOOST_CHECK_EQUAL(*(*pulses)[3].whole_float, 0.0F);
+
+    const auto* matrix = snapshot->GetJsonArray("gs_config.cameras.kCamera1CalibrationMatrix");
+    BOOST_REQUIRE(matrix != nullptr);
+    BOOST_REQUIRE_EQUAL(matrix->size(), 3U);
+    BOOST_REQUIRE_EQUAL((*matrix)[1].elements.size(), 3U);
+    BOOST_CHECK_EQUAL(*(*matrix)[1].elements[1].whole_double, 1832.1);
+    BOOST_CHECK_EQUAL(*(*matrix)[2].elements[2].whole_double, 1.0);
+
+    // Sections exist as nodes, but have no elements
+    BOOST_CHECK(snapshot->JsonNodeExists("gs_config.cameras"));
+    BOOST_REQUIRE(snapshot->GetJsonArray("gs_config.cameras") != nullptr);
+    BOOST_CHECK(snapshot->GetJsonArray("gs_config.cameras")->empty());
+}
+
+BOOST_AUTO_TEST_CASE(Publish_SwapsTheCurrentSnapshot) {
+    const ConfigSnapshot& before = ConfigSnapshot::Current();
+
+    const uint64_t first = ConfigSnapshot::Publish(ConfigSnapshot::Build(ReadTestConfiguration(), {}));
+    BOOST_CHECK_GT(first, before.generation());
+    BOOST_CHECK_EQUAL(ConfigSnapshot::Current().generation(), first);
+    BOOST_CHECK_EQUAL(ConfigSnapshot::Current().GetDouble("gs_config.cameras.kCamera1Gain", 0.0), 6.0);
+
+    const ConfigSnapshot& held = ConfigSnapshot::Current();
+
+    const uint64_t second = ConfigSnapshot::Publish(ConfigSnapshot::Build(ReadTestConfiguration(),
+                                                    { { "gs_config.cameras.kCamera1Gain", "8.0" } }));
+    BOOST_CHECK_EQUAL(second, first + 1);
+    BOOST_CHECK_EQUAL(ConfigSnapshot::Current().GetDouble("gs_config.cameras.kCamera1Gain", 0.0), 8.0);
+
+    // A reader that is still holding the earlier snapshot sees it unchanged
+    BOOST_CHECK_EQUAL(held.generation(), first);
+    BOOST_CHECK_EQUAL(held.GetDouble("gs_config.cameras.kCamera1Gain", 0.0), 6.0);
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark_PropertyTreeVersusSnapshot) {
+    const int kIterations = 20000;
+    const std::vector<std::string> keys = {
+        "gs_config.strobing.kBaudRateForFastPulses",
+        "gs_config.cameras.kCamera1Gain",
+        "gs_config.cameras.kCamera1ExposureUs",
+        "gs_config.no_such_section.kNoSuchValue",
+    };
+
+    const boost::property_tree::ptree root = ReadTestConfiguration();
+    const auto snapshot = ConfigSnapshot::Build(root, {});
+
+    // The way SetConstant used to read a value: walk the tree path, parse, and catch any failure
+    double tree_total = 0.0;
+    boost::timer::cpu_timer tree_timer;
+    for (int i = 0; i < kIterations; i++) {
+        for (const std::string& key : keys) {
+            try {
+                tree_total += root.get<double>(key, 0.0);
+            }
+            catch (const boost::property_tree::ptree_error&) {
+            }
+        }
+    }
+    tree_timer.stop();
+
+    double snapshot_total = 0.0;
+    boost::timer::cpu_timer snapshot_timer;
+    for (int i = 0; i < kIterations; i++) {
+        for (const std::string& key : keys) {
+            snapshot_total += snapshot->GetDouble(key, 0.0);
+        }
+    }
+    snapshot_timer.stop();
+
+    const double lookups = (double)kIterations * keys.size();
+    const double tree_ns = tree_timer.elapsed().wall / lookups;
+    const double snapshot_ns = snapshot_timer.elapsed().wall / lookups;
+
+    BOOST_TEST_MESSAGE("Configuration lookup: property tree " << tree_ns << " ns, snapshot " << snapshot_ns << " ns");
+
+    BOOST_CHECK_EQUAL(tree_total, snapshot_total);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_dnn_preprocessor.cpp
+ * @brief Unit tests for the shared YOLO input preprocessing
+ *
+ * Checks that the packed tensor is bit-for-bit what cv::dnn::blobFromImage
+ * produces (for any width, so the SIMD tails are exercised, and for non-continuous
+ * images), that letterboxing pads and places the image correctly even when the
+ * buffer is reused, and benchmarks the packing against blobFromImage.
+ */
+
+#define BOOST_TEST_MODULE DnnPreprocessorTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "dnn_preprocessor.h"
+#include <boost/timer/timer.hpp>
+#include <opencv2/dnn.hpp>
+#include <cstring>
+
+using namespace golf_sim;
+
+namespace {
+
+cv::Mat MakeImage(int rows, int cols, int seed) {
+    cv::Mat image(rows, cols, CV_8UC3);
+    cv::RNG rng(seed);
+    rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+    return image;
+}
+
+// Every float must have the same bits, not just be close
+bool SameBits(const cv::Mat& blob, const std::vector<float>& tensor) {
+    return blob.isContinuous() && blob.total() == tensor.size() &&
+           std::memcmp(blob.ptr<float>(), tensor.data(), tensor.size() * sizeof(float)) == 0;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(DnnPreprocessorTests)
+
+BOOST_AUTO_TEST_CASE(PackedTensor_MatchesBlobFromImageExactly) {
+    BOOST_TEST_MESSAGE("DnnPreprocessor backend: " << DnnPreprocessor::BackendName());
+
+    for (int cols : { 1, 15, 16, 17, 47, 320, 333 }) {
+        for (bool swap_rb : { false, true }) {
+            for (double scale : { 1.0 / 255.0, 1.0, 0.0039 }) {
+                BOOST_TEST_CONTEXT("cols " << cols << ", swap_rb " << swap_rb << ", scale " << scale) {
+                    cv::Mat image = MakeImage(9, cols, cols);
+
+                    cv::Mat blob = cv::dnn::blobFromImage(image, scale, image.size(), cv::Scalar(), swap_rb, false);
+
+                    std::vector<float> tensor(3 * image.total(), -1.0F);
+                    DnnPreprocessor::PackToPlanarTensor(image, tensor.data(), scale, swap_rb);
+                    BOOST_CHECK(SameBits(blob, tensor));
+
+                    std::vector<float> reference(3 * image.total(), -1.0F);
+                    DnnPreprocessor::PackToPlanarTensorReference(image, reference.data(), scale, swap_rb);
+                    BOOST_CHECK(SameBits(blob, reference));
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(NonContinuousImage_IsPackedRowByRow) {
+    cv::Mat image = MakeImage(120, 200, 3);
+    cv::Mat crop = image(cv::Rect(13, 7, 101, 50));
+    BOOST_REQUIRE(!crop.isContinuous());
+
+    cv::Mat blob = cv::dnn::blobFromImage(crop, 1.0 / 255.0, crop.size(), cv::Scalar(), false, false);
+
+    std::vector<float> tensor(3 * crop.total());
+    DnnPreprocessor::PackToPlanarTensor(crop, tensor.data());
+    BOOST_CHECK(SameBits(blob, tensor));
+}
+
+BOOST_AUTO_TEST_CASE(Letterbox_PlacesAndPadsTheImage) {
+    const cv::Size input_size(320, 320);
+    cv::Mat letterbox_image;
+
+    // Wide image, so there is padding above and below
+    cv::Mat wide = MakeImage(100, 400, 5);
+    DnnPreprocessor::LetterboxParams letterbox = DnnPreprocessor::Letterbox(wide, input_size, letterbox_image);
+
+    BOOST_CHECK_CLOSE(letterbox.scale, 0.8F, 1e-4);
+    BOOST_CHECK_EQUAL(letterbox.x_offset, 0);
+    BOOST_CHECK_EQUAL(letterbox.y_offset, 120);
+    BOOST_CHECK_EQUAL(letterbox_image.size(), input_size);
+
+    cv::Mat resized;
+    cv::resize(wide, resized, cv::Size(320, 80), 0, 0, cv::INTER_LINEAR);
+    BOOST_CHECK_EQUAL(cv::norm(letterbox_image(cv::Rect(0, 120, 320, 80)), resized, cv::NORM_INF), 0.0);
+    BOOST_CHECK(letterbox_image.at<cv::Vec3b>(0, 0) == cv::Vec3b::all(DnnPreprocessor::kLetterboxPaddingValue));
+    BOOST_CHECK(letterbox_image.at<cv::Vec3b>(319, 319) == cv::Vec3b::all(DnnPreprocessor::kLetterboxPaddingValue));
+
+    // Reusing the buffer for a tall image must not leave any of the wide one behind
+    cv::Mat tall = MakeImage(400, 100, 6);
+    letterbox = DnnPreprocessor::Letterbox(tall, input_size, letterbox_image);
+
+    BOOST_CHECK_EQUAL(letterbox.x_offset, 120);
+    BOOST_CHECK_EQUAL(letterbox.y_offset, 0);
+    BOOST_CHECK(letterbox_image.at<cv::Vec3b>(160, 0) == cv::Vec3b::all(DnnPreprocessor::kLetterboxPaddingValue));
+    BOOST_CHECK(letterbox_image.at<cv::Vec3b>(160, 319) == cv::Vec3b::all(DnnPreprocessor::kLetterboxPaddingValue));
+
+    // An input-sized image is copied as is
+    cv::Mat exact = MakeImage(320, 320, 7);
+    letterbox = DnnPreprocessor::Letterbox(exact, input_size, letterbox_image);
+    BOOST_CHECK_EQUAL(letterbox.x_offset, 0);
+    BOOST_CHECK_EQUAL(letterbox.y_offset, 0);
+    BOOST_CHECK_EQUAL(cv::norm(letterbox_image, exact, cv::NORM_INF), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark_PackVersusBlobFromImage) {
+    const int kIterations = 50;
+
+    for (int input_size : { 640, 1472 }) {
+        cv::Mat image = MakeImage(input_size, input_size, input_size);
+        std::vector<float> tensor(3 * image.total());
+        cv::Mat blob;
+
+        boost::timer::cpu_timer blob_timer;
+        for (int i = 0; i < kIterations; i++) {
+            cv::dnn::blobFromImage(image, blob, 1.0 / 255.0, image.size(), cv::Scalar(), false, false);
+        }
+        blob_timer.stop();
+
+        boost::timer::cpu_timer pack_timer;
+        for (int i = 0; i < kIterations; i++) {
+            DnnPreprocessor::PackToPlanarTensor(image, tensor.data());
+        }
+        pack_timer.stop();
+
+        boost::timer::cpu_timer reference_timer;
+        for (int i = 0; i < kIterations; i++) {
+            DnnPreprocessor::PackToPlanarTensorReference(image, tensor.data());
+        }
+        reference_timer.stop();
+
+        const double blob_ms = blob_timer.elapsed().wall / 1.0e6 / kIterations;
+        const double pack_ms = pack_timer.elapsed().wall / 1.0e6 / kIterations;
+        const double reference_ms = reference_timer.elapsed().wall / 1.0e6 / kIterations;
+
+        BOOST_TEST_MESSAGE("Preprocess " << input_size << "x" << input_size << ": blobFromImage " << blob_ms << " ms, "
+                           << DnnPreprocessor::BackendName() << " pack " << pack_ms << " ms, reference pack " << reference_ms
+                           << " ms");
+
+        BOOST_CHECK(SameBits(blob, tensor));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
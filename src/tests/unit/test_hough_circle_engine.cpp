@@ -0,0 +1,399 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_hough_circle_engine.cpp
+ * @brief Unit tests and benchmark for the single-pass Hough circle search
+ *
+ * Tests that HoughCircleEngine finds synthetic balls, that stricter thresholds
+ * only ever remove circles, that radius bands select the right balls, and that
+ * GetBall's engine covers narrowed radius bands below the initial minimum.
+ *
+ * The benchmark runs GetBall with and without the engine on the raw camera
+ * captures in test_data/images/hough_recall, and reports the latency and how
+ * many of the recorded balls each found.  The captures are teed, strobed and
+ * putting images, listed in ground_truth.csv with one line per ball:
+ *
+ *   log_cam2_last_strobed_img_001.png, strobed, 412.5, 301.0, 33.5
+ *
+ * The engine must find every ball that cv::HoughCircles does in each image.
+ */
+
+#define BOOST_TEST_MODULE HoughCircleEngineTests
+#include <boost/test/unit_test.hpp>
+#include <boost/timer/timer.hpp>
+#include "../test_utilities.hpp"
+#include "hough_circle_engine.h"
+#include "ball_image_proc.h"
+#include "utils/cv_utils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace golf_sim;
+using namespace golf_sim::testing;
+
+namespace {
+
+struct TestBall {
+    cv::Point center;
+    int radius;
+};
+
+cv::Mat MakeBallsImage(const cv::Size& size, const std::vector<TestBall>& balls, uint64_t noise_seed = 17) {
+    cv::Mat image(size, CV_8UC1, cv::Scalar(40));
+
+    for (const TestBall& ball : balls) {
+        cv::circle(image, ball.center, ball.radius, cv::Scalar(200), cv::FILLED, cv::LINE_AA);
+    }
+
+    // Signed, so that the noise goes both ways
+    cv::Mat noisy;
+    image.convertTo(noisy, CV_16S);
+    cv::Mat noise(size, CV_16S);
+    cv::RNG rng(noise_seed);
+    rng.fill(noise, cv::RNG::NORMAL, 0, 2);
+    noisy += noise;
+    noisy.convertTo(image, CV_8U);
+
+    cv::GaussianBlur(image, image, cv::Size(5, 5), 0);
+    return image;
+}
+
+HoughCircleEngine::Settings MakeSettings(int min_radius, int max_radius) {
+    HoughCircleEngine::Settings settings;
+    settings.dp = 1.5;
+    settings.canny_threshold = 130.0;
+    settings.use_scharr = true;
+    settings.min_radius = min_radius;
+    settings.max_radius = max_radius;
+    return settings;
+}
+
+bool FoundBall(const std::vector<GsCircle>& circles, const TestBall& ball, double tolerance_pixels) {
+    for (const GsCircle& c : circles) {
+        if (cv::norm(cv::Point2d(c[0], c[1]) - cv::Point2d(ball.center)) <= tolerance_pixels &&
+            std::abs(c[2] - ball.radius) <= tolerance_pixels) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Contains(const std::vector<GsCircle>& circles, const GsCircle& circle) {
+    return std::find(circles.begin(), circles.end(), circle) != circles.end();
+}
+
+// One ground-truth ball in a raw camera capture
+struct RecordedBall {
+    std::string image_file;
+    BallImageProc::BallSearchMode search_mode;
+    TestBall ball;
+};
+
+// Reads the hough_recall ground truth.  Each line is "image_file, kind, x, y, radius", where kind is
+// teed, strobed or putting, and a strobed image has one line per ball exposure.  '#' starts a comment.
+std::vector<RecordedBall> ReadGroundTruth(const std::filesystem::path& ground_truth_file) {
+    std::vector<RecordedBall> recorded_balls;
+    std::ifstream ground_truth(ground_truth_file);
+    std::string line;
+
+    while (std::getline(ground_truth, line)) {
+        line = line.substr(0, line.find('#'));
+        std::replace(line.begin(), line.end(), ',', ' ');
+
+        std::istringstream fields(line);
+        std::string image_file;
+        std::string kind;
+        double x = 0.0;
+        double y = 0.0;
+        double radius = 0.0;
+
+        if (!(fields >> image_file >> kind >> x >> y >> radius) || radius <= 0.0) {
+            continue;
+        }
+
+        BallImageProc::BallSearchMode search_mode;
+        if (kind == "teed") {
+            search_mode = BallImageProc::BallSearchMode::kFindPlacedBall;
+        }
+        else if (kind == "strobed") {
+            search_mode = BallImageProc::BallSearchMode::kStrobed;
+        }
+        else if (kind == "putting") {
+            search_mode = BallImageProc::BallSearchMode::kPutting;
+        }
+        else {
+            BOOST_TEST_MESSAGE("Unknown kind '" << kind << "' in " << ground_truth_file.string());
+            continue;
+        }
+
+        recorded_balls.push_back({ image_file, search_mode,
+                                   { cv::Point((int)std::round(x), (int)std::round(y)), (int)std::round(radius) } });
+    }
+
+    return recorded_balls;
+}
+
+// Runs GetBall on the image with or without the single-pass engine, the way lm_main does
+std::vector<GsCircle> FindBallsWithGetBall(const cv::Mat& image, BallImageProc::BallSearchMode search_mode,
+                                           int min_radius, int max_radius, bool use_hough_engine, double& elapsed_ms) {
+    BallImageProc* ip = BallImageProc::get_ball_image_processor();
+    ip->min_ball_radius_ = min_radius;
+    ip->max_ball_radius_ = max_radius;
+
+    GolfBall ball;
+    ball.ball_color_ = GolfBall::BallColor::kWhite;
+
+    const bool saved_use_hough_engine = BallImageProc::kUseSinglePassHoughEngine;
+    BallImageProc::kUseSinglePassHoughEngine = use_hough_engine;
+
+    cv::Rect no_roi;
+    std::vector<GolfBall> return_balls;
+
+    boost::timer::cpu_timer timer;
+    ip->GetBall(image, ball, return_balls, no_roi, search_mode, false, false);
+    timer.stop();
+    elapsed_ms = timer.elapsed().wall / 1.0e6;
+
+    BallImageProc::kUseSinglePassHoughEngine = saved_use_hough_engine;
+
+    std::vector<GsCircle> circles;
+    for (const GolfBall& found : return_balls) {
+        circles.push_back(found.ball_circle_);
+    }
+    return circles;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(HoughCircleEngineTests)
+
+BOOST_AUTO_TEST_CASE(SyntheticBalls_AreFound) {
+    const std::vector<TestBall> balls = { { { 100, 120 }, 25 }, { { 300, 110 }, 30 },
+                                          { { 480, 300 }, 35 }, { { 180, 360 }, 28 } };
+    cv::Mat image = MakeBallsImage(cv::Size(640, 480), balls);
+
+    HoughCircleEngine engine;
+    BOOST_REQUIRE(engine.Compute(image, MakeSettings(15, 50)));
+
+    HoughCircleEngine::Query query;
+    query.threshold = 0.8;
+    query.min_distance = 10.0;
+    std::vector<GsCircle> circles = engine.GetCircles(query);
+
+    BOOST_CHECK_GE(circles.size(), balls.size());
+
+    for (const TestBall& ball : balls) {
+        BOOST_TEST_CONTEXT("ball at " << ball.center) {
+            BOOST_CHECK(FoundBall(circles, ball, 2.0));
+        }
+    }
+
+    // The same balls by center votes
+    query.score = HoughCircleEngine::Score::kCenterVotes;
+    query.threshold = 50;
+    circles = engine.GetCircles(query);
+
+    for (const TestBall& ball : balls) {
+        BOOST_TEST_CONTEXT("ball at " << ball.center) {
+            BOOST_CHECK(FoundBall(circles, ball, 2.0));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(StricterThresholds_OnlyRemoveCircles) {
+    const std::vector<TestBall> balls = { { { 120, 120 }, 30 }, { { 150, 130 }, 30 }, { { 420, 260 }, 22 } };
+    cv::Mat image = MakeBallsImage(cv::Size(640, 480), balls);
+
+    HoughCircleEngine engine;
+    BOOST_REQUIRE(engine.Compute(image, MakeSettings(15, 50)));
+
+    for (auto score : { HoughCircleEngine::Score::kPerimeterSupport, HoughCircleEngine::Score::kCenterVotes }) {
+        const double loosest = (score == HoughCircleEngine::Score::kPerimeterSupport) ? 0.3 : 10.0;
+        const double increment = (score == HoughCircleEngine::Score::kPerimeterSupport) ? 0.05 : 10.0;
+
+        HoughCircleEngine::Query query;
+        query.score = score;
+        query.min_distance = 8.0;
+        query.threshold = loosest;
+        std::vector<GsCircle> looser = engine.GetCircles(query);
+
+        for (int step = 1; step <= 12; step++) {
+            query.threshold = loosest + step * increment;
+            std::vector<GsCircle> stricter = engine.GetCircles(query);
+
+            BOOST_CHECK_LE(stricter.size(), looser.size());
+            for (const GsCircle& c : stricter) {
+                BOOST_CHECK(Contains(looser, c));
+            }
+            looser = stricter;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(RadiusBands_SelectTheBallsOfThatSize) {
+    const TestBall small_ball = { { 160, 240 }, 20 };
+    const TestBall large_ball = { { 440, 240 }, 40 };
+    cv::Mat image = MakeBallsImage(cv::Size(640, 480), { small_ball, large_ball });
+
+    HoughCircleEngine engine;
+    BOOST_REQUIRE(engine.Compute(image, MakeSettings(12, 60)));
+
+    HoughCircleEngine::Query query;
+    query.threshold = 0.8;
+    query.min_distance = 10.0;
+
+    query.min_radius = 15;
+    query.max_radius = 25;
+    std::vector<GsCircle> small_circles = engine.GetCircles(query);
+    BOOST_CHECK(FoundBall(small_circles, small_ball, 2.0));
+    BOOST_CHECK(!FoundBall(small_circles, large_ball, 10.0));
+
+    query.min_radius = 35;
+    query.max_radius = 45;
+    std::vector<GsCircle> large_circles = engine.GetCircles(query);
+    BOOST_CHECK(FoundBall(large_circles, large_ball, 2.0));
+    BOOST_CHECK(!FoundBall(large_circles, small_ball, 10.0));
+}
+
+BOOST_AUTO_TEST_CASE(EmptyOrFeaturelessImage_FindsNothing) {
+    HoughCircleEngine engine;
+    BOOST_CHECK(!engine.Compute(cv::Mat(), MakeSettings(10, 20)));
+    BOOST_CHECK(engine.GetCircles(HoughCircleEngine::Query()).empty());
+
+    BOOST_CHECK(!engine.Compute(cv::Mat(100, 100, CV_8UC1, cv::Scalar(90)), MakeSettings(10, 20)));
+    BOOST_CHECK(engine.GetCircles(HoughCircleEngine::Query()).empty());
+}
+
+BOOST_AUTO_TEST_CASE(NarrowedBandBelowInitialMinimum_IsSearched) {
+    // A strobed search for radii 30 to 60 whose narrowing pass finds the radius-32 ball.  The
+    // narrowed band then reaches down to 0.7 * 32, and the radius-24 ball is inside it.
+    const TestBall found_ball = { { 160, 240 }, 32 };
+    const TestBall small_ball = { { 440, 240 }, 24 };
+    cv::Mat image = MakeBallsImage(cv::Size(640, 480), { found_ball, small_ball });
+
+    const bool saved_use_dynamic_radii = BallImageProc::kUseDynamicRadiiAdjustment;
+    const double saved_min_ratio = BallImageProc::kStrobedNarrowingRadiiMinRatio;
+    const double saved_max_ratio = BallImageProc::kStrobedNarrowingRadiiMaxRatio;
+    BallImageProc::kUseDynamicRadiiAdjustment = true;
+    BallImageProc::kStrobedNarrowingRadiiMinRatio = 0.7;
+    BallImageProc::kStrobedNarrowingRadiiMaxRatio = 1.6;
+
+    int engine_min_radius = 0;
+    int engine_max_radius = 0;
+    BallImageProc::GetHoughEngineRadiusRange(BallImageProc::BallSearchMode::kStrobed, 30, 60, engine_min_radius, engine_max_radius);
+
+    BallImageProc::kUseDynamicRadiiAdjustment = saved_use_dynamic_radii;
+    BallImageProc::kStrobedNarrowingRadiiMinRatio = saved_min_ratio;
+    BallImageProc::kStrobedNarrowingRadiiMaxRatio = saved_max_ratio;
+
+    // The narrowed band that GetBall would search, from the smallest and largest possible averages
+    const int narrowed_min_radius = CvUtils::RoundAndMakeEven(found_ball.radius * 0.7);
+    const int narrowed_max_radius = CvUtils::RoundAndMakeEven(found_ball.radius * 1.6);
+
+    BOOST_CHECK_LT(narrowed_min_radius, 30);
+    BOOST_CHECK_LE(engine_min_radius, CvUtils::RoundAndMakeEven(30 * 0.7));
+    BOOST_CHECK_GE(engine_max_radius, CvUtils::RoundAndMakeEven(60 * 1.6));
+
+    HoughCircleEngine engine;
+    BOOST_REQUIRE(engine.Compute(image, MakeSettings(engine_min_radius, engine_max_radius)));
+
+    HoughCircleEngine::Query query;
+    query.threshold = 0.8;
+    query.min_distance = 10.0;
+    query.min_radius = narrowed_min_radius;
+    query.max_radius = narrowed_max_radius;
+
+    std::vector<GsCircle> circles = engine.GetCircles(query);
+    BOOST_CHECK(FoundBall(circles, found_ball, 2.0));
+    BOOST_CHECK(FoundBall(circles, small_ball, 2.0));
+
+    // Without the widening, the engine never measures radius 24, so the narrowed search can't find it
+    HoughCircleEngine initial_range_engine;
+    BOOST_REQUIRE(initial_range_engine.Compute(image, MakeSettings(30, 60)));
+    BOOST_CHECK(!FoundBall(initial_range_engine.GetCircles(query), small_ball, 2.0));
+}
+
+BOOST_FIXTURE_TEST_CASE(Benchmark_RecallAndLatency_RecordedImages, OpenCVTestFixture) {
+    const std::filesystem::path corpus = TestPaths::GetTestImagesDir() / "hough_recall";
+    const std::filesystem::path ground_truth_file = corpus / "ground_truth.csv";
+
+    if (!std::filesystem::exists(ground_truth_file)) {
+        BOOST_TEST_MESSAGE("Recorded Hough recall images not found at " << corpus.string() << " - skipping");
+        return;
+    }
+
+    // Grouped by image, so that every exposure in a strobed image is counted
+    std::map<std::string, std::vector<RecordedBall>> images;
+    for (const RecordedBall& recorded : ReadGroundTruth(ground_truth_file)) {
+        images[recorded.image_file].push_back(recorded);
+    }
+
+    std::map<BallImageProc::BallSearchMode, int> number_of_images_by_mode;
+    int number_of_balls = 0;
+    int legacy_found = 0;
+    int engine_found = 0;
+    double legacy_ms_total = 0.0;
+    double engine_ms_total = 0.0;
+
+    for (const auto& [image_file, recorded_balls] : images) {
+        cv::Mat image = cv::imread((corpus / image_file).string(), cv::IMREAD_COLOR);
+        BOOST_REQUIRE_MESSAGE(!image.empty(), "Failed to load recorded image: " + (corpus / image_file).string());
+
+        const BallImageProc::BallSearchMode search_mode = recorded_balls.front().search_mode;
+
+        // The radius range the camera code would have from calibration
+        int min_radius = recorded_balls.front().ball.radius;
+        int max_radius = min_radius;
+        for (const RecordedBall& recorded : recorded_balls) {
+            min_radius = std::min(min_radius, recorded.ball.radius);
+            max_radius = std::max(max_radius, recorded.ball.radius);
+        }
+        min_radius = (int)std::round(min_radius * 0.7);
+        max_radius = (int)std::round(max_radius * 1.4);
+
+        double legacy_ms = 0.0;
+        double engine_ms = 0.0;
+        const std::vector<GsCircle> legacy_circles = FindBallsWithGetBall(image, search_mode, min_radius, max_radius, false, legacy_ms);
+        const std::vector<GsCircle> engine_circles = FindBallsWithGetBall(image, search_mode, min_radius, max_radius, true, engine_ms);
+
+        int legacy_hits = 0;
+        int engine_hits = 0;
+        for (const RecordedBall& recorded : recorded_balls) {
+            const double tolerance = recorded.ball.radius * 0.5;
+            legacy_hits += FoundBall(legacy_circles, recorded.ball, tolerance) ? 1 : 0;
+            engine_hits += FoundBall(engine_circles, recorded.ball, tolerance) ? 1 : 0;
+        }
+
+        number_of_images_by_mode[search_mode]++;
+        number_of_balls += (int)recorded_balls.size();
+        legacy_found += legacy_hits;
+        engine_found += engine_hits;
+        legacy_ms_total += legacy_ms;
+        engine_ms_total += engine_ms;
+
+        BOOST_TEST_MESSAGE("Hough " << image_file << ": GetBall with cv::HoughCircles " << legacy_ms << " ms, found "
+                           << legacy_hits << " of " << recorded_balls.size() << " balls; with the single-pass engine "
+                           << engine_ms << " ms, found " << engine_hits);
+
+        // The engine must find every ball that cv::HoughCircles finds
+        BOOST_CHECK_MESSAGE(engine_hits >= legacy_hits, "Single-pass engine found " << engine_hits << " of the "
+                            << legacy_hits << " balls that cv::HoughCircles found in " << image_file);
+    }
+
+    BOOST_TEST_MESSAGE("Hough recall over " << images.size() << " recorded images (" << number_of_images_by_mode[BallImageProc::BallSearchMode::kFindPlacedBall]
+                       << " teed, " << number_of_images_by_mode[BallImageProc::BallSearchMode::kStrobed] << " strobed, "
+                       << number_of_images_by_mode[BallImageProc::BallSearchMode::kPutting] << " putting) with " << number_of_balls
+                       << " balls: cv::HoughCircles " << legacy_found << " in " << legacy_ms_total << " ms, single-pass engine "
+                       << engine_found << " in " << engine_ms_total << " ms");
+
+    BOOST_CHECK_GT(images.size(), 0U);
+    BOOST_CHECK_GE(engine_found, legacy_found);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
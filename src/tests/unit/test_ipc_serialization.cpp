@@ -9,10 +9,14 @@
  *
  * Tests message packing, unpacking, Mat image transmission, and queue management.
  * Critical for ensuring reliable communication between camera processes.
+ * Also benchmarks the bytes copied and time taken to move a camera 2 frame.
  */
 
 #define BOOST_TEST_MODULE IPCSerializationTests
 #include <boost/test/unit_test.hpp>
+#include <boost/timer/timer.hpp>
+#include <cstring>
+#include <memory>
 #include <thread>
 #include "../test_utilities.hpp"
 #include "gs_ipc_message.h"
@@ -150,6 +154,249 @@ BOOST_FIXTURE_TEST_CASE(MatSerialization_DifferentTypes_HandlesFloat, MatSeriali
     BOOST_CHECK(true);
 }
 
+// ===========================================================================
+// Mat Encoding Tests
+// ===========================================================================
+
+namespace {
+
+    // Sends the packed bytes through a second GsIPCMat, as the receiving system would
+    cv::Mat RoundTrip(const GsIPCMat& sender) {
+        const msgpack::sbuffer& serialized = sender.GetSerializedMat();
+        std::vector<char> received(serialized.data(), serialized.data() + serialized.size());
+
+        GsIPCMat receiver;
+        BOOST_REQUIRE(receiver.UnpackMatData(received.data(), received.size()));
+        return receiver.GetImageMat();
+    }
+
+    bool SameImage(const cv::Mat& a, const cv::Mat& b) {
+        return a.size() == b.size() && a.type() == b.type() && cv::norm(a, b, cv::NORM_INF) == 0;
+    }
+
+    // The GsIPCMat holder as it was before the encoding and roi fields were added
+    struct OldMatHolder {
+        std::vector<uchar> matrix;
+        int rows = 0;
+        int cols = 0;
+        int type = 0;
+        MSGPACK_DEFINE(matrix, rows, cols, type);
+    };
+
+}
+
+BOOST_FIXTURE_TEST_CASE(MatEncoding_LosslessEncodings_RoundTripExactly, MatSerializationFixture) {
+    cv::Mat original = CreateTestImage();
+    cv::Mat gray;
+    cv::cvtColor(original, gray, cv::COLOR_BGR2GRAY);
+
+    for (GsIPCMatEncoding encoding : { GsIPCMatEncoding::kRaw, GsIPCMatEncoding::kPng, GsIPCMatEncoding::kLz4 }) {
+        for (const cv::Mat& image : { original, gray }) {
+            BOOST_TEST_CONTEXT("encoding " << GsIPCMat::FormatEncoding(encoding) << ", channels " << image.channels()) {
+                GsIPCMat ipc_mat;
+                ipc_mat.SetAndPackMat(image, encoding);
+
+                // LZ4 falls back to PNG if this build doesn't have it
+                if (encoding != GsIPCMatEncoding::kLz4 || GsIPCMat::IsLz4Available()) {
+                    BOOST_CHECK(ipc_mat.GetEncoding() == encoding);
+                }
+
+                BOOST_CHECK(SameImage(RoundTrip(ipc_mat), image));
+            }
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(MatEncoding_CompressionShrinksMostlyDarkImage, MatSerializationFixture) {
+    // Like a strobed camera 2 image - a bright ball on a black background
+    cv::Mat image = CreateSyntheticBallImage(1456, 1088, cv::Point(400, 500), 30, cv::Scalar(200, 200, 200), cv::Scalar(0, 0, 0));
+
+    GsIPCMat raw_mat;
+    raw_mat.SetAndPackMat(image, GsIPCMatEncoding::kRaw);
+
+    GsIPCMat png_mat;
+    png_mat.SetAndPackMat(image, GsIPCMatEncoding::kPng);
+
+    BOOST_CHECK_LT(png_mat.GetSerializedMat().size(), raw_mat.GetSerializedMat().size() / 4);
+}
+
+BOOST_FIXTURE_TEST_CASE(MatEncoding_Roi_SendsOnlyCroppedPixels, MatSerializationFixture) {
+    cv::Mat original = CreateTestImage();
+    cv::Rect roi(200, 120, 240, 240);
+
+    GsIPCMat full_mat;
+    full_mat.SetAndPackMat(original, GsIPCMatEncoding::kRaw);
+
+    GsIPCMat cropped_mat;
+    cropped_mat.SetAndPackMat(original, GsIPCMatEncoding::kRaw, roi);
+    BOOST_CHECK_LT(cropped_mat.GetSerializedMat().size(), full_mat.GetSerializedMat().size() / 4);
+
+    // Full size, with the original pixels inside the roi and black outside of it
+    cv::Mat received = RoundTrip(cropped_mat);
+    BOOST_REQUIRE_EQUAL(received.rows, original.rows);
+    BOOST_REQUIRE_EQUAL(received.cols, original.cols);
+    BOOST_CHECK(SameImage(received(roi), original(roi)));
+
+    cv::Mat outside_roi = received.clone();
+    outside_roi(roi).setTo(cv::Scalar::all(0));
+    BOOST_CHECK_EQUAL(cv::countNonZero(outside_roi.reshape(1)), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(MatEncoding_FloatImage_FallsBackToRaw, MatSerializationFixture) {
+    cv::Mat float_img(100, 100, CV_32FC1, cv::Scalar(1.5));
+
+    GsIPCMat ipc_mat;
+    ipc_mat.SetAndPackMat(float_img, GsIPCMatEncoding::kPng);
+
+    BOOST_CHECK(ipc_mat.GetEncoding() == GsIPCMatEncoding::kRaw);
+    BOOST_CHECK(SameImage(RoundTrip(ipc_mat), float_img));
+}
+
+BOOST_FIXTURE_TEST_CASE(MatEncoding_OlderSender_StillUnpacks, MatSerializationFixture) {
+    cv::Mat original = CreateTestImage();
+
+    OldMatHolder holder;
+    holder.matrix.assign(original.data, original.data + original.total() * original.elemSize());
+    holder.rows = original.rows;
+    holder.cols = original.cols;
+    holder.type = original.type();
+
+    msgpack::sbuffer serialized;
+    msgpack::pack(&serialized, holder);
+
+    GsIPCMat receiver;
+    BOOST_REQUIRE(receiver.UnpackMatData(serialized.data(), serialized.size()));
+    BOOST_CHECK(SameImage(receiver.GetImageMat(), original));
+}
+
+BOOST_FIXTURE_TEST_CASE(MatEncoding_OlderReceiver_StillUnpacksRaw, MatSerializationFixture) {
+    cv::Mat original = CreateTestImage();
+
+    GsIPCMat ipc_mat;
+    ipc_mat.SetAndPackMat(original, GsIPCMatEncoding::kRaw);
+
+    msgpack::object_handle unpacked = msgpack::unpack(ipc_mat.GetSerializedMat().data(), ipc_mat.GetSerializedMat().size());
+    OldMatHolder holder = unpacked.get().as<OldMatHolder>();
+
+    BOOST_REQUIRE_EQUAL(holder.matrix.size(), original.total() * original.elemSize());
+    BOOST_CHECK(SameImage(cv::Mat(holder.rows, holder.cols, holder.type, holder.matrix.data()), original));
+}
+
+BOOST_FIXTURE_TEST_CASE(MatEncoding_StridedMat_RoundTripsExactly, MatSerializationFixture) {
+    // A view into a larger image, so its rows are not next to each other in memory
+    cv::Mat full_image = CreateTestImage();
+    cv::Mat view = full_image(cv::Rect(101, 37, 333, 211));
+    BOOST_REQUIRE(!view.isContinuous());
+
+    GsIPCMat ipc_mat;
+    ipc_mat.SetAndPackMat(view, GsIPCMatEncoding::kRaw);
+
+    BOOST_CHECK(SameImage(RoundTrip(ipc_mat), view));
+}
+
+BOOST_FIXTURE_TEST_CASE(MatEncoding_ReceivedRawImage_SharesReceiveBuffer, MatSerializationFixture) {
+    cv::Mat original = CreateTestImage();
+
+    GsIPCMat sender;
+    sender.SetAndPackMat(original, GsIPCMatEncoding::kRaw);
+
+    const msgpack::sbuffer& serialized = sender.GetSerializedMat();
+    cv::Mat received_data(1, (int)serialized.size(), CV_8UC1);
+    memcpy(received_data.data, serialized.data(), serialized.size());
+
+    cv::Mat received_image;
+    {
+        GsIPCMat receiver;
+        BOOST_REQUIRE(receiver.UnpackMatData(received_data));
+        received_image = receiver.GetImageMat();
+    }
+
+    // No copy was made, and the image is still good after the receiver has gone away
+    BOOST_CHECK(received_image.data >= received_data.data);
+    BOOST_CHECK(received_image.data < received_data.data + received_data.total());
+    BOOST_CHECK(SameImage(received_image, original));
+}
+
+BOOST_FIXTURE_TEST_CASE(Benchmark_Camera2FrameTransport, MatSerializationFixture) {
+    // A full-resolution camera 2 frame
+    cv::Mat frame = CreateSyntheticBallImage(1456, 1088, cv::Point(700, 500), 30);
+    const size_t frame_bytes = frame.total() * frame.elemSize();
+    const int kIterations = 20;
+
+    // The way this used to be done.  Each step copies (about) the whole frame.
+    size_t old_bytes_copied = 0;
+    boost::timer::cpu_timer old_timer;
+
+    for (int i = 0; i < kIterations; i++) {
+        OldMatHolder holder;
+        holder.matrix.assign(frame.data, frame.data + frame_bytes);
+        holder.rows = frame.rows;
+        holder.cols = frame.cols;
+        holder.type = frame.type();
+
+        msgpack::sbuffer serialized;
+        msgpack::pack(&serialized, holder);
+        // BytesMessage::setBodyBytes
+        std::vector<char> message_body(serialized.data(), serialized.data() + serialized.size());
+        // BytesMessage::getBodyBytes
+        std::unique_ptr<char[]> body_data(new char[message_body.size()]);
+        memcpy(body_data.get(), message_body.data(), message_body.size());
+        msgpack::sbuffer received;
+        received.write(body_data.get(), message_body.size());
+        // The unpack copies into its zone, and as<>() copies into the vector
+        msgpack::object_handle unpacked = msgpack::unpack(received.data(), received.size());
+        OldMatHolder received_holder = unpacked.get().as<OldMatHolder>();
+        cv::Mat image = cv::Mat(received_holder.rows, received_holder.cols, received_holder.type, received_holder.matrix.data()).clone();
+
+        old_bytes_copied += 8 * frame_bytes;
+        BOOST_REQUIRE(!image.empty());
+    }
+    old_timer.stop();
+
+    size_t new_bytes_copied = 0;
+    boost::timer::cpu_timer new_timer;
+
+    for (int i = 0; i < kIterations; i++) {
+        GsIPCMat sender;
+        sender.SetAndPackMat(frame, GsIPCMatEncoding::kRaw);
+        const msgpack::sbuffer& serialized = sender.GetSerializedMat();
+        // BytesMessage::setBodyBytes
+        std::vector<char> message_body(serialized.data(), serialized.data() + serialized.size());
+        // BytesMessage::readBytes into the receive buffer
+        cv::Mat received_data(1, (int)message_body.size(), CV_8UC1);
+        memcpy(received_data.data, message_body.data(), message_body.size());
+
+        GsIPCMat receiver;
+        receiver.UnpackMatData(received_data);
+        cv::Mat image = receiver.GetImageMat();
+
+        new_bytes_copied += serialized.size() + 2 * message_body.size();
+        BOOST_REQUIRE(image.data >= received_data.data && image.data < received_data.data + received_data.total());
+    }
+    new_timer.stop();
+
+    const double old_ms = old_timer.elapsed().wall / 1.0e6 / kIterations;
+    const double new_ms = new_timer.elapsed().wall / 1.0e6 / kIterations;
+
+    BOOST_TEST_MESSAGE("Camera 2 frame " << frame.cols << "x" << frame.rows << " (" << frame_bytes << " bytes): "
+                       << "previous path " << old_bytes_copied / kIterations << " bytes copied, " << old_ms << " ms/frame; "
+                       << "current path " << new_bytes_copied / kIterations << " bytes copied, " << new_ms << " ms/frame");
+
+    BOOST_CHECK_LT(new_bytes_copied, old_bytes_copied / 2);
+}
+
+BOOST_AUTO_TEST_CASE(MatEncoding_ParsesConfigurationNames) {
+    GsIPCMatEncoding encoding = GsIPCMatEncoding::kRaw;
+
+    BOOST_CHECK(GsIPCMat::ParseEncodingName("PNG", encoding));
+    BOOST_CHECK(encoding == GsIPCMatEncoding::kPng);
+    BOOST_CHECK(GsIPCMat::ParseEncodingName("lz4", encoding));
+    BOOST_CHECK(encoding == GsIPCMatEncoding::kLz4);
+
+    BOOST_CHECK(!GsIPCMat::ParseEncodingName("jpeg", encoding));
+    BOOST_CHECK(encoding == GsIPCMatEncoding::kRaw);
+}
+
 // ===========================================================================
 // Message Size Tests
 // ===========================================================================
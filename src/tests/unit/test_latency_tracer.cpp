@@ -0,0 +1,169 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_latency_tracer.cpp
+ * @brief Unit tests for the frame-to-trigger LatencyTracer and its histograms
+ *
+ * Checks the histogram bucketing and percentiles, that per-frame events are
+ * turned into the right intervals (including when recorded in the camera
+ * pipeline's order), and that concurrent recording neither loses samples nor
+ * tears the raw event records.
+ */
+
+#define BOOST_TEST_MODULE LatencyTracerTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "latency_tracer.h"
+
+#include <memory>
+#include <thread>
+
+using namespace golf_sim;
+using Event = LatencyTracer::Event;
+using Interval = LatencyTracer::Interval;
+
+BOOST_AUTO_TEST_SUITE(LatencyTracerTests)
+
+BOOST_AUTO_TEST_CASE(HistogramBucketsCoverEveryValue) {
+    // Every value must land in a bucket whose upper bound is at least the value,
+    // and no more than 12.5% above it
+    for (uint64_t value : { 0ull, 1ull, 7ull, 8ull, 15ull, 16ull, 1000ull, 123456ull, 987654321ull, (1ull << 62) + 12345ull }) {
+        int index = LatencyHistogram::BucketIndex(value);
+        BOOST_TEST_CONTEXT("value " << value) {
+            BOOST_REQUIRE_LT(index, LatencyHistogram::kNumBuckets);
+            BOOST_CHECK_GE(LatencyHistogram::BucketUpperBound(index), value);
+            BOOST_CHECK_LE((double)LatencyHistogram::BucketUpperBound(index), value * 1.125 + 1.0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(HistogramPercentiles) {
+    LatencyHistogram histogram;
+
+    // 1..1000 microseconds
+    for (int i = 1; i <= 1000; i++) {
+        histogram.Add(i * 1000);
+    }
+
+    BOOST_CHECK_EQUAL(histogram.count(), 1000u);
+    BOOST_CHECK_EQUAL(histogram.min_ns(), 1000);
+    BOOST_CHECK_EQUAL(histogram.max_ns(), 1000000);
+    BOOST_CHECK_CLOSE(histogram.mean_ns(), 500500.0, 0.001);
+
+    BOOST_CHECK_CLOSE((double)histogram.Percentile(0.50), 500000.0, 12.5);
+    BOOST_CHECK_CLOSE((double)histogram.Percentile(0.95), 950000.0, 12.5);
+    BOOST_CHECK_CLOSE((double)histogram.Percentile(0.99), 990000.0, 12.5);
+    BOOST_CHECK_EQUAL(histogram.Percentile(1.0), 1000000);
+
+    histogram.Reset();
+    BOOST_CHECK_EQUAL(histogram.count(), 0u);
+    BOOST_CHECK_EQUAL(histogram.Percentile(0.5), 0);
+}
+
+BOOST_AUTO_TEST_CASE(EventsBecomeIntervals) {
+    auto tracer = std::make_unique<LatencyTracer>();
+
+    // Frame 10 triggers, frame 11 does not, and frame 12 is missing its start
+    tracer->Record(10, Event::kSensorTimestamp, 1000000);
+    tracer->Record(10, Event::kRequestCompleted, 1004000);
+    tracer->Record(10, Event::kMotionDecision, 1004050);
+    tracer->Record(10, Event::kTriggerSent, 1004070);
+
+    tracer->Record(11, Event::kRequestCompleted, 2000000);
+    tracer->Record(11, Event::kMotionDecision, 2000040);
+
+    tracer->Record(12, Event::kMotionDecision, 3000000);
+
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kSensorToRequest).count(), 1u);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kSensorToRequest).max_ns(), 4000);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kRequestToMotionDecision).count(), 2u);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kRequestToMotionDecision).max_ns(), 50);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kMotionDecisionToTrigger).max_ns(), 20);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kRequestToTrigger).max_ns(), 70);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kSensorToTrigger).max_ns(), 4070);
+
+    std::vector<LatencyTracer::EventRecord> events = tracer->GetRecentEvents();
+    BOOST_REQUIRE_EQUAL(events.size(), 7u);
+    BOOST_CHECK_EQUAL(events.front().frame_sequence, 10u);
+    BOOST_CHECK(events.back().event == Event::kMotionDecision);
+
+    // One line per interval that has samples
+    BOOST_CHECK_EQUAL(tracer->FormatStatistics().size(), 5u);
+}
+
+BOOST_AUTO_TEST_CASE(PipelineOrderFillsEveryInterval) {
+    auto tracer = std::make_unique<LatencyTracer>();
+
+    // The order the camera pipeline records them in: RPiCamApp::requestComplete records the
+    // sensor and request events before handing the frame to the post-processing stages, where
+    // MotionDetectStage records its decision and (on motion) the trigger.  More frames than
+    // there are frame slots, so that the slots get re-used.
+    const uint64_t kFrames = 1000;
+    const uint64_t kTriggerEvery = 10;
+    const int64_t kExposureNs = 500000;
+
+    for (uint64_t frame = 0; frame < kFrames; frame++) {
+        const int64_t request_completed_ns = LatencyTracer::NowNs();
+        tracer->Record(frame, Event::kSensorTimestamp, request_completed_ns - kExposureNs);
+        tracer->Record(frame, Event::kRequestCompleted, request_completed_ns);
+
+        tracer->Record(frame, Event::kMotionDecision);
+        if (frame % kTriggerEvery == 0) {
+            tracer->Record(frame, Event::kTriggerSent);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kSensorToRequest).count(), kFrames);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kSensorToRequest).min_ns(), kExposureNs);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kRequestToMotionDecision).count(), kFrames);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kMotionDecisionToTrigger).count(), kFrames / kTriggerEvery);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kRequestToTrigger).count(), kFrames / kTriggerEvery);
+    BOOST_CHECK_EQUAL(tracer->GetHistogram(Interval::kSensorToTrigger).count(), kFrames / kTriggerEvery);
+    BOOST_CHECK_GE(tracer->GetHistogram(Interval::kSensorToTrigger).min_ns(), kExposureNs);
+
+    BOOST_CHECK_EQUAL(tracer->FormatStatistics().size(), (size_t)LatencyTracer::Interval::kNumIntervals);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentRecordingKeepsEverySample) {
+    auto tracer = std::make_unique<LatencyTracer>();
+
+    const int kThreads = 4;
+    const int kFramesPerThread = 20000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&tracer, t]() {
+            // Each thread uses its own range of sequence numbers, so frames don't collide
+            for (int i = 0; i < kFramesPerThread; i++) {
+                uint64_t frame = (uint64_t)i * kThreads + t;
+                tracer->Record(frame, Event::kRequestCompleted, (int64_t)frame * 1000);
+                tracer->Record(frame, Event::kMotionDecision, (int64_t)frame * 1000 + 100);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Frame slots are shared by sequence number modulo the slot count, so a frame can
+    // only lose its start if another thread was more than a slot table ahead
+    const LatencyHistogram& histogram = tracer->GetHistogram(Interval::kRequestToMotionDecision);
+    BOOST_CHECK_GT(histogram.count(), 0u);
+    BOOST_CHECK_LE(histogram.count(), (uint64_t)kThreads * kFramesPerThread);
+
+    std::vector<LatencyTracer::EventRecord> events = tracer->GetRecentEvents();
+    BOOST_CHECK_LE(events.size(), LatencyTracer::kRingSize);
+
+    for (const auto& record : events) {
+        // A torn record would pair one frame's number with another frame's time
+        const int64_t base = (int64_t)record.frame_sequence * 1000;
+        const int64_t expected = (record.event == Event::kRequestCompleted) ? base : base + 100;
+        BOOST_CHECK_EQUAL(record.timestamp_ns, expected);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,120 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_logging_front_end.cpp
+ * @brief Unit tests for the level checks in the GS_LOG macros
+ *
+ * Checks that a message for a level that is not being logged is never built,
+ * and benchmarks disabled trace calls like those in the spin and ball-detection
+ * loops against the previous, unchecked BOOST_LOG_FUNCTION + BOOST_LOG_TRIVIAL form.
+ */
+
+#define BOOST_TEST_MODULE LoggingFrontEndTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "utils/logging_tools.h"
+#include <boost/timer/timer.hpp>
+
+using namespace golf_sim;
+
+namespace {
+
+std::string CountedMessage(int& count) {
+    count++;
+    return "message " + std::to_string(count);
+}
+
+// Restores the logging level after each test
+struct LoggingLevelFixture {
+    LoggingLevelFixture() : level((boost::log::trivial::severity_level)LoggingTools::runtime_min_level_.load()) {
+    }
+
+    ~LoggingLevelFixture() {
+        LoggingTools::SetRuntimeMinLevel(level);
+    }
+
+    boost::log::trivial::severity_level level;
+};
+
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(LoggingFrontEndTests, LoggingLevelFixture)
+
+BOOST_AUTO_TEST_CASE(DisabledLevels_DoNotBuildTheMessage) {
+    LoggingTools::SetRuntimeMinLevel(boost::log::trivial::warning);
+
+    BOOST_CHECK(!LoggingTools::IsLevelEnabled(boost::log::trivial::trace));
+    BOOST_CHECK(!LoggingTools::IsLevelEnabled(boost::log::trivial::info));
+    BOOST_CHECK(LoggingTools::IsLevelEnabled(boost::log::trivial::warning));
+    BOOST_CHECK(LoggingTools::IsLevelEnabled(boost::log::trivial::error));
+
+    int count = 0;
+
+    GS_LOG_TRACE_MSG(trace, CountedMessage(count));
+    GS_LOG_MSG(info, CountedMessage(count));
+    GS_LOG_TRACE_FMT(debug, "{} {}", CountedMessage(count), count);
+    BOOST_CHECK_EQUAL(count, 0);
+
+    GS_LOG_MSG(warning, CountedMessage(count));
+    GS_LOG_TRACE_FMT(error, "{}", CountedMessage(count));
+    BOOST_CHECK_EQUAL(count, 2);
+}
+
+BOOST_AUTO_TEST_CASE(Macros_ActAsSingleStatements) {
+    LoggingTools::SetRuntimeMinLevel(boost::log::trivial::error);
+
+    int count = 0;
+
+    // The whole macro must be inside the if, and leave the else attached to it
+    if (count > 0)
+        GS_LOG_MSG(error, CountedMessage(count));
+    else
+        count = 10;
+
+    BOOST_CHECK_EQUAL(count, 10);
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark_DisabledTraceCalls) {
+    LoggingTools::SetRuntimeMinLevel(boost::log::trivial::info);
+
+    const int kIterations = 200000;
+    const cv::Vec3i rotation(12, -7, 31);
+    const GsCircle circle(512.5F, 380.25F, 41.0F);
+    volatile int sink = 0;
+
+    // A per-candidate spin message, and a per-circle detection message
+    boost::timer::cpu_timer unchecked_timer;
+    for (int i = 0; i < kIterations; i++) {
+        {
+            BOOST_LOG_FUNCTION();  BOOST_LOG_TRIVIAL(trace) << "I=" + std::to_string(i) + ", Rot: (" + std::to_string(rotation[0]) + ", " +
+                std::to_string(rotation[1]) + ", " + std::to_string(rotation[2]) + ").";
+        }
+        {
+            BOOST_LOG_FUNCTION();  BOOST_LOG_TRIVIAL(trace) << "Found circle: " + LoggingTools::FormatCircle(circle);
+        }
+        sink = sink + 1;
+    }
+    unchecked_timer.stop();
+
+    boost::timer::cpu_timer checked_timer;
+    for (int i = 0; i < kIterations; i++) {
+        GS_LOG_TRACE_MSG(trace, "I=" + std::to_string(i) + ", Rot: (" + std::to_string(rotation[0]) + ", " +
+            std::to_string(rotation[1]) + ", " + std::to_string(rotation[2]) + ").");
+        GS_LOG_TRACE_MSG(trace, "Found circle: " + LoggingTools::FormatCircle(circle));
+        sink = sink + 1;
+    }
+    checked_timer.stop();
+
+    const double unchecked_ns = (double)unchecked_timer.elapsed().wall / (2.0 * kIterations);
+    const double checked_ns = (double)checked_timer.elapsed().wall / (2.0 * kIterations);
+
+    BOOST_TEST_MESSAGE("Disabled trace call: previous macro " << unchecked_ns << " ns/call, GS_LOG_TRACE_MSG "
+                       << checked_ns << " ns/call");
+
+    BOOST_CHECK_EQUAL(sink, 2 * kIterations);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,220 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_motion_detect_kernel.cpp
+ * @brief Equivalence tests and a latency benchmark for the MotionDetectStage kernel
+ *
+ * The vectorized MotionDetectKernel must make exactly the same motion decision,
+ * and leave exactly the same previous frame behind, as the original per-pixel
+ * loop - otherwise the hit trigger would fire at a different time.  The benchmark
+ * reports the per-frame latency at the watching and club-strike crop sizes, as
+ * every microsecond here is delay before camera 2 is triggered.
+ */
+
+#define BOOST_TEST_MODULE MotionDetectKernelTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "motion_detect_kernel.h"
+
+#include <boost/timer/timer.hpp>
+
+#include <algorithm>
+#include <random>
+
+using namespace golf_sim;
+
+namespace {
+
+    struct TestFrame {
+        unsigned int width = 0;
+        unsigned int height = 0;
+        size_t stride = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    TestFrame MakeFrame(unsigned int width, unsigned int height, std::mt19937& rng) {
+        TestFrame frame;
+        frame.width = width;
+        frame.height = height;
+        // Like the camera buffers, rows are padded out past the image width
+        frame.stride = (width + 63) & ~63u;
+        frame.pixels.resize(frame.stride * height);
+
+        std::uniform_int_distribution<int> value(0, 255);
+        for (auto& p : frame.pixels) {
+            p = (uint8_t)value(rng);
+        }
+        return frame;
+    }
+
+    // Changes roughly fraction of the pixels by up to max_change, to get a mix of
+    // pixels just above and just below the threshold
+    void PerturbFrame(TestFrame& frame, double fraction, int max_change, std::mt19937& rng) {
+        std::uniform_real_distribution<double> pick(0.0, 1.0);
+        std::uniform_int_distribution<int> change(-max_change, max_change);
+
+        for (auto& p : frame.pixels) {
+            if (pick(rng) < fraction) {
+                p = (uint8_t)std::clamp((int)p + change(rng), 0, 255);
+            }
+        }
+    }
+
+    MotionDetectKernel::Settings MakeSettings(unsigned int width, unsigned int height, unsigned int skip, float difference_m, int difference_c) {
+        MotionDetectKernel::Settings settings;
+        settings.hskip = skip;
+        settings.vskip = skip;
+        settings.image_width = width;
+        settings.roi_x = 1;
+        settings.roi_y = 1;
+        settings.roi_width = width / skip - 1;
+        settings.roi_height = height / skip - 1;
+        settings.difference_m = difference_m;
+        settings.difference_c = difference_c;
+        // Same 5% as the default kRegionThreshold
+        settings.region_threshold = (unsigned int)(0.05 * settings.roi_width * settings.roi_height);
+        return settings;
+    }
+
+    // Runs a sequence of frames through both the kernel and the original loop
+    void CheckMatchesReference(const MotionDetectKernel::Settings& settings, unsigned int width, unsigned int height, std::mt19937& rng) {
+        TestFrame frame = MakeFrame(width, height, rng);
+
+        MotionDetectKernel kernel;
+        kernel.Configure(settings);
+        kernel.Reset(frame.pixels.data(), frame.stride);
+
+        std::vector<uint8_t> reference_previous(kernel.previous_frame());
+
+        for (int i = 0; i < 20; i++) {
+            // Alternate small changes (no motion) with larger ones (motion)
+            PerturbFrame(frame, (i % 3 == 2) ? 0.5 : 0.02, (i % 2 == 0) ? 8 : 40, rng);
+
+            unsigned int kernel_regions = 0;
+            unsigned int reference_regions = 0;
+            bool kernel_motion = kernel.DetectMotion(frame.pixels.data(), frame.stride, &kernel_regions);
+            bool reference_motion = MotionDetectKernel::DetectMotionReference(settings, frame.pixels.data(), frame.stride,
+                                                                              reference_previous, &reference_regions);
+
+            BOOST_TEST_CONTEXT("frame " << i) {
+                BOOST_CHECK_EQUAL(kernel_motion, reference_motion);
+
+                if (settings.early_exit_rows == 1) {
+                    BOOST_CHECK_EQUAL(kernel_regions, reference_regions);
+                    BOOST_CHECK(kernel.previous_frame() == reference_previous);
+                }
+            }
+
+            kernel.UpdateThresholds();
+
+            if (settings.early_exit_rows != 1) {
+                // The kernel may have updated a few more rows than the reference
+                reference_previous = kernel.previous_frame();
+            }
+        }
+    }
+
+}
+
+BOOST_AUTO_TEST_SUITE(MotionDetectKernelTests)
+
+BOOST_AUTO_TEST_CASE(MatchesReferenceLoop) {
+    std::mt19937 rng(0x5EED);
+
+    // Widths that are and are not multiples of the vector width, with and without the stride-2 gather
+    for (unsigned int skip : { 1u, 2u, 3u }) {
+        for (unsigned int width : { 96u, 130u, 340u }) {
+            for (float difference_m : { 0.0f, 0.1f, 0.9f }) {
+                MotionDetectKernel::Settings settings = MakeSettings(width, 88, skip, difference_m, 3);
+
+                BOOST_TEST_CONTEXT("skip " << skip << ", width " << width << ", m " << difference_m) {
+                    CheckMatchesReference(settings, width, 88, rng);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(EarlyExitGranularityDoesNotChangeResult) {
+    std::mt19937 rng(1234);
+
+    for (unsigned int early_exit_rows : { 2u, 4u, 7u, 100u }) {
+        MotionDetectKernel::Settings settings = MakeSettings(96, 88, 2, 0.9f, 3);
+        settings.early_exit_rows = early_exit_rows;
+
+        BOOST_TEST_CONTEXT("early_exit_rows " << early_exit_rows) {
+            CheckMatchesReference(settings, 96, 88, rng);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(NegativeThresholdFallsBackToReference) {
+    std::mt19937 rng(42);
+    // Every pixel counts as different when the threshold is below zero
+    MotionDetectKernel::Settings settings = MakeSettings(96, 88, 2, 0.1f, -5);
+    CheckMatchesReference(settings, 96, 88, rng);
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark_PerFrameLatency) {
+    std::mt19937 rng(7);
+
+    // The ball-watching crop (kMaxWatchingCropWidth/Height) and the club-strike crop
+    // (kClubImageWidth/HeightPixels), both with the default 2x2 skip
+    struct CropSize { unsigned int width; unsigned int height; };
+
+    BOOST_TEST_MESSAGE("MotionDetectKernel backend: " << MotionDetectKernel::BackendName());
+
+    for (const CropSize& crop : { CropSize{ 96, 88 }, CropSize{ 340, 200 } }) {
+        TestFrame frame = MakeFrame(crop.width, crop.height, rng);
+        // Full-frame ROI and no motion, i.e., the worst case that runs on every frame
+        MotionDetectKernel::Settings settings = MakeSettings(crop.width, crop.height, 2, 0.9f, 3);
+        settings.roi_x = 0;
+        settings.roi_y = 0;
+        settings.roi_width = crop.width / 2;
+        settings.roi_height = crop.height / 2;
+        settings.region_threshold = settings.roi_width * settings.roi_height + 1;
+
+        const int kIterations = 20000;
+
+        MotionDetectKernel kernel;
+        kernel.Configure(settings);
+        kernel.Reset(frame.pixels.data(), frame.stride);
+
+        boost::timer::cpu_timer kernel_timer;
+        for (int i = 0; i < kIterations; i++) {
+            kernel.DetectMotion(frame.pixels.data(), frame.stride);
+        }
+        kernel_timer.stop();
+
+        // Time the threshold refresh separately, as it happens after the trigger decision
+        boost::timer::cpu_timer refresh_timer;
+        for (int i = 0; i < kIterations; i++) {
+            kernel.Reset(frame.pixels.data(), frame.stride);
+            kernel.UpdateThresholds();
+        }
+        refresh_timer.stop();
+
+        std::vector<uint8_t> reference_previous(kernel.previous_frame());
+
+        boost::timer::cpu_timer reference_timer;
+        for (int i = 0; i < kIterations; i++) {
+            MotionDetectKernel::DetectMotionReference(settings, frame.pixels.data(), frame.stride, reference_previous);
+        }
+        reference_timer.stop();
+
+        const double kernel_us = kernel_timer.elapsed().wall / 1000.0 / kIterations;
+        const double refresh_us = refresh_timer.elapsed().wall / 1000.0 / kIterations;
+        const double reference_us = reference_timer.elapsed().wall / 1000.0 / kIterations;
+
+        BOOST_TEST_MESSAGE("Motion detect " << crop.width << "x" << crop.height << " crop (" << settings.roi_width << "x"
+                           << settings.roi_height << " sampled): kernel (incl. threshold refresh) " << kernel_us << " us/frame, reset + threshold refresh "
+                           << refresh_us << " us/frame, original loop " << reference_us << " us/frame");
+
+        BOOST_CHECK_GT(kernel_us, 0.0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_onnx_tiling.cpp
+ * @brief Unit tests for the crop selection of ONNXRuntimeDetector's tiled mode
+ *
+ * Running the model needs a model file, so these tests only cover which
+ * model-input-sized crops are chosen for a set of predicted ball centers.
+ */
+
+#define BOOST_TEST_MODULE ONNXTilingTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "onnx_runtime_detector.hpp"
+
+using namespace golf_sim;
+
+namespace {
+
+const cv::Size kFrameSize(1456, 1088);
+const cv::Size kTileSize(640, 640);
+
+bool Contains(const cv::Rect& tile, const cv::Point2f& point) {
+    return point.x >= tile.x && point.x < tile.br().x && point.y >= tile.y && point.y < tile.br().y;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(ONNXTilingTests)
+
+BOOST_AUTO_TEST_CASE(Tiles_AreCenteredOnPredictionAndInsideImage) {
+    const cv::Point2f prediction(700.0F, 500.0F);
+
+    auto tiles = ONNXRuntimeDetector::GetTilesForPredictions(kFrameSize, kTileSize, { prediction });
+    BOOST_REQUIRE_EQUAL(tiles.size(), 1u);
+    BOOST_CHECK_EQUAL(tiles[0].size(), kTileSize);
+    BOOST_CHECK_EQUAL(tiles[0].x + tiles[0].width / 2, 700);
+    BOOST_CHECK_EQUAL(tiles[0].y + tiles[0].height / 2, 500);
+
+    // Near the corner, the crop is moved back into the image instead of being padded
+    tiles = ONNXRuntimeDetector::GetTilesForPredictions(kFrameSize, kTileSize, { cv::Point2f(1450.0F, 5.0F) });
+    BOOST_REQUIRE_EQUAL(tiles.size(), 1u);
+    BOOST_CHECK((tiles[0] & cv::Rect(cv::Point(0, 0), kFrameSize)) == tiles[0]);
+    BOOST_CHECK(Contains(tiles[0], cv::Point2f(1450.0F, 5.0F)));
+}
+
+BOOST_AUTO_TEST_CASE(Tiles_AreSharedOnlyWhenThePredictionIsWellInside) {
+    // Strobed exposures of the same ball, close together
+    const std::vector<cv::Point2f> close_predictions = { {400.0F, 540.0F}, {460.0F, 530.0F}, {520.0F, 520.0F} };
+
+    auto tiles = ONNXRuntimeDetector::GetTilesForPredictions(kFrameSize, kTileSize, close_predictions);
+    BOOST_CHECK_EQUAL(tiles.size(), 1u);
+
+    // The second prediction is inside the first crop, but so close to its edge that a ball
+    // there could be cut in half
+    const std::vector<cv::Point2f> spread_predictions = { {400.0F, 540.0F}, {700.0F, 540.0F}, {1200.0F, 540.0F} };
+
+    tiles = ONNXRuntimeDetector::GetTilesForPredictions(kFrameSize, kTileSize, spread_predictions);
+    BOOST_CHECK_EQUAL(tiles.size(), 3u);
+
+    for (const auto& prediction : spread_predictions) {
+        bool covered = false;
+        for (const auto& tile : tiles) {
+            covered = covered || Contains(tile, prediction);
+        }
+        BOOST_CHECK(covered);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Tiles_NoneForImagesSmallerThanTheModelInput) {
+    auto tiles = ONNXRuntimeDetector::GetTilesForPredictions(cv::Size(600, 480), kTileSize, { cv::Point2f(300.0F, 240.0F) });
+    BOOST_CHECK(tiles.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
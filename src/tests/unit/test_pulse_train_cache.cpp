@@ -0,0 +1,271 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_pulse_train_cache.cpp
+ * @brief Unit tests for the precompiled strobe pulse trains
+ *
+ * Checks the compiled SPI byte streams against golden byte patterns (small,
+ * hand-checked trains, and the default driver and putter trains from
+ * golf_sim_config.json), that bad specs are rejected, and that the cache only
+ * recompiles changed profiles and never leaves a partly-rebuilt set.
+ */
+
+#define BOOST_TEST_MODULE PulseTrainCacheTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "pulse_train_cache.h"
+#include <boost/timer/timer.hpp>
+#include <map>
+
+using namespace golf_sim;
+
+namespace {
+
+// 8000 baud is 8 bits per millisecond, which keeps the small trains easy to check by hand
+PulseTrainSpec MakeSpec(unsigned long baud_rate, const std::vector<float>& intervals_ms, int number_bits_for_on_pulse) {
+    PulseTrainSpec spec;
+    spec.baud_rate = baud_rate;
+    spec.intervals_ms = intervals_ms;
+    spec.number_bits_for_on_pulse = number_bits_for_on_pulse;
+    spec.bits_per_word = 16;
+    return spec;
+}
+
+// The default driver and putter settings in golf_sim_config.json
+PulseTrainSpec DriverSpec() {
+    return MakeSpec(115200, { 0.7F, 1.8F, 3.0F, 2.2F, 3.0F, 7.1F, 4.0F, 0.0F }, 1);
+}
+
+PulseTrainSpec PutterSpec() {
+    return MakeSpec(115200, { 2.5F, 5.0F, 8.0F, 10.5F, 8.5F, 21.0F, 21.0F, 21.0F, 21.0F, 21.0F, 21.0F, 21.0F, 0.0F }, 8);
+}
+
+std::vector<unsigned char> Bytes(const PulseTrain& train) {
+    return std::vector<unsigned char>(train.bytes.begin(), train.bytes.end());
+}
+
+// The long trains are mostly zeros, so only the non-zero bytes are compared
+std::map<size_t, unsigned char> NonZeroBytes(const PulseTrain& train) {
+    std::map<size_t, unsigned char> non_zero;
+    for (size_t i = 0; i < train.bytes.size(); i++) {
+        if (train.bytes[i] != 0) {
+            non_zero[i] = (unsigned char)train.bytes[i];
+        }
+    }
+    return non_zero;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(PulseTrainCacheTests)
+
+BOOST_AUTO_TEST_CASE(NextTwoPulseBytes_ArePaddedMostSignificantBitFirst) {
+    unsigned char first = 0, second = 0;
+
+    BOOST_CHECK_EQUAL(PulseTrainCompiler::GetNextTwoPulseBytes(0, 3, first, second), 13);
+    BOOST_CHECK_EQUAL(first, 0xE0);
+    BOOST_CHECK_EQUAL(second, 0x00);
+
+    BOOST_CHECK_EQUAL(PulseTrainCompiler::GetNextTwoPulseBytes(6, 8, first, second), 2);
+    BOOST_CHECK_EQUAL(first, 0x03);
+    BOOST_CHECK_EQUAL(second, 0xFC);
+
+    BOOST_CHECK_EQUAL(PulseTrainCompiler::GetNextTwoPulseBytes(0, 0, first, second), -1);
+}
+
+BOOST_AUTO_TEST_CASE(SmallTrains_MatchGoldenBytes) {
+    // 3-bit pulses 28 and then 16 bits (3.5 and 2 ms) apart, padded to a 16-bit word
+    auto train = PulseTrainCompiler::Compile(MakeSpec(8000, { 3.5F, 2.0F, 0.0F }, 3));
+    BOOST_REQUIRE(train != nullptr);
+    const std::vector<unsigned char> expected = { 0xE0, 0x00, 0x00, 0x0E, 0x00, 0x0E, 0x00, 0x00 };
+    BOOST_CHECK(Bytes(*train) == expected);
+
+    // Off times shorter than the pulse itself are not possible, so the pulses are back-to-back
+    train = PulseTrainCompiler::Compile(MakeSpec(8000, { 1.0F, 0.0F }, 3));
+    BOOST_REQUIRE(train != nullptr);
+    BOOST_CHECK(Bytes(*train) == std::vector<unsigned char>({ 0xE0, 0x00, 0xE0, 0x00 }));
+
+    // Word padding
+    PulseTrainSpec spec = MakeSpec(8000, { 3.0F, 0.0F }, 3);
+    spec.bits_per_word = 32;
+    train = PulseTrainCompiler::Compile(spec);
+    BOOST_REQUIRE(train != nullptr);
+    BOOST_CHECK(Bytes(*train) == std::vector<unsigned char>({ 0xE0, 0x00, 0x00, 0xE0, 0x00, 0x00, 0x00, 0x00 }));
+}
+
+BOOST_AUTO_TEST_CASE(SinglePulseAndStrobesOff_MatchGoldenBytes) {
+    // One double-width pulse (capped at 15 bits), then a zero byte of extra shutter time
+    PulseTrainSpec spec = MakeSpec(115200, { 0.7F, 1.8F, 0.0F }, 5);
+    spec.single_pulse = true;
+    auto train = PulseTrainCompiler::Compile(spec);
+    BOOST_REQUIRE(train != nullptr);
+    BOOST_CHECK(Bytes(*train) == std::vector<unsigned char>({ 0xFF, 0xC0, 0x00, 0x00 }));
+
+    spec.number_bits_for_on_pulse = 8;
+    train = PulseTrainCompiler::Compile(spec);
+    BOOST_REQUIRE(train != nullptr);
+    BOOST_CHECK(Bytes(*train) == std::vector<unsigned char>({ 0xFF, 0xFE, 0x00, 0x00 }));
+
+    // Each on-pulse becomes a single zero byte
+    spec = MakeSpec(8000, { 2.0F, 0.0F }, 3);
+    spec.turn_off_strobes = true;
+    train = PulseTrainCompiler::Compile(spec);
+    BOOST_REQUIRE(train != nullptr);
+    BOOST_CHECK(Bytes(*train) == std::vector<unsigned char>({ 0x00, 0x00 }));
+}
+
+BOOST_AUTO_TEST_CASE(DefaultDriverAndPutterTrains_MatchGoldenBytes) {
+    auto driver = PulseTrainCompiler::Compile(DriverSpec());
+    BOOST_REQUIRE(driver != nullptr);
+    BOOST_CHECK_EQUAL(driver->length(), 316UL);
+
+    const std::map<size_t, unsigned char> expected_driver = {
+        { 0, 0x80 }, { 10, 0x40 }, { 36, 0x80 }, { 79, 0x20 }, { 110, 0x01 }, { 154, 0x40 }, { 256, 0x10 }, { 314, 0x80 },
+    };
+    BOOST_CHECK(NonZeroBytes(*driver) == expected_driver);
+
+    auto putter = PulseTrainCompiler::Compile(PutterSpec());
+    BOOST_REQUIRE(putter != nullptr);
+    BOOST_CHECK_EQUAL(putter->length(), 2616UL);
+
+    const std::map<size_t, unsigned char> expected_putter = {
+        { 0, 0xFF }, { 36, 0xFF }, { 108, 0xFF }, { 223, 0x3F }, { 224, 0xC0 }, { 374, 0x0F }, { 375, 0xF0 },
+        { 496, 0x01 }, { 497, 0xFE }, { 799, 0x3F }, { 800, 0xC0 }, { 1101, 0x07 }, { 1102, 0xF8 }, { 1404, 0xFF },
+        { 1706, 0x1F }, { 1707, 0xE0 }, { 2008, 0x03 }, { 2009, 0xFC }, { 2311, 0x7F }, { 2312, 0x80 },
+        { 2613, 0x0F }, { 2614, 0xF0 },
+    };
+    BOOST_CHECK(NonZeroBytes(*putter) == expected_putter);
+
+    // A slower SPI clock means fewer bytes for the same times
+    PulseTrainSpec corrected = DriverSpec();
+    corrected.baud_rate_pulse_multiplier = 0.5;
+    auto corrected_driver = PulseTrainCompiler::Compile(corrected);
+    BOOST_REQUIRE(corrected_driver != nullptr);
+    BOOST_CHECK_LT(corrected_driver->length(), driver->length());
+}
+
+BOOST_AUTO_TEST_CASE(InvalidSpecs_AreRejected) {
+    std::string reason;
+    BOOST_CHECK(PulseTrainCompiler::Validate(DriverSpec(), reason));
+
+    auto check_rejected = [](const PulseTrainSpec& spec) {
+        std::string error;
+        BOOST_CHECK(!PulseTrainCompiler::Validate(spec, error));
+        BOOST_CHECK(!error.empty());
+        BOOST_CHECK(PulseTrainCompiler::Compile(spec) == nullptr);
+    };
+
+    PulseTrainSpec spec = DriverSpec();
+    spec.baud_rate = 0;
+    check_rejected(spec);
+
+    spec = DriverSpec();
+    spec.baud_rate_pulse_multiplier = 0.0;
+    check_rejected(spec);
+
+    spec = DriverSpec();
+    spec.intervals_ms.clear();
+    check_rejected(spec);
+
+    spec = DriverSpec();
+    spec.intervals_ms[2] = -1.0F;
+    check_rejected(spec);
+
+    spec = DriverSpec();
+    spec.number_bits_for_on_pulse = 17;
+    check_rejected(spec);
+
+    spec = DriverSpec();
+    spec.bits_per_word = 12;
+    check_rejected(spec);
+
+    // Valid, but far too long to send
+    spec = MakeSpec(115200, { 100000.0F, 0.0F }, 1);
+    BOOST_CHECK(PulseTrainCompiler::Validate(spec, reason));
+    BOOST_CHECK(PulseTrainCompiler::Compile(spec) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Cache_RebuildsOnlyChangedProfiles) {
+    PulseTrainCache cache;
+    BOOST_CHECK(cache.Get(PulseTrainCache::Profile::kFast) == nullptr);
+
+    PulseTrainCache::ProfileSpecs specs = { DriverSpec(), PutterSpec(), MakeSpec(115200, { 444.0F }, 8) };
+    BOOST_REQUIRE(cache.Rebuild(specs));
+
+    const auto fast = cache.Get(PulseTrainCache::Profile::kFast);
+    const auto slow = cache.Get(PulseTrainCache::Profile::kSlow);
+    BOOST_REQUIRE(fast != nullptr && slow != nullptr);
+    BOOST_CHECK(fast->spec == specs[0]);
+    BOOST_CHECK(cache.Get(PulseTrainCache::Profile::kTailRepeat) != nullptr);
+
+    // Only the putter settings change
+    specs[1].baud_rate = 57600;
+    BOOST_REQUIRE(cache.Rebuild(specs));
+    BOOST_CHECK(cache.Get(PulseTrainCache::Profile::kFast) == fast);
+    BOOST_CHECK(cache.Get(PulseTrainCache::Profile::kSlow) != slow);
+    BOOST_CHECK_EQUAL(cache.Get(PulseTrainCache::Profile::kSlow)->spec.baud_rate, 57600UL);
+
+    // The old train is still usable by whoever holds it
+    BOOST_CHECK_EQUAL(slow->length(), 2616UL);
+
+    // An unconfigured profile has no train
+    specs[2].intervals_ms.clear();
+    BOOST_REQUIRE(cache.Rebuild(specs));
+    BOOST_CHECK(cache.Get(PulseTrainCache::Profile::kTailRepeat) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Cache_FailedRebuildKeepsExistingTrains) {
+    PulseTrainCache cache;
+
+    PulseTrainCache::ProfileSpecs specs = { DriverSpec(), PutterSpec(), PulseTrainSpec() };
+    BOOST_REQUIRE(cache.Rebuild(specs));
+    const unsigned long generation = cache.generation();
+    const auto fast = cache.Get(PulseTrainCache::Profile::kFast);
+    const auto slow = cache.Get(PulseTrainCache::Profile::kSlow);
+
+    // The fast train would compile, but the slow one does not
+    PulseTrainCache::ProfileSpecs bad_specs = specs;
+    bad_specs[0].number_bits_for_on_pulse = 2;
+    bad_specs[1].number_bits_for_on_pulse = 0;
+    BOOST_CHECK(!cache.Rebuild(bad_specs));
+
+    BOOST_CHECK_EQUAL(cache.generation(), generation);
+    BOOST_CHECK(cache.Get(PulseTrainCache::Profile::kFast) == fast);
+    BOOST_CHECK(cache.Get(PulseTrainCache::Profile::kSlow) == slow);
+
+    cache.Clear();
+    BOOST_CHECK(cache.Get(PulseTrainCache::Profile::kFast) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark_CompileVersusLookup) {
+    const int kIterations = 2000;
+
+    PulseTrainCache cache;
+    BOOST_REQUIRE(cache.Rebuild({ DriverSpec(), PutterSpec(), PulseTrainSpec() }));
+
+    unsigned long total_length = 0;
+
+    boost::timer::cpu_timer compile_timer;
+    for (int i = 0; i < kIterations; i++) {
+        total_length += PulseTrainCompiler::Compile(PutterSpec())->length();
+    }
+    compile_timer.stop();
+
+    boost::timer::cpu_timer lookup_timer;
+    for (int i = 0; i < kIterations; i++) {
+        total_length += cache.Get(PulseTrainCache::Profile::kSlow)->length();
+    }
+    lookup_timer.stop();
+
+    const double compile_us = compile_timer.elapsed().wall / 1.0e3 / kIterations;
+    const double lookup_us = lookup_timer.elapsed().wall / 1.0e3 / kIterations;
+
+    BOOST_TEST_MESSAGE("Putter pulse train: compile " << compile_us << " us, cached lookup " << lookup_us << " us");
+
+    BOOST_CHECK_EQUAL(total_length, 2UL * kIterations * 2616UL);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,516 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_spin_scoring.cpp
+ * @brief Equivalence tests for the spin-analysis candidate scoring backends
+ *
+ * The SpinSearchEngine projections and the bit-packed SpinBitplaneScorer must
+ * produce exactly the same pixels_matching / pixels_examined counts as the
+ * reference Project2dImageTo3dBall + CompareRotationImage path, or the chosen
+ * spin axis would silently change.  Also checks that independent spin analyses
+ * can run concurrently on the shared work-stealing pool, and that the cached
+ * Gabor filter bank matches filtering with each of its kernels in turn.
+ */
+
+#define BOOST_TEST_MODULE SpinScoringTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "ball_image_proc.h"
+#include "spin_search_engine.h"
+#include "spin_bitplane_scorer.h"
+#include "spin_analysis_context.h"
+#include "work_stealing_pool.h"
+#include "spin_remap_cache.h"
+#include "gabor_filter_bank.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <future>
+
+using namespace golf_sim;
+using namespace golf_sim::testing;
+
+namespace {
+
+// Reduces a gray ball image to the 0/255/ignore form that GetBallRotation scores
+cv::Mat MakeDimpleEdgeImage(const cv::Mat& gray, const GolfBall& ball) {
+    cv::Mat edges;
+    cv::adaptiveThreshold(gray, edges, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 7, 0);
+
+    cv::Mat mask = cv::Mat::zeros(edges.size(), CV_8UC1);
+    cv::circle(mask, cv::Point((int)ball.x(), (int)ball.y()), (int)(ball.measured_radius_pixels_ * 0.92), cv::Scalar(255), -1);
+    edges.setTo(cv::Scalar(kPixelIgnoreValue), mask == 0);
+
+    // Stand in for a couple of removed reflections inside the ball
+    cv::circle(edges, cv::Point((int)ball.x() - 10, (int)ball.y() - 12), 4, cv::Scalar(kPixelIgnoreValue), -1);
+    return edges;
+}
+
+GolfBall MakeCenteredBall(const cv::Mat& img) {
+    GolfBall ball;
+    ball.set_x((float)(img.cols / 2));
+    ball.set_y((float)(img.rows / 2));
+    // Keep the radius on the remap cache's quarter-pixel grid, so that snapping the geometry
+    // for the cache does not move the ball away from the reference projection's
+    ball.measured_radius_pixels_ = std::round(((img.cols / 2) / 1.05) * 4.0) / 4.0;
+    ball.ball_circle_[2] = (float)ball.measured_radius_pixels_;
+    return ball;
+}
+
+const std::vector<cv::Vec3i> kTestRotations = {
+    { 0, 0, 0 }, { 4, 0, 0 }, { 0, -5, 0 }, { 0, 0, 12 },
+    { -36, -15, -10 }, { 20, 5, 44 }, { 36, 15, 110 }, { -8, 10, 60 },
+};
+
+void CheckScoringEquivalence(const cv::Mat& base_edges, const cv::Mat& target_edges, const GolfBall& ball) {
+    // When two source pixels rotate onto the same destination, the reference projection keeps
+    // whichever was written last.  Run it serially so that "last" is deterministic.
+    const int saved_threads = cv::getNumThreads();
+    cv::setNumThreads(1);
+
+    SpinSearchEngine engine(base_edges, ball);
+    BOOST_REQUIRE(engine.IsBitplaneCompatible());
+
+    SpinBitplanes target_planes;
+    BOOST_REQUIRE(SpinBitplaneScorer::PackImage(target_edges, target_planes));
+
+    for (const auto& rotation : kTestRotations) {
+        BOOST_TEST_CONTEXT("rotation " << rotation) {
+            // Reference path
+            cv::Mat reference_projection = BallImageProc::Project2dImageTo3dBall(base_edges, ball, rotation);
+            cv::Vec2i reference = BallImageProc::CompareRotationImage(target_edges, reference_projection);
+
+            // Precomputed hemisphere, full image projection
+            cv::Mat engine_projection;
+            engine.ProjectCandidate(rotation, engine_projection);
+            cv::Vec2i engine_result = BallImageProc::CompareRotationImage(target_edges, engine_projection);
+
+            // Precomputed hemisphere, bitplane projection
+            SpinBitplanes candidate_planes;
+            engine.ProjectCandidate(SpinSearchEngine::CompactRotation::FromDegrees(rotation), candidate_planes);
+            cv::Vec2i bitplane_result = SpinBitplaneScorer::Compare(target_planes, candidate_planes);
+
+            // Bitplanes packed from the reference projection
+            SpinBitplanes packed_reference;
+            BOOST_REQUIRE(SpinBitplaneScorer::PackProjection(reference_projection, packed_reference));
+            cv::Vec2i packed_result = SpinBitplaneScorer::Compare(target_planes, packed_reference);
+
+            // Remap-table gather - the first call builds and caches the table, the second re-uses it
+            std::vector<SpinRemapTables::Index> remap_scratch;
+            SpinBitplanes built_planes;
+            SpinBitplanes cached_planes;
+            engine.ProjectCandidate(rotation, built_planes, remap_scratch);
+            engine.ProjectCandidate(rotation, cached_planes, remap_scratch);
+            cv::Vec2i built_result = SpinBitplaneScorer::Compare(target_planes, built_planes);
+            cv::Vec2i cached_result = SpinBitplaneScorer::Compare(target_planes, cached_planes);
+
+            BOOST_CHECK_GT(reference[1], 0);
+            BOOST_CHECK_EQUAL(engine_result[0], reference[0]);
+            BOOST_CHECK_EQUAL(engine_result[1], reference[1]);
+            BOOST_CHECK_EQUAL(bitplane_result[0], reference[0]);
+            BOOST_CHECK_EQUAL(bitplane_result[1], reference[1]);
+            BOOST_CHECK_EQUAL(packed_result[0], reference[0]);
+            BOOST_CHECK_EQUAL(packed_result[1], reference[1]);
+            BOOST_CHECK_EQUAL(built_result[0], reference[0]);
+            BOOST_CHECK_EQUAL(built_result[1], reference[1]);
+            BOOST_CHECK_EQUAL(cached_result[0], reference[0]);
+            BOOST_CHECK_EQUAL(cached_result[1], reference[1]);
+        }
+    }
+
+    cv::setNumThreads(saved_threads);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(SpinScoringTests)
+
+BOOST_FIXTURE_TEST_CASE(BitplaneScoringMatchesReference_ApprovalBallImages, OpenCVTestFixture) {
+    auto artifacts = TestPaths::GetImageAnalysisApprovalArtifactsDir();
+    if (artifacts.empty()) {
+        BOOST_TEST_MESSAGE("ImageAnalysis approval artifacts not found - skipping");
+        return;
+    }
+
+    cv::Mat ball1 = cv::imread((artifacts / "spin_ball_1_gray_image1.approved.png").string(), cv::IMREAD_GRAYSCALE);
+    cv::Mat ball2 = cv::imread((artifacts / "spin_ball_2_gray_image1.approved.png").string(), cv::IMREAD_GRAYSCALE);
+    BOOST_REQUIRE(!ball1.empty());
+    BOOST_REQUIRE(!ball2.empty());
+    BOOST_REQUIRE_EQUAL(ball1.size(), ball2.size());
+
+    GolfBall ball = MakeCenteredBall(ball1);
+    CheckScoringEquivalence(MakeDimpleEdgeImage(ball1, ball), MakeDimpleEdgeImage(ball2, ball), ball);
+}
+
+BOOST_FIXTURE_TEST_CASE(BitplaneScoringMatchesReference_SyntheticNoise, OpenCVTestFixture) {
+    cv::RNG rng(0x5EED);
+
+    // Odd sizes exercise the padding at the end of the packed words
+    for (int size : { 57, 112, 131 }) {
+        cv::Mat base(size, size, CV_8UC1);
+        cv::Mat target(size, size, CV_8UC1);
+        rng.fill(base, cv::RNG::UNIFORM, 0, 256);
+        rng.fill(target, cv::RNG::UNIFORM, 0, 256);
+        cv::threshold(base, base, 127, 255, cv::THRESH_BINARY);
+        cv::threshold(target, target, 127, 255, cv::THRESH_BINARY);
+
+        GolfBall ball = MakeCenteredBall(base);
+        cv::Mat mask = cv::Mat::zeros(base.size(), CV_8UC1);
+        cv::circle(mask, cv::Point((int)ball.x(), (int)ball.y()), (int)(ball.measured_radius_pixels_ * 0.92), cv::Scalar(255), -1);
+        base.setTo(cv::Scalar(kPixelIgnoreValue), mask == 0);
+        target.setTo(cv::Scalar(kPixelIgnoreValue), mask == 0);
+
+        BOOST_TEST_CONTEXT("size " << size) {
+            CheckScoringEquivalence(base, target, ball);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ScoreCandidates_SameResultsForBothBackends) {
+    cv::RNG rng(42);
+    cv::Mat base(96, 96, CV_8UC1);
+    cv::Mat target(96, 96, CV_8UC1);
+    rng.fill(base, cv::RNG::UNIFORM, 0, 2);
+    rng.fill(target, cv::RNG::UNIFORM, 0, 2);
+    base *= 255;
+    target *= 255;
+
+    GolfBall ball = MakeCenteredBall(base);
+    SpinSearchEngine engine(base, ball);
+
+    BallImageProc::RotationSearchSpace space;
+    space.anglex_rotation_degrees_increment = 6;
+    space.anglex_rotation_degrees_start = -12;
+    space.anglex_rotation_degrees_end = 12;
+    space.angley_rotation_degrees_increment = 5;
+    space.angley_rotation_degrees_start = -5;
+    space.angley_rotation_degrees_end = 5;
+    space.anglez_rotation_degrees_increment = 10;
+    space.anglez_rotation_degrees_start = -10;
+    space.anglez_rotation_degrees_end = 30;
+
+    cv::Mat elements;
+    cv::Vec3i elements_size;
+    std::vector<RotationCandidate> bitplane_candidates;
+    engine.BuildCandidates(space, elements, elements_size, bitplane_candidates);
+    std::vector<RotationCandidate> image_candidates = bitplane_candidates;
+    BOOST_REQUIRE_EQUAL(bitplane_candidates.size(), (size_t)(elements_size[0] * elements_size[1] * elements_size[2]));
+
+    const bool saved_setting = BallImageProc::kUseBitplaneSpinScoring;
+    std::vector<std::string> csv_bitplanes;
+    std::vector<std::string> csv_images;
+
+    BallImageProc::kUseBitplaneSpinScoring = true;
+    engine.ScoreCandidates(target, bitplane_candidates, csv_bitplanes);
+    BallImageProc::kUseBitplaneSpinScoring = false;
+    engine.ScoreCandidates(target, image_candidates, csv_images);
+    BallImageProc::kUseBitplaneSpinScoring = saved_setting;
+
+    for (size_t i = 0; i < bitplane_candidates.size(); i++) {
+        BOOST_CHECK_EQUAL(bitplane_candidates[i].pixels_matching, image_candidates[i].pixels_matching);
+        BOOST_CHECK_EQUAL(bitplane_candidates[i].pixels_examined, image_candidates[i].pixels_examined);
+    }
+    BOOST_CHECK(csv_bitplanes == csv_images);
+    BOOST_CHECK_EQUAL(BallImageProc::SelectBestCandidate(bitplane_candidates),
+                      BallImageProc::SelectBestCandidate(image_candidates));
+}
+
+BOOST_AUTO_TEST_CASE(PackImage_RejectsNonBinaryPixels) {
+    cv::Mat img(16, 16, CV_8UC1, cv::Scalar(255));
+    img.at<uchar>(3, 4) = 37;
+
+    SpinBitplanes planes;
+    BOOST_CHECK(!SpinBitplaneScorer::PackImage(img, planes));
+
+    img.at<uchar>(3, 4) = kPixelIgnoreValue;
+    BOOST_CHECK(SpinBitplaneScorer::PackImage(img, planes));
+    BOOST_TEST_MESSAGE("SpinBitplaneScorer backend: " << SpinBitplaneScorer::BackendName());
+}
+
+BOOST_AUTO_TEST_CASE(SpinRemapCache_SavedTablesAreMappedAndReused) {
+    auto cache_dir = std::filesystem::temp_directory_path() / "pitrac_spin_remap_test";
+    std::filesystem::remove_all(cache_dir);
+    std::filesystem::create_directories(cache_dir);
+
+    const bool saved_use_cache = BallImageProc::kUseSpinRemapCache;
+    const bool saved_save_to_disk = BallImageProc::kSaveSpinRemapCacheToDisk;
+    const std::string saved_directory = BallImageProc::kSpinRemapCacheDirectory;
+    BallImageProc::kUseSpinRemapCache = true;
+    BallImageProc::kSaveSpinRemapCacheToDisk = true;
+    BallImageProc::kSpinRemapCacheDirectory = cache_dir.string();
+    SpinRemapCache::GetSharedCache().Clear();
+
+    cv::RNG rng(99);
+    cv::Mat base(70, 70, CV_8UC1);
+    cv::Mat target(70, 70, CV_8UC1);
+    rng.fill(base, cv::RNG::UNIFORM, 0, 2);
+    rng.fill(target, cv::RNG::UNIFORM, 0, 2);
+    base *= 255;
+    target *= 255;
+    GolfBall ball = MakeCenteredBall(base);
+
+    SpinBitplanes target_planes;
+    BOOST_REQUIRE(SpinBitplaneScorer::PackImage(target, target_planes));
+
+    const cv::Vec3i rotation(12, -5, 40);
+    std::vector<SpinRemapTables::Index> remap_scratch;
+    SpinBitplanes planes;
+    cv::Vec2i first_result;
+    {
+        SpinSearchEngine engine(base, ball);
+        BOOST_REQUIRE(engine.GetRemapTables() != nullptr);
+        BOOST_CHECK(engine.GetRemapTables()->Find(rotation) == nullptr);
+
+        engine.ProjectCandidate(rotation, planes, remap_scratch);
+        first_result = SpinBitplaneScorer::Compare(target_planes, planes);
+        BOOST_CHECK(engine.GetRemapTables()->Find(rotation) != nullptr);
+    }
+
+    SpinRemapCache::GetSharedCache().SaveToDisk(cache_dir.string());
+    SpinRemapCache::GetSharedCache().Clear();
+    SpinRemapCache::GetSharedCache().LoadFromDisk(cache_dir.string());
+
+    {
+        // A new engine for a ball of the same geometry should find the table without building it
+        SpinSearchEngine engine(base, ball);
+        BOOST_REQUIRE(engine.GetRemapTables() != nullptr);
+        BOOST_CHECK(engine.GetRemapTables()->Find(rotation) != nullptr);
+        BOOST_CHECK_EQUAL(SpinRemapCache::GetSharedCache().GetCachedBytes(), 0u);
+
+        engine.ProjectCandidate(rotation, planes, remap_scratch);
+        cv::Vec2i mapped_result = SpinBitplaneScorer::Compare(target_planes, planes);
+        BOOST_CHECK_EQUAL(mapped_result[0], first_result[0]);
+        BOOST_CHECK_EQUAL(mapped_result[1], first_result[1]);
+    }
+
+    SpinRemapCache::GetSharedCache().Clear();
+    BallImageProc::kUseSpinRemapCache = saved_use_cache;
+    BallImageProc::kSaveSpinRemapCacheToDisk = saved_save_to_disk;
+    BallImageProc::kSpinRemapCacheDirectory = saved_directory;
+    std::filesystem::remove_all(cache_dir);
+}
+
+BOOST_AUTO_TEST_CASE(SpinRemapTables_RejectsCorruptAndTornFiles) {
+    auto cache_dir = std::filesystem::temp_directory_path() / "pitrac_spin_remap_corrupt_test";
+    std::filesystem::remove_all(cache_dir);
+    std::filesystem::create_directories(cache_dir);
+    SpinRemapCache::GetSharedCache().Clear();
+
+    SpinRemapGeometry geometry;
+    geometry.rows = 8;
+    geometry.cols = 8;
+    geometry.center_x_steps = 4;
+    geometry.center_y_steps = 4;
+    geometry.radius_steps = 3;
+    const std::filesystem::path path = cache_dir / geometry.FileName();
+
+    auto make_table = [&](SpinRemapTables::Index shift) {
+        std::vector<SpinRemapTables::Index> table(geometry.rows * geometry.cols);
+        for (size_t i = 0; i < table.size(); i++) {
+            table[i] = (SpinRemapTables::Index)((i + shift) % table.size());
+        }
+        table[0] = SpinRemapTables::kNoDestination;
+        return table;
+    };
+
+    const cv::Vec3i first_rotation(10, 0, 0);
+    const cv::Vec3i second_rotation(0, 20, 0);
+    {
+        SpinRemapTables tables(geometry);
+        BOOST_REQUIRE(tables.Insert(first_rotation, make_table(1)) != nullptr);
+        BOOST_REQUIRE(tables.SaveToDisk(cache_dir.string()));
+    }
+
+    // A save that was cut short leaves part of a record at the end of the file
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.write("torn", 4);
+    }
+
+    {
+        SpinRemapTables tables(geometry);
+        BOOST_REQUIRE(tables.LoadFromDisk(cache_dir.string()));
+        BOOST_CHECK(tables.Find(first_rotation) != nullptr);
+        BOOST_REQUIRE(tables.Insert(second_rotation, make_table(2)) != nullptr);
+        BOOST_REQUIRE(tables.SaveToDisk(cache_dir.string()));
+    }
+
+    // The new record must not have been shifted by the torn one
+    {
+        SpinRemapTables tables(geometry);
+        BOOST_REQUIRE(tables.LoadFromDisk(cache_dir.string()));
+        BOOST_REQUIRE(tables.Find(first_rotation) != nullptr);
+        const SpinRemapTables::Index* second_table = tables.Find(second_rotation);
+        BOOST_REQUIRE(second_table != nullptr);
+
+        const std::vector<SpinRemapTables::Index> expected = make_table(2);
+        BOOST_CHECK(std::equal(expected.begin(), expected.end(), second_table));
+    }
+
+    // An entry that is neither a pixel nor kNoDestination would be an out-of-bounds write
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-(std::streamoff)sizeof(SpinRemapTables::Index), std::ios::end);
+        const SpinRemapTables::Index bad_entry = 1000;
+        file.write((const char*)&bad_entry, sizeof(bad_entry));
+    }
+
+    {
+        SpinRemapTables tables(geometry);
+        BOOST_CHECK(!tables.LoadFromDisk(cache_dir.string()));
+        BOOST_CHECK(tables.Find(first_rotation) == nullptr);
+        BOOST_CHECK(tables.Find(second_rotation) == nullptr);
+    }
+
+    SpinRemapCache::GetSharedCache().Clear();
+    std::filesystem::remove_all(cache_dir);
+}
+
+BOOST_AUTO_TEST_CASE(WorkStealingPool_CoversRangeExactlyOnce) {
+    WorkStealingPool pool(3);
+    const int kCount = 10007;
+    std::vector<std::atomic<int>> visits(kCount);
+
+    // Several callers at once, each also nesting a ParallelFor inside its chunks
+    auto run = [&](int offset) {
+        pool.ParallelFor(0, kCount / 4, [&](int begin, int end) {
+            pool.ParallelFor(begin, end, [&](int inner_begin, int inner_end) {
+                for (int i = inner_begin; i < inner_end; i++) {
+                    visits[(i * 4 + offset) % kCount]++;
+                }
+            }, 7);
+        }, 50);
+    };
+
+    std::vector<std::future<void>> callers;
+    for (int offset = 0; offset < 4; offset++) {
+        callers.push_back(std::async(std::launch::async, run, offset));
+    }
+    for (auto& caller : callers) {
+        caller.get();
+    }
+
+    int total = 0;
+    for (int i = 0; i < kCount; i++) {
+        BOOST_CHECK_LE(visits[i].load(), 1);
+        total += visits[i].load();
+    }
+    BOOST_CHECK_EQUAL(total, 4 * (kCount / 4));
+}
+
+BOOST_AUTO_TEST_CASE(WorkStealingPool_PropagatesExceptions) {
+    WorkStealingPool pool(2);
+
+    BOOST_CHECK_THROW(pool.ParallelFor(0, 100, [](int begin, int end) {
+        if (begin <= 42 && 42 < end) {
+            throw std::runtime_error("chunk failed");
+        }
+    }, 5), std::runtime_error);
+
+    // The pool must still be usable afterward
+    std::atomic<int> sum{ 0 };
+    pool.ParallelFor(0, 100, [&](int begin, int end) { sum += end - begin; }, 5);
+    BOOST_CHECK_EQUAL(sum.load(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(SpinAnalysisContext_ConcurrentAnalysesMatchSerial) {
+    cv::RNG rng(7);
+    const int kNumShots = 4;
+
+    std::vector<cv::Mat> bases;
+    std::vector<cv::Mat> targets;
+    for (int i = 0; i < kNumShots; i++) {
+        cv::Mat base(80, 80, CV_8UC1);
+        cv::Mat target(80, 80, CV_8UC1);
+        rng.fill(base, cv::RNG::UNIFORM, 0, 2);
+        rng.fill(target, cv::RNG::UNIFORM, 0, 2);
+        bases.push_back(base * 255);
+        targets.push_back(target * 255);
+    }
+    GolfBall ball = MakeCenteredBall(bases[0]);
+
+    BallImageProc::RotationSearchSpace space;
+    space.anglex_rotation_degrees_increment = 6;
+    space.anglex_rotation_degrees_start = -18;
+    space.anglex_rotation_degrees_end = 18;
+    space.angley_rotation_degrees_increment = 5;
+    space.angley_rotation_degrees_start = -10;
+    space.angley_rotation_degrees_end = 10;
+    space.anglez_rotation_degrees_increment = 10;
+    space.anglez_rotation_degrees_start = -20;
+    space.anglez_rotation_degrees_end = 60;
+
+    auto analyze = [&](int shot) {
+        SpinAnalysisContext context(bases[shot], ball, targets[shot]);
+        SpinAnalysisContext::SearchPass pass;
+        context.RunSearchPass(space, pass);
+        return pass;
+    };
+
+    std::vector<SpinAnalysisContext::SearchPass> serial;
+    for (int shot = 0; shot < kNumShots; shot++) {
+        serial.push_back(analyze(shot));
+    }
+
+    std::vector<std::future<SpinAnalysisContext::SearchPass>> concurrent;
+    for (int shot = 0; shot < kNumShots; shot++) {
+        concurrent.push_back(std::async(std::launch::async, analyze, shot));
+    }
+
+    for (int shot = 0; shot < kNumShots; shot++) {
+        SpinAnalysisContext::SearchPass pass = concurrent[shot].get();
+
+        BOOST_TEST_CONTEXT("shot " << shot) {
+            BOOST_CHECK_EQUAL(pass.best_candidate_index, serial[shot].best_candidate_index);
+            BOOST_REQUIRE_EQUAL(pass.candidates.size(), serial[shot].candidates.size());
+            BOOST_CHECK(pass.comparison_csv_data == serial[shot].comparison_csv_data);
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(GaborFilterBank_MatchesDirectFiltering, OpenCVTestFixture) {
+    // A dimple-like texture, with some noise
+    cv::Mat gray(117, 131, CV_8UC1);
+    cv::RNG rng(1234);
+    rng.fill(gray, cv::RNG::UNIFORM, 0, 256);
+    cv::GaussianBlur(gray, gray, cv::Size(5, 5), 1.5);
+
+    cv::Mat img_f32;
+    gray.convertTo(img_f32, CV_32F, 1.0 / 255, 0);
+
+    GaborFilterBank::Parameters parameters = BallImageProc::GetGaborParameters(21, 1.0, 6.0, 270.0, 0.2);
+    std::shared_ptr<const GaborFilterBank> bank = GaborFilterBank::GetBank(parameters);
+
+    BOOST_CHECK(bank == GaborFilterBank::GetBank(parameters));
+    BOOST_CHECK_EQUAL(bank->orientation_count(), 33u);
+    BOOST_CHECK_LE(bank->distinct_kernel_count(), 16u);
+
+    cv::Mat direct = bank->ComputeMaxResponseDirect(img_f32);
+    cv::Mat banked = bank->ComputeMaxResponse(img_f32);
+    BOOST_REQUIRE(banked.size() == direct.size());
+    BOOST_CHECK_LT(cv::norm(banked, direct, cv::NORM_INF), 1e-4);
+
+    // Only values right at a rounding boundary can come out differently in 8 bits
+    cv::Mat direct_gray = GaborFilterBank::ResponseTo8U(direct);
+    cv::Mat banked_gray = GaborFilterBank::ResponseTo8U(banked);
+    BOOST_CHECK_LE(cv::norm(banked_gray, direct_gray, cv::NORM_INF), 1.0);
+    BOOST_CHECK_LT(cv::countNonZero(banked_gray != direct_gray), (int)(banked_gray.total() / 100));
+
+    // The histogram must give the same white percentage as actually thresholding
+    GaborFilterBank::Histogram histogram = GaborFilterBank::ComputeHistogram(banked_gray);
+    for (float binary_threshold = 1.0F; binary_threshold <= 31.0F; binary_threshold += 0.5F) {
+        int white_percent = 0;
+        cv::Mat edges = BallImageProc::ApplyTestGaborFilter(img_f32, 21, 1.0, 6.0, 240.0, 270.0, 0.2, binary_threshold, white_percent);
+
+        BOOST_TEST_CONTEXT("binary_threshold " << binary_threshold) {
+            BOOST_CHECK_EQUAL(GaborFilterBank::WhitePercent(histogram, BallImageProc::GaborEdgeThreshold(binary_threshold)), white_percent);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
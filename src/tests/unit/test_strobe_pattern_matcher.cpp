@@ -0,0 +1,359 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_strobe_pattern_matcher.cpp
+ * @brief Unit tests for matching ball spacings to the strobe pulse pattern
+ *
+ * StrobePatternMatcher replaces the brute-force enumeration of collapsed pulse
+ * patterns in GolfSimCamera::DetermineStrobeIntervals.  These tests run a corpus of
+ * synthesized ball spacings (and a larger set of randomized ones) through both the
+ * matcher and a copy of the original enumeration, and check that they choose the
+ * same collapsed pulse intervals and offset.
+ */
+
+#define BOOST_TEST_MODULE StrobePatternMatcherTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "strobe_pattern_matcher.h"
+#include <bitset>
+#include <boost/timer/timer.hpp>
+#include <cmath>
+#include <random>
+#include <string>
+
+using namespace golf_sim;
+
+namespace {
+
+// The default strobe pulse vectors in golf_sim_config.json
+const std::vector<float> kDriverPulseIntervals = { 0.7F, 1.8F, 3.0F, 2.2F, 3.0F, 7.1F, 4.0F, 0.0F };
+const std::vector<float> kPutterPulseIntervals = { 2.5F, 5.0F, 8.0F, 10.5F, 8.5F, 21.0F, 21.0F, 21.0F, 21.0F, 21.0F, 21.0F, 21.0F, 0.0F };
+
+struct SpacingSample {
+    std::string club;
+    std::vector<double> spacings_px;
+};
+
+// Synthesized pixel distances between successive strobed ball images, NOT recorded from real
+// shots.  Each sample is the default driver or putter pulse vector scaled by a ball speed, with
+// about a percent of noise, and with some of the exposures removed, as happens when the first
+// ball images overlap or the ball leaves the frame.  Spacings recorded from real shots should
+// replace these once they are available.
+const std::vector<SpacingSample> kSpacingCorpus = {
+    { "driver", { 178.3, 213.1, 157.2, 211.1, 774.7 } },   // missing pulse(s) 1,6
+    { "driver", { 113.4, 82.5, 111.8, 260.1, 148.5 } },   // missing pulse(s) 0,1
+    { "driver", { 137.5, 234.7, 164.7, 230.1, 549.4 } },   // missing pulse(s) 0,7
+    { "driver", { 160.6, 117.8, 161.1, 380.3, 213.8 } },   // missing pulse(s) 0,1
+    { "driver", { 38.9, 101.1, 175.3, 122.7, 583.8 } },   // missing pulse(s) 5,7
+    { "driver", { 161.8, 265.2, 199.2, 267.5, 647.6 } },   // missing pulse(s) 0,7
+    { "driver", { 83.0, 137.8, 101.3, 137.8, 326.4 } },   // missing pulse(s) 0,7
+    { "driver", { 120.8, 204.3, 147.6, 203.6, 485.5, 266.7 } },   // missing pulse(s) 0
+    { "driver", { 247.1, 183.5, 248.8, 590.3, 330.5 } },   // missing pulse(s) 0,1
+    { "driver", { 161.0, 191.9, 145.7, 191.2, 442.9, 251.3 } },   // missing pulse(s) 1
+    { "putter", { 40.5, 65.6, 85.4, 68.3, 169.4, 164.0, 164.2, 163.7, 162.2, 162.5 } },   // missing pulse(s) 0,12
+    { "putter", { 20.5, 31.8, 41.9, 34.1, 83.5, 78.0, 76.0, 72.5, 71.5, 68.1, 65.0 } },   // missing pulse(s) 0
+    { "putter", { 12.5, 24.0, 39.8, 50.4, 38.9, 95.1, 90.8, 87.8, 81.6 } },   // missing pulse(s) 10,11,12
+    { "putter", { 18.1, 28.8, 38.8, 29.9, 72.9, 70.2, 63.9, 60.6, 55.7, 53.7 } },   // missing pulse(s) 0,12
+    { "putter", { 15.3, 31.0, 49.7, 64.2, 52.4, 129.1, 128.2, 127.5, 126.8 } },   // missing pulse(s) 10,11,12
+    { "putter", { 12.3, 24.0, 38.0, 49.8, 39.3, 94.7, 92.4, 87.9, 84.7 } },   // missing pulse(s) 10,11,12
+    { "putter", { 26.8, 43.5, 56.1, 45.5, 111.7, 107.8, 109.5, 105.7, 104.7, 103.8, 101.0 } },   // missing pulse(s) 0
+    { "putter", { 19.3, 37.2, 60.8, 77.7, 62.8, 153.0, 148.5, 146.5 } },   // missing pulse(s) 9,10,11,12
+};
+
+struct LegacyResult {
+    bool found = false;
+    std::vector<float> pulse_intervals_ms;
+    int ratio_offset = -1;
+    double score = 0.0;
+};
+
+// The collapsing, scoring and search from GolfSimCamera::DetermineStrobeIntervals as it
+// was before StrobePatternMatcher (without the logging)
+void LegacyCollapse(const std::vector<float>& initial_intervals, int offset, std::vector<float>& intervals) {
+    intervals = initial_intervals;
+    intervals[offset] += intervals[offset + 1];
+    intervals.erase(intervals.begin() + offset + 1);
+}
+
+void LegacyIntervalsAndRatios(const std::vector<bool>& intervals_to_collapse, const std::vector<float>& pulse_intervals_ms,
+                              std::vector<float>& pulse_intervals, std::vector<double>& pulse_ratios) {
+    std::vector<float> current = pulse_intervals_ms;
+    int number_collapsed_so_far = 0;
+
+    for (int v = 0; v < (int)intervals_to_collapse.size() - 1; v++) {
+        if (intervals_to_collapse[v]) {
+            LegacyCollapse(current, v - number_collapsed_so_far, pulse_intervals);
+            pulse_ratios.clear();
+            for (size_t i = 0; i < pulse_intervals.size() - 1; i++) {
+                pulse_ratios.push_back((double)pulse_intervals[i + 1] / (double)pulse_intervals[i]);
+            }
+            number_collapsed_so_far++;
+            current = pulse_intervals;
+        }
+    }
+}
+
+int LegacyFindClosestOffset(const std::vector<double>& distance_ratios, const std::vector<double>& pulse_ratios, double& delta) {
+    delta = 99999.0;
+    int closest_offset = -1;
+
+    if (pulse_ratios.size() < distance_ratios.size()) {
+        return -1;
+    }
+
+    for (int offset = 0; offset < (int)(pulse_ratios.size() - distance_ratios.size()); offset++) {
+        double difference = 0;
+        for (size_t i = 0; i < distance_ratios.size(); i++) {
+            double single = 100. * std::abs(distance_ratios[i] - pulse_ratios[i + offset]);
+            if (single > 1000.0) {
+                single = 1000.0;
+            }
+            difference += pow(single, 2);
+        }
+
+        if (difference < delta) {
+            delta = difference;
+            closest_offset = offset;
+        }
+    }
+
+    return closest_offset;
+}
+
+LegacyResult LegacyMatch(const std::vector<float>& pulse_intervals_ms, const std::vector<double>& distance_ratios, int number_ball_exposures) {
+    LegacyResult result;
+
+    const int number_of_strobes = (int)pulse_intervals_ms.size();
+    const int number_missed_exposures = number_of_strobes - number_ball_exposures;
+
+    std::vector<bool> combinations_vector(number_of_strobes - 1, false);
+    std::vector<std::vector<bool>> candidates;
+
+    for (int i = 0; i < (1 << number_of_strobes) - 1; ++i) {
+        if (std::bitset<32>(i).count() == (size_t)number_missed_exposures) {
+            std::bitset<512> bit_array(i);
+            for (int b = 0; b < (int)combinations_vector.size(); ++b) {
+                combinations_vector[combinations_vector.size() - b - 1] = (bit_array[b] == 1);
+            }
+            candidates.push_back(combinations_vector);
+        }
+    }
+
+    double best_ratio_distance = 999999.;
+    int best_index = -1;
+
+    for (int i = 0; i < (int)candidates.size(); i++) {
+        std::vector<double> pulse_ratios;
+        std::vector<float> pulse_intervals;
+        LegacyIntervalsAndRatios(candidates[i], pulse_intervals_ms, pulse_intervals, pulse_ratios);
+
+        double delta;
+        int offset = LegacyFindClosestOffset(distance_ratios, pulse_ratios, delta);
+
+        if (offset >= 0 && delta <= best_ratio_distance) {
+            best_ratio_distance = delta;
+            best_index = i;
+            result.ratio_offset = offset;
+            result.pulse_intervals_ms = pulse_intervals;
+        }
+    }
+
+    result.found = (best_index >= 0);
+    result.score = best_ratio_distance;
+    return result;
+}
+
+std::vector<double> DistanceRatios(const std::vector<double>& spacings_px) {
+    std::vector<double> ratios;
+    for (size_t i = 0; i + 1 < spacings_px.size(); i++) {
+        ratios.push_back(spacings_px[i + 1] / spacings_px[i]);
+    }
+    return ratios;
+}
+
+void CheckMatchesLegacy(const StrobePatternMatcher& matcher, const std::vector<double>& spacings_px) {
+    const std::vector<float>& pulse_intervals = matcher.pulse_intervals_ms();
+    const std::vector<double> distance_ratios = DistanceRatios(spacings_px);
+    const int number_ball_exposures = (int)spacings_px.size() + 1;
+
+    const LegacyResult legacy = LegacyMatch(pulse_intervals, distance_ratios, number_ball_exposures);
+
+    StrobePatternMatcher::Match match;
+    const bool found = matcher.FindBestMatch(distance_ratios, (int)pulse_intervals.size() - number_ball_exposures, match);
+
+    BOOST_REQUIRE_EQUAL(found, legacy.found);
+    if (found) {
+        BOOST_CHECK_EQUAL(match.ratio_offset, legacy.ratio_offset);
+        BOOST_CHECK(match.pulse_intervals_ms == legacy.pulse_intervals_ms);
+        BOOST_CHECK_EQUAL(match.score, legacy.score);
+    }
+}
+
+// Spacings for a ball moving at a constant speed, with the given pulses missing, and
+// some noise in the measured distances
+std::vector<double> SimulatedSpacings(const std::vector<float>& pulse_intervals, const std::vector<bool>& missing_pulses,
+                                      double speed_px_per_ms, double noise, std::mt19937& generator) {
+    std::normal_distribution<double> noise_distribution(0.0, noise);
+    std::vector<double> spacings;
+
+    double time_since_last_exposure = 0.0;
+    bool seen_first = false;
+    for (size_t pulse = 0; pulse < pulse_intervals.size(); pulse++) {
+        if (!missing_pulses[pulse]) {
+            if (seen_first) {
+                spacings.push_back(speed_px_per_ms * time_since_last_exposure * (1.0 + noise_distribution(generator)));
+            }
+            seen_first = true;
+            time_since_last_exposure = 0.0;
+        }
+        time_since_last_exposure += pulse_intervals[pulse];
+    }
+
+    return spacings;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(StrobePatternMatcherTests)
+
+BOOST_AUTO_TEST_CASE(Corpus_MatchesTheOriginalEnumeration) {
+    StrobePatternMatcher driver_matcher(kDriverPulseIntervals);
+    StrobePatternMatcher putter_matcher(kPutterPulseIntervals);
+
+    for (size_t i = 0; i < kSpacingCorpus.size(); i++) {
+        const SpacingSample& sample = kSpacingCorpus[i];
+        BOOST_TEST_CONTEXT("Corpus sample " << i << " (" << sample.club << ")") {
+            CheckMatchesLegacy(sample.club == "putter" ? putter_matcher : driver_matcher, sample.spacings_px);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Corpus_FindsTheMissingPulses) {
+    // Sample 1 of the corpus is a driver shot without the first two pulses
+    StrobePatternMatcher matcher(kDriverPulseIntervals);
+
+    StrobePatternMatcher::Match match;
+    BOOST_REQUIRE(matcher.FindBestMatch(DistanceRatios(kSpacingCorpus[1].spacings_px), 2, match));
+
+    // The first pulse ratio is skipped, and the first two intervals are collapsed into one
+    BOOST_CHECK_EQUAL(match.ratio_offset, 1);
+    BOOST_REQUIRE_EQUAL(match.pulse_intervals_ms.size(), 7U);
+    BOOST_CHECK_CLOSE(match.pulse_intervals_ms[0], 0.7F + 1.8F, 1e-4);
+    BOOST_CHECK_CLOSE(match.pulse_intervals_ms[1], 3.0F, 1e-4);
+    BOOST_CHECK_LT(match.score, StrobePatternMatcher::kMaxMatchScore);
+    BOOST_CHECK_CLOSE(match.score, StrobePatternMatcher::ComputeRatioDistance(DistanceRatios(kSpacingCorpus[1].spacings_px),
+                                                                              { 3.0 / 2.5, 2.2 / 3.0, 3.0 / 2.2, 7.1 / 3.0, 4.0 / 7.1, 0.0 },
+                                                                              match.ratio_offset), 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(RandomSpacings_MatchTheOriginalEnumeration) {
+    std::mt19937 generator(24);
+    std::uniform_real_distribution<double> speed(3.0, 90.0);
+    std::uniform_real_distribution<double> noise(0.0, 0.08);
+
+    for (const std::vector<float>* pulse_intervals : { &kDriverPulseIntervals, &kPutterPulseIntervals }) {
+        StrobePatternMatcher matcher(*pulse_intervals);
+        const int number_of_strobes = (int)pulse_intervals->size();
+
+        for (int trial = 0; trial < 300; trial++) {
+            // Anywhere from none to all but three of the exposures may be missing
+            std::vector<bool> missing_pulses(number_of_strobes, false);
+            const int number_missing = trial % (number_of_strobes - 2);
+            for (int m = 0; m < number_missing; ) {
+                const int pulse = std::uniform_int_distribution<int>(0, number_of_strobes - 1)(generator);
+                if (!missing_pulses[pulse]) {
+                    missing_pulses[pulse] = true;
+                    m++;
+                }
+            }
+
+            const std::vector<double> spacings = SimulatedSpacings(*pulse_intervals, missing_pulses, speed(generator), noise(generator), generator);
+
+            // The original enumeration had no match to fall back on with nothing missing
+            if (number_missing == 0) {
+                continue;
+            }
+
+            BOOST_TEST_CONTEXT("Strobes " << number_of_strobes << ", trial " << trial) {
+                CheckMatchesLegacy(matcher, spacings);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(NoMissingExposures_MatchesTheWholePattern) {
+    StrobePatternMatcher matcher(kDriverPulseIntervals);
+
+    const std::vector<double> spacings = { 7.0, 18.0, 30.0, 22.0, 30.0, 71.0, 40.0 };
+
+    StrobePatternMatcher::Match match;
+    BOOST_REQUIRE(matcher.FindBestMatch(DistanceRatios(spacings), 0, match));
+    BOOST_CHECK_EQUAL(match.ratio_offset, 0);
+    BOOST_CHECK(match.pulse_intervals_ms == kDriverPulseIntervals);
+}
+
+BOOST_AUTO_TEST_CASE(BadInputs_DoNotMatch) {
+    StrobePatternMatcher matcher(kDriverPulseIntervals);
+    StrobePatternMatcher::Match match;
+
+    BOOST_CHECK(!matcher.FindBestMatch({}, 2, match));
+    BOOST_CHECK(!matcher.FindBestMatch({ 1.0 }, -1, match));
+    BOOST_CHECK(!matcher.FindBestMatch({ 1.0 }, 9, match));
+
+    // Spacings that look nothing like the pulse pattern
+    BOOST_CHECK(!matcher.FindBestMatch({ 40.0, 0.01, 40.0 }, 3, match));
+
+    StrobePatternMatcher too_short({ 1.0F, 0.0F });
+    BOOST_CHECK(!too_short.FindBestMatch({ 1.0 }, 0, match));
+}
+
+BOOST_AUTO_TEST_CASE(ForPulseIntervals_ReusesMatchers) {
+    auto driver = StrobePatternMatcher::ForPulseIntervals(kDriverPulseIntervals);
+    auto putter = StrobePatternMatcher::ForPulseIntervals(kPutterPulseIntervals);
+
+    BOOST_CHECK(driver != putter);
+    BOOST_CHECK(StrobePatternMatcher::ForPulseIntervals(kDriverPulseIntervals) == driver);
+    BOOST_CHECK(StrobePatternMatcher::ForPulseIntervals(kPutterPulseIntervals) == putter);
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark_EnumerationVersusMatcher) {
+    const int kIterations = 20;
+
+    StrobePatternMatcher matcher(kPutterPulseIntervals);
+
+    int legacy_found = 0;
+    boost::timer::cpu_timer legacy_timer;
+    for (int i = 0; i < kIterations; i++) {
+        for (const SpacingSample& sample : kSpacingCorpus) {
+            if (sample.club == "putter") {
+                legacy_found += LegacyMatch(kPutterPulseIntervals, DistanceRatios(sample.spacings_px), (int)sample.spacings_px.size() + 1).found;
+            }
+        }
+    }
+    legacy_timer.stop();
+
+    int matcher_found = 0;
+    boost::timer::cpu_timer matcher_timer;
+    for (int i = 0; i < kIterations; i++) {
+        for (const SpacingSample& sample : kSpacingCorpus) {
+            if (sample.club == "putter") {
+                StrobePatternMatcher::Match match;
+                matcher_found += matcher.FindBestMatch(DistanceRatios(sample.spacings_px),
+                                                       (int)kPutterPulseIntervals.size() - (int)sample.spacings_px.size() - 1, match);
+            }
+        }
+    }
+    matcher_timer.stop();
+
+    const double legacy_us = legacy_timer.elapsed().wall / 1.0e3 / kIterations;
+    const double matcher_us = matcher_timer.elapsed().wall / 1.0e3 / kIterations;
+
+    BOOST_TEST_MESSAGE("Putter corpus: enumeration " << legacy_us << " us, matcher " << matcher_us << " us");
+
+    BOOST_CHECK_EQUAL(legacy_found, matcher_found);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,129 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+/**
+ * @file test_strobed_ball_corridor.cpp
+ * @brief Unit tests for the camera 2 strobed-ball search corridor
+ *
+ * Tests that projecting a real-world position into camera pixels undoes
+ * ComputeXyzDistanceFromOrthoCamPerspective, and that the corridor built from
+ * the teed-up ball covers the likely ball flight, and nothing behind the tee.
+ */
+
+#define BOOST_TEST_MODULE StrobedBallCorridorTests
+#include <boost/test/unit_test.hpp>
+#include "../test_utilities.hpp"
+#include "gs_camera.h"
+#include "strobed_ball_corridor.h"
+
+using namespace golf_sim;
+
+namespace {
+
+const cv::Size kImageSize(1456, 1088);
+
+// A simple pinhole camera at the origin, looking along +Z, with +Y up
+const double kFocalLengthPixels = 1000.0;
+
+bool PinholeProjector(const cv::Vec3d& position, cv::Point2d& pixel) {
+    if (position[2] <= 0.0) {
+        return false;
+    }
+    pixel.x = kImageSize.width / 2.0 + kFocalLengthPixels * position[0] / position[2];
+    pixel.y = kImageSize.height / 2.0 - kFocalLengthPixels * position[1] / position[2];
+    return true;
+}
+
+cv::Point2f Project(const cv::Vec3d& position) {
+    cv::Point2d pixel;
+    BOOST_REQUIRE(PinholeProjector(position, pixel));
+    return cv::Point2f((float)pixel.x, (float)pixel.y);
+}
+
+const cv::Vec3d kTeedBall(-0.25, -0.1, 0.6);
+
+StrobedBallCorridor::Settings GetSettings() {
+    StrobedBallCorridor::Settings settings;
+    settings.max_distance_meters = 0.5;
+    settings.margin_pixels = 30.0;
+    return settings;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(StrobedBallCorridorTests)
+
+BOOST_AUTO_TEST_CASE(Projection_UndoesComputeXyzDistance) {
+    GolfSimCamera camera;
+    camera.camera_hardware_.resolution_x_ = kImageSize.width;
+    camera.camera_hardware_.resolution_y_ = kImageSize.height;
+    camera.camera_hardware_.focal_length_ = 6.0F;
+    camera.camera_hardware_.sensor_width_ = 5.077F;
+    camera.camera_hardware_.sensor_height_ = 3.789F;
+    camera.camera_hardware_.camera_angles_ = cv::Vec2d(22.0, -12.0);
+
+    GolfBall ball;
+    ball.set_x(300L);
+    ball.set_y(800L);
+    ball.distance_to_z_plane_from_lens_ = 0.55;
+
+    cv::Vec3d distances;
+    BOOST_REQUIRE(GolfSimCamera::ComputeXyzDistanceFromOrthoCamPerspective(camera, ball, distances));
+
+    cv::Point2d pixel;
+    BOOST_REQUIRE(GolfSimCamera::ProjectXyzOrthoCamPerspectiveToPixel(camera, distances, pixel));
+    BOOST_CHECK_SMALL(pixel.x - 300.0, 1e-6);
+    BOOST_CHECK_SMALL(pixel.y - 800.0, 1e-6);
+
+    // Directly behind the camera
+    BOOST_CHECK(!GolfSimCamera::ProjectXyzOrthoCamPerspectiveToPixel(camera, -distances, pixel));
+}
+
+BOOST_AUTO_TEST_CASE(Corridor_CoversFlightDownrangeOnly) {
+    StrobedBallCorridor corridor;
+    BOOST_REQUIRE(corridor.Build(kTeedBall, +1, PinholeProjector, kImageSize, GetSettings()));
+    BOOST_CHECK(corridor.IsUsable());
+
+    // The tee, and a ball in flight at a typical iron launch angle
+    BOOST_CHECK(corridor.Contains(Project(kTeedBall)));
+    BOOST_CHECK(corridor.Contains(Project(kTeedBall + cv::Vec3d(0.3, 0.1, 0.0))));
+
+    // Behind the tee, and straight up from it
+    BOOST_CHECK(!corridor.Contains(Project(kTeedBall + cv::Vec3d(-0.2, 0.0, 0.0))));
+    BOOST_CHECK(!corridor.Contains(Project(kTeedBall + cv::Vec3d(0.02, 0.3, 0.0))));
+
+    // The search area starts just behind the tee, and is smaller than the image
+    const cv::Rect& rect = corridor.bounding_rect();
+    BOOST_CHECK_GE(rect.x, (int)Project(kTeedBall).x - 31);
+    BOOST_CHECK_LT(rect.area(), kImageSize.area());
+
+    cv::Mat mask = corridor.GetMask();
+    BOOST_CHECK_EQUAL(mask.size(), kImageSize);
+    BOOST_CHECK_EQUAL(mask.at<uchar>(cv::Point(Project(kTeedBall))), 255);
+}
+
+BOOST_AUTO_TEST_CASE(Corridor_LeftHandedFlightGoesTheOtherWay) {
+    const cv::Vec3d teed_ball(0.25, -0.1, 0.6);
+
+    StrobedBallCorridor corridor;
+    BOOST_REQUIRE(corridor.Build(teed_ball, -1, PinholeProjector, kImageSize, GetSettings()));
+
+    BOOST_CHECK(corridor.Contains(Project(teed_ball + cv::Vec3d(-0.3, 0.1, 0.0))));
+    BOOST_CHECK(!corridor.Contains(Project(teed_ball + cv::Vec3d(0.2, 0.0, 0.0))));
+}
+
+BOOST_AUTO_TEST_CASE(Corridor_TooLargeOrNotVisible_IsNotUsable) {
+    StrobedBallCorridor::Settings settings = GetSettings();
+    settings.max_area_fraction = 0.01;
+
+    StrobedBallCorridor corridor;
+    BOOST_CHECK(!corridor.Build(kTeedBall, +1, PinholeProjector, kImageSize, settings));
+    BOOST_CHECK(!corridor.IsUsable());
+
+    // A ball behind the camera
+    BOOST_CHECK(!corridor.Build(cv::Vec3d(0.0, 0.0, -0.5), +1, PinholeProjector, kImageSize, GetSettings()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,161 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <tuple>
+
+#include <opencv2/calib3d/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "utils/logging_tools.h"
+
+#include "undistort_map_cache.h"
+
+
+namespace golf_sim {
+
+    UndistortMapKey UndistortMapKey::FromCamera(const CameraHardware& camera, const cv::Size& image_size) {
+        UndistortMapKey key;
+        key.camera_number = camera.camera_number_;
+        key.camera_model = camera.camera_model_;
+        key.lens_type = camera.lens_type_;
+        key.camera_orientation = camera.camera_orientation_;
+        key.width = image_size.width;
+        key.height = image_size.height;
+        return key;
+    }
+
+    bool UndistortMapKey::operator<(const UndistortMapKey& other) const {
+        return std::tie(camera_number, camera_model, lens_type, camera_orientation, width, height) <
+            std::tie(other.camera_number, other.camera_model, other.lens_type, other.camera_orientation, other.width, other.height);
+    }
+
+    // The calibration values may be float or double, depending on where they came from
+    static bool SameValues(const cv::Mat& a, const cv::Mat& b) {
+        if (a.size() != b.size() || a.channels() != b.channels()) {
+            return false;
+        }
+
+        if (a.empty()) {
+            return true;
+        }
+
+        cv::Mat a64, b64;
+        a.convertTo(a64, CV_64F);
+        b.convertTo(b64, CV_64F);
+
+        return cv::norm(a64, b64, cv::NORM_INF) == 0.0;
+    }
+
+    bool UndistortMaps::MatchesCalibration(const cv::Mat& other_calibration_matrix, const cv::Mat& other_distortion_vector) const {
+        return SameValues(calibration_matrix, other_calibration_matrix) && SameValues(distortion_vector, other_distortion_vector);
+    }
+
+
+    UndistortMapCache& UndistortMapCache::GetSharedCache() {
+        static UndistortMapCache shared_cache;
+        return shared_cache;
+    }
+
+    std::shared_ptr<const UndistortMaps> UndistortMapCache::GetMaps(const UndistortMapKey& key,
+                                                                    const cv::Mat& calibration_matrix,
+                                                                    const cv::Mat& distortion_vector) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto found = entries_.find(key);
+            if (found != entries_.end() && found->second.maps->MatchesCalibration(calibration_matrix, distortion_vector)) {
+                found->second.last_used = ++use_counter_;
+                return found->second.maps;
+            }
+        }
+
+        // Build the maps without holding the lock, so that the other camera isn't held up
+        GS_LOG_TRACE_MSG(trace, "UndistortMapCache building maps for camera " + std::to_string((int)key.camera_number) +
+                                " at " + std::to_string(key.width) + "x" + std::to_string(key.height) + ".");
+
+        auto maps = std::make_shared<UndistortMaps>();
+        maps->calibration_matrix = calibration_matrix.clone();
+        maps->distortion_vector = distortion_vector.clone();
+
+        cv::initUndistortRectifyMap(calibration_matrix, distortion_vector, cv::Mat(), calibration_matrix,
+                                    cv::Size(key.width, key.height), CV_16SC2, maps->map1, maps->map2);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        Entry& entry = entries_[key];
+
+        // Another thread may have built the same maps in the meantime
+        if (entry.maps == nullptr || !entry.maps->MatchesCalibration(calibration_matrix, distortion_vector)) {
+            entry.maps = maps;
+        }
+        entry.last_used = ++use_counter_;
+
+        if (entries_.size() > kMaxEntries) {
+            auto oldest = entries_.begin();
+            for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                if (it->second.last_used < oldest->second.last_used) {
+                    oldest = it;
+                }
+            }
+            entries_.erase(oldest);
+        }
+
+        return entries_[key].maps;
+    }
+
+    cv::Mat UndistortMapCache::Undistort(const cv::Mat& img, const CameraHardware& camera, const cv::Rect& roi) {
+        if (img.empty()) {
+            return img;
+        }
+
+        std::shared_ptr<const UndistortMaps> maps = GetMaps(UndistortMapKey::FromCamera(camera, img.size()),
+                                                            camera.calibrationMatrix_, camera.cameraDistortionVector_);
+
+        cv::Mat undistorted_img;
+
+        if (roi.empty()) {
+            cv::remap(img, undistorted_img, maps->map1, maps->map2, cv::INTER_LINEAR);
+            return undistorted_img;
+        }
+
+        const cv::Rect clipped_roi = roi & cv::Rect(0, 0, img.cols, img.rows);
+
+        if (clipped_roi.empty()) {
+            GS_LOG_MSG(warning, "UndistortMapCache::Undistort - roi is outside of the image.");
+            return cv::Mat();
+        }
+
+        // The maps say where each undistorted pixel comes from in the whole (distorted) image,
+        // so the part of the maps for the roi produces just the roi
+        cv::remap(img, undistorted_img, maps->map1(clipped_roi), maps->map2(clipped_roi), cv::INTER_LINEAR);
+
+        return undistorted_img;
+    }
+
+    void UndistortMapCache::OnCalibrationLoaded(GsCameraNumber camera_number, const cv::Mat& calibration_matrix, const cv::Mat& distortion_vector) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        for (auto it = entries_.begin(); it != entries_.end(); ) {
+            if (it->first.camera_number == camera_number && !it->second.maps->MatchesCalibration(calibration_matrix, distortion_vector)) {
+                GS_LOG_TRACE_MSG(trace, "UndistortMapCache dropping maps for camera " + std::to_string((int)camera_number) + " after a calibration change.");
+                it = entries_.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    size_t UndistortMapCache::size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    void UndistortMapCache::Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+}
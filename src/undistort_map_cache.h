@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Cache of the remap tables that undistort camera images.
+//
+// cv::initUndistortRectifyMap computes a source position for every pixel of the
+// image, which costs far more than the cv::remap that uses it.  But the calibration
+// matrix, distortion vector and image size of a camera almost never change, so the
+// maps are built once per camera number, model, lens, orientation and image size,
+// and reused for every later image.  The maps are in the fixed-point CV_16SC2 /
+// CV_16UC1 format, which is about half the size of the floating-point maps and is
+// faster to remap with.
+//
+// Each set of maps remembers the calibration it was built from.  If a camera's
+// calibration is (re)loaded with different values, CameraHardware::init_camera_parameters
+// drops that camera's stale maps, and they are rebuilt the next time they are needed.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <opencv2/core.hpp>
+
+#include "camera_hardware.h"
+
+
+namespace golf_sim {
+
+struct UndistortMapKey {
+    GsCameraNumber camera_number = GsCameraNumber::kGsCamera1;
+    CameraHardware::CameraModel camera_model = CameraHardware::CameraModel::kCameraUnknown;
+    CameraHardware::LensType lens_type = CameraHardware::LensType::kLensUnknown;
+    CameraHardware::CameraOrientation camera_orientation = CameraHardware::CameraOrientation::kCameraOrientationUnknown;
+    int width = 0;
+    int height = 0;
+
+    static UndistortMapKey FromCamera(const CameraHardware& camera, const cv::Size& image_size);
+
+    bool operator<(const UndistortMapKey& other) const;
+};
+
+
+struct UndistortMaps {
+    // CV_16SC2 integer source positions, and CV_16UC1 interpolation table indexes
+    cv::Mat map1;
+    cv::Mat map2;
+
+    // What the maps were built from
+    cv::Mat calibration_matrix;
+    cv::Mat distortion_vector;
+
+    bool MatchesCalibration(const cv::Mat& calibration_matrix, const cv::Mat& distortion_vector) const;
+};
+
+
+class UndistortMapCache {
+public:
+
+    // Enough for both cameras at a few different resolutions
+    static constexpr size_t kMaxEntries = 8;
+
+    // Process-wide cache that is shared by all cameras
+    static UndistortMapCache& GetSharedCache();
+
+    // Returns the maps for the key, building them if they are not cached or were built
+    // from a different calibration
+    std::shared_ptr<const UndistortMaps> GetMaps(const UndistortMapKey& key,
+                                                 const cv::Mat& calibration_matrix,
+                                                 const cv::Mat& distortion_vector);
+
+    // Undistorts img using the camera's calibration.  If roi is not empty, only that part
+    // of the undistorted image is produced (so the result is roi-sized), which is much
+    // faster when only the area around a ball is of interest.
+    cv::Mat Undistort(const cv::Mat& img, const CameraHardware& camera, const cv::Rect& roi = cv::Rect());
+
+    // Drops any maps for the camera that were built from a different calibration
+    void OnCalibrationLoaded(GsCameraNumber camera_number, const cv::Mat& calibration_matrix, const cv::Mat& distortion_vector);
+
+    size_t size() const;
+
+    // Forgets all maps.  Maps that are still in use stay valid.
+    void Clear();
+
+private:
+
+    struct Entry {
+        std::shared_ptr<const UndistortMaps> maps;
+        uint64_t last_used = 0;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<UndistortMapKey, Entry> entries_;
+    uint64_t use_counter_ = 0;
+};
+
+}
@@ -0,0 +1,301 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+#include <vector>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include "logging_tools.h"
+#include "artifact_writer.h"
+
+
+namespace golf_sim {
+
+    bool ArtifactWriter::kUseAsyncArtifactWriter = true;
+    int ArtifactWriter::kMaxPendingDiagnosticImages = 16;
+    int ArtifactWriter::kMaxPendingWebserverImages = 8;
+    int ArtifactWriter::kPngCompressionLevel = 1;
+    std::string ArtifactWriter::kDiagnosticImageFormat = "png";
+
+    static int64_t SteadyNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static bool EndsWith(const std::string& s, const std::string& suffix) {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    ArtifactWriter& ArtifactWriter::GetSharedWriter() {
+        static ArtifactWriter shared_writer;
+        return shared_writer;
+    }
+
+    ArtifactWriter::ArtifactWriter() {
+    }
+
+    ArtifactWriter::~ArtifactWriter() {
+        Shutdown();
+    }
+
+    ArtifactWriter::Format ArtifactWriter::GetDiagnosticFormat() {
+        return (kDiagnosticImageFormat == "bmp" || kDiagnosticImageFormat == "BMP") ? Format::kBmp : Format::kPng;
+    }
+
+    bool ArtifactWriter::Submit(const std::string& file_name, cv::Mat&& image, Priority priority) {
+
+        if (image.empty()) {
+            GS_LOG_MSG(warning, "ArtifactWriter::Submit - image for " + file_name + " was empty - ignoring.");
+            return false;
+        }
+
+        std::string target_name = file_name;
+
+        if (priority == Priority::kDiagnostic && GetDiagnosticFormat() == Format::kBmp && EndsWith(target_name, ".png")) {
+            target_name.replace(target_name.size() - 4, 4, ".bmp");
+        }
+
+        if (!kUseAsyncArtifactWriter) {
+            return WriteSynchronously(target_name, image);
+        }
+
+        const int p = (int)priority;
+        uint64_t number_dropped = 0;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (!running_ && !stopping_) {
+            Start();
+        }
+
+        if (priority == Priority::kDiagnostic) {
+            // Make room by dropping the oldest diagnostics, rather than waiting for the disk
+            const size_t max_pending = (size_t)std::max(1, kMaxPendingDiagnosticImages);
+
+            while (queues_[p].size() >= max_pending) {
+                queues_[p].pop_front();
+                number_dropped++;
+            }
+        }
+        else {
+            const size_t max_pending = (size_t)std::max(1, kMaxPendingWebserverImages);
+
+            if (queues_[p].size() >= max_pending) {
+                const int64_t wait_start_ns = SteadyNowNs();
+                work_done_.wait(lock, [&] { return queues_[p].size() < max_pending || stopping_; });
+                statistics_.total_producer_wait_ns += SteadyNowNs() - wait_start_ns;
+            }
+        }
+
+        if (stopping_) {
+            lock.unlock();
+            return WriteSynchronously(target_name, image);
+        }
+
+        queues_[p].push_back({ target_name, std::move(image), ++last_submitted_[p] });
+
+        statistics_.submitted++;
+        statistics_.dropped += number_dropped;
+        statistics_.max_pending = std::max(statistics_.max_pending, queues_[0].size() + queues_[1].size());
+
+        lock.unlock();
+        work_available_.notify_one();
+
+        if (number_dropped > 0) {
+            // Flush() may have been waiting for the dropped images
+            work_done_.notify_all();
+            GS_LOG_TRACE_MSG(trace, "ArtifactWriter::Submit - dropped " + std::to_string(number_dropped) +
+                                    " pending diagnostic image(s) to make room for " + target_name);
+        }
+
+        return true;
+    }
+
+    bool ArtifactWriter::WriteSynchronously(const std::string& file_name, const cv::Mat& image) {
+        const bool success = WriteImage(file_name, image);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        statistics_.submitted++;
+        statistics_.written_synchronously++;
+        (success ? statistics_.written : statistics_.failed)++;
+
+        return success;
+    }
+
+    void ArtifactWriter::Start() {
+        // mutex_ is held
+        running_ = true;
+        worker_ = std::thread(&ArtifactWriter::Process, this);
+    }
+
+    void ArtifactWriter::Process() {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while (true) {
+            work_available_.wait(lock, [this] {
+                return stopping_ || !queues_[0].empty() || !queues_[1].empty();
+            });
+
+            // Lower priority numbers are more important
+            int p = 0;
+            while (p < (int)Priority::kNumPriorities && queues_[p].empty()) {
+                p++;
+            }
+
+            if (p == (int)Priority::kNumPriorities) {
+                // Nothing left, so stopping_ must be set
+                break;
+            }
+
+            Job job = std::move(queues_[p].front());
+            queues_[p].pop_front();
+            in_flight_[p] = job.sequence;
+
+            lock.unlock();
+
+            const int64_t start_ns = SteadyNowNs();
+            const bool success = WriteImage(job.file_name, job.image);
+            const int64_t write_ns = SteadyNowNs() - start_ns;
+            job.image.release();
+
+            lock.lock();
+
+            in_flight_[p] = 0;
+            (success ? statistics_.written : statistics_.failed)++;
+            statistics_.total_write_ns += write_ns;
+            statistics_.max_write_ns = std::max(statistics_.max_write_ns, write_ns);
+
+            work_done_.notify_all();
+        }
+    }
+
+    bool ArtifactWriter::IsFlushed(int priority, uint64_t sequence) const {
+        const std::deque<Job>& queue = queues_[priority];
+
+        return (queue.empty() || queue.front().sequence > sequence) &&
+               (in_flight_[priority] == 0 || in_flight_[priority] > sequence);
+    }
+
+    bool ArtifactWriter::Flush(Priority priority, unsigned int timeout_ms) {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        const int last_priority = (int)priority;
+        uint64_t targets[(int)Priority::kNumPriorities] = {};
+
+        for (int p = 0; p <= last_priority; p++) {
+            targets[p] = last_submitted_[p];
+        }
+
+        auto is_flushed = [&] {
+            for (int p = 0; p <= last_priority; p++) {
+                if (!IsFlushed(p, targets[p])) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        if (timeout_ms == 0) {
+            work_done_.wait(lock, is_flushed);
+            return true;
+        }
+
+        return work_done_.wait_for(lock, std::chrono::milliseconds(timeout_ms), is_flushed);
+    }
+
+    void ArtifactWriter::Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+
+            if (!running_) {
+                return;
+            }
+        }
+
+        work_available_.notify_all();
+        work_done_.notify_all();
+
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+
+    ArtifactWriter::Statistics ArtifactWriter::GetStatistics() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        Statistics statistics = statistics_;
+        statistics.pending = queues_[0].size() + queues_[1].size();
+
+        for (int p = 0; p < (int)Priority::kNumPriorities; p++) {
+            statistics.pending += (in_flight_[p] != 0) ? 1 : 0;
+        }
+
+        return statistics;
+    }
+
+    std::string ArtifactWriter::FormatStatistics() const {
+        const Statistics s = GetStatistics();
+        const uint64_t number_timed = s.written + s.failed - s.written_synchronously;
+
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(1);
+
+        out << "artifacts: submitted=" << s.submitted << " written=" << s.written << " dropped=" << s.dropped
+            << " failed=" << s.failed << " synchronous=" << s.written_synchronously
+            << " pending=" << s.pending << " (max " << s.max_pending << ")"
+            << " write mean=" << ((number_timed > 0) ? s.total_write_ns / 1e6 / number_timed : 0.0) << "ms"
+            << " max=" << s.max_write_ns / 1e6 << "ms"
+            << " producer wait=" << s.total_producer_wait_ns / 1e6 << "ms";
+
+        return out.str();
+    }
+
+    bool ArtifactWriter::WriteImage(const std::string& file_name, const cv::Mat& image) {
+
+        std::vector<int> parameters;
+
+        if (EndsWith(file_name, ".png")) {
+            parameters = { cv::IMWRITE_PNG_COMPRESSION, std::clamp(kPngCompressionLevel, 0, 9) };
+        }
+
+        // Keep the extension at the end, as that is how imwrite picks the format
+        const std::filesystem::path path(file_name);
+        std::filesystem::path partial_path(path);
+        partial_path.replace_filename(path.stem().string() + ".partial" + path.extension().string());
+
+        try {
+            if (!cv::imwrite(partial_path.string(), image, parameters)) {
+                GS_LOG_MSG(warning, "ArtifactWriter - could not save to file name: " + file_name);
+                return false;
+            }
+        }
+        catch (std::exception& ex) {
+            GS_LOG_MSG(warning, "Exception! - failed to imwrite with fname = " + file_name + " - " + ex.what());
+            return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(partial_path, path, ec);
+
+        if (ec) {
+            GS_LOG_MSG(warning, "ArtifactWriter - could not rename " + partial_path.string() + " to " + file_name + ": " + ec.message());
+            std::filesystem::remove(partial_path, ec);
+            return false;
+        }
+
+        GS_LOG_TRACE_MSG(trace, "Logged image to file: " + file_name);
+
+        return true;
+    }
+
+}
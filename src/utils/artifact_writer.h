@@ -0,0 +1,145 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// Writes logged and webserver images to disk on a background thread.
+//
+// Encoding a full-resolution PNG takes tens of milliseconds, and images are logged
+// from time-critical places such as the FSM transitions right after camera 2 is
+// triggered.  Callers hand their image over (by moving it, so there is no extra copy),
+// and a single worker thread encodes and writes it.
+//
+// There are two priority classes.  Webserver images are shown to the user, so they are
+// always written first and are never dropped.  Diagnostic images are dropped (oldest
+// first) if too many are waiting, rather than making the caller wait for the disk.
+// Files are written under a temporary name and then renamed, so that a reader never
+// sees a partly-written image.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <opencv2/core.hpp>
+
+
+namespace golf_sim {
+
+class ArtifactWriter {
+public:
+
+    enum class Priority {
+        kWebserver = 0,     // Shown by the GUI (or otherwise needed) - written first, and never dropped
+        kDiagnostic = 1,    // Debugging aids - may be dropped under load
+        kNumPriorities = 2
+    };
+
+    // How diagnostic images are encoded.  Webserver images are always PNG, because that is
+    // what the GUI expects.
+    enum class Format {
+        kPng,
+        kBmp        // Uncompressed.  Fastest to write, but several times larger.
+    };
+
+    struct Statistics {
+        uint64_t submitted = 0;
+        uint64_t written = 0;
+        uint64_t failed = 0;
+        uint64_t dropped = 0;               // Diagnostic images discarded because the queue was full
+        uint64_t written_synchronously = 0; // Because the writer was disabled or not running
+        size_t pending = 0;
+        size_t max_pending = 0;             // High-water mark of the queue
+        int64_t total_write_ns = 0;         // Time the worker spent encoding and writing
+        int64_t max_write_ns = 0;
+        int64_t total_producer_wait_ns = 0; // Time callers were blocked on a full webserver queue
+    };
+
+    // If false, images are written on the caller's thread, as before
+    static bool kUseAsyncArtifactWriter;
+
+    // Diagnostic images beyond this many waiting are dropped, oldest first
+    static int kMaxPendingDiagnosticImages;
+
+    // Submitting a webserver image blocks once this many are waiting
+    static int kMaxPendingWebserverImages;
+
+    // 0 (no compression, fastest) to 9.  OpenCV's default is 3.
+    static int kPngCompressionLevel;
+
+    // "png" or "bmp"
+    static std::string kDiagnosticImageFormat;
+
+    // Process-wide writer.  The worker thread is started on first use.
+    static ArtifactWriter& GetSharedWriter();
+
+    ArtifactWriter();
+    ~ArtifactWriter();
+
+    ArtifactWriter(const ArtifactWriter&) = delete;
+    ArtifactWriter& operator=(const ArtifactWriter&) = delete;
+
+    // Queues the image to be written to file_name.  The writer takes over the image, so
+    // the caller must not change its pixels afterward (clone it first if that is needed).
+    // For diagnostic images, a file name ending in .png may be changed to the configured
+    // format.  Returns false only if the image is empty, or if it had to be written
+    // synchronously and that failed.
+    bool Submit(const std::string& file_name, cv::Mat&& image, Priority priority = Priority::kDiagnostic);
+
+    // Waits until every image of the given priority (or higher) that was submitted before
+    // this call has been written.  Returns false if that did not happen within timeout_ms
+    // (0 means wait indefinitely).
+    bool Flush(Priority priority = Priority::kDiagnostic, unsigned int timeout_ms = 0);
+
+    Statistics GetStatistics() const;
+
+    // E.g., "artifacts: submitted=40 written=38 dropped=2 failed=0 pending=0 (max 16) ..."
+    std::string FormatStatistics() const;
+
+    // Writes everything that is pending and stops the worker thread.  Later submissions
+    // are written synchronously.
+    void Shutdown();
+
+    // Encodes and writes the image on the calling thread
+    static bool WriteImage(const std::string& file_name, const cv::Mat& image);
+
+    static Format GetDiagnosticFormat();
+
+private:
+
+    struct Job {
+        std::string file_name;
+        cv::Mat image;
+        uint64_t sequence = 0;
+    };
+
+    void Start();
+    void Process();
+    bool WriteSynchronously(const std::string& file_name, const cv::Mat& image);
+
+    // True once nothing of the given priority up to the sequence number is queued or being written
+    bool IsFlushed(int priority, uint64_t sequence) const;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable work_done_;
+
+    std::deque<Job> queues_[(int)Priority::kNumPriorities];
+
+    // Per priority, the sequence number of the last submitted job, and of the job that the
+    // worker is writing (0 if none).  Sequence numbers start at 1.
+    uint64_t last_submitted_[(int)Priority::kNumPriorities] = {};
+    uint64_t in_flight_[(int)Priority::kNumPriorities] = {};
+
+    std::thread worker_;
+    bool running_ = false;
+    bool stopping_ = false;
+
+    Statistics statistics_;
+};
+
+}
@@ -0,0 +1,127 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+
+#include "cv_utils.h"
+#include "logging_tools.h"
+
+#include "ball_color_statistics.h"
+
+
+namespace golf_sim {
+
+    BallColorStatistics::BallColorStatistics(const cv::Mat& img, const std::vector<GsCircle>& circles)
+        : img_(img), region_(GetColorRegion(img, circles)) {
+
+        // The total area that summing each candidate's square directly would cover
+        double candidates_area = 0.0;
+
+        for (const GsCircle& circle : circles) {
+            const cv::Rect color_rect = CvUtils::GetBallColorRect(img, circle);
+
+            if (color_rect.width > 0 && color_rect.height > 0) {
+                candidates_area += (double)color_rect.area();
+            }
+        }
+
+        // Candidates spread across the image leave most of the region unused, and then building
+        // the integral images would cost more than it saves
+        if ((double)region_.area() > kMaxRegionToCandidatesAreaRatio * candidates_area) {
+            GS_LOG_TRACE_MSG(trace, "BallColorStatistics - the " + std::to_string(region_.width) + "x" + std::to_string(region_.height) +
+                                    " region is larger than the candidates.  Using GetBallColorRgb for each one.");
+            region_ = cv::Rect();
+            return;
+        }
+
+        BuildIntegralImages();
+    }
+
+    BallColorStatistics::BallColorStatistics(const cv::Mat& img, const cv::Rect& region)
+        : img_(img), region_(region & cv::Rect(0, 0, img.cols, img.rows)) {
+        BuildIntegralImages();
+    }
+
+    void BallColorStatistics::BuildIntegralImages() {
+        if (img_.type() != CV_8UC3 || region_.empty()) {
+            region_ = cv::Rect();
+            return;
+        }
+
+        region_img_ = img_(region_);
+
+        // 32-bit integers hold the sums of 8-bit pixels exactly for regions of up to 8 million pixels,
+        // which is more than a full frame.  The squared sums need doubles, which also hold them exactly.
+        cv::integral(region_img_, sum_, squared_sum_, CV_32S, CV_64F);
+
+        GS_LOG_TRACE_MSG(trace, "BallColorStatistics - built the integral images for a " + std::to_string(region_.width) +
+                                "x" + std::to_string(region_.height) + " region.");
+    }
+
+    cv::Rect BallColorStatistics::GetColorRegion(const cv::Mat& img, const std::vector<GsCircle>& circles) {
+        cv::Rect region;
+
+        for (const GsCircle& circle : circles) {
+            const cv::Rect color_rect = CvUtils::GetBallColorRect(img, circle);
+
+            if (color_rect.width <= 0 || color_rect.height <= 0) {
+                continue;
+            }
+
+            region = region.empty() ? color_rect : (region | color_rect);
+        }
+
+        return region;
+    }
+
+    std::vector<GsColorTriplet> BallColorStatistics::GetBallColorRgb(const GsCircle& circle) const {
+
+        if (region_.empty() || (int)CvUtils::CircleRadius(circle) == 0) {
+            return CvUtils::GetBallColorRgb(img_, circle);
+        }
+
+        const cv::Rect color_rect = CvUtils::GetBallColorRect(img_, circle);
+
+        if (color_rect.width <= 0 || color_rect.height <= 0 || (color_rect & region_) != color_rect) {
+            return CvUtils::GetBallColorRgb(img_, circle);
+        }
+
+        // The corners of the square in the integral images
+        const int x0 = color_rect.x - region_.x;
+        const int y0 = color_rect.y - region_.y;
+        const int x1 = x0 + color_rect.width;
+        const int y1 = y0 + color_rect.height;
+
+        const cv::Vec3i sum = sum_.at<cv::Vec3i>(y1, x1) - sum_.at<cv::Vec3i>(y0, x1) -
+                              sum_.at<cv::Vec3i>(y1, x0) + sum_.at<cv::Vec3i>(y0, x0);
+        const cv::Vec3d squared_sum = squared_sum_.at<cv::Vec3d>(y1, x1) - squared_sum_.at<cv::Vec3d>(y0, x1) -
+                                      squared_sum_.at<cv::Vec3d>(y1, x0) + squared_sum_.at<cv::Vec3d>(y0, x0);
+
+        const double number_pixels = (double)color_rect.area();
+
+        GsColorTriplet avg_color(0, 0, 0);
+        GsColorTriplet std_color(0, 0, 0);
+
+        for (int channel = 0; channel < 3; channel++) {
+            const double mean = (double)sum[channel] / number_pixels;
+            const double variance = squared_sum[channel] / number_pixels - mean * mean;
+
+            // Only rounding could make the variance negative
+            avg_color[channel] = (float)mean;
+            std_color[channel] = (float)std::sqrt(std::max(variance, 0.0));
+        }
+
+        GsColorTriplet median_color;
+        const cv::Mat square = region_img_(cv::Rect(x0, y0, color_rect.width, color_rect.height));
+        CvUtils::GetMedianColor(square, median_color);
+
+        std::vector<GsColorTriplet> results{ avg_color, median_color, std_color };
+        return results;
+    }
+
+}
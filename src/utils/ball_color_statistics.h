@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// The color statistics of many candidate balls in the same image.
+//
+// CvUtils::GetBallColorRgb runs cv::meanStdDev over the square inside each circle.  When
+// hundreds of Hough candidates (and the expected ball) are each compared that way, the
+// same pixels are summed over and over, and the cost grows with both the number and the
+// size of the candidates.  BallColorStatistics instead builds the integral and squared-
+// integral images once for the region that the candidates cover.  The mean and standard
+// deviation of any candidate's square then take four lookups per channel, however large
+// it is.  The median comes from a histogram of (at most) a fixed grid of the square's
+// pixels, the same way GetBallColorRgb computes it.
+//
+// The results are the same as GetBallColorRgb, to within floating-point rounding.  Circles
+// whose square is not inside the region, and images that are not 8-bit, 3-channel, are
+// simply passed on to GetBallColorRgb.  So are all of the circles if they are spread out
+// enough that the region is larger than their squares put together, because building the
+// integral images for it would then take longer than summing each square directly.
+
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "gs_globals.h"
+
+
+namespace golf_sim {
+
+class BallColorStatistics {
+public:
+
+    // Builds the integral images for the part of the image covered by the circles' color squares
+    BallColorStatistics(const cv::Mat& img, const std::vector<GsCircle>& circles);
+
+    // Builds the integral images for the region, which is clipped to the image
+    BallColorStatistics(const cv::Mat& img, const cv::Rect& region);
+
+    // Returns the average, median and standard deviation of the color, in the same form as
+    // CvUtils::GetBallColorRgb
+    std::vector<GsColorTriplet> GetBallColorRgb(const GsCircle& circle) const;
+
+    // The union of the color squares of the circles, clipped to the image
+    static cv::Rect GetColorRegion(const cv::Mat& img, const std::vector<GsCircle>& circles);
+
+    const cv::Rect& region() const { return region_; }
+
+    // Beyond this ratio of the region's area to the total area of the candidates' squares,
+    // the integral images are not built.  Building them costs about as much per pixel as
+    // GetBallColorRgb does.
+    static constexpr double kMaxRegionToCandidatesAreaRatio = 1.0;
+
+private:
+
+    void BuildIntegralImages();
+
+    // The full image, for any circle that can't be answered from the region
+    cv::Mat img_;
+
+    cv::Rect region_;
+    cv::Mat region_img_;
+
+    // One row and column larger than the region, as cv::integral produces them
+    cv::Mat sum_;
+    cv::Mat squared_sum_;
+};
+
+}
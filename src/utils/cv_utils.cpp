@@ -100,40 +100,28 @@ namespace golf_sim {
     {
         BOOST_LOG_FUNCTION();
 
-        int r = (int)CircleRadius(circle);
-        cv::Vec2i xy = CircleXY(circle);
-        int x = xy[0];
-        int y = xy[1];
-
-        if (r == 0) {
+        if ((int)CircleRadius(circle) == 0) {
             GS_LOG_MSG(error, "CvUtils::GetBallColorRgb called with circle of 0 radius.");
             std::vector<GsColorTriplet> empty;
             return empty;
         }
 
-        const double BOUNDED_BOX_RADIUS_RATIO = ((2.0*r) * 0.707) / 2.0;   // 1.6 (which is almost the whole ball may be resulting in too much averaging)
-        int xmin = std::max(0, (int)round(x - BOUNDED_BOX_RADIUS_RATIO));
-        int xmax = std::min(CvWidth(img), (int)round(x + BOUNDED_BOX_RADIUS_RATIO));    // Somehow, the box otherwise seems too far to the left?
-        int ymin = std::max(0, (int)round(y - BOUNDED_BOX_RADIUS_RATIO));    // Round up to focus more on the better-lit top of the ball
-        int ymax = std::min(CvHeight(img), (int)round(y + BOUNDED_BOX_RADIUS_RATIO));
-
-        // GS_LOG_TRACE_MSG(trace, "GetBall_color: xmin,max, ymin,max = (" + std::to_string(xmin) + "," + std::to_string(xmax) + ") : (" + std::to_string(ymin) + "," + std::to_string(ymax) + ")");
+        cv::Rect color_rect = GetBallColorRect(img, circle);
 
-        // LoggingTools::ShowRectangleOnImage("getBallColor area to average: ", img, cv::Point(xmin, ymin), cv::Point(xmax, ymax));
+        // LoggingTools::ShowRectangleOnImage("getBallColor area to average: ", img, color_rect.tl(), color_rect.br());
 
-        cv::Mat subImg = img(cv::Range(ymin, ymax), cv::Range(xmin, xmax));
+        cv::Mat subImg = img(cv::Range(color_rect.y, color_rect.y + color_rect.height), cv::Range(color_rect.x, color_rect.x + color_rect.width));
 
         cv::Scalar avg_color, std_color;
         cv::meanStdDev(subImg, avg_color, std_color);
-        cv::Scalar median_color = avg_color; // TBD - Compute Median
 
-        // TBD - Not sure the first element of the array is the correct one
-        // GS_LOG_TRACE_MSG(trace, "Average is (RGB):" + LoggingTools::FormatGsColorTriplet(avg_color) + " Median is: " + LoggingTools::FormatGsColorTriplet(median_color) + " STD is " + LoggingTools::FormatGsColorTriplet(std_color));
+        cv::Scalar median_color;
+        if (!GetMedianColor(subImg, median_color)) {
+            median_color = avg_color;
+        }
 
-        GsColorTriplet average_color_Scalar{ avg_color };
-        // LoggingTools::DebugShowColorSwatch("Average Color of  Ball (BGR)", average_color_Scalar );
+        // GS_LOG_TRACE_MSG(trace, "Average is (RGB):" + LoggingTools::FormatGsColorTriplet(avg_color) + " Median is: " + LoggingTools::FormatGsColorTriplet(median_color) + " STD is " + LoggingTools::FormatGsColorTriplet(std_color));
 
-        // TBD - Not sure whaht we're going to be getting from the statistical calls, above
         GsColorTriplet avg_color_vec3f{ (float)avg_color[0], (float)avg_color[1], (float)avg_color[2] };
         GsColorTriplet median_color_vec3f{ (float)median_color[0], (float)median_color[1], (float)median_color[2] };
         GsColorTriplet std_color_vec3f{ (float)std_color[0], (float)std_color[1], (float)std_color[2] };
@@ -142,6 +130,66 @@ namespace golf_sim {
         return results;  
     }
 
+    cv::Rect CvUtils::GetBallColorRect(const cv::Mat& img, const GsCircle& circle)
+    {
+        int r = (int)CircleRadius(circle);
+        cv::Vec2i xy = CircleXY(circle);
+        int x = xy[0];
+        int y = xy[1];
+
+        const double BOUNDED_BOX_RADIUS_RATIO = ((2.0*r) * 0.707) / 2.0;   // 1.6 (which is almost the whole ball may be resulting in too much averaging)
+        int xmin = std::max(0, (int)round(x - BOUNDED_BOX_RADIUS_RATIO));
+        int xmax = std::min(CvWidth(img), (int)round(x + BOUNDED_BOX_RADIUS_RATIO));    // Somehow, the box otherwise seems too far to the left?
+        int ymin = std::max(0, (int)round(y - BOUNDED_BOX_RADIUS_RATIO));    // Round up to focus more on the better-lit top of the ball
+        int ymax = std::min(CvHeight(img), (int)round(y + BOUNDED_BOX_RADIUS_RATIO));
+
+        // GS_LOG_TRACE_MSG(trace, "GetBall_color: xmin,max, ymin,max = (" + std::to_string(xmin) + "," + std::to_string(xmax) + ") : (" + std::to_string(ymin) + "," + std::to_string(ymax) + ")");
+
+        // Note - the width or height will be negative if the circle is entirely outside the image
+        return cv::Rect(xmin, ymin, xmax - xmin, ymax - ymin);
+    }
+
+    bool CvUtils::GetMedianColor(const cv::Mat& img, GsColorTriplet& median_color)
+    {
+        if (img.type() != CV_8UC3 || img.empty()) {
+            return false;
+        }
+
+        const int step_x = (img.cols + kMedianColorSamplesPerSide - 1) / kMedianColorSamplesPerSide;
+        const int step_y = (img.rows + kMedianColorSamplesPerSide - 1) / kMedianColorSamplesPerSide;
+
+        int histogram[3][256] = {};
+        int number_samples = 0;
+
+        for (int y = 0; y < img.rows; y += step_y) {
+            const cv::Vec3b* row = img.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < img.cols; x += step_x) {
+                for (int channel = 0; channel < 3; channel++) {
+                    histogram[channel][row[x][channel]]++;
+                }
+                number_samples++;
+            }
+        }
+
+        // The lower median if there are an even number of samples
+        const int median_rank = (number_samples - 1) / 2;
+
+        median_color = GsColorTriplet(0, 0, 0);
+
+        for (int channel = 0; channel < 3; channel++) {
+            int count = 0;
+            for (int value = 0; value < 256; value++) {
+                count += histogram[channel][value];
+                if (count > median_rank) {
+                    median_color[channel] = value;
+                    break;
+                }
+            }
+        }
+
+        return true;
+    }
+
     cv::Mat CvUtils::GetAreaMaskImage(int resolution_x_, int resolution_y_, int expected_ball_X, int expected_ball_Y, int mask_radius, cv::Rect& mask_dimensions, bool use_square)
     {
         BOOST_LOG_FUNCTION();
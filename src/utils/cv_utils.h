@@ -66,6 +66,14 @@ struct CvUtils
     // The ball color will be an average of the colors near the middle of the input ball
     // The returned color is in RGB form
     static std::vector<GsColorTriplet> GetBallColorRgb(const cv::Mat &img, const GsCircle &circle);
+
+    // The square inside the circle that GetBallColorRgb takes its statistics from, clipped to the image
+    static cv::Rect GetBallColorRect(const cv::Mat& img, const GsCircle& circle);
+
+    // Per-channel median of an 8-bit, 3-channel image.  Larger images are sampled on a grid of at most
+    // kMedianColorSamplesPerSide x kMedianColorSamplesPerSide pixels.  Returns false for any other image type.
+    static bool GetMedianColor(const cv::Mat& img, GsColorTriplet& median_color);
+    static const int kMedianColorSamplesPerSide = 32;
     
     static cv::Mat GetAreaMaskImage(int resolution_x_, int resolution_y_, int expected_ball_X, int expected_ball_Y, int mask_radius, cv::Rect &mask_dimensions, bool use_square = false);
 
@@ -11,6 +11,7 @@
 #include <boost/log/core/record_view.hpp>
 #include "gs_options.h"
 #include "cv_utils.h"
+#include "artifact_writer.h"
 
 #include "logging_tools.h"
 
@@ -70,6 +71,9 @@ namespace golf_sim {
 
     boost::circular_buffer<std::string> LoggingTools::RecentLogMessages(20);
 
+    // Everything is logged until InitLogging sets the real level
+    std::atomic<int> LoggingTools::runtime_min_level_{ (int)boost::log::trivial::trace };
+
 #ifdef __unix__
     std::string LoggingTools::kBaseImageLoggingDir = "VALUE_NOT_SET";
 #else
@@ -109,39 +113,33 @@ namespace golf_sim {
 
         switch (GolfSimOptions::GetCommandLineOptions().logging_level_) {
             case kTrace: {
-                boost::log::core::get()->set_filter(
-                    boost::log::trivial::severity >= boost::log::trivial::trace);
+                SetRuntimeMinLevel(boost::log::trivial::trace);
                 break;
             }
 
             case kDebug: {
-                boost::log::core::get()->set_filter(
-                    boost::log::trivial::severity >= boost::log::trivial::debug);
+                SetRuntimeMinLevel(boost::log::trivial::debug);
                 break;
             }
 
             case kInfo: {
-                boost::log::core::get()->set_filter(
-                    boost::log::trivial::severity >= boost::log::trivial::info);
+                SetRuntimeMinLevel(boost::log::trivial::info);
                 break;
             }
 
             case kWarn: {
-                boost::log::core::get()->set_filter(
-                    boost::log::trivial::severity >= boost::log::trivial::warning);
+                SetRuntimeMinLevel(boost::log::trivial::warning);
                 break;
             }
 
             case kError: {
-                boost::log::core::get()->set_filter(
-                    boost::log::trivial::severity >= boost::log::trivial::error);
+                SetRuntimeMinLevel(boost::log::trivial::error);
                 break;
             }
 
             default: {
                 std::cout << "WARNING - Received unknown logging level.  Setting to Trace" << std::endl;
-                boost::log::core::get()->set_filter(
-                    boost::log::trivial::severity >= boost::log::trivial::trace);
+                SetRuntimeMinLevel(boost::log::trivial::trace);
                 break;
             }
         };
@@ -209,6 +207,11 @@ namespace golf_sim {
 
     }
 
+    void LoggingTools::SetRuntimeMinLevel(boost::log::trivial::severity_level level) {
+        runtime_min_level_.store((int)level, std::memory_order_relaxed);
+        boost::log::core::get()->set_filter(boost::log::trivial::severity >= level);
+    }
+
     boost::circular_buffer<std::string> &LoggingTools::GetRecentLogMessagesQueue() {
         return RecentLogMessages;
     }
@@ -216,6 +219,10 @@ namespace golf_sim {
 
     void LoggingTools::InternalLog(boost::log::trivial::severity_level log_level, const std::string& msg) {
 
+        if (!IsLevelEnabled(log_level)) {
+            return;
+        }
+
         switch(log_level) {
 
             case severity_level::trace:
@@ -532,15 +539,12 @@ namespace golf_sim {
             fname += ".png";
         }
 
-        try {
-            cv::imwrite(fname, imgToLog);
-        }
-        catch (std::exception& ex) {
-            GS_LOG_TRACE_MSG(warning, "Exception! - failed to imwrite with fname = " + fname + " - " + ex.what());
-            return true;
-        }
+        // The PNG encoding is slow, so it is done in the background.  imgToLog is our own copy.
+        // Fixed-name images are the ones the GUI opens, so they must not be dropped or re-encoded.
+        const ArtifactWriter::Priority priority = (forceFixedFileName && !fixedFileName.empty()) ?
+            ArtifactWriter::Priority::kWebserver : ArtifactWriter::Priority::kDiagnostic;
 
-        InternalLog(trace, "Logged image to file: " + fname);
+        ArtifactWriter::GetSharedWriter().Submit(fname, std::move(imgToLog), priority);
 
         return true;
     }
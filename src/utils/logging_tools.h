@@ -28,8 +28,10 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/highgui.hpp>
 
+#include <atomic>
 #include <string>
 
+#include "gs_format_lib.h"
 #include "golf_ball.h"   // TBD - Something wrong here architecturally - why does logging know about specific golf types?  Does that make sense?
 #include "gs_globals.h"
 
@@ -48,6 +50,16 @@ struct LoggingTools
 
 	static void InitLogging();
 
+	// The least severe level that is currently being logged.  The GS_LOG macros check this
+	// before building their message, so a disabled message costs only this comparison.
+	static std::atomic<int> runtime_min_level_;
+
+	static bool IsLevelEnabled(boost::log::trivial::severity_level level) {
+		return (int)level >= runtime_min_level_.load(std::memory_order_relaxed);
+	}
+
+	static void SetRuntimeMinLevel(boost::log::trivial::severity_level level);
+
 	// Lowest-level logging function to allow for additional filtering, sinking, etc.
 	static void InternalLog(boost::log::trivial::severity_level level, const std::string& msg);
 
@@ -143,11 +155,31 @@ protected:
 	static boost::circular_buffer<std::string> RecentLogMessages;
 };
 
-// Used as a define so that we can get file/line-numbers in our tracing if we want
-#define GS_LOG_MSG(LEVEL, MSG) BOOST_LOG_FUNCTION();  BOOST_LOG_TRIVIAL(LEVEL) << MSG
-
-// Trace logging is everywhere, so this macro allows just that macro to be undefined
-// in order to increase performance
-#define GS_LOG_TRACE_MSG(LEVEL, MSG) BOOST_LOG_FUNCTION();  BOOST_LOG_TRIVIAL(LEVEL) << MSG
+// Messages less severe than this (0 = trace ... 5 = fatal) are compiled out entirely.
+// Set with the meson log_compile_time_min_level option.
+#ifndef GS_LOG_COMPILE_TIME_MIN_LEVEL
+#define GS_LOG_COMPILE_TIME_MIN_LEVEL 0
+#endif
+
+#define GS_LOG_LEVEL_IS_COMPILED_IN(LEVEL) ((int)::boost::log::trivial::LEVEL >= GS_LOG_COMPILE_TIME_MIN_LEVEL)
+
+// Used as a define so that we can get file/line-numbers in our tracing if we want.
+// MSG is only evaluated (and the named scope only pushed) if LEVEL is being logged.
+#define GS_LOG_MSG(LEVEL, MSG) \
+	do { \
+		if constexpr (GS_LOG_LEVEL_IS_COMPILED_IN(LEVEL)) { \
+			if (::golf_sim::LoggingTools::IsLevelEnabled(::boost::log::trivial::LEVEL)) { \
+				BOOST_LOG_FUNCTION();  BOOST_LOG_TRIVIAL(LEVEL) << MSG; \
+			} \
+		} \
+	} while (0)
+
+// Trace logging is everywhere, including inside some hot loops, so it is a separate macro
+// in case it ever needs to be handled differently
+#define GS_LOG_TRACE_MSG(LEVEL, MSG) GS_LOG_MSG(LEVEL, MSG)
+
+// fmt-style formatting, e.g., GS_LOG_TRACE_FMT(trace, "ball at ({}, {})", x, y).  The
+// arguments are only formatted if LEVEL is being logged.
+#define GS_LOG_TRACE_FMT(LEVEL, ...) GS_LOG_MSG(LEVEL, GS_FORMATLIB_FORMAT(__VA_ARGS__))
 
 }
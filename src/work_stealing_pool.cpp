@@ -0,0 +1,184 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+#include <algorithm>
+
+#include "work_stealing_pool.h"
+
+
+namespace golf_sim {
+
+    // Lets ParallelFor know whether it is being called from one of a pool's own workers,
+    // in which case the new chunks go onto that worker's deque so that it works on them first.
+    static thread_local const WorkStealingPool* tls_current_pool = nullptr;
+    static thread_local unsigned int tls_worker_index = 0;
+
+    WorkStealingPool::WorkStealingPool(unsigned int num_threads) {
+        if (num_threads == 0) {
+            unsigned int hardware_threads = std::thread::hardware_concurrency();
+            // The calling thread always works too, so leave a core for it
+            num_threads = (hardware_threads > 1) ? hardware_threads - 1 : 1;
+        }
+
+        for (unsigned int i = 0; i < num_threads; i++) {
+            queues_.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        for (unsigned int i = 0; i < num_threads; i++) {
+            workers_.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stopping_ = true;
+        }
+        wake_cv_.notify_all();
+
+        for (std::thread& worker : workers_) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    WorkStealingPool& WorkStealingPool::GetSharedPool() {
+        static WorkStealingPool shared_pool;
+        return shared_pool;
+    }
+
+    void WorkStealingPool::ParallelFor(int begin, int end, const RangeBody& body, int grain_size) {
+        const int count = end - begin;
+
+        if (count <= 0) {
+            return;
+        }
+
+        if (grain_size <= 0) {
+            // Several chunks per thread, so that stealing can even out uneven chunk costs
+            grain_size = std::max(1, count / (int)(4 * (workers_.size() + 1)));
+        }
+
+        if (count <= grain_size || workers_.empty()) {
+            body(begin, end);
+            return;
+        }
+
+        Job job;
+        job.body = &body;
+
+        const int num_chunks = (count + grain_size - 1) / grain_size;
+        job.chunks_remaining.store(num_chunks);
+
+        const bool called_from_worker = (tls_current_pool == this);
+
+        for (int i = 0; i < num_chunks; i++) {
+            Chunk chunk;
+            chunk.job = &job;
+            chunk.begin = begin + i * grain_size;
+            chunk.end = std::min(end, chunk.begin + grain_size);
+
+            unsigned int queue_index = called_from_worker ? tls_worker_index :
+                                       next_queue_.fetch_add(1, std::memory_order_relaxed) % (unsigned int)queues_.size();
+
+            std::lock_guard<std::mutex> lock(queues_[queue_index]->mutex);
+            queues_[queue_index]->chunks.push_back(chunk);
+        }
+
+        pending_chunks_.fetch_add(num_chunks);
+        {
+            // Taking the lock closes the window between a worker checking for work and going to sleep
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+        }
+        wake_cv_.notify_all();
+
+        // Help out until every chunk of this job has finished.  Any chunk is fair game,
+        // including other callers' - it all needs to be done anyway.
+        const unsigned int home_queue = called_from_worker ? tls_worker_index : 0;
+
+        while (job.chunks_remaining.load(std::memory_order_acquire) > 0) {
+            Chunk chunk;
+
+            if (TryGetChunk(home_queue, chunk)) {
+                RunChunk(chunk);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+
+        if (job.exception) {
+            std::rethrow_exception(job.exception);
+        }
+    }
+
+    bool WorkStealingPool::TryGetChunk(unsigned int queue_index, Chunk& chunk) {
+        {
+            WorkerQueue& own_queue = *queues_[queue_index];
+            std::lock_guard<std::mutex> lock(own_queue.mutex);
+
+            if (!own_queue.chunks.empty()) {
+                chunk = own_queue.chunks.back();
+                own_queue.chunks.pop_back();
+                pending_chunks_.fetch_sub(1);
+                return true;
+            }
+        }
+
+        for (size_t offset = 1; offset < queues_.size(); offset++) {
+            WorkerQueue& victim = *queues_[(queue_index + offset) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+
+            if (!victim.chunks.empty()) {
+                chunk = victim.chunks.front();
+                victim.chunks.pop_front();
+                pending_chunks_.fetch_sub(1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void WorkStealingPool::RunChunk(const Chunk& chunk) {
+        Job* job = chunk.job;
+
+        try {
+            (*job->body)(chunk.begin, chunk.end);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(job->exception_mutex);
+            if (!job->exception) {
+                job->exception = std::current_exception();
+            }
+        }
+
+        // This must be the last access to the job, which belongs to the waiting caller
+        job->chunks_remaining.fetch_sub(1, std::memory_order_release);
+    }
+
+    void WorkStealingPool::WorkerLoop(unsigned int worker_index) {
+        tls_current_pool = this;
+        tls_worker_index = worker_index;
+
+        while (true) {
+            Chunk chunk;
+
+            if (TryGetChunk(worker_index, chunk)) {
+                RunChunk(chunk);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait(lock, [this] { return stopping_ || pending_chunks_.load() > 0; });
+
+            if (stopping_ && pending_chunks_.load() <= 0) {
+                return;
+            }
+        }
+    }
+
+}
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (C) 2022-2025, Verdant Consultants, LLC.
+ */
+
+// A small fork-join pool for CPU-bound, data-parallel work such as scoring spin candidates.
+// Each worker owns a deque of range chunks; it pops its own work LIFO and steals the
+// oldest chunks from other workers when it runs dry.  The thread that calls ParallelFor
+// also executes (and steals) chunks until its own job is finished, so several independent
+// callers - e.g., two spin analyses running at once - share all of the cores instead of
+// one of them being serialized, as happens with nested/concurrent cv::parallel_for_ calls.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace golf_sim {
+
+class WorkStealingPool {
+public:
+
+    // The body is called with a half-open [begin, end) sub-range of the overall range
+    typedef std::function<void(int begin, int end)> RangeBody;
+
+    // num_threads == 0 means one worker per hardware thread, less the calling thread
+    explicit WorkStealingPool(unsigned int num_threads = 0);
+
+    // Waits for any chunks that are in-flight and then stops the workers
+    ~WorkStealingPool();
+
+    // Runs body over [begin, end) in chunks of (about) grain_size elements and returns when
+    // every chunk is done.  Safe to call concurrently from several threads and re-entrantly
+    // from inside another body.  If a body throws, the first exception is re-thrown here
+    // after the remaining chunks of this call have finished.
+    void ParallelFor(int begin, int end, const RangeBody& body, int grain_size = 0);
+
+    unsigned int GetNumWorkers() const { return (unsigned int)workers_.size(); }
+
+    // Process-wide pool that is shared by all spin analyses
+    static WorkStealingPool& GetSharedPool();
+
+private:
+
+    // Per-ParallelFor-call bookkeeping.  Lives on the caller's stack.
+    struct Job {
+        const RangeBody* body = nullptr;
+        std::atomic<int> chunks_remaining{ 0 };
+        std::mutex exception_mutex;
+        std::exception_ptr exception;
+    };
+
+    struct Chunk {
+        Job* job = nullptr;
+        int begin = 0;
+        int end = 0;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    void WorkerLoop(unsigned int worker_index);
+
+    // Pops from the back of queue_index's deque, or steals from the front of another one
+    bool TryGetChunk(unsigned int queue_index, Chunk& chunk);
+
+    static void RunChunk(const Chunk& chunk);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    // Round-robin starting queue for chunks posted by threads that are not workers
+    std::atomic<unsigned int> next_queue_{ 0 };
+
+    std::atomic<int> pending_chunks_{ 0 };
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool stopping_ = false;
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+};
+
+}